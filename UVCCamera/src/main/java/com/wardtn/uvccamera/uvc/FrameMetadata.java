@@ -0,0 +1,116 @@
+package com.wardtn.uvccamera.uvc;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+
+/**
+ * 帧元数据
+ * 本地层在调用 IFrameCallback/IBufferedFrameCallback#onFrame 之前写入 UVCCamera#getFrameMetadataBuffer
+ * 返回的共享 direct ByteBuffer, 读取时不需要额外的 JNI 调用。
+ * IFrameCallback 的元数据只在 onFrame 中有效,
+ * IBufferedFrameCallback 的元数据在调用 UVCCamera#releaseFrame 之前有效。
+ */
+public class FrameMetadata {
+	/** 每个元数据的字节数, 与本地层的 frame_metadata_t 一致 */
+	public static final int BYTES = 320;
+	/** IBufferedFrameCallback 的最大缓冲区数 */
+	public static final int MAX_BUFFERS = 16;
+	/** IFrameCallback 用的 slot */
+	public static final int SLOT_FRAME_CALLBACK = MAX_BUFFERS;
+
+	// UVCCamera#setFrameStats 的 flags, 与本地层的 FrameStats.h 一致
+	public static final int STATS_MEAN = 0x01;
+	public static final int STATS_HISTOGRAM = 0x02;
+	public static final int STATS_FOCUS = 0x04;
+	public static final int STATS_ALL = STATS_MEAN | STATS_HISTOGRAM | STATS_FOCUS;
+	/** 直方图的 bin 数, 每个 bin 4 个亮度等级 */
+	public static final int HISTOGRAM_BINS = 64;
+
+	private static final int OFFSET_SEQUENCE = 0;
+	private static final int OFFSET_PTS = 4;
+	private static final int OFFSET_CAPTURE_TIME = 8;
+	private static final int OFFSET_WIDTH = 16;
+	private static final int OFFSET_HEIGHT = 20;
+	private static final int OFFSET_STEP = 24;
+	private static final int OFFSET_PIXEL_FORMAT = 28;
+	private static final int OFFSET_FRAME_FORMAT = 32;
+	private static final int OFFSET_DATA_BYTES = 36;
+	private static final int OFFSET_DROPPED = 40;
+	private static final int OFFSET_SCR = 44;
+	private static final int OFFSET_STATS_FLAGS = 48;
+	private static final int OFFSET_STATS_SAMPLES = 52;
+	private static final int OFFSET_LUMA_MEAN = 56;
+	private static final int OFFSET_FOCUS = 60;
+	private static final int OFFSET_HISTOGRAM = 64;
+
+	/** 帧编号 */
+	public int sequence;
+	/** dwPresentationTime, 没有时为 0 */
+	public int pts;
+	/** SCR 的 STC 部分, 没有时为 0 */
+	public int scr;
+	/** 帧接收完成时的主机时间 [us] */
+	public long captureTimeUs;
+	public int width;
+	public int height;
+	/** 每行的字节数, MJPEG 时为 0 */
+	public int step;
+	/** UVCCamera#PIXEL_FORMAT_XXX */
+	public int pixelFormat;
+	/** 回调数据的 uvc_frame_format */
+	public int frameFormat;
+	public int dataBytes;
+	/** 与上一次回调之间丢失的帧数 */
+	public int dropped;
+	/** 计算了的 STATS_XXX, 0: 没有统计 */
+	public int statsFlags;
+	/** 统计的像素数 */
+	public int statsSamples;
+	/** 亮度平均值, STATS_MEAN */
+	public float lumaMean;
+	/** 对焦评价值(Laplacian 的方差), 越大越清晰, STATS_FOCUS */
+	public float focus;
+	/** 亮度直方图, STATS_HISTOGRAM 时有效 */
+	public final int[] histogram = new int[HISTOGRAM_BINS];
+
+	/**
+	 * IBufferedFrameCallback#onFrame 的 index 对应的 slot
+	 */
+	public static int slotOf(final int index) {
+		return index & 0xffff;
+	}
+
+	/**
+	 * 从共享缓冲区读取元数据
+	 * @param buffer UVCCamera#getFrameMetadataBuffer
+	 * @param slot slotOf(index) 或 SLOT_FRAME_CALLBACK
+	 * @return this
+	 */
+	public FrameMetadata read(final ByteBuffer buffer, final int slot) {
+		if (buffer.order() != ByteOrder.nativeOrder()) {
+			buffer.order(ByteOrder.nativeOrder());
+		}
+		final int base = slot * BYTES;
+		sequence = buffer.getInt(base + OFFSET_SEQUENCE);
+		pts = buffer.getInt(base + OFFSET_PTS);
+		captureTimeUs = buffer.getLong(base + OFFSET_CAPTURE_TIME);
+		width = buffer.getInt(base + OFFSET_WIDTH);
+		height = buffer.getInt(base + OFFSET_HEIGHT);
+		step = buffer.getInt(base + OFFSET_STEP);
+		pixelFormat = buffer.getInt(base + OFFSET_PIXEL_FORMAT);
+		frameFormat = buffer.getInt(base + OFFSET_FRAME_FORMAT);
+		dataBytes = buffer.getInt(base + OFFSET_DATA_BYTES);
+		dropped = buffer.getInt(base + OFFSET_DROPPED);
+		scr = buffer.getInt(base + OFFSET_SCR);
+		statsFlags = buffer.getInt(base + OFFSET_STATS_FLAGS);
+		statsSamples = buffer.getInt(base + OFFSET_STATS_SAMPLES);
+		lumaMean = buffer.getFloat(base + OFFSET_LUMA_MEAN);
+		focus = buffer.getFloat(base + OFFSET_FOCUS);
+		if ((statsFlags & STATS_HISTOGRAM) != 0) {
+			for (int i = 0; i < HISTOGRAM_BINS; i++) {
+				histogram[i] = buffer.getInt(base + OFFSET_HISTOGRAM + i * 4);
+			}
+		}
+		return this;
+	}
+}
@@ -0,0 +1,22 @@
+package com.wardtn.uvccamera.uvc;
+
+import java.nio.ByteBuffer;
+
+/**
+ * UVCCamera 类的回调接口(常驻缓冲区版)
+ * 与 IFrameCallback 不同, 每帧不会生成新的 ByteBuffer, 而是循环使用 UVCCamera#setFrameCallback
+ * 时分配的固定个数的 direct ByteBuffer。
+ * 调用 UVCCamera#releaseFrame(index) 之前, 该缓冲区不会被覆盖, 所以可以不复制地持有帧数据。
+ * 所有缓冲区都被持有时, 新的帧会被丢弃。
+ */
+public interface IBufferedFrameCallback {
+	/**
+	 * 该方法通过 JNI 从本地库调用，并且在与 UVCCamera#startCapture 相同的线程上执行。
+	 * 缓冲区的 position/limit 不会被重置, 请使用绝对位置访问或者 frame.clear().limit(size)。
+	 * 调用 UVCCamera#releaseFrame(index) 之后不能再访问该缓冲区。
+	 * @param frame 来自 JNI 层的常驻 direct ByteBuffer
+	 * @param index 传给 UVCCamera#releaseFrame 的值
+	 * @param size 有效数据的字节数
+	 */
+	public void onFrame(ByteBuffer frame, int index, int size);
+}
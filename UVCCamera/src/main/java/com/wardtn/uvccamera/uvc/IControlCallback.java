@@ -0,0 +1,17 @@
+package com.wardtn.uvccamera.uvc;
+
+/**
+ * UVCCamera#setControlAsync 的完成通知
+ */
+public interface IControlCallback {
+	/**
+	 * 在本地库的控制工作线程上调用, 不要在这里进行耗时的处理。
+	 * 被合并(被之后的写入覆盖)的写入不会单独通知, 只通知合并后的ticket。
+	 * 可以在这里调用 UVCCamera#setControlCallback。
+	 * @param id UVCCamera#CONTROL_XXX
+	 * @param value 写入的值
+	 * @param result 0: 成功, <0: 错误
+	 * @param ticket UVCCamera#setControlAsync 返回的值
+	 */
+	public void onComplete(int id, int value, int result, int ticket);
+}
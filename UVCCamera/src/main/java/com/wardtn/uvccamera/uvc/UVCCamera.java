@@ -2,6 +2,7 @@ package com.wardtn.uvccamera.uvc;
 
 import android.graphics.SurfaceTexture;
 import android.hardware.usb.UsbDevice;
+import android.os.ParcelFileDescriptor;
 import android.text.TextUtils;
 import android.view.Surface;
 import android.view.SurfaceHolder;
@@ -14,6 +15,9 @@ import org.json.JSONArray;
 import org.json.JSONException;
 import org.json.JSONObject;
 
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
 import java.util.ArrayList;
 import java.util.List;
 
@@ -36,6 +40,10 @@ public class UVCCamera {
 	public static final int PIXEL_FORMAT_YUV420SP = 4;	// NV12
 	public static final int PIXEL_FORMAT_NV21 = 5;		// = YVU420SemiPlanar,NV21，但是保存到jpg颜色失真
 
+	// YUYV静止图像的色度抽样, same as TJSAMP_XXX
+	public static final int STILL_SUBSAMPLING_422 = 1;
+	public static final int STILL_SUBSAMPLING_420 = 2;
+
 	//--------------------------------------------------------------------------------
     public static final int	CTRL_SCANNING		= 0x00000001;	// D0:  Scanning Mode
     public static final int CTRL_AE				= 0x00000002;	// D1:  Auto-Exposure Mode
@@ -77,6 +85,68 @@ public class UVCCamera {
     public static final int PU_AVIDEO_LOCK		= 0x80020000;	// D17: AnaXLogWrapper Video Lock Status
     public static final int PU_CONTRAST_AUTO	= 0x80040000;	// D18: Contrast, Auto
 
+	// control id for #setControl/#setControlAsync, values are raw values of the device(not %)
+	public static final int CONTROL_SCANNING_MODE = 0;
+	public static final int CONTROL_EXPOSURE_MODE = 1;
+	public static final int CONTROL_EXPOSURE_PRIORITY = 2;
+	public static final int CONTROL_EXPOSURE = 3;
+	public static final int CONTROL_EXPOSURE_REL = 4;
+	public static final int CONTROL_AUTO_FOCUS = 5;
+	public static final int CONTROL_FOCUS = 6;
+	public static final int CONTROL_FOCUS_REL = 7;
+	public static final int CONTROL_IRIS = 8;
+	public static final int CONTROL_IRIS_REL = 9;
+	public static final int CONTROL_ZOOM = 10;
+	public static final int CONTROL_ZOOM_REL = 11;
+	public static final int CONTROL_PAN = 12;
+	public static final int CONTROL_TILT = 13;
+	public static final int CONTROL_ROLL = 14;
+	public static final int CONTROL_PAN_REL = 15;
+	public static final int CONTROL_TILT_REL = 16;
+	public static final int CONTROL_ROLL_REL = 17;
+	public static final int CONTROL_PRIVACY = 18;
+	public static final int CONTROL_AUTO_WHITE_BLANCE = 19;
+	public static final int CONTROL_AUTO_WHITE_BLANCE_COMPO = 20;
+	public static final int CONTROL_WHITE_BLANCE = 21;
+	public static final int CONTROL_WHITE_BLANCE_COMPO = 22;
+	public static final int CONTROL_BACKLIGHT_COMP = 23;
+	public static final int CONTROL_BRIGHTNESS = 24;
+	public static final int CONTROL_CONTRAST = 25;
+	public static final int CONTROL_AUTO_CONTRAST = 26;
+	public static final int CONTROL_SHARPNESS = 27;
+	public static final int CONTROL_GAIN = 28;
+	public static final int CONTROL_GAMMA = 29;
+	public static final int CONTROL_SATURATION = 30;
+	public static final int CONTROL_HUE = 31;
+	public static final int CONTROL_AUTO_HUE = 32;
+	public static final int CONTROL_POWERLINE_FREQUENCY = 33;
+	public static final int CONTROL_DIGITAL_MULTIPLIER = 34;
+	public static final int CONTROL_DIGITAL_MULTIPLIER_LIMIT = 35;
+	public static final int CONTROL_ANALOG_VIDEO_STANDARD = 36;
+	public static final int CONTROL_ANALOG_VIDEO_LOCK_STATE = 37;
+	public static final int CONTROL_NUM = 38;
+
+	// axis for #setPtzTarget/#setPtzVelocity, same as PtzController.h
+	public static final int PTZ_AXIS_PAN = 0;
+	public static final int PTZ_AXIS_TILT = 1;
+	public static final int PTZ_AXIS_ZOOM = 2;
+
+	// flags for #setSoftwareAeAwb, same as AeAwbLoop.h
+	public static final int SOFT_AE = 0x01;
+	public static final int SOFT_AWB = 0x02;
+
+	// uvc_thread_type from libuvc.h
+	public static final int THREAD_EVENT = 0;
+	public static final int THREAD_CALLBACK = 1;
+	public static final int THREAD_PREVIEW = 2;
+	public static final int THREAD_CAPTURE = 3;
+
+	// scheduling policy for #setThreadConfig
+	public static final int SCHED_KEEP = -1;
+	public static final int SCHED_OTHER = 0;
+	public static final int SCHED_FIFO = 1;
+	public static final int SCHED_RR = 2;
+
 	// uvc_status_class from libuvc.h
 	public static final int STATUS_CLASS_CONTROL = 0x10;
 	public static final int STATUS_CLASS_CONTROL_CAMERA = 0x11;
@@ -333,6 +403,31 @@ public class UVCCamera {
 		}
 	}
 
+	/**
+	 * Change preview size and preview mode while previewing
+	 * without restarting preview(threads, buffers and surfaces are kept)
+	 * same as #setPreviewSize when not previewing
+	 * @param width
+	 * @param height
+	 * @param min_fps
+	 * @param max_fps
+	 * @param frameFormat either FRAME_FORMAT_YUYV(0) or FRAME_FORMAT_MJPEG(1)
+	 * @param bandwidthFactor
+	 */
+	public synchronized void reconfigurePreview(final int width, final int height, final int min_fps, final int max_fps, final int frameFormat, final float bandwidthFactor) {
+		if ((width == 0) || (height == 0))
+			throw new IllegalArgumentException("invalid preview size");
+		if (mNativePtr != 0) {
+			final int result = nativeReconfigurePreview(mNativePtr, width, height, min_fps, max_fps, frameFormat, bandwidthFactor);
+			if (result != 0)
+				throw new IllegalArgumentException("Failed to reconfigure preview");
+			mCurrentFrameFormat = frameFormat;
+			mCurrentWidth = width;
+			mCurrentHeight = height;
+			mCurrentBandwidthFactor = bandwidthFactor;
+		}
+	}
+
 	public List<Size> getSupportedSizeList() {
 		if (mCurrentFrameFormat < 0) {
 			mCurrentFrameFormat = FRAME_FORMAT_MJPEG;
@@ -417,6 +512,293 @@ public class UVCCamera {
     	}
     }
 
+    /**
+     * 设置帧回调(常驻缓冲区版), 每帧不生成ByteBuffer
+     * 收到的缓冲区需要调用releaseFrame归还
+     * @param callback
+     * @param pixelFormat
+     * @param numBuffers 缓冲区数(1-16)
+     */
+    public void setFrameCallback(final IBufferedFrameCallback callback, final int pixelFormat, final int numBuffers) {
+    	if (mNativePtr != 0) {
+        	nativeSetBufferedFrameCallback(mNativePtr, callback, pixelFormat, numBuffers);
+    	}
+    }
+
+    /**
+     * 帧元数据的共享缓冲区, 用FrameMetadata#read读取
+     * 在destroy之前有效, 只需要取得一次
+     * @return null: 未打开
+     */
+    public synchronized ByteBuffer getFrameMetadataBuffer() {
+    	if (mNativePtr != 0) {
+    		final ByteBuffer result = nativeGetFrameMetadataBuffer(mNativePtr);
+    		if (result != null) {
+    			result.order(ByteOrder.nativeOrder());
+    		}
+    		return result;
+    	}
+    	return null;
+    }
+
+    /**
+     * 在本地计算亮度统计, 结果附加到帧元数据(FrameMetadata#statsFlags等)
+     * NV21/YUV420SP时使用回调数据的Y plane, 其他像素格式使用转换前的YUYV帧, MJPEG时不计算
+     * @param flags FrameMetadata#STATS_XXX的组合, 0: 不计算
+     * @param roiX 回调帧上的像素坐标
+     * @param roiY
+     * @param roiWidth <=0: 整个帧
+     * @param roiHeight <=0: 整个帧
+     * @param rowStep 每rowStep行取一行
+     */
+    public synchronized void setFrameStats(final int flags,
+    	final int roiX, final int roiY, final int roiWidth, final int roiHeight, final int rowStep) {
+
+    	if (mNativePtr != 0) {
+    		nativeSetFrameStats(mNativePtr, flags, roiX, roiY, roiWidth, roiHeight, rowStep);
+    	}
+    }
+
+    /**
+     * 追加本地帧处理插件(.so), 插件在本地工作线程上直接接收帧, 不经过Java
+     * 插件的ABI见jni/UVCCamera/uvc_frame_processor.h
+     * @param path 插件的路径(如 getApplicationInfo().nativeLibraryDir + "/libmotion.so")
+     * @param args 传给插件的字符串, 可以是null
+     * @return 插件id, 用于removeFrameProcessor
+     * @throws IllegalArgumentException 读入失败
+     */
+    public synchronized int addFrameProcessor(final String path, final String args) {
+    	if (mNativePtr == 0 || TextUtils.isEmpty(path)) {
+    		throw new IllegalArgumentException("invalid frame processor");
+    	}
+    	final int result = nativeAddFrameProcessor(mNativePtr, path, args);
+    	if (result <= 0) {
+    		throw new IllegalArgumentException("failed to load frame processor:err=" + result);
+    	}
+    	return result;
+    }
+
+    public synchronized void removeFrameProcessor(final int id) {
+    	if (mNativePtr != 0) {
+    		nativeRemoveFrameProcessor(mNativePtr, id);
+    	}
+    }
+
+    /**
+     * 开始向跨进程共享的帧环(memfd/ashmem)写入帧
+     * 把返回的ParcelFileDescriptor经Binder传给其他进程, 用libuvcshmreader(uvc_shm_ring.h)不复制地读取
+     * @param numSlots 帧数(2-64)
+     * @param slotBytes 每帧的最大字节数, 0: 当前的帧大小
+     * @return 共享内存的fd, 调用侧负责close
+     * @throws IOException
+     */
+    public synchronized ParcelFileDescriptor startSharedFrameRing(final int numSlots, final int slotBytes) throws IOException {
+    	if (mNativePtr == 0) {
+    		throw new IllegalStateException("camera is not opened");
+    	}
+    	final int fd = nativeStartSharedFrameRing(mNativePtr, numSlots, slotBytes);
+    	if (fd < 0) {
+    		throw new IOException("failed to create shared frame ring:err=" + fd);
+    	}
+    	// dup so that the ring keeps its own fd
+    	return ParcelFileDescriptor.fromFd(fd);
+    }
+
+    public synchronized void stopSharedFrameRing() {
+    	if (mNativePtr != 0) {
+    		nativeStopSharedFrameRing(mNativePtr);
+    	}
+    }
+
+    /**
+     * 预录: 在内存中保留最近收到的帧(MJPEG/YUYV, 不解码), 用于事件触发录像
+     * @param budgetBytes 最大字节数(预先分配), 0: 停止预录
+     * @param durationMs 最长时间, 0: 只按字节数
+     */
+    public synchronized void setPreRoll(final int budgetBytes, final int durationMs) {
+    	if (mNativePtr != 0) {
+    		final int result = nativeSetPreRoll(mNativePtr, budgetBytes, durationMs);
+    		if (result != 0) {
+    			throw new IllegalArgumentException("failed to set pre-roll:err=" + result);
+    		}
+    	}
+    }
+
+    /**
+     * 把预录的帧写入文件, 写入由后台线程进行
+     * path: 帧数据(MJPEG时为连续的jpeg), path + ".idx": 每帧的时间戳等(csv)
+     * @param path
+     * @return 写入的帧数
+     * @throws IOException
+     */
+    public synchronized int dumpPreRoll(final String path) throws IOException {
+    	if (mNativePtr == 0 || TextUtils.isEmpty(path)) {
+    		throw new IOException("invalid state or path");
+    	}
+    	final int result = nativeDumpPreRoll(mNativePtr, path);
+    	if (result < 0) {
+    		throw new IOException("failed to dump pre-roll:err=" + result);
+    	}
+    	return result;
+    }
+
+    /**
+     * 把下一个完整的帧作为静止图像(jpeg)写入文件
+     * MJPEG时不解码/不重新编码, 只在缺少时补上标准的霍夫曼表(DHT)
+     * YUYV时在native层用TurboJPEG编码, 参见{@link #setStillQuality(int, int)}
+     * @param path
+     * @param timeoutMs 等待写入结束的时间, 0: 不等待(后台写入)
+     * @throws IOException 失败/超时/不支持的帧格式
+     */
+    public synchronized void captureStill(final String path, final int timeoutMs) throws IOException {
+    	if (mNativePtr == 0 || TextUtils.isEmpty(path)) {
+    		throw new IOException("invalid state or path");
+    	}
+    	final int result = nativeCaptureStill(mNativePtr, path, timeoutMs);
+    	if (result != 0) {
+    		throw new IOException("failed to capture still:err=" + result);
+    	}
+    }
+
+    /**
+     * 设置YUYV静止图像的jpeg质量
+     * @param quality 1-100, 默认90
+     * @param subsampling STILL_SUBSAMPLING_422 or STILL_SUBSAMPLING_420
+     * @return true: 成功
+     */
+    public synchronized boolean setStillQuality(final int quality, final int subsampling) {
+    	return (mNativePtr != 0) && (nativeSetStillQuality(mNativePtr, quality, subsampling) == 0);
+    }
+
+    /**
+     * 开始MJPEG录像, 不经过MediaCodec, 直接把收到的jpeg写入Matroska(.mkv)文件
+     * 只在以FRAME_FORMAT_MJPEG预览中有效
+     * 意外结束时已写入的部分仍然可以播放
+     * @param path
+     * @throws IOException 不是MJPEG/正在录像/无法打开文件
+     */
+    public synchronized void startRecording(final String path) throws IOException {
+    	if (mNativePtr == 0 || TextUtils.isEmpty(path)) {
+    		throw new IOException("invalid state or path");
+    	}
+    	final int result = nativeStartRecording(mNativePtr, path);
+    	if (result != 0) {
+    		throw new IOException("failed to start recording:err=" + result);
+    	}
+    }
+
+    /**
+     * 结束录像, 写完剩余的帧和索引之后返回, stopPreview时也会自动结束
+     * @return 写入的帧数, <0: 错误
+     */
+    public synchronized int stopRecording() {
+    	return mNativePtr != 0 ? nativeStopRecording(mNativePtr) : -1;
+    }
+
+    /**
+     * 录像的写入统计, 结束之后返回最后一次录像的值
+     * @return {写入的字节数, 队列中的字节数, 队列的最大字节数, 吞吐量[bytes/s],
+     *          write次数, fdatasync次数, 丢弃的帧数}, 还没有录像时为null
+     */
+    public synchronized long[] getRecordingStats() {
+    	return mNativePtr != 0 ? nativeGetRecordingStats(mNativePtr) : null;
+    }
+
+    /**
+     * 开始原始帧转储, 用于离线分析图像质量
+     * 把收到的帧(YUYV/MJPEG, 不转换, 包括不完整的帧)连续写入path,
+     * 每帧的信息(sequence,capture_time_us,pts,scr,width,height,frame_format,step,offset,bytes,actual_bytes,bfh_err)写入path.idx(csv)
+     * bytes是写入path的字节数, 有错误位的帧actual_bytes为0, bytes为实际收到的字节数
+     * @param path
+     * @param maxFrames 最多写入的帧数, 0: 不限
+     * @param maxBytes 最多写入的字节数, 0: 不限
+     * @throws IOException
+     */
+    public synchronized void startRawDump(final String path, final int maxFrames, final long maxBytes) throws IOException {
+    	if (mNativePtr == 0 || TextUtils.isEmpty(path)) {
+    		throw new IOException("invalid state or path");
+    	}
+    	final int result = nativeStartRawDump(mNativePtr, path, maxFrames, maxBytes);
+    	if (result != 0) {
+    		throw new IOException("failed to start raw dump:err=" + result);
+    	}
+    }
+
+    /**
+     * 结束原始帧转储, 写完剩余的数据之后返回
+     * @return 写入的帧数, <0: 错误
+     */
+    public synchronized int stopRawDump() {
+    	return mNativePtr != 0 ? nativeStopRawDump(mNativePtr) : -1;
+    }
+
+    /**
+     * 归还IBufferedFrameCallback#onFrame收到的缓冲区
+     * @param index IBufferedFrameCallback#onFrame的index
+     */
+    public void releaseFrame(final int index) {
+    	if (mNativePtr != 0) {
+    		nativeReleaseFrame(mNativePtr, index);
+    	}
+    }
+
+    /**
+     * 低延迟预览模式: 只保留最新一帧, 到达后立即绘制
+     * @param lowLatency
+     */
+    public synchronized void setLowLatency(final boolean lowLatency) {
+    	if (mNativePtr != 0) {
+    		nativeSetLowLatency(mNativePtr, lowLatency);
+    	}
+    }
+
+    /**
+     * 设置线程调度(在开始预览时生效, 需要在open之后调用)
+     * @param thread THREAD_EVENT/THREAD_CALLBACK/THREAD_PREVIEW/THREAD_CAPTURE
+     * @param policy SCHED_KEEP/SCHED_OTHER/SCHED_FIFO/SCHED_RR, SCHED_FIFO/SCHED_RR需要权限, 失败时使用nice值
+     * @param priority SCHED_OTHER时为nice值(-20...19), 否则为实时优先级(1...99)
+     * @param cpuMask bit n => cpu n, 0: 不变
+     */
+    public synchronized void setThreadConfig(final int thread, final int policy, final int priority, final int cpuMask) {
+    	if (mCtrlBlock != null) {
+    		nativeSetThreadConfig(mNativePtr, thread, policy, priority, cpuMask);
+    	}
+    }
+
+    /**
+     * startPreview/reconfigurePreview到收到第一帧的时间
+     * @return [us], 0: 还没有收到
+     */
+    public synchronized long getTimeToFirstFrame() {
+    	return mNativePtr != 0 ? nativeGetTimeToFirstFrame(mNativePtr) : 0;
+    }
+
+    /**
+     * 设置协商结果(stream control)缓存的保存路径, 缓存在所有UVCCamera之间共享
+     * 命中时startPreview只需要commit, 不需要probe
+     * @param path null: 只保存在内存中
+     */
+    public static void setStreamCtrlCachePath(final String path) {
+    	nativeSetStreamCtrlCachePath(path);
+    }
+
+    /**
+     * 清除协商结果缓存(包括文件)
+     */
+    public static void clearStreamCtrlCache() {
+    	nativeClearStreamCtrlCache();
+    }
+
+    /**
+     * 预览延迟(曝光开始(PTS) => 绘制结束)
+     * 设备不提供PTS/SCR时为帧接收完成 => 绘制结束
+     * @param average true: 平滑后的平均值, false: 最后一帧
+     * @return [us]
+     */
+    public synchronized long getPreviewLatency(final boolean average) {
+    	return mNativePtr != 0 ? nativeGetPreviewLatency(mNativePtr, average) : 0;
+    }
+
     /**
      * start preview
      */
@@ -436,6 +818,23 @@ public class UVCCamera {
     	}
     }
 
+    /**
+     * 暂停预览(warm standby), 保留传输缓冲区/altsetting/线程/帧池
+     * 比stopPreview/startPreview快, 但暂停中依然占用USB带宽
+     * @return true: 成功
+     */
+    public synchronized boolean pausePreview() {
+    	return mCtrlBlock != null && nativePausePreview(mNativePtr) == 0;
+    }
+
+    /**
+     * 恢复pausePreview暂停的预览, 只重新提交传输
+     * @return true: 成功
+     */
+    public synchronized boolean resumePreview() {
+    	return mCtrlBlock != null && nativeResumePreview(mNativePtr) == 0;
+    }
+
     /**
      * destroy UVCCamera object
      */
@@ -457,6 +856,206 @@ public class UVCCamera {
     		return (mControlSupports & flag) == flag;
     }
 
+    /**
+     * 控制值缓存(默认有效), getXXX从缓存返回当前值而不进行USB传输,
+     * 相机通过状态中断通知变化的控制始终保持最新, 其他控制超过refreshMs之后重新读取
+     * @param enable false: 每次都从相机读取
+     * @param refreshMs 没有状态中断的控制的有效期[ms], 0: 不过期
+     */
+    public synchronized void setControlCache(final boolean enable, final int refreshMs) {
+    	if (mCtrlBlock != null) {
+    		nativeSetControlCache(mNativePtr, enable, refreshMs);
+    	}
+    }
+
+    /**
+     * @return {命中次数, 未命中次数}, 未打开时为null
+     */
+    public synchronized long[] getControlCacheStats() {
+    	return mCtrlBlock != null ? nativeGetControlCacheStats(mNativePtr) : null;
+    }
+
+    /**
+     * 按控制id写入(同步)
+     * @param id CONTROL_XXX
+     * @param value 设备的值(不是%)
+     * @return 0: 成功, <0: 错误
+     */
+    public synchronized int setControl(final int id, final int value) {
+    	return mCtrlBlock != null ? nativeSetControl(mNativePtr, id, value) : -1;
+    }
+
+    /**
+     * 按控制id异步写入, 立即返回. 对同一个控制还没执行的写入会被合并(在原来的位置替换成最后的值),
+     * 不同控制之间按第一次调用的顺序执行. 滑块等连续改变值时使用
+     * @param id CONTROL_XXX
+     * @param value 设备的值(不是%)
+     * @return ticket(>0), 用于#waitControl和IControlCallback, <0: 错误
+     */
+    public synchronized int setControlAsync(final int id, final int value) {
+    	return mCtrlBlock != null ? nativeSetControlAsync(mNativePtr, id, value) : -1;
+    }
+
+    /**
+     * 等待到ticket为止的所有异步写入完成(被合并的写入在合并它的写入完成时完成),
+     * 等待期间其他的方法也会被阻塞, 请指定较短的超时
+     * @param ticket #setControlAsync的返回值
+     * @param timeoutMs <=0: 不超时
+     * @return true: 完成, false: 超时或者相机已经关闭
+     */
+    public synchronized boolean waitControl(final int ticket, final int timeoutMs) {
+    	return mCtrlBlock != null && nativeWaitControl(mNativePtr, ticket, timeoutMs) == 0;
+    }
+
+    /**
+     * 设置异步写入的完成通知
+     * @param callback null: 移除
+     */
+    public synchronized void setControlCallback(final IControlCallback callback) {
+    	if (mCtrlBlock != null) {
+    		nativeSetControlCallback(mNativePtr, callback);
+    	}
+    }
+
+    /**
+     * 一次性取得所有支持的控制的最小值/最大值/默认值/分辨率/GET_INFO(请求同时发送)
+     * updateCameraParams会自动调用
+     * @return 0: 成功, <0: 错误
+     */
+    public synchronized int probeControls() {
+    	return mCtrlBlock != null ? nativeProbeControls(mNativePtr, 1000) : -1;
+    }
+
+    /**
+     * @param id CONTROL_XXX
+     * @return {min, max, def, res, info, valid}, 不支持时为null
+     */
+    public synchronized int[] getControlCaps(final int id) {
+    	return mCtrlBlock != null ? nativeGetControlCaps(mNativePtr, id) : null;
+    }
+
+    /**
+     * 一次设置多个控制(恢复配置等), 比逐个调用setXXX快.
+     * 不支持的控制被跳过, 自动模式(曝光模式/自动对焦/自动白平衡等)先设置, 其他按指定的顺序
+     * @param ids CONTROL_XXX, 最多CONTROL_NUM个
+     * @param values 设备的值(不是%), 超出范围时限制在最小值・最大值之间
+     * @return 每个控制的结果(和ids的顺序相同), 0: 成功, <0: 错误, 失败或者未打开时为null
+     */
+    public synchronized int[] applyControls(final int[] ids, final int[] values) {
+    	if ((ids == null) || (values == null) || (ids.length != values.length)) {
+    		throw new IllegalArgumentException("ids and values should have same length");
+    	}
+    	return mCtrlBlock != null ? nativeApplyControls(mNativePtr, ids, values) : null;
+    }
+
+    /**
+     * 扩展单元(XU)的一览
+     * @return JSON, {"units":[{"id":.., "guid":"..", "bmControls":.., "controls":[{"selector":.., "len":.., "info":..}]}]}
+     * 未打开时为null
+     */
+    public synchronized String getExtensionUnits() {
+    	return mCtrlBlock != null ? nativeGetExtensionUnits(mNativePtr) : null;
+    }
+
+    /**
+     * 读取扩展单元的控制(GET_CUR)
+     * @param unitId 扩展单元的id
+     * @param selector 控制的selector(bmControls的bit位置+1)
+     * @param data 长度需要和GET_LEN的值一致
+     * @return 读取的字节数, <0: 错误
+     */
+    public synchronized int getXuControl(final int unitId, final int selector, final byte[] data) {
+    	return mCtrlBlock != null ? nativeGetXuControl(mNativePtr, unitId, selector, data) : -1;
+    }
+
+    /**
+     * 写入扩展单元的控制(SET_CUR)
+     * @param unitId 扩展单元的id
+     * @param selector 控制的selector(bmControls的bit位置+1)
+     * @param data 长度需要和GET_LEN的值一致
+     * @return 写入的字节数, <0: 错误
+     */
+    public synchronized int setXuControl(final int unitId, final int selector, final byte[] data) {
+    	return mCtrlBlock != null ? nativeSetXuControl(mNativePtr, unitId, selector, data) : -1;
+    }
+
+    /**
+     * 所有支持的控制的当前值作为配置输出(包括pan/tilt, digital window, ROI), 用importControlProfile恢复
+     * @return JSON, 未打开时为null
+     */
+    public synchronized String exportControlProfile() {
+    	return mCtrlBlock != null ? nativeExportControlProfile(mNativePtr) : null;
+    }
+
+    /**
+     * 设置配置, 之后每次open时在开始预览之前一起恢复, 已经打开时马上恢复.
+     * 只发送和当前值不同的控制, 比逐个调用setXXX快
+     * @param profile exportControlProfile的返回值, null时清除
+     * @return 0: 成功, <0: 格式错误或者恢复失败
+     */
+    public synchronized int importControlProfile(final String profile) {
+    	return mNativePtr != 0 ? nativeImportControlProfile(mNativePtr, profile) : -1;
+    }
+
+    /**
+     * PTZ: 在durationMs内平滑地移动到目标位置(需要绝对控制).
+     * native线程按固定周期插值后发送, pan/tilt合并成一个请求, 移动中也可以变更目标
+     * @param axis PTZ_AXIS_XXX
+     * @param value 设备的值, 超出范围时限制在最小值・最大值之间
+     * @param durationMs 0: 立即
+     * @return 0: 成功, <0: 错误(不支持时等)
+     */
+    public synchronized int setPtzTarget(final int axis, final int value, final int durationMs) {
+    	return mCtrlBlock != null ? nativeSetPtzTarget(mNativePtr, axis, value, durationMs) : -1;
+    }
+
+    /**
+     * PTZ: 以一定的速度移动(摇杆等), 设置0时停止.
+     * 连续调用也只在每个周期发送一次, 只支持相对控制的设备在方向/速度变化时发送
+     * @param axis PTZ_AXIS_XXX
+     * @param velocity 每秒的移动量(设备的单位), 符号是方向. 只支持相对控制时绝对值是设备的速度
+     * @return 0: 成功, <0: 错误(不支持时等)
+     */
+    public synchronized int setPtzVelocity(final int axis, final int velocity) {
+    	return mCtrlBlock != null ? nativeSetPtzVelocity(mNativePtr, axis, velocity) : -1;
+    }
+
+    /**
+     * PTZ: 所有的轴停止
+     */
+    public synchronized int haltPtz() {
+    	return mCtrlBlock != null ? nativeHaltPtz(mNativePtr) : -1;
+    }
+
+    /**
+     * PTZ: 发送的周期, 默认50ms
+     * @param periodMs 最小10ms
+     */
+    public synchronized int setPtzPeriod(final int periodMs) {
+    	return mCtrlBlock != null ? nativeSetPtzPeriod(mNativePtr, periodMs) : -1;
+    }
+
+    /**
+     * PTZ: 最后发送的位置(绝对控制), 不支持时为0
+     * @param axis PTZ_AXIS_XXX
+     */
+    public synchronized int getPtzPosition(final int axis) {
+    	return mCtrlBlock != null ? nativeGetPtzPosition(mNativePtr, axis) : 0;
+    }
+
+    /**
+     * 软件自动曝光/自动白平衡(设备的AE/AWB不好或者没有时).
+     * native预览线程在子采样的行上计算亮度/颜色的平均值, 通过异步控制队列调整曝光时间/增益/色温.
+     * 开始时设备的自动模式切换到手动, 结束时恢复
+     * @param flags SOFT_AE/SOFT_AWB的组合, 0: 结束
+     * @param targetLuma 目标平均亮度(1-254), <=0: 默认值(118)
+     * @param interval 每几帧计算一次, <=0: 默认值(3)
+     * @return 实际开始的SOFT_XXX, <0: 错误(设备不支持时等)
+     */
+    public synchronized int setSoftwareAeAwb(final int flags, final int targetLuma, final int interval) {
+    	return mCtrlBlock != null ? nativeSetSoftwareAeAwb(mNativePtr, flags, targetLuma, interval) : -1;
+    }
+
 //================================================================================
 	public synchronized void setAutoFocus(final boolean autoFocus) {
     	if (mNativePtr != 0) {
@@ -942,6 +1541,8 @@ public class UVCCamera {
     				mProcSupports = nativeGetProcSupports(mNativePtr);
     	    	// 設定値を取得
     	    	if ((mControlSupports != 0) && (mProcSupports != 0)) {
+    	    		// 先批量取得所有的范围, 之后的nativeUpdateXXXLimit不再访问设备
+    	    		nativeProbeControls(mNativePtr, 1000);
 	    	    	nativeUpdateBrightnessLimit(mNativePtr);
 	    	    	nativeUpdateContrastLimit(mNativePtr);
 	    	    	nativeUpdateSharpnessLimit(mNativePtr);
@@ -1070,10 +1671,36 @@ public class UVCCamera {
 
 	private static final native int nativeSetPreviewSize(final long id_camera, final int width, final int height, final int min_fps, final int max_fps, final int mode, final float bandwidth);
 	private static final native String nativeGetSupportedSize(final long id_camera);
+	private static final native int nativeReconfigurePreview(final long id_camera, final int width, final int height, final int min_fps, final int max_fps, final int mode, final float bandwidth);
 	private static final native int nativeStartPreview(final long id_camera);
 	private static final native int nativeStopPreview(final long id_camera);
 	private static final native int nativeSetPreviewDisplay(final long id_camera, final Surface surface);
 	private static final native int nativeSetFrameCallback(final long mNativePtr, final IFrameCallback callback, final int pixelFormat);
+	private static final native int nativeSetBufferedFrameCallback(final long mNativePtr, final IBufferedFrameCallback callback, final int pixelFormat, final int numBuffers);
+	private static final native int nativeReleaseFrame(final long id_camera, final int index);
+	private static final native ByteBuffer nativeGetFrameMetadataBuffer(final long id_camera);
+	private static final native int nativeSetFrameStats(final long id_camera, final int flags, final int roiX, final int roiY, final int roiWidth, final int roiHeight, final int rowStep);
+	private static final native int nativeAddFrameProcessor(final long id_camera, final String path, final String args);
+	private static final native int nativeRemoveFrameProcessor(final long id_camera, final int id);
+	private static final native int nativeStartSharedFrameRing(final long id_camera, final int numSlots, final int slotBytes);
+	private static final native int nativeStopSharedFrameRing(final long id_camera);
+	private static final native int nativeSetPreRoll(final long id_camera, final int budgetBytes, final int durationMs);
+	private static final native int nativeDumpPreRoll(final long id_camera, final String path);
+	private static final native int nativeCaptureStill(final long id_camera, final String path, final int timeoutMs);
+	private static final native int nativeSetStillQuality(final long id_camera, final int quality, final int subsampling);
+	private static final native int nativeStartRecording(final long id_camera, final String path);
+	private static final native int nativeStopRecording(final long id_camera);
+	private static final native long[] nativeGetRecordingStats(final long id_camera);
+	private static final native int nativeStartRawDump(final long id_camera, final String path, final int maxFrames, final long maxBytes);
+	private static final native int nativeStopRawDump(final long id_camera);
+	private static final native int nativeSetLowLatency(final long id_camera, final boolean lowLatency);
+	private static final native long nativeGetPreviewLatency(final long id_camera, final boolean average);
+	private static final native long nativeGetTimeToFirstFrame(final long id_camera);
+	private static final native int nativePausePreview(final long id_camera);
+	private static final native int nativeResumePreview(final long id_camera);
+	private static final native int nativeSetStreamCtrlCachePath(final String path);
+	private static final native int nativeClearStreamCtrlCache();
+	private static final native int nativeSetThreadConfig(final long id_camera, final int thread, final int policy, final int priority, final int cpuMask);
 
 //**********************************************************************
 	/**
@@ -1099,6 +1726,26 @@ public class UVCCamera {
 
 	private static final native long nativeGetCtrlSupports(final long id_camera);
 	private static final native long nativeGetProcSupports(final long id_camera);
+	private static final native int nativeSetControlCache(final long id_camera, final boolean enable, final int refreshMs);
+	private static final native long[] nativeGetControlCacheStats(final long id_camera);
+	private static final native int nativeSetControl(final long id_camera, final int id, final int value);
+	private static final native int nativeSetControlAsync(final long id_camera, final int id, final int value);
+	private static final native int nativeWaitControl(final long id_camera, final int ticket, final int timeoutMs);
+	private static final native int nativeSetControlCallback(final long id_camera, final IControlCallback callback);
+	private static final native int nativeProbeControls(final long id_camera, final int timeout_ms);
+	private static final native int[] nativeGetControlCaps(final long id_camera, final int id);
+	private static final native int[] nativeApplyControls(final long id_camera, final int[] ids, final int[] values);
+	private static final native String nativeGetExtensionUnits(final long id_camera);
+	private static final native int nativeGetXuControl(final long id_camera, final int unit_id, final int selector, final byte[] data);
+	private static final native int nativeSetXuControl(final long id_camera, final int unit_id, final int selector, final byte[] data);
+	private static final native String nativeExportControlProfile(final long id_camera);
+	private static final native int nativeImportControlProfile(final long id_camera, final String profile);
+	private static final native int nativeSetPtzTarget(final long id_camera, final int axis, final int value, final int duration_ms);
+	private static final native int nativeSetPtzVelocity(final long id_camera, final int axis, final int velocity);
+	private static final native int nativeHaltPtz(final long id_camera);
+	private static final native int nativeSetPtzPeriod(final long id_camera, final int period_ms);
+	private static final native int nativeGetPtzPosition(final long id_camera, final int axis);
+	private static final native int nativeSetSoftwareAeAwb(final long id_camera, final int flags, final int target, final int interval);
 
 	private final native int nativeUpdateScanningModeLimit(final long id_camera);
 	private static final native int nativeSetScanningMode(final long id_camera, final int scanning_mode);
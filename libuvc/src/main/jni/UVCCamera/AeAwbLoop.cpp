@@ -0,0 +1,285 @@
+/*
+ * UVCCamera
+ * library and sample to access to UVC web camera on non-rooted Android device
+ *
+ * Copyright (c) 2014-2017 saki t_saki@serenegiant.com
+ *
+ * File name: AeAwbLoop.cpp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * All files in the folder are under this Apache License, Version 2.0.
+ * Files in the jni/libjpeg, jni/libusb, jin/libuvc, jni/rapidjson folder may have a different license, see the respective files.
+*/
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#if 1	// set 1 if you don't need debug log
+	#ifndef LOG_NDEBUG
+		#define	LOG_NDEBUG		// w/o LOGV/LOGD/MARK
+	#endif
+	#undef USE_LOGALL
+#else
+	#define USE_LOGALL
+	#undef LOG_NDEBUG
+//	#undef NDEBUG
+#endif
+
+#include "utilbase.h"
+#include "AeAwbLoop.h"
+#include "ControlQueue.h"
+#include "UVCCamera.h"
+
+#define	LOCAL_DEBUG 0
+
+#define EXPOSURE_MODE_MANUAL	0x01
+#define GAIN_EV_RANGE			8.0		// assume full range of gain is about 8EV
+#define WB_STEPS_PER_LOG		0.25	// fraction of the temperature range per unit of log(B/R)
+#define WB_MAX_STEP				(1.0 / 16)
+
+AeAwbLoop::AeAwbLoop(UVCCamera *camera, ControlQueue *queue)
+:	mCamera(camera),
+	mQueue(queue),
+	mFlags(0),
+	mTarget(SOFT_AE_DEFAULT_TARGET),
+	mInterval(SOFT_AE_DEFAULT_INTERVAL),
+	mFrames(0),
+	mSent(0),
+	mCompleted(0) {
+
+	ENTER();
+	pthread_mutex_init(&loop_mutex, NULL);
+	memset(&mExposure, 0, sizeof(mExposure));
+	memset(&mGain, 0, sizeof(mGain));
+	memset(&mWhiteBalance, 0, sizeof(mWhiteBalance));
+	mExposure.restore_id = mGain.restore_id = mWhiteBalance.restore_id = -1;
+	mQueue->setCompleteCallback(on_control_complete, this);
+	EXIT();
+}
+
+AeAwbLoop::~AeAwbLoop() {
+	ENTER();
+	mFlags = 0;
+	mQueue->setCompleteCallback(NULL, NULL);
+	pthread_mutex_destroy(&loop_mutex);
+	EXIT();
+}
+
+/*static*/
+void AeAwbLoop::on_control_complete(void *user_ptr, int id, int32_t value, int result, int32_t ticket) {
+	AeAwbLoop *loop = reinterpret_cast<AeAwbLoop *>(user_ptr);
+	if (UNLIKELY(result)) {
+		LOGD("control write failed:id=%d,value=%d,err=%d", id, value, result);
+	}
+	__atomic_store_n(&loop->mCompleted, ticket, __ATOMIC_RELEASE);
+}
+
+/**
+ * 从能力表取得范围, 读取当前值, 自动模式有效时切换到手动(结束时恢复)
+ * 重新开始时设备已经是之前切换的手动模式(或者还在队列中), 沿用之前保存的自动模式
+ * @param mode_id 对应的自动模式的控制, -1: 没有
+ * @param manual_value 手动时mode_id的值
+ */
+void AeAwbLoop::prepare_ctrl(soft_ctrl_t &ctrl, int id, int mode_id, int32_t manual_value) {
+	const int32_t prev_restore_id = ctrl.restore_id;
+	const int32_t prev_restore_value = ctrl.restore_value;
+	memset(&ctrl, 0, sizeof(ctrl));
+	ctrl.id = id;
+	ctrl.restore_id = (mode_id >= 0) && (prev_restore_id == mode_id) ? mode_id : -1;
+	ctrl.restore_value = prev_restore_value;
+	control_caps_t caps;
+	if (mCamera->getControlCaps(id, &caps)
+		|| ((caps.valid & (CONTROL_CAPS_MIN | CONTROL_CAPS_MAX)) != (CONTROL_CAPS_MIN | CONTROL_CAPS_MAX))
+		|| (caps.max <= caps.min)) {
+		return;
+	}
+	ctrl.supported = true;
+	ctrl.min = caps.min;
+	ctrl.max = caps.max;
+	int32_t value;
+	if (!mCamera->getCtrlValue(id, value)) {
+		ctrl.value = value;
+	} else {
+		ctrl.value = (caps.valid & CONTROL_CAPS_DEF) ? caps.def : caps.min;
+	}
+	if ((mode_id >= 0) && (ctrl.restore_id < 0)) {
+		int32_t mode;
+		if (!mCamera->getCtrlValue(mode_id, mode) && (mode != manual_value)) {
+			ctrl.restore_id = mode_id;
+			ctrl.restore_value = mode;
+			const int32_t ticket = mCamera->setControlAsync(mode_id, manual_value);
+			if (ticket > 0) {
+				__atomic_store_n(&mSent, ticket, __ATOMIC_RELEASE);
+			}
+		}
+	}
+}
+
+// 四舍五入后有变化时加入ControlQueue, 小数部分保留在value中累积
+void AeAwbLoop::write_ctrl(soft_ctrl_t &ctrl, double value) {
+	value = value < ctrl.min ? ctrl.min : (value > ctrl.max ? ctrl.max : value);
+	const int32_t prev = (int32_t)lround(ctrl.value);
+	const int32_t next = (int32_t)lround(value);
+	ctrl.value = value;
+	if (next != prev) {
+		const int32_t ticket = mCamera->setControlAsync(ctrl.id, next);
+		if (ticket > 0) {
+			__atomic_store_n(&mSent, ticket, __ATOMIC_RELEASE);
+		}
+	}
+}
+
+void AeAwbLoop::restore_ctrl(soft_ctrl_t &ctrl) {
+	if (ctrl.restore_id >= 0) {
+		mCamera->setControlAsync(ctrl.restore_id, ctrl.restore_value);
+		ctrl.restore_id = -1;
+	}
+}
+
+/**
+ * 开始软件AE/AWB, 已经开始时用新的设置重新开始
+ * 在调用线程上读取能力表和当前值, 之后的写入都是异步的
+ * @param flags SOFT_AE/SOFT_AWB, 0: 结束
+ * @param target 目标平均亮度(1-254), <=0: 默认值
+ * @param interval 每几帧计算一次(写入完成后开始计数), <=0: 默认值
+ * @return 实际开始的SOFT_XXX, <0: 错误(设备不支持)
+ */
+int AeAwbLoop::start(int flags, int target, int interval) {
+	ENTER();
+	if (!flags) {
+		RETURN(stop(), int);
+	}
+	pthread_mutex_lock(&loop_mutex);
+	{
+		// 重新开始时不恢复自动模式, 保存的值由prepare_ctrl沿用
+		mFlags = 0;
+		mTarget = (target > 0) && (target < 255) ? target : SOFT_AE_DEFAULT_TARGET;
+		mInterval = interval > 0 ? interval : SOFT_AE_DEFAULT_INTERVAL;
+		mFrames = 0;
+		int effective = 0;
+		if (flags & SOFT_AE) {
+			prepare_ctrl(mExposure, CONTROL_EXPOSURE, CONTROL_EXPOSURE_MODE, EXPOSURE_MODE_MANUAL);
+			prepare_ctrl(mGain, CONTROL_GAIN, -1, 0);
+			if (mExposure.supported || mGain.supported) {
+				effective |= SOFT_AE;
+			}
+		}
+		if (flags & SOFT_AWB) {
+			prepare_ctrl(mWhiteBalance, CONTROL_WHITE_BLANCE, CONTROL_AUTO_WHITE_BLANCE, 0);
+			if (mWhiteBalance.supported) {
+				effective |= SOFT_AWB;
+			}
+		}
+		// 不再由软件控制的恢复自动模式
+		if (!(effective & SOFT_AE)) {
+			restore_ctrl(mExposure);
+		}
+		if (!(effective & SOFT_AWB)) {
+			restore_ctrl(mWhiteBalance);
+		}
+		mFlags = effective;
+	}
+	pthread_mutex_unlock(&loop_mutex);
+	RETURN(mFlags ? mFlags : UVC_ERROR_NOT_SUPPORTED, int);
+}
+
+/**
+ * 结束, 切换到手动之前的自动模式恢复
+ */
+int AeAwbLoop::stop() {
+	ENTER();
+	pthread_mutex_lock(&loop_mutex);
+	{
+		if (mFlags) {
+			restore_ctrl(mExposure);
+			restore_ctrl(mWhiteBalance);
+			mFlags = 0;
+		}
+	}
+	pthread_mutex_unlock(&loop_mutex);
+	RETURN(0, int);
+}
+
+/**
+ * 亮暗都是先动曝光时间(噪声少), 变亮时曝光时间到上限后调增益, 变暗时先降增益
+ * 每次只动一个
+ */
+void AeAwbLoop::update_exposure(float luma) {
+	const double ev = log2(mTarget / (luma > 1.0f ? luma : 1.0f));
+	if (fabs(ev) < SOFT_AE_DEADBAND) return;
+	// damped, at most SOFT_AE_MAX_STEP per update
+	double step = ev * 0.5;
+	step = step < -SOFT_AE_MAX_STEP ? -SOFT_AE_MAX_STEP : (step > SOFT_AE_MAX_STEP ? SOFT_AE_MAX_STEP : step);
+	const bool exposure_movable = mExposure.supported
+		&& (step > 0 ? lround(mExposure.value) < mExposure.max : lround(mExposure.value) > mExposure.min);
+	const bool gain_movable = mGain.supported
+		&& (step > 0 ? lround(mGain.value) < mGain.max : lround(mGain.value) > mGain.min);
+	if (gain_movable && ((step < 0) || !exposure_movable)) {
+		write_ctrl(mGain, mGain.value + step * (mGain.max - mGain.min) / GAIN_EV_RANGE);
+	} else if (exposure_movable) {
+		const double exposure = mExposure.value > 1.0 ? mExposure.value : 1.0;
+		write_ctrl(mExposure, exposure * pow(2.0, step));
+	}
+}
+
+/**
+ * gray world, 偏蓝时提高色温设定(画面变暖), 偏红时降低
+ */
+void AeAwbLoop::update_white_balance(float r, float b) {
+	if ((r < 1.0f) || (b < 1.0f)) return;
+	const double e = log(b / r);
+	if (fabs(e) < SOFT_AWB_DEADBAND) return;
+	const double range = mWhiteBalance.max - mWhiteBalance.min;
+	double delta = e * range * WB_STEPS_PER_LOG;
+	const double max_step = range * WB_MAX_STEP;
+	delta = delta < -max_step ? -max_step : (delta > max_step ? max_step : delta);
+	write_ctrl(mWhiteBalance, mWhiteBalance.value + delta);
+}
+
+/**
+ * 在预览线程上调用, 不阻塞(正在start/stop时跳过这一帧)
+ * @param frame YUYV
+ */
+void AeAwbLoop::offer(const uvc_frame_t *frame) {
+	if (LIKELY(!mFlags) || UNLIKELY(frame->frame_format != UVC_FRAME_FORMAT_YUYV)) return;
+	// the frame does not reflect the last write yet
+	if ((int32_t)(__atomic_load_n(&mCompleted, __ATOMIC_ACQUIRE)
+		- __atomic_load_n(&mSent, __ATOMIC_ACQUIRE)) < 0) {
+		mFrames = 0;
+		return;
+	}
+	if (++mFrames < (uint32_t)mInterval) return;
+	if (pthread_mutex_trylock(&loop_mutex)) return;
+	{
+		mFrames = 0;
+		if (mFlags) {
+			const int row_step = frame->height > SOFT_AE_SAMPLE_LINES ? frame->height / SOFT_AE_SAMPLE_LINES : 1;
+			const int step = frame->step ? frame->step : frame->width * 2;
+			yuv_means_t means;
+			frame_stats_yuyv_means((const uint8_t *)frame->data, frame->width, frame->height,
+				step, row_step, &means);
+			if (mFlags & SOFT_AE) {
+				update_exposure(means.y);
+			}
+			if (mFlags & SOFT_AWB) {
+				float r, g, b;
+				frame_stats_yuv2rgb(&means, &r, &g, &b);
+				update_white_balance(r, b);
+			}
+		}
+	}
+	pthread_mutex_unlock(&loop_mutex);
+}
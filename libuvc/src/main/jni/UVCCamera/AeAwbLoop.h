@@ -0,0 +1,94 @@
+/*
+ * UVCCamera
+ * library and sample to access to UVC web camera on non-rooted Android device
+ *
+ * Copyright (c) 2014-2017 saki t_saki@serenegiant.com
+ *
+ * File name: AeAwbLoop.h
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * All files in the folder are under this Apache License, Version 2.0.
+ * Files in the jni/libjpeg, jni/libusb, jin/libuvc, jni/rapidjson folder may have a different license, see the respective files.
+*/
+
+
+#ifndef AEAWBLOOP_H_
+#define AEAWBLOOP_H_
+
+#include <pthread.h>
+#include "libUVCCamera.h"
+#include "FrameStats.h"
+
+#pragma interface
+
+// flags for start, same as UVCCamera.java
+#define SOFT_AE		0x01	// exposure time + gain
+#define SOFT_AWB	0x02	// white balance temperature
+
+#define SOFT_AE_DEFAULT_TARGET	118		// mean luma
+#define SOFT_AE_DEFAULT_INTERVAL	3	// analyze every N frames
+#define SOFT_AE_SAMPLE_LINES	32		// lines sampled per frame
+#define SOFT_AE_DEADBAND	0.1		// [EV]
+#define SOFT_AE_MAX_STEP	1.0		// [EV] per update
+#define SOFT_AWB_DEADBAND	0.02	// log(B/R)
+
+class UVCCamera;
+class ControlQueue;
+
+typedef struct soft_ctrl {
+	int id;				// CONTROL_XXX
+	bool supported;
+	int32_t min, max;
+	double value;		// value written last
+	int32_t restore_id;	// auto mode control restored on stop, -1: none
+	int32_t restore_value;
+} soft_ctrl_t;
+
+/**
+ * 软件自动曝光/自动白平衡
+ * 预览线程把解码后的YUYV帧交给offer, 每mInterval帧在子采样的行上计算平均值(NEON/SSE2),
+ * 曝光: log2(目标/平均亮度)的比例控制(阻尼, 每次最多±1EV), 先调曝光时间, 到上限后调增益
+ * 白平衡: gray world, 根据log(B/R)调色温
+ * 写入都通过ControlQueue(异步), 上一个写入完成之前不再计算, 所以不会阻塞预览线程
+ */
+class AeAwbLoop {
+private:
+	UVCCamera *mCamera;
+	ControlQueue *mQueue;
+	pthread_mutex_t loop_mutex;
+	volatile int mFlags;			// SOFT_XXX, 0: stopped
+	int mTarget;
+	int mInterval;
+	uint32_t mFrames;
+	volatile int32_t mSent;			// last ticket enqueued
+	volatile int32_t mCompleted;	// last ticket completed
+	soft_ctrl_t mExposure;
+	soft_ctrl_t mGain;
+	soft_ctrl_t mWhiteBalance;
+	static void on_control_complete(void *user_ptr, int id, int32_t value, int result, int32_t ticket);
+	void prepare_ctrl(soft_ctrl_t &ctrl, int id, int mode_id, int32_t manual_value);
+	void write_ctrl(soft_ctrl_t &ctrl, double value);
+	void restore_ctrl(soft_ctrl_t &ctrl);
+	void update_exposure(float luma);
+	void update_white_balance(float r, float b);
+public:
+	AeAwbLoop(UVCCamera *camera, ControlQueue *queue);
+	~AeAwbLoop();
+
+	int start(int flags, int target, int interval);
+	int stop();
+	void offer(const uvc_frame_t *frame);
+};
+
+#endif /* AEAWBLOOP_H_ */
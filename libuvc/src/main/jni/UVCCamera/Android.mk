@@ -48,15 +48,33 @@ LOCAL_LDLIBS := -L$(SYSROOT)/usr/lib -ldl
 LOCAL_LDLIBS += -llog
 LOCAL_LDLIBS += -landroid
 
-LOCAL_SHARED_LIBRARIES += usb100 uvc
+LOCAL_SHARED_LIBRARIES += usb100 uvc jpeg-turbo1500
 
 LOCAL_ARM_MODE := arm
+ifeq ($(TARGET_ARCH_ABI),armeabi-v7a)
+LOCAL_ARM_NEON := true
+endif
 
 LOCAL_SRC_FILES := \
 		_onload.cpp \
 		utilbase.cpp \
 		UVCCamera.cpp \
 		UVCPreview.cpp \
+		UVCStreamCtrlCache.cpp \
+		CallbackBufferRing.cpp \
+		FrameProcessor.cpp \
+		SharedFrameRing.cpp \
+		PreRollBuffer.cpp \
+		StillCapture.cpp \
+		ControlQueue.cpp \
+		ExtensionUnits.cpp \
+		ControlProfile.cpp \
+		PtzController.cpp \
+		FrameStats.cpp \
+		AeAwbLoop.cpp \
+		AsyncFileWriter.cpp \
+		MjpegRecorder.cpp \
+		RawFrameDump.cpp \
 		UVCButtonCallback.cpp \
 		UVCStatusCallback.cpp \
 		Parameters.cpp \
@@ -64,3 +82,18 @@ LOCAL_SRC_FILES := \
 
 LOCAL_MODULE    := UVCCamera
 include $(BUILD_SHARED_LIBRARY)
+
+######################################################################
+# Make shared library libuvcshmreader.so
+# reader of shared frame ring for other processes, only depends on libc
+######################################################################
+include $(CLEAR_VARS)
+
+LOCAL_CFLAGS := -I$(LOCAL_PATH)/
+LOCAL_CFLAGS += -O3 -fstrict-aliasing
+LOCAL_EXPORT_C_INCLUDES := $(LOCAL_PATH)/
+
+LOCAL_SRC_FILES := uvc_shm_reader.c
+
+LOCAL_MODULE    := uvcshmreader
+include $(BUILD_SHARED_LIBRARY)
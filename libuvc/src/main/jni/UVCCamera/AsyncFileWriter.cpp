@@ -0,0 +1,449 @@
+/*
+ * UVCCamera
+ * library and sample to access to UVC web camera on non-rooted Android device
+ *
+ * Copyright (c) 2014-2017 saki t_saki@serenegiant.com
+ *
+ * File name: AsyncFileWriter.cpp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * All files in the folder are under this Apache License, Version 2.0.
+ * Files in the jni/libjpeg, jni/libusb, jin/libuvc, jni/rapidjson folder may have a different license, see the respective files.
+*/
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+#if 1	// set 1 if you don't need debug log
+	#ifndef LOG_NDEBUG
+		#define	LOG_NDEBUG		// w/o LOGV/LOGD/MARK
+	#endif
+	#undef USE_LOGALL
+#else
+	#define USE_LOGALL
+	#undef LOG_NDEBUG
+//	#undef NDEBUG
+#endif
+
+#include "utilbase.h"
+#include "AsyncFileWriter.h"
+
+#define	LOCAL_DEBUG 0
+
+static int64_t now_us() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+AsyncFileWriter::AsyncFileWriter()
+:	writer_thread(0),
+	mFd(-1),
+	mDirect(false),
+	mRing(NULL),
+	mCapacity(0),
+	mAppended(0),
+	mFlushed(0),
+	mClosing(false),
+	mFlushing(0),
+	mError(0),
+	mSyncIntervalMs(0),
+	mLastSyncUs(0),
+	mStartUs(0),
+	mEndUs(0),
+	mMaxQueued(0),
+	mWrites(0),
+	mSyncs(0),
+	mDropped(0) {
+
+	pthread_mutex_init(&writer_mutex, NULL);
+	pthread_cond_init(&writer_sync, NULL);
+}
+
+AsyncFileWriter::~AsyncFileWriter() {
+	close();
+	free(mRing);
+	pthread_mutex_destroy(&writer_mutex);
+	pthread_cond_destroy(&writer_sync);
+}
+
+/**
+ * @param capacity 环形缓冲区的最小大小(=最大的排队字节数), 向上取整到ASYNC_WRITER_ALIGN
+ *                 重复使用时保留已经分配的更大的缓冲区
+ * @param flags ASYNC_WRITER_DIRECT
+ * @param sync_interval_ms 定期fdatasync的间隔, 0: 只在close时
+ * @return 0: 成功, <0: -errno or UVC_ERROR_XXX
+ */
+int AsyncFileWriter::open(const char *path, size_t capacity, int flags, int sync_interval_ms) {
+	ENTER();
+
+	if (UNLIKELY(!path || !capacity)) {
+		RETURN(UVC_ERROR_INVALID_PARAM, int);
+	}
+	if (UNLIKELY(writer_thread)) {
+		RETURN(UVC_ERROR_BUSY, int);
+	}
+	capacity = (capacity + ASYNC_WRITER_ALIGN - 1) & ~((size_t)ASYNC_WRITER_ALIGN - 1);
+	if (capacity > mCapacity) {	// reuse larger ring
+		free(mRing);
+		mRing = NULL;
+		mCapacity = 0;
+		void *ring = NULL;
+		if (UNLIKELY(posix_memalign(&ring, ASYNC_WRITER_ALIGN, capacity))) {
+			RETURN(UVC_ERROR_NO_MEM, int);
+		}
+		mRing = (uint8_t *)ring;
+		mCapacity = capacity;
+	}
+	int fd = -1;
+	mDirect = false;
+	if (flags & ASYNC_WRITER_DIRECT) {
+		// some file systems(e.g. fuse on external storage) reject O_DIRECT
+		fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC | O_DIRECT, 0644);
+		mDirect = fd >= 0;
+	}
+	if (fd < 0) {
+		fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	}
+	if (UNLIKELY(fd < 0)) {
+		LOGE("failed to open %s:errno=%d", path, errno);
+		RETURN(-errno, int);
+	}
+	mFd = fd;
+	mAppended = mFlushed = 0;
+	mClosing = false;
+	mFlushing = 0;
+	mError = 0;
+	mSyncIntervalMs = sync_interval_ms > 0 ? sync_interval_ms : 0;
+	mStartUs = mLastSyncUs = now_us();
+	mEndUs = 0;
+	mMaxQueued = 0;
+	mWrites = mSyncs = mDropped = 0;
+	int result = 0;
+	if (UNLIKELY(pthread_create(&writer_thread, NULL, writer_thread_func, (void *)this))) {
+		writer_thread = 0;
+		::close(mFd);
+		mFd = -1;
+		result = UVC_ERROR_OTHER;
+	}
+	RETURN(result, int);
+}
+
+int AsyncFileWriter::write(const void *data, size_t bytes, bool block) {
+	struct iovec iov;
+	iov.iov_base = const_cast<void *>(data);
+	iov.iov_len = bytes;
+	return writev(&iov, 1, block);
+}
+
+/**
+ * 把数据追加到队列, 所有的数据都被接受或都不被接受
+ * @param block true: 等待队列有空间, false: 队列已满时立即返回UVC_ERROR_BUSY
+ * @return 0: 成功
+ */
+int AsyncFileWriter::writev(const struct iovec *iov, int iovcnt, bool block) {
+	size_t total = 0;
+	for (int i = 0; i < iovcnt; i++) {
+		total += iov[i].iov_len;
+	}
+	int result = 0;
+	pthread_mutex_lock(&writer_mutex);
+	{
+		if (UNLIKELY(!writer_thread || mClosing || (total > mCapacity))) {
+			result = UVC_ERROR_INVALID_PARAM;
+		} else if (UNLIKELY(mError)) {
+			result = mError;
+		}
+		for ( ; !result && (mCapacity - (mAppended - mFlushed) < total) ; ) {
+			if (!block) {
+				mDropped++;
+				result = UVC_ERROR_BUSY;
+				break;
+			}
+			pthread_cond_wait(&writer_sync, &writer_mutex);
+			if (UNLIKELY(mError)) {
+				result = mError;
+			}
+		}
+		if (LIKELY(!result)) {
+			// only free space of the ring is written here, I/O thread does not touch it
+			size_t pos = (size_t)(mAppended % mCapacity);
+			for (int i = 0; i < iovcnt; i++) {
+				const uint8_t *src = (const uint8_t *)iov[i].iov_base;
+				size_t bytes = iov[i].iov_len;
+				for ( ; bytes > 0 ; ) {
+					const size_t n = bytes < mCapacity - pos ? bytes : mCapacity - pos;
+					memcpy(mRing + pos, src, n);
+					src += n;
+					bytes -= n;
+					pos = (pos + n) % mCapacity;
+				}
+			}
+			mAppended += total;
+			const uint64_t queued = mAppended - mFlushed;
+			if (queued > mMaxQueued) {
+				mMaxQueued = queued;
+			}
+			if (queued >= ASYNC_WRITER_BATCH) {
+				pthread_cond_broadcast(&writer_sync);
+			}
+		}
+	}
+	pthread_mutex_unlock(&writer_mutex);
+	return result;
+}
+
+/**
+ * 等待到目前为止接受的数据全部写入(包括未对齐的尾部)
+ * O_DIRECT时之后的写入改为普通的写入
+ */
+int AsyncFileWriter::flush() {
+	ENTER();
+
+	int result;
+	pthread_mutex_lock(&writer_mutex);
+	{
+		mFlushing++;
+		pthread_cond_broadcast(&writer_sync);
+		for ( ; writer_thread && !mError && (mFlushed < mAppended) ; ) {
+			pthread_cond_wait(&writer_sync, &writer_mutex);
+		}
+		mFlushing--;
+		result = mError;
+	}
+	pthread_mutex_unlock(&writer_mutex);
+
+	RETURN(result, int);
+}
+
+/**
+ * 回写已经写入的部分, 只能在flush之后到close之前调用
+ */
+int AsyncFileWriter::patch(uint64_t pos, const void *data, size_t bytes) {
+	if (UNLIKELY(mFd < 0)) {
+		return UVC_ERROR_INVALID_PARAM;
+	}
+	if (UNLIKELY(mDirect)) {
+		// patches are small and unaligned
+		fcntl(mFd, F_SETFL, fcntl(mFd, F_GETFL) & ~O_DIRECT);
+		mDirect = false;
+	}
+	const uint8_t *p = (const uint8_t *)data;
+	for ( ; bytes > 0 ; ) {
+		const ssize_t n = pwrite(mFd, p, bytes, pos);
+		if (UNLIKELY(n < 0)) {
+			if (errno == EINTR) continue;
+			return -errno;
+		}
+		p += n;
+		pos += n;
+		bytes -= n;
+	}
+	return 0;
+}
+
+/**
+ * 写完所有的数据, fdatasync之后关闭文件
+ * @return 0: 成功, <0: 写入中发生的错误
+ */
+int AsyncFileWriter::close() {
+	ENTER();
+
+	closeAsync();
+	const int result = join();
+
+	RETURN(result, int);
+}
+
+/**
+ * 请求在后台写完所有的数据后关闭文件, 不等待
+ * 之后需要调用close或析构函数来回收线程
+ */
+int AsyncFileWriter::closeAsync() {
+	pthread_mutex_lock(&writer_mutex);
+	{
+		mClosing = true;
+		pthread_cond_broadcast(&writer_sync);
+	}
+	pthread_mutex_unlock(&writer_mutex);
+	return 0;
+}
+
+int AsyncFileWriter::join() {
+	if (writer_thread) {
+		if (pthread_join(writer_thread, NULL) != EXIT_SUCCESS) {
+			LOGW("AsyncFileWriter::terminate writer thread: pthread_join failed");
+		}
+		writer_thread = 0;
+	}
+	return mError;
+}
+
+/**
+ * @return true: 还有没有写完的数据或者文件还没有关闭
+ */
+bool AsyncFileWriter::isBusy() {
+	pthread_mutex_lock(&writer_mutex);
+	const bool result = mFd >= 0;
+	pthread_mutex_unlock(&writer_mutex);
+	return result;
+}
+
+/**
+ * @return 到目前为止接受的字节数, 即下一次写入的文件偏移量
+ */
+uint64_t AsyncFileWriter::position() {
+	pthread_mutex_lock(&writer_mutex);
+	const uint64_t result = mAppended;
+	pthread_mutex_unlock(&writer_mutex);
+	return result;
+}
+
+/**
+ * 只有I/O线程能增加空闲空间, 所以唯一的写入者在检查之后写入不会被拒绝
+ * @return 不阻塞时能写入的字节数, 没有打开或者出错时为0
+ */
+size_t AsyncFileWriter::available() {
+	pthread_mutex_lock(&writer_mutex);
+	const size_t result = (!writer_thread || mClosing || mError)
+		? 0 : mCapacity - (size_t)(mAppended - mFlushed);
+	pthread_mutex_unlock(&writer_mutex);
+	return result;
+}
+
+void AsyncFileWriter::getStats(async_writer_stats_t *stats) {
+	pthread_mutex_lock(&writer_mutex);
+	{
+		stats->bytes_written = mFlushed;
+		stats->bytes_queued = mAppended - mFlushed;
+		stats->max_queued = mMaxQueued;
+		const int64_t elapsed_us = (mEndUs ? mEndUs : now_us()) - mStartUs;
+		stats->throughput = elapsed_us > 0 ? mFlushed * 1000000ULL / elapsed_us : 0;
+		stats->writes = mWrites;
+		stats->syncs = mSyncs;
+		stats->dropped = mDropped;
+	}
+	pthread_mutex_unlock(&writer_mutex);
+}
+
+/*static*/
+void *AsyncFileWriter::writer_thread_func(void *vptr_args) {
+	ENTER();
+
+	AsyncFileWriter *writer = reinterpret_cast<AsyncFileWriter *>(vptr_args);
+	if (LIKELY(writer)) {
+		pthread_setname_np(pthread_self(), "uvc_writer");
+		writer->do_write();
+	}
+	PRE_EXIT();
+	pthread_exit(NULL);
+}
+
+void AsyncFileWriter::do_write() {
+	ENTER();
+
+	pthread_mutex_lock(&writer_mutex);
+	for ( ; ; ) {
+		const uint64_t pending = mAppended - mFlushed;
+		if (!pending && mClosing) break;
+		const size_t aligned = (size_t)pending & ~((size_t)ASYNC_WRITER_ALIGN - 1);
+		size_t bytes = 0;
+		if ((mClosing || mFlushing) && pending) {
+			bytes = (size_t)pending;
+		} else if (aligned >= ASYNC_WRITER_BATCH) {
+			bytes = aligned;
+		} else {
+			struct timespec ts;
+			clock_gettime(CLOCK_REALTIME, &ts);
+			ts.tv_nsec += ASYNC_WRITER_IDLE_MS * 1000000L;
+			if (ts.tv_nsec >= 1000000000L) {
+				ts.tv_sec++;
+				ts.tv_nsec -= 1000000000L;
+			}
+			if ((pthread_cond_timedwait(&writer_sync, &writer_mutex, &ts) == ETIMEDOUT)
+				&& (mAppended - mFlushed == pending) && aligned) {
+				bytes = aligned;	// no more data for a while
+			} else {
+				continue;
+			}
+		}
+		// don't cross the end of the ring
+		const size_t start = (size_t)(mFlushed % mCapacity);
+		if (bytes > mCapacity - start) {
+			bytes = mCapacity - start;
+		}
+		pthread_mutex_unlock(&writer_mutex);
+		write_range(start, bytes);
+		pthread_mutex_lock(&writer_mutex);
+		mFlushed += bytes;
+		pthread_cond_broadcast(&writer_sync);
+	}
+	pthread_mutex_unlock(&writer_mutex);
+
+	if (LIKELY(!mError)) {
+		fdatasync(mFd);
+		mSyncs++;
+	}
+	pthread_mutex_lock(&writer_mutex);
+	{
+		::close(mFd);
+		mFd = -1;
+		mEndUs = now_us();
+		pthread_cond_broadcast(&writer_sync);
+	}
+	pthread_mutex_unlock(&writer_mutex);
+	LOGI("written=%llu,max_queued=%llu,writes=%u,syncs=%u,dropped=%u,err=%d",
+		(unsigned long long)mFlushed, (unsigned long long)mMaxQueued,
+		mWrites, mSyncs, mDropped, mError);
+
+	EXIT();
+}
+
+// called from I/O thread without writer_mutex
+void AsyncFileWriter::write_range(size_t start, size_t bytes) {
+	if (UNLIKELY(mError)) return;	// discard
+	if (UNLIKELY(mDirect && (bytes & (ASYNC_WRITER_ALIGN - 1)))) {
+		// unaligned tail, file offset is not aligned after this
+		fcntl(mFd, F_SETFL, fcntl(mFd, F_GETFL) & ~O_DIRECT);
+		mDirect = false;
+	}
+	size_t written = 0;
+	for ( ; written < bytes ; ) {
+		const ssize_t n = ::write(mFd, mRing + start + written, bytes - written);
+		if (UNLIKELY(n < 0)) {
+			const int err = errno;
+			if (err == EINTR) continue;
+			LOGE("write failed:errno=%d", err);
+			pthread_mutex_lock(&writer_mutex);
+			mError = -err;
+			pthread_mutex_unlock(&writer_mutex);
+			return;
+		}
+		written += n;
+	}
+	mWrites++;
+	if (mSyncIntervalMs) {
+		const int64_t now = now_us();
+		if (now - mLastSyncUs >= mSyncIntervalMs * 1000LL) {
+			fdatasync(mFd);
+			mSyncs++;
+			mLastSyncUs = now;
+		}
+	}
+}
@@ -0,0 +1,99 @@
+/*
+ * UVCCamera
+ * library and sample to access to UVC web camera on non-rooted Android device
+ *
+ * Copyright (c) 2014-2017 saki t_saki@serenegiant.com
+ *
+ * File name: AsyncFileWriter.h
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * All files in the folder are under this Apache License, Version 2.0.
+ * Files in the jni/libjpeg, jni/libusb, jin/libuvc, jni/rapidjson folder may have a different license, see the respective files.
+*/
+
+
+
+#ifndef ASYNCFILEWRITER_H_
+#define ASYNCFILEWRITER_H_
+
+#include <pthread.h>
+#include <sys/uio.h>
+#include "libUVCCamera.h"
+
+#pragma interface
+
+#define ASYNC_WRITER_ALIGN 4096
+#define ASYNC_WRITER_BATCH (1024 * 1024)	// coalesce writes up to this size
+#define ASYNC_WRITER_IDLE_MS 100			// write aligned part when no more data arrives
+
+// flags for AsyncFileWriter#open
+#define ASYNC_WRITER_DIRECT 0x01			// try O_DIRECT, fall back to buffered I/O
+
+typedef struct async_writer_stats {
+	uint64_t bytes_written;
+	uint64_t bytes_queued;		// current queue depth
+	uint64_t max_queued;
+	uint64_t throughput;		// bytes/sec since open
+	uint32_t writes;			// number of write(2)
+	uint32_t syncs;				// number of fdatasync(2)
+	uint32_t dropped;			// rejected non-blocking writes
+} async_writer_stats_t;
+
+/**
+ * 异步文件写入
+ * 调用线程只把数据复制到固定大小的环形缓冲区(内存有上限), I/O线程把连续的数据合并成
+ * 以ASYNC_WRITER_ALIGN对齐的大块写入. 环形缓冲区的位置和文件偏移量一致,
+ * 所以O_DIRECT时也不需要再复制. 只支持顺序追加, 回写(patch)只能在flush之后
+ */
+class AsyncFileWriter {
+private:
+	pthread_mutex_t writer_mutex;
+	pthread_cond_t writer_sync;
+	pthread_t writer_thread;
+	int mFd;
+	bool mDirect;
+	uint8_t *mRing;
+	size_t mCapacity;
+	uint64_t mAppended;			// bytes accepted
+	uint64_t mFlushed;			// bytes written to mFd
+	volatile bool mClosing;
+	int mFlushing;				// number of threads waiting in flush
+	int mError;
+	int mSyncIntervalMs;		// 0: only on close
+	int64_t mLastSyncUs;
+	int64_t mStartUs, mEndUs;
+	uint64_t mMaxQueued;
+	uint32_t mWrites, mSyncs, mDropped;
+	static void *writer_thread_func(void *vptr_args);
+	void do_write();
+	void write_range(size_t start, size_t bytes);
+	int join();
+public:
+	AsyncFileWriter();
+	~AsyncFileWriter();
+
+	int open(const char *path, size_t capacity, int flags = 0, int sync_interval_ms = 0);
+	int write(const void *data, size_t bytes, bool block);
+	int writev(const struct iovec *iov, int iovcnt, bool block);
+	int flush();
+	int patch(uint64_t pos, const void *data, size_t bytes);
+	int close();
+	int closeAsync();
+	bool isBusy();
+	uint64_t position();
+	size_t available();
+	void getStats(async_writer_stats_t *stats);
+};
+
+#endif /* ASYNCFILEWRITER_H_ */
@@ -0,0 +1,163 @@
+/*
+ * UVCCamera
+ * library and sample to access to UVC web camera on non-rooted Android device
+ *
+ * Copyright (c) 2014-2017 saki t_saki@serenegiant.com
+ *
+ * File name: CallbackBufferRing.cpp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * All files in the folder are under this Apache License, Version 2.0.
+ * Files in the jni/libjpeg, jni/libusb, jin/libuvc, jni/rapidjson folder may have a different license, see the respective files.
+*/
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#if 1	// set 1 if you don't need debug log
+	#ifndef LOG_NDEBUG
+		#define	LOG_NDEBUG		// w/o LOGV/LOGD/MARK
+	#endif
+	#undef USE_LOGALL
+#else
+	#define USE_LOGALL
+	#undef LOG_NDEBUG
+//	#undef NDEBUG
+#endif
+
+#include "utilbase.h"
+#include "CallbackBufferRing.h"
+
+#define	LOCAL_DEBUG 0
+
+CallbackBufferRing::CallbackBufferRing(int generation, int num_buffers, size_t buffer_bytes)
+:	mGeneration(generation),
+	mNumBuffers(num_buffers < 1 ? 1 : (num_buffers > MAX_CALLBACK_BUFFERS ? MAX_CALLBACK_BUFFERS : num_buffers)),
+	mBufferBytes(buffer_bytes),
+	mNext(0),
+	mBuffers(NULL) {
+}
+
+CallbackBufferRing::~CallbackBufferRing() {
+	if (mBuffers) {
+		// global refs should be already deleted by #release(JNIEnv *)
+		for (int i = 0; i < mNumBuffers; i++) {
+			if (mBuffers[i].frame) {
+				free(mBuffers[i].frame->data);
+				mBuffers[i].frame->data = NULL;
+				uvc_free_frame(mBuffers[i].frame);
+			}
+		}
+		free(mBuffers);
+		mBuffers = NULL;
+	}
+}
+
+/**
+ * 分配缓冲区并生成direct ByteBuffer的全局引用
+ * @return 0: 成功
+ */
+int CallbackBufferRing::init(JNIEnv *env) {
+	ENTER();
+
+	mBuffers = (callback_buffer_t *)calloc(mNumBuffers, sizeof(callback_buffer_t));
+	if (UNLIKELY(!mBuffers)) {
+		RETURN(UVC_ERROR_NO_MEM, int);
+	}
+	for (int i = 0; i < mNumBuffers; i++) {
+		uvc_frame_t *frame = uvc_allocate_frame(0);
+		if (UNLIKELY(!frame)) {
+			RETURN(UVC_ERROR_NO_MEM, int);
+		}
+		// XXX uvc_allocate_frame(0) does not clear the fields on Android
+		memset(frame, 0, sizeof(uvc_frame_t));
+		mBuffers[i].frame = frame;
+		// not library_owns_data, so that uvc_ensure_frame_size never reallocates
+		// the memory that ByteBuffer refers
+		frame->data = malloc(mBufferBytes);
+		if (UNLIKELY(!frame->data)) {
+			RETURN(UVC_ERROR_NO_MEM, int);
+		}
+		frame->data_bytes = frame->actual_bytes = mBufferBytes;
+		frame->library_owns_data = 0;
+		jobject buf = env->NewDirectByteBuffer(frame->data, mBufferBytes);
+		if (UNLIKELY(!buf)) {
+			env->ExceptionClear();
+			RETURN(UVC_ERROR_NO_MEM, int);
+		}
+		mBuffers[i].buf = env->NewGlobalRef(buf);
+		env->DeleteLocalRef(buf);
+	}
+	RETURN(0, int);
+}
+
+/**
+ * 删除ByteBuffer的全局引用, 之后Java侧不能再访问
+ */
+void CallbackBufferRing::release(JNIEnv *env) {
+	ENTER();
+
+	if (mBuffers) {
+		for (int i = 0; i < mNumBuffers; i++) {
+			if (mBuffers[i].buf) {
+				if (env) {
+					env->DeleteGlobalRef(mBuffers[i].buf);
+				}
+				mBuffers[i].buf = NULL;
+			}
+		}
+	}
+
+	EXIT();
+}
+
+/**
+ * 取得空闲缓冲区, 只从捕获线程调用
+ * @return slot, -1: Java侧持有所有缓冲区
+ */
+int CallbackBufferRing::acquire() {
+	for (int i = 0; i < mNumBuffers; i++) {
+		const int slot = (mNext + i) % mNumBuffers;
+		if (!__atomic_load_n(&mBuffers[slot].in_use, __ATOMIC_ACQUIRE)) {
+			__atomic_store_n(&mBuffers[slot].in_use, 1, __ATOMIC_RELAXED);
+			mNext = (slot + 1) % mNumBuffers;
+			return slot;
+		}
+	}
+	return -1;
+}
+
+/**
+ * 归还缓冲区, 可以从任意线程调用
+ * @return 0: 成功
+ */
+int CallbackBufferRing::release(int slot) {
+	if (UNLIKELY((slot < 0) || (slot >= mNumBuffers) || !mBuffers)) {
+		return UVC_ERROR_INVALID_PARAM;
+	}
+	__atomic_store_n(&mBuffers[slot].in_use, 0, __ATOMIC_RELEASE);
+	return 0;
+}
+
+bool CallbackBufferRing::isIdle() const {
+	if (mBuffers) {
+		for (int i = 0; i < mNumBuffers; i++) {
+			if (__atomic_load_n(&mBuffers[i].in_use, __ATOMIC_ACQUIRE)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
@@ -0,0 +1,73 @@
+/*
+ * UVCCamera
+ * library and sample to access to UVC web camera on non-rooted Android device
+ *
+ * Copyright (c) 2014-2017 saki t_saki@serenegiant.com
+ *
+ * File name: CallbackBufferRing.h
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * All files in the folder are under this Apache License, Version 2.0.
+ * Files in the jni/libjpeg, jni/libusb, jin/libuvc, jni/rapidjson folder may have a different license, see the respective files.
+*/
+
+
+#ifndef CALLBACKBUFFERRING_H_
+#define CALLBACKBUFFERRING_H_
+
+#include <jni.h>
+#include "libUVCCamera.h"
+
+#pragma interface
+
+#define MAX_CALLBACK_BUFFERS 16
+
+typedef struct callback_buffer {
+	uvc_frame_t *frame;		// data is owned by this ring and never reallocated
+	jobject buf;			// global ref of direct ByteBuffer that wraps frame->data
+	volatile int32_t in_use;
+} callback_buffer_t;
+
+/**
+ * IBufferedFrameCallback用的帧缓冲区环
+ * 每个缓冲区的direct ByteBuffer只在初始化时生成一次, 之后每帧不需要JNI分配
+ * Java侧调用releaseFrame(index)之前不会覆盖该缓冲区
+ * index = (generation << 16) | slot
+ */
+class CallbackBufferRing {
+private:
+	const int mGeneration;
+	const int mNumBuffers;
+	const size_t mBufferBytes;
+	int mNext;
+	callback_buffer_t *mBuffers;
+public:
+	CallbackBufferRing(int generation, int num_buffers, size_t buffer_bytes);
+	~CallbackBufferRing();
+
+	int init(JNIEnv *env);
+	void release(JNIEnv *env);
+	int acquire();
+	int release(int slot);
+	bool isIdle() const;
+
+	inline int generation() const { return mGeneration; };
+	inline int numBuffers() const { return mNumBuffers; };
+	inline size_t bufferBytes() const { return mBufferBytes; };
+	inline uvc_frame_t *frame(int slot) { return mBuffers[slot].frame; };
+	inline jobject buffer(int slot) { return mBuffers[slot].buf; };
+	inline int index(int slot) const { return (mGeneration << 16) | slot; };
+};
+
+#endif /* CALLBACKBUFFERRING_H_ */
@@ -0,0 +1,190 @@
+/*
+ * UVCCamera
+ * library and sample to access to UVC web camera on non-rooted Android device
+ *
+ * Copyright (c) 2014-2017 saki t_saki@serenegiant.com
+ *
+ * File name: ControlProfile.cpp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * All files in the folder are under this Apache License, Version 2.0.
+ * Files in the jni/libjpeg, jni/libusb, jin/libuvc, jni/rapidjson folder may have a different license, see the respective files.
+*/
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#if 1	// set 1 if you don't need debug log
+	#ifndef LOG_NDEBUG
+		#define	LOG_NDEBUG		// w/o LOGV/LOGD/MARK
+	#endif
+	#undef USE_LOGALL
+#else
+	#define USE_LOGALL
+	#undef LOG_NDEBUG
+//	#undef NDEBUG
+#endif
+
+#include "utilbase.h"
+#include "ControlProfile.h"
+#include "rapidjson/rapidjson.h"
+#include "rapidjson/document.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+using namespace rapidjson;
+
+#define	LOCAL_DEBUG 0
+
+#define PROFILE_KEY_VERSION		"version"
+#define PROFILE_KEY_CONTROLS	"controls"
+#define PROFILE_KEY_WINDOW		"window"
+#define PROFILE_KEY_ROI			"roi"
+
+ControlProfile::ControlProfile() {
+	clear();
+}
+
+ControlProfile::~ControlProfile() {
+}
+
+void ControlProfile::clear() {
+	mMask = 0;
+	memset(mValues, 0, sizeof(mValues));
+	hasWindow = hasRoi = false;
+	memset(window, 0, sizeof(window));
+	memset(roi, 0, sizeof(roi));
+}
+
+bool ControlProfile::has(int id) const {
+	return (id >= 0) && (id < CONTROL_NUM) && (mMask & (1ULL << id));
+}
+
+int32_t ControlProfile::get(int id) const {
+	return has(id) ? mValues[id] : 0;
+}
+
+void ControlProfile::set(int id, int32_t value) {
+	if (LIKELY((id >= 0) && (id < CONTROL_NUM))) {
+		mValues[id] = value;
+		mMask |= (1ULL << id);
+	}
+}
+
+static void write_fields(Writer<StringBuffer> &writer, const char *key, const uint16_t *fields, int num) {
+	writer.String(key);
+	writer.StartArray();
+	for (int i = 0; i < num; i++) {
+		writer.Uint(fields[i]);
+	}
+	writer.EndArray();
+}
+
+/**
+ * @return JSON, 调用方需要free
+ */
+char *ControlProfile::toJSON() const {
+	ENTER();
+	StringBuffer buffer;
+	Writer<StringBuffer> writer(buffer);
+
+	writer.StartObject();
+	{
+		writer.String(PROFILE_KEY_VERSION);
+		writer.Int(PROFILE_VERSION);
+		writer.String(PROFILE_KEY_CONTROLS);
+		writer.StartArray();
+		for (int id = 0; id < CONTROL_NUM; id++) {
+			if (!has(id)) continue;
+			writer.StartArray();
+			writer.Int(id);
+			writer.Int(mValues[id]);
+			writer.EndArray();
+		}
+		writer.EndArray();
+		if (hasWindow) {
+			write_fields(writer, PROFILE_KEY_WINDOW, window, PROFILE_WINDOW_FIELDS);
+		}
+		if (hasRoi) {
+			write_fields(writer, PROFILE_KEY_ROI, roi, PROFILE_ROI_FIELDS);
+		}
+	}
+	writer.EndObject();
+	RETURN(strdup(buffer.GetString()), char *);
+}
+
+// @return true: 读取了num个字段
+static bool read_fields(const Value &array, uint16_t *fields, int num) {
+	if (!array.IsArray() || (array.Size() != (SizeType)num)) return false;
+	for (SizeType i = 0; i < (SizeType)num; i++) {
+		if (!array[i].IsUint() || (array[i].GetUint() > 0xffff)) return false;
+		fields[i] = (uint16_t)array[i].GetUint();
+	}
+	return true;
+}
+
+/**
+ * 读取toJSON输出的JSON, 失败时内容被清除
+ * @return 0: 成功, UVC_ERROR_INVALID_PARAM: 格式错误或者不支持的版本
+ */
+int ControlProfile::parse(const char *json) {
+	ENTER();
+	clear();
+	Document doc;
+	doc.Parse(json);
+	if (UNLIKELY(doc.HasParseError() || !doc.IsObject())) {
+		LOGW("failed to parse control profile");
+		RETURN(UVC_ERROR_INVALID_PARAM, int);
+	}
+	int ret = UVC_SUCCESS;
+	Value::ConstMemberIterator it = doc.FindMember(PROFILE_KEY_VERSION);
+	if (UNLIKELY((it == doc.MemberEnd()) || !it->value.IsInt()
+		|| (it->value.GetInt() > PROFILE_VERSION))) {
+		ret = UVC_ERROR_INVALID_PARAM;
+	}
+	it = doc.FindMember(PROFILE_KEY_CONTROLS);
+	if (LIKELY(!ret && (it != doc.MemberEnd()))) {
+		const Value &controls = it->value;
+		if (controls.IsArray()) {
+			for (SizeType i = 0; !ret && (i < controls.Size()); i++) {
+				const Value &pair = controls[i];
+				if (pair.IsArray() && (pair.Size() == 2)
+					&& pair[0u].IsInt() && pair[1u].IsInt()
+					&& (pair[0u].GetInt() >= 0) && (pair[0u].GetInt() < CONTROL_NUM)) {
+					set(pair[0u].GetInt(), pair[1u].GetInt());
+				} else {
+					ret = UVC_ERROR_INVALID_PARAM;
+				}
+			}
+		} else {
+			ret = UVC_ERROR_INVALID_PARAM;
+		}
+	}
+	it = doc.FindMember(PROFILE_KEY_WINDOW);
+	if (!ret && (it != doc.MemberEnd())) {
+		hasWindow = read_fields(it->value, window, PROFILE_WINDOW_FIELDS);
+		if (UNLIKELY(!hasWindow)) ret = UVC_ERROR_INVALID_PARAM;
+	}
+	it = doc.FindMember(PROFILE_KEY_ROI);
+	if (!ret && (it != doc.MemberEnd())) {
+		hasRoi = read_fields(it->value, roi, PROFILE_ROI_FIELDS);
+		if (UNLIKELY(!hasRoi)) ret = UVC_ERROR_INVALID_PARAM;
+	}
+	if (UNLIKELY(ret)) {
+		LOGW("invalid control profile");
+		clear();
+	}
+	RETURN(ret, int);
+}
@@ -0,0 +1,63 @@
+/*
+ * UVCCamera
+ * library and sample to access to UVC web camera on non-rooted Android device
+ *
+ * Copyright (c) 2014-2017 saki t_saki@serenegiant.com
+ *
+ * File name: ControlProfile.h
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * All files in the folder are under this Apache License, Version 2.0.
+ * Files in the jni/libjpeg, jni/libusb, jin/libuvc, jni/rapidjson folder may have a different license, see the respective files.
+*/
+
+
+#ifndef CONTROLPROFILE_H_
+#define CONTROLPROFILE_H_
+
+#include "UVCCamera.h"
+
+#pragma interface
+
+#define PROFILE_VERSION 1
+#define PROFILE_WINDOW_FIELDS 6		// wWindow_Top/Left/Bottom/Right, wNumSteps, bmNumStepsUnits
+#define PROFILE_ROI_FIELDS 5		// wROI_Top/Left/Bottom/Right, bmAutoControls
+
+/**
+ * 控制的配置(快照), 和JSON相互转换
+ * {"version":1,"controls":[[CONTROL_XXX,value],...],"window":[top,left,bottom,right,steps,units],"roi":[top,left,bottom,right,auto]}
+ * 值是设备的值(和setControls相同), window/roi是各字段的值
+ */
+class ControlProfile {
+private:
+	uint64_t mMask;		// bit of CONTROL_XXX that has the value
+	int32_t mValues[CONTROL_NUM];
+public:
+	bool hasWindow;
+	uint16_t window[PROFILE_WINDOW_FIELDS];
+	bool hasRoi;
+	uint16_t roi[PROFILE_ROI_FIELDS];
+
+	ControlProfile();
+	~ControlProfile();
+
+	void clear();
+	bool has(int id) const;
+	int32_t get(int id) const;
+	void set(int id, int32_t value);
+	char *toJSON() const;
+	int parse(const char *json);
+};
+
+#endif /* CONTROLPROFILE_H_ */
@@ -0,0 +1,317 @@
+/*
+ * UVCCamera
+ * library and sample to access to UVC web camera on non-rooted Android device
+ *
+ * Copyright (c) 2014-2017 saki t_saki@serenegiant.com
+ *
+ * File name: ControlQueue.cpp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * All files in the folder are under this Apache License, Version 2.0.
+ * Files in the jni/libjpeg, jni/libusb, jin/libuvc, jni/rapidjson folder may have a different license, see the respective files.
+*/
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/time.h>
+
+#if 1	// set 1 if you don't need debug log
+	#ifndef LOG_NDEBUG
+		#define	LOG_NDEBUG		// w/o LOGV/LOGD/MARK
+	#endif
+	#undef USE_LOGALL
+#else
+	#define USE_LOGALL
+	#undef LOG_NDEBUG
+//	#undef NDEBUG
+#endif
+
+#include "utilbase.h"
+#include "ControlQueue.h"
+#include "UVCCamera.h"
+
+#define	LOCAL_DEBUG 0
+
+ControlQueue::ControlQueue(UVCCamera *camera)
+:	mCamera(camera),
+	worker_thread(0),
+	mIsRunning(false),
+	mNumPending(0),
+	mTicket(0),
+	mCompleted(0),
+	mCompleteFunc(NULL),
+	mCompleteUserPtr(NULL),
+	mControlCallbackObj(NULL) {
+
+	ENTER();
+	pthread_mutex_init(&queue_mutex, NULL);
+	pthread_cond_init(&queue_sync, NULL);
+	pthread_cond_init(&complete_sync, NULL);
+	pthread_mutex_init(&callback_mutex, NULL);
+	icontrolcallback_fields.onComplete = NULL;
+	EXIT();
+}
+
+ControlQueue::~ControlQueue() {
+	ENTER();
+	stop();
+	if (mControlCallbackObj) {
+		JavaVM *vm = getVM();
+		JNIEnv *env;
+		if (vm->GetEnv((void **)&env, JNI_VERSION_1_6) == JNI_OK) {
+			env->DeleteGlobalRef(mControlCallbackObj);
+		}
+		mControlCallbackObj = NULL;
+	}
+	pthread_mutex_destroy(&callback_mutex);
+	pthread_cond_destroy(&complete_sync);
+	pthread_cond_destroy(&queue_sync);
+	pthread_mutex_destroy(&queue_mutex);
+	EXIT();
+}
+
+/**
+ * IControlCallback#onComplete(int id, int value, int result, int ticket)
+ * @param control_callback_obj global reference, NULL: remove
+ */
+int ControlQueue::setCallback(JNIEnv *env, jobject control_callback_obj) {
+	ENTER();
+	pthread_mutex_lock(&callback_mutex);
+	{
+		if (!env->IsSameObject(mControlCallbackObj, control_callback_obj)) {
+			icontrolcallback_fields.onComplete = NULL;
+			if (mControlCallbackObj) {
+				env->DeleteGlobalRef(mControlCallbackObj);
+			}
+			mControlCallbackObj = control_callback_obj;
+			if (control_callback_obj) {
+				jclass clazz = env->GetObjectClass(control_callback_obj);
+				if (LIKELY(clazz)) {
+					icontrolcallback_fields.onComplete = env->GetMethodID(clazz,
+						"onComplete", "(IIII)V");
+				} else {
+					LOGW("failed to get object class");
+				}
+				env->ExceptionClear();
+				if (!icontrolcallback_fields.onComplete) {
+					LOGE("Can't find IControlCallback#onComplete");
+					env->DeleteGlobalRef(control_callback_obj);
+					mControlCallbackObj = NULL;
+				}
+			}
+		} else if (control_callback_obj) {
+			env->DeleteGlobalRef(control_callback_obj);
+		}
+	}
+	pthread_mutex_unlock(&callback_mutex);
+	RETURN(0, int);
+}
+
+/**
+ * 设置native的完成通知, 在工作线程上调用, 不能阻塞
+ */
+void ControlQueue::setCompleteCallback(control_complete_func_t func, void *user_ptr) {
+	pthread_mutex_lock(&callback_mutex);
+	{
+		mCompleteFunc = func;
+		mCompleteUserPtr = user_ptr;
+	}
+	pthread_mutex_unlock(&callback_mutex);
+}
+
+/**
+ * 把写入加入队列, 立即返回
+ * @param id CONTROL_XXX
+ * @return ticket(>0), <0: 错误
+ */
+int32_t ControlQueue::enqueue(int id, int32_t value) {
+	int32_t result = 0;
+	pthread_mutex_lock(&queue_mutex);
+	{
+		// replace pending write to the same control in place
+		control_request_t *req = NULL;
+		for (int i = 0; i < mNumPending; i++) {
+			if (mPending[i].id == id) {
+				req = &mPending[i];
+				break;
+			}
+		}
+		if (req) {
+			result = req->ticket = ++mTicket;
+			req->value = value;
+		} else if (UNLIKELY(mNumPending >= CONTROL_QUEUE_SIZE)) {
+			result = UVC_ERROR_BUSY;
+		} else if (UNLIKELY(!worker_thread)) {
+			mIsRunning = true;
+			if (UNLIKELY(pthread_create(&worker_thread, NULL, worker_thread_func, (void *)this))) {
+				LOGE("failed to create worker thread");
+				worker_thread = 0;
+				mIsRunning = false;
+				result = UVC_ERROR_OTHER;
+			}
+		}
+		if (LIKELY(!result)) {
+			result = ++mTicket;
+			req = &mPending[mNumPending++];
+			req->id = id;
+			req->value = value;
+			req->ticket = req->first_ticket = result;
+			pthread_cond_signal(&queue_sync);
+		}
+	}
+	pthread_mutex_unlock(&queue_mutex);
+	return result;
+}
+
+/**
+ * 等待到ticket为止的写入完成
+ * @param timeout_ms <=0: 不超时
+ * @return 0: 完成, UVC_ERROR_TIMEOUT
+ */
+int ControlQueue::wait(int32_t ticket, int timeout_ms) {
+	int result = 0;
+	struct timespec ts;
+	if (timeout_ms > 0) {
+#if _POSIX_TIMERS > 0
+		clock_gettime(CLOCK_REALTIME, &ts);
+#else
+		struct timeval tv;
+		gettimeofday(&tv, NULL);
+		ts.tv_sec = tv.tv_sec;
+		ts.tv_nsec = tv.tv_usec * 1000;
+#endif
+		ts.tv_sec += timeout_ms / 1000;
+		ts.tv_nsec += (timeout_ms % 1000) * 1000000;
+		if (ts.tv_nsec >= 1000000000) {
+			ts.tv_sec++;
+			ts.tv_nsec -= 1000000000;
+		}
+	}
+	pthread_mutex_lock(&queue_mutex);
+	{
+		for ( ; mIsRunning && (mCompleted < ticket) ; ) {
+			if (timeout_ms > 0) {
+				if (pthread_cond_timedwait(&complete_sync, &queue_mutex, &ts) == ETIMEDOUT) {
+					break;
+				}
+			} else {
+				pthread_cond_wait(&complete_sync, &queue_mutex);
+			}
+		}
+		if (mCompleted < ticket) {
+			result = UVC_ERROR_TIMEOUT;
+		}
+	}
+	pthread_mutex_unlock(&queue_mutex);
+	return result;
+}
+
+int ControlQueue::getPending() {
+	pthread_mutex_lock(&queue_mutex);
+	const int result = mNumPending;
+	pthread_mutex_unlock(&queue_mutex);
+	return result;
+}
+
+/**
+ * 结束工作线程, 还没执行的写入被丢弃
+ */
+void ControlQueue::stop() {
+	ENTER();
+	pthread_t thread = 0;
+	pthread_mutex_lock(&queue_mutex);
+	{
+		mIsRunning = false;
+		mNumPending = 0;
+		thread = worker_thread;
+		pthread_cond_broadcast(&queue_sync);
+		pthread_cond_broadcast(&complete_sync);
+	}
+	pthread_mutex_unlock(&queue_mutex);
+	if (thread) {
+		if (pthread_join(thread, NULL) != EXIT_SUCCESS) {
+			LOGW("ControlQueue::stop:pthread_join failed");
+		}
+		worker_thread = 0;
+	}
+	EXIT();
+}
+
+/*static*/
+void *ControlQueue::worker_thread_func(void *vptr_args) {
+	ENTER();
+	ControlQueue *queue = reinterpret_cast<ControlQueue *>(vptr_args);
+	if (LIKELY(queue)) {
+		pthread_setname_np(pthread_self(), "uvc_control");
+		JavaVM *vm = getVM();
+		JNIEnv *env;
+		// attach to JavaVM
+		vm->AttachCurrentThread(&env, NULL);
+		queue->do_work(env);
+		// detach from JavaVM
+		vm->DetachCurrentThread();
+	}
+	PRE_EXIT();
+	pthread_exit(NULL);
+}
+
+void ControlQueue::do_work(JNIEnv *env) {
+	ENTER();
+	control_request_t req;
+	pthread_mutex_lock(&queue_mutex);
+	for ( ; mIsRunning ; ) {
+		if (!mNumPending) {
+			pthread_cond_wait(&queue_sync, &queue_mutex);
+			continue;
+		}
+		req = mPending[0];
+		mNumPending--;
+		memmove(&mPending[0], &mPending[1], mNumPending * sizeof(control_request_t));
+		pthread_mutex_unlock(&queue_mutex);
+		const int result = mCamera->setControl(req.id, req.value);
+		notify_complete(env, req, result);
+		pthread_mutex_lock(&queue_mutex);
+		// first_ticket increases along the queue, tickets before the head are all done
+		mCompleted = (mNumPending ? mPending[0].first_ticket : mTicket + 1) - 1;
+		pthread_cond_broadcast(&complete_sync);
+	}
+	pthread_mutex_unlock(&queue_mutex);
+	EXIT();
+}
+
+void ControlQueue::notify_complete(JNIEnv *env, const control_request_t &req, int result) {
+	jobject callback_obj = NULL;
+	jmethodID on_complete = NULL;
+	pthread_mutex_lock(&callback_mutex);
+	{
+		if (mCompleteFunc) {
+			mCompleteFunc(mCompleteUserPtr, req.id, req.value, result, req.ticket);
+		}
+		// call Java without callback_mutex, the callback may call setControlCallback
+		if (mControlCallbackObj) {
+			callback_obj = env->NewLocalRef(mControlCallbackObj);
+			on_complete = icontrolcallback_fields.onComplete;
+		}
+	}
+	pthread_mutex_unlock(&callback_mutex);
+	if (callback_obj) {
+		env->CallVoidMethod(callback_obj, on_complete,
+			req.id, req.value, result, req.ticket);
+		env->ExceptionClear();
+		env->DeleteLocalRef(callback_obj);
+	}
+}
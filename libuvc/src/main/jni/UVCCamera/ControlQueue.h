@@ -0,0 +1,92 @@
+/*
+ * UVCCamera
+ * library and sample to access to UVC web camera on non-rooted Android device
+ *
+ * Copyright (c) 2014-2017 saki t_saki@serenegiant.com
+ *
+ * File name: ControlQueue.h
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * All files in the folder are under this Apache License, Version 2.0.
+ * Files in the jni/libjpeg, jni/libusb, jin/libuvc, jni/rapidjson folder may have a different license, see the respective files.
+*/
+
+
+#ifndef CONTROLQUEUE_H_
+#define CONTROLQUEUE_H_
+
+#include <jni.h>
+#include <pthread.h>
+#include "libUVCCamera.h"
+
+#pragma interface
+
+#define CONTROL_QUEUE_SIZE 64	// max number of pending writes(writes to same control are coalesced)
+
+class UVCCamera;
+
+// called on the worker thread after each write
+typedef void (*control_complete_func_t)(void *user_ptr, int id, int32_t value, int result, int32_t ticket);
+
+typedef struct control_request {
+	int id;				// CONTROL_XXX
+	int32_t value;
+	int32_t ticket;		// ticket of the last merged write
+	int32_t first_ticket;	// ticket of the oldest merged write
+} control_request_t;
+
+typedef struct {
+	jmethodID onComplete;
+} Fields_icontrolcallback;
+
+/**
+ * 异步控制写入队列
+ * 调用线程只把请求加入队列, 工作线程按顺序执行SET_CUR.
+ * 还没开始执行的对同一个控制的写入会被合并(在原来的位置替换成最后的值, 使用新的ticket),
+ * 所以不同控制之间按第一次写入的顺序执行.
+ * 被合并的写入在合并它的写入完成时视为完成, wait(ticket)等待到ticket为止的所有写入完成
+ */
+class ControlQueue {
+private:
+	UVCCamera *mCamera;
+	pthread_mutex_t queue_mutex;
+	pthread_cond_t queue_sync;		// new request/stop
+	pthread_cond_t complete_sync;	// mCompleted changed
+	pthread_t worker_thread;
+	volatile bool mIsRunning;
+	control_request_t mPending[CONTROL_QUEUE_SIZE];
+	int mNumPending;
+	int32_t mTicket;				// last issued ticket
+	int32_t mCompleted;				// all writes up to this ticket are completed
+	control_complete_func_t mCompleteFunc;
+	void *mCompleteUserPtr;
+	pthread_mutex_t callback_mutex;
+	jobject mControlCallbackObj;
+	Fields_icontrolcallback icontrolcallback_fields;
+	static void *worker_thread_func(void *vptr_args);
+	void do_work(JNIEnv *env);
+	void notify_complete(JNIEnv *env, const control_request_t &req, int result);
+public:
+	ControlQueue(UVCCamera *camera);
+	~ControlQueue();
+
+	int setCallback(JNIEnv *env, jobject control_callback_obj);
+	void setCompleteCallback(control_complete_func_t func, void *user_ptr);
+	int32_t enqueue(int id, int32_t value);
+	int wait(int32_t ticket, int timeout_ms);
+	int getPending();
+	void stop();
+};
+
+#endif /* CONTROLQUEUE_H_ */
@@ -0,0 +1,274 @@
+/*
+ * UVCCamera
+ * library and sample to access to UVC web camera on non-rooted Android device
+ *
+ * Copyright (c) 2014-2017 saki t_saki@serenegiant.com
+ *
+ * File name: ExtensionUnits.cpp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * All files in the folder are under this Apache License, Version 2.0.
+ * Files in the jni/libjpeg, jni/libusb, jin/libuvc, jni/rapidjson folder may have a different license, see the respective files.
+*/
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#if 1	// set 1 if you don't need debug log
+	#ifndef LOG_NDEBUG
+		#define	LOG_NDEBUG		// w/o LOGV/LOGD/MARK
+	#endif
+	#undef USE_LOGALL
+#else
+	#define USE_LOGALL
+	#undef LOG_NDEBUG
+//	#undef NDEBUG
+#endif
+
+#include "utilbase.h"
+#include "ExtensionUnits.h"
+#include "rapidjson/rapidjson.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#include "libuvc/libuvc_internal.h"
+
+using namespace rapidjson;
+
+#define	LOCAL_DEBUG 0
+
+ExtensionUnits::ExtensionUnits(uvc_device_handle_t *devh)
+:	mDeviceHandle(devh),
+	mProbed(false),
+	mNumUnits(0) {
+
+	ENTER();
+	pthread_mutex_init(&xu_mutex, NULL);
+	memset(mUnits, 0, sizeof(mUnits));
+	EXIT();
+}
+
+ExtensionUnits::~ExtensionUnits() {
+	ENTER();
+	pthread_mutex_destroy(&xu_mutex);
+	EXIT();
+}
+
+/**
+ * 列举扩展单元, 所有控制的GET_LEN/GET_INFO同时发送
+ * 只在第一次调用时访问设备
+ */
+int ExtensionUnits::probe(int timeout_ms) {
+	ENTER();
+	int ret = UVC_SUCCESS;
+	pthread_mutex_lock(&xu_mutex);
+	if (!mProbed) {
+		const uvc_extension_unit_t *xu;
+		mNumUnits = 0;
+		DL_FOREACH(uvc_get_extension_units(mDeviceHandle), xu) {
+			if (mNumUnits >= XU_MAX_UNITS) {
+				LOGW("too many extension units");
+				break;
+			}
+			xu_unit_t &unit = mUnits[mNumUnits++];
+			unit.unit_id = xu->bUnitID;
+			memcpy(unit.guid, xu->guidExtensionCode, sizeof(unit.guid));
+			unit.bmControls = xu->bmControls;
+			unit.num_controls = 0;
+			for (int i = 0; i < XU_MAX_CONTROLS; i++) {
+				if (xu->bmControls & (1ULL << i)) {
+					xu_control_t &ctrl = unit.controls[unit.num_controls++];
+					ctrl.selector = i + 1;
+					ctrl.info = 0;
+					ctrl.len = 0;
+				}
+			}
+		}
+		int num_reqs = 0;
+		for (int i = 0; i < mNumUnits; i++) {
+			num_reqs += mUnits[i].num_controls * 2;
+		}
+		if (num_reqs) {
+			uvc_ctrl_request_t *reqs = (uvc_ctrl_request_t *)calloc(num_reqs, sizeof(uvc_ctrl_request_t));
+			uint8_t *data = (uint8_t *)calloc(num_reqs, 2);
+			if (LIKELY(reqs && data)) {
+				int r = 0;
+				for (int i = 0; i < mNumUnits; i++) {
+					for (int j = 0; j < mUnits[i].num_controls; j++, r += 2) {
+						reqs[r].unit = reqs[r + 1].unit = mUnits[i].unit_id;
+						reqs[r].selector = reqs[r + 1].selector = mUnits[i].controls[j].selector;
+						reqs[r].req_code = UVC_GET_LEN;
+						reqs[r].len = 2;
+						reqs[r].data = &data[r * 2];
+						reqs[r + 1].req_code = UVC_GET_INFO;
+						reqs[r + 1].len = 1;
+						reqs[r + 1].data = &data[(r + 1) * 2];
+					}
+				}
+				ret = uvc_ctrl_transfer_batch(mDeviceHandle, reqs, num_reqs, timeout_ms);
+				if (LIKELY(!ret)) {
+					r = 0;
+					for (int i = 0; i < mNumUnits; i++) {
+						for (int j = 0; j < mUnits[i].num_controls; j++, r += 2) {
+							xu_control_t &ctrl = mUnits[i].controls[j];
+							if (reqs[r].result == 2) {
+								ctrl.len = SW_TO_SHORT(&data[r * 2]);
+							}
+							if (reqs[r + 1].result == 1) {
+								ctrl.info = data[(r + 1) * 2];
+							}
+						}
+					}
+				}
+			} else {
+				ret = UVC_ERROR_NO_MEM;
+			}
+			free(reqs);
+			free(data);
+		}
+		// failed controls keep len 0, do not probe again on every access
+		mProbed = true;
+	}
+	pthread_mutex_unlock(&xu_mutex);
+	RETURN(ret, int);
+}
+
+int ExtensionUnits::getNumUnits() {
+	ENTER();
+	probe();
+	RETURN(mNumUnits, int);
+}
+
+const xu_unit_t *ExtensionUnits::getUnit(int index) {
+	ENTER();
+	probe();
+	RETURN((index >= 0) && (index < mNumUnits) ? &mUnits[index] : NULL, const xu_unit_t *);
+}
+
+// 复制到ctrl(在xu_mutex中), @return false: 不存在的控制
+bool ExtensionUnits::find(uint8_t unit_id, uint8_t selector, xu_control_t &ctrl) {
+	if (UNLIKELY(!mProbed)) {
+		probe();
+	}
+	bool found = false;
+	pthread_mutex_lock(&xu_mutex);
+	for (int i = 0; !found && (i < mNumUnits); i++) {
+		const xu_unit_t &unit = mUnits[i];
+		if (unit.unit_id == unit_id) {
+			if ((selector >= 1) && (selector <= XU_MAX_CONTROLS)
+				&& (unit.bmControls & (1ULL << (selector - 1)))) {
+				for (int j = 0; j < unit.num_controls; j++) {
+					if (unit.controls[j].selector == selector) {
+						ctrl = unit.controls[j];
+						found = true;
+						break;
+					}
+				}
+			}
+			break;
+		}
+	}
+	pthread_mutex_unlock(&xu_mutex);
+	return found;
+}
+
+/**
+ * @return JSON, {"units":[{"id":..,"guid":"..","bmControls":..,"controls":[{"selector":..,"len":..,"info":..}]}]}
+ * 调用方需要free
+ */
+char *ExtensionUnits::getDescriptions() {
+	ENTER();
+	probe();
+	StringBuffer buffer;
+	Writer<StringBuffer> writer(buffer);
+	char guid[33];
+
+	writer.StartObject();
+	{
+		writer.String("units");
+		writer.StartArray();
+		for (int i = 0; i < mNumUnits; i++) {
+			const xu_unit_t &unit = mUnits[i];
+			for (int k = 0; k < 16; k++) {
+				snprintf(&guid[k * 2], 3, "%02x", unit.guid[k]);
+			}
+			writer.StartObject();
+			{
+				writer.String("id");
+				writer.Uint(unit.unit_id);
+				writer.String("guid");
+				writer.String(guid);
+				writer.String("bmControls");
+				writer.Uint64(unit.bmControls);
+				writer.String("controls");
+				writer.StartArray();
+				for (int j = 0; j < unit.num_controls; j++) {
+					writer.StartObject();
+					writer.String("selector");
+					writer.Uint(unit.controls[j].selector);
+					writer.String("len");
+					writer.Uint(unit.controls[j].len);
+					writer.String("info");
+					writer.Uint(unit.controls[j].info);
+					writer.EndObject();
+				}
+				writer.EndArray();
+			}
+			writer.EndObject();
+		}
+		writer.EndArray();
+	}
+	writer.EndObject();
+	RETURN(strdup(buffer.GetString()), char *);
+}
+
+/**
+ * @return GET_LEN的值, <0: 不存在的控制或者错误
+ */
+int ExtensionUnits::getControlLength(uint8_t unit_id, uint8_t selector) {
+	xu_control_t ctrl;
+	if (UNLIKELY(!find(unit_id, selector, ctrl))) return UVC_ERROR_INVALID_PARAM;
+	return ctrl.len ? (int)ctrl.len : (int)UVC_ERROR_NOT_SUPPORTED;
+}
+
+/**
+ * GET_XXX, len需要和GET_LEN的值一致(GET_LEN/GET_INFO除外)
+ * @param len wLength是16位, 超出范围时是错误(不截断)
+ * @return 传输的字节数, <0: 错误
+ */
+int ExtensionUnits::get(uint8_t unit_id, uint8_t selector, void *data, int len,
+	enum uvc_req_code req_code) {
+
+	xu_control_t ctrl;
+	if (UNLIKELY(!data || (len <= 0) || (len > 0xffff)
+		|| !find(unit_id, selector, ctrl))) return UVC_ERROR_INVALID_PARAM;
+	if ((req_code != UVC_GET_LEN) && (req_code != UVC_GET_INFO)) {
+		if (UNLIKELY(!ctrl.len || ((ctrl.info & 0x01) == 0))) return UVC_ERROR_NOT_SUPPORTED;
+		if (UNLIKELY(len != ctrl.len)) return UVC_ERROR_INVALID_PARAM;
+	}
+	return uvc_get_ctrl(mDeviceHandle, unit_id, selector, data, (uint16_t)len, req_code);
+}
+
+/**
+ * SET_CUR, len需要和GET_LEN的值一致
+ * @return 传输的字节数, <0: 错误
+ */
+int ExtensionUnits::set(uint8_t unit_id, uint8_t selector, const void *data, int len) {
+	xu_control_t ctrl;
+	if (UNLIKELY(!data || !find(unit_id, selector, ctrl))) return UVC_ERROR_INVALID_PARAM;
+	if (UNLIKELY(!ctrl.len || ((ctrl.info & 0x02) == 0))) return UVC_ERROR_NOT_SUPPORTED;
+	if (UNLIKELY(len != (int)ctrl.len)) return UVC_ERROR_INVALID_PARAM;
+	return uvc_set_ctrl(mDeviceHandle, unit_id, selector, const_cast<void *>(data), (uint16_t)len);
+}
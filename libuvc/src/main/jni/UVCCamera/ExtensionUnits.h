@@ -0,0 +1,78 @@
+/*
+ * UVCCamera
+ * library and sample to access to UVC web camera on non-rooted Android device
+ *
+ * Copyright (c) 2014-2017 saki t_saki@serenegiant.com
+ *
+ * File name: ExtensionUnits.h
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * All files in the folder are under this Apache License, Version 2.0.
+ * Files in the jni/libjpeg, jni/libusb, jin/libuvc, jni/rapidjson folder may have a different license, see the respective files.
+*/
+
+
+#ifndef EXTENSIONUNITS_H_
+#define EXTENSIONUNITS_H_
+
+#include <pthread.h>
+#include "libUVCCamera.h"
+
+#pragma interface
+
+#define XU_MAX_UNITS 8
+#define XU_MAX_CONTROLS 64		// bmControls of one extension unit
+
+typedef struct xu_control {
+	uint8_t selector;	// bit index of bmControls + 1
+	uint8_t info;		// GET_INFO, D0: GET, D1: SET
+	uint16_t len;		// GET_LEN, 0: failed to get
+} xu_control_t;
+
+typedef struct xu_unit {
+	uint8_t unit_id;
+	uint8_t guid[16];
+	uint64_t bmControls;
+	int num_controls;
+	xu_control_t controls[XU_MAX_CONTROLS];
+} xu_unit_t;
+
+/**
+ * 扩展单元(XU, vendor specific)的控制
+ * 第一次使用时一次性取得所有控制的GET_LEN/GET_INFO并保存(失败的控制len为0, 不再重试),
+ * 之后的get/set只检查长度后直接传输(调用方准备缓冲区, 不分配内存), XU的值不经过控制缓存
+ */
+class ExtensionUnits {
+private:
+	uvc_device_handle_t *mDeviceHandle;
+	pthread_mutex_t xu_mutex;
+	volatile bool mProbed;
+	int mNumUnits;
+	xu_unit_t mUnits[XU_MAX_UNITS];
+	bool find(uint8_t unit_id, uint8_t selector, xu_control_t &ctrl);
+public:
+	ExtensionUnits(uvc_device_handle_t *devh);
+	~ExtensionUnits();
+
+	int probe(int timeout_ms = 1000);
+	int getNumUnits();
+	const xu_unit_t *getUnit(int index);
+	char *getDescriptions();
+	int getControlLength(uint8_t unit_id, uint8_t selector);
+	int get(uint8_t unit_id, uint8_t selector, void *data, int len,
+		enum uvc_req_code req_code = UVC_GET_CUR);
+	int set(uint8_t unit_id, uint8_t selector, const void *data, int len);
+};
+
+#endif /* EXTENSIONUNITS_H_ */
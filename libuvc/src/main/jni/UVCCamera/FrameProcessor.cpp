@@ -0,0 +1,222 @@
+/*
+ * UVCCamera
+ * library and sample to access to UVC web camera on non-rooted Android device
+ *
+ * Copyright (c) 2014-2017 saki t_saki@serenegiant.com
+ *
+ * File name: FrameProcessor.cpp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * All files in the folder are under this Apache License, Version 2.0.
+ * Files in the jni/libjpeg, jni/libusb, jin/libuvc, jni/rapidjson folder may have a different license, see the respective files.
+*/
+
+
+#include <stdlib.h>
+#include <dlfcn.h>
+
+#if 1	// set 1 if you don't need debug log
+	#ifndef LOG_NDEBUG
+		#define	LOG_NDEBUG		// w/o LOGV/LOGD/MARK
+	#endif
+	#undef USE_LOGALL
+#else
+	#define USE_LOGALL
+	#undef LOG_NDEBUG
+//	#undef NDEBUG
+#endif
+
+#include "utilbase.h"
+#include "FrameProcessor.h"
+
+#define	LOCAL_DEBUG 0
+
+FrameProcessor::FrameProcessor(int id)
+:	mId(id),
+	mHandle(NULL),
+	mProcessor(NULL),
+	mContext(NULL),
+	mIsRunning(false),
+	mPending(NULL),
+	mWorking(NULL),
+	mHasPending(false),
+	mDropped(0) {
+
+	pthread_mutex_init(&processor_mutex, NULL);
+	pthread_cond_init(&processor_sync, NULL);
+}
+
+FrameProcessor::~FrameProcessor() {
+	release();
+	pthread_mutex_destroy(&processor_mutex);
+	pthread_cond_destroy(&processor_sync);
+}
+
+/**
+ * 读入插件并启动工作线程
+ * @param path 插件.so的路径
+ * @param args 传给插件create的字符串, 可以是NULL
+ * @return 0: 成功
+ */
+int FrameProcessor::load(const char *path, const char *args) {
+	ENTER();
+
+	int result = UVC_ERROR_INVALID_PARAM;
+	mHandle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+	if (UNLIKELY(!mHandle)) {
+		LOGE("failed to load %s:%s", path, dlerror());
+		RETURN(UVC_ERROR_NOT_FOUND, int);
+	}
+	uvc_frame_processor_entry_t entry
+		= (uvc_frame_processor_entry_t)dlsym(mHandle, UVC_FRAME_PROCESSOR_ENTRY_NAME);
+	mProcessor = entry ? entry() : NULL;
+	if (UNLIKELY(!mProcessor || !mProcessor->on_frame)) {
+		LOGE("%s is not a frame processor", path);
+		goto ERR;
+	}
+	if (UNLIKELY(mProcessor->abi_version != UVC_FRAME_PROCESSOR_ABI_VERSION)) {
+		LOGE("abi version mismatch:%u/%d", mProcessor->abi_version, UVC_FRAME_PROCESSOR_ABI_VERSION);
+		goto ERR;
+	}
+	result = 0;
+	if (mProcessor->create) {
+		mContext = mProcessor->create(args, &result);
+		if (UNLIKELY(result)) {
+			LOGE("%s rejected:err=%d", mProcessor->name, result);
+			goto ERR;
+		}
+	}
+	mIsRunning = true;
+	result = pthread_create(&processor_thread, NULL, processor_thread_func, (void *)this);
+	if (UNLIKELY(result)) {
+		mIsRunning = false;
+		if (mProcessor->destroy) {
+			mProcessor->destroy(mContext);
+		}
+		mContext = NULL;
+		goto ERR;
+	}
+	LOGI("frame processor %s loaded:id=%d", mProcessor->name, mId);
+	RETURN(0, int);
+ERR:
+	mProcessor = NULL;
+	dlclose(mHandle);
+	mHandle = NULL;
+	RETURN(result ? result : UVC_ERROR_INVALID_PARAM, int);
+}
+
+/**
+ * 停止工作线程并卸载插件
+ */
+void FrameProcessor::release() {
+	ENTER();
+
+	if (mIsRunning) {
+		pthread_mutex_lock(&processor_mutex);
+		{
+			mIsRunning = false;
+			pthread_cond_signal(&processor_sync);
+		}
+		pthread_mutex_unlock(&processor_mutex);
+		if (pthread_join(processor_thread, NULL) != EXIT_SUCCESS) {
+			LOGW("FrameProcessor::terminate processor thread: pthread_join failed");
+		}
+		if (mProcessor->destroy) {
+			mProcessor->destroy(mContext);
+		}
+		mContext = NULL;
+		LOGI("frame processor %s released:dropped=%u", mProcessor->name, mDropped);
+	}
+	mProcessor = NULL;
+	if (mHandle) {
+		dlclose(mHandle);
+		mHandle = NULL;
+	}
+	if (mPending) {
+		uvc_free_frame(mPending);
+		mPending = NULL;
+	}
+	if (mWorking) {
+		uvc_free_frame(mWorking);
+		mWorking = NULL;
+	}
+
+	EXIT();
+}
+
+/**
+ * 把帧交给工作线程, 从uvc的回调线程调用
+ * 复制到插件专用的帧中, 所以调用之后可以马上重复使用frame
+ */
+void FrameProcessor::post(const uvc_frame_t *frame) {
+	if (UNLIKELY(!mIsRunning)) return;
+
+	pthread_mutex_lock(&processor_mutex);
+	{
+		if (UNLIKELY(!mPending)) {
+			mPending = uvc_allocate_frame(frame->data_bytes);
+		}
+		if (LIKELY(mPending)) {
+			if (mHasPending) {
+				mDropped++;	// worker thread is still busy
+			}
+			if (LIKELY(!uvc_duplicate_frame(const_cast<uvc_frame_t *>(frame), mPending))) {
+				mHasPending = true;
+				pthread_cond_signal(&processor_sync);
+			}
+		}
+	}
+	pthread_mutex_unlock(&processor_mutex);
+}
+
+/*static*/
+void *FrameProcessor::processor_thread_func(void *vptr_args) {
+	ENTER();
+
+	FrameProcessor *processor = reinterpret_cast<FrameProcessor *>(vptr_args);
+	if (LIKELY(processor)) {
+		pthread_setname_np(pthread_self(), "uvc_processor");
+		processor->do_process();
+	}
+	PRE_EXIT();
+	pthread_exit(NULL);
+}
+
+void FrameProcessor::do_process() {
+	ENTER();
+
+	for ( ; mIsRunning ; ) {
+		bool has_frame = false;
+		pthread_mutex_lock(&processor_mutex);
+		{
+			if (!mHasPending && mIsRunning) {
+				pthread_cond_wait(&processor_sync, &processor_mutex);
+			}
+			if (mHasPending) {
+				// swap so that post can fill next frame while the plugin processes this one
+				uvc_frame_t *tmp = mWorking;
+				mWorking = mPending;
+				mPending = tmp;
+				mHasPending = false;
+				has_frame = true;
+			}
+		}
+		pthread_mutex_unlock(&processor_mutex);
+		if (LIKELY(mIsRunning && has_frame)) {
+			mProcessor->on_frame(mContext, mWorking);
+		}
+	}
+
+	EXIT();
+}
@@ -0,0 +1,67 @@
+/*
+ * UVCCamera
+ * library and sample to access to UVC web camera on non-rooted Android device
+ *
+ * Copyright (c) 2014-2017 saki t_saki@serenegiant.com
+ *
+ * File name: FrameProcessor.h
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * All files in the folder are under this Apache License, Version 2.0.
+ * Files in the jni/libjpeg, jni/libusb, jin/libuvc, jni/rapidjson folder may have a different license, see the respective files.
+*/
+
+
+#ifndef FRAMEPROCESSOR_H_
+#define FRAMEPROCESSOR_H_
+
+#include <pthread.h>
+#include "libUVCCamera.h"
+#include "uvc_frame_processor.h"
+
+#pragma interface
+
+/**
+ * 本地帧处理插件的宿主
+ * dlopen插件, 在自己的工作线程上调用uvc_frame_processor_t#on_frame
+ * 工作线程处理中只保留最新一帧, 其余的丢弃
+ */
+class FrameProcessor {
+private:
+	const int mId;
+	void *mHandle;						// dlopen handle
+	const uvc_frame_processor_t *mProcessor;
+	void *mContext;						// plugin context
+	volatile bool mIsRunning;
+	pthread_t processor_thread;
+	pthread_mutex_t processor_mutex;
+	pthread_cond_t processor_sync;
+	uvc_frame_t *mPending;				// latest frame waiting for worker thread
+	uvc_frame_t *mWorking;				// frame being processed by plugin
+	bool mHasPending;
+	uint32_t mDropped;
+	static void *processor_thread_func(void *vptr_args);
+	void do_process();
+public:
+	FrameProcessor(int id);
+	~FrameProcessor();
+
+	int load(const char *path, const char *args);
+	void release();
+	void post(const uvc_frame_t *frame);
+	inline int id() const { return mId; };
+	inline uint32_t dropped() const { return mDropped; };
+};
+
+#endif /* FRAMEPROCESSOR_H_ */
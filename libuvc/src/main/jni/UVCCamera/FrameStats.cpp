@@ -0,0 +1,276 @@
+/*
+ * UVCCamera
+ * library and sample to access to UVC web camera on non-rooted Android device
+ *
+ * Copyright (c) 2014-2017 saki t_saki@serenegiant.com
+ *
+ * File name: FrameStats.cpp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * All files in the folder are under this Apache License, Version 2.0.
+ * Files in the jni/libjpeg, jni/libusb, jin/libuvc, jni/rapidjson folder may have a different license, see the respective files.
+*/
+
+
+#include <stdlib.h>
+#include <string.h>
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+	#include <arm_neon.h>
+	#define USE_NEON 1
+#elif defined(__SSE2__)
+	#include <emmintrin.h>
+	#define USE_SSE2 1
+#endif
+
+#include "FrameStats.h"
+
+#if USE_NEON
+static inline uint64_t horizontal_sum(uint32x4_t v) {
+	const uint64x2_t s = vpaddlq_u32(v);
+	return vgetq_lane_u64(s, 0) + vgetq_lane_u64(s, 1);
+}
+#elif USE_SSE2
+static inline uint64_t horizontal_sum(__m128i v) {
+	uint64_t s[2];
+	_mm_storeu_si128((__m128i *)s, v);
+	return s[0] + s[1];
+}
+#endif
+
+// Y/U/V sum of one YUYV line, pixels should be even
+static void sum_yuyv_line(const uint8_t *src, int pixels, uint64_t &sum_y, uint64_t &sum_u, uint64_t &sum_v) {
+	int i = 0;
+#if USE_NEON
+	uint32x4_t acc_y = vdupq_n_u32(0);
+	uint32x4_t acc_u = vdupq_n_u32(0);
+	uint32x4_t acc_v = vdupq_n_u32(0);
+	for ( ; i + 32 <= pixels; i += 32, src += 64) {
+		const uint8x16x4_t p = vld4q_u8(src);	// Y0, U, Y1, V
+		acc_y = vpadalq_u16(acc_y, vaddq_u16(vpaddlq_u8(p.val[0]), vpaddlq_u8(p.val[2])));
+		acc_u = vpadalq_u16(acc_u, vpaddlq_u8(p.val[1]));
+		acc_v = vpadalq_u16(acc_v, vpaddlq_u8(p.val[3]));
+	}
+	sum_y += horizontal_sum(acc_y);
+	sum_u += horizontal_sum(acc_u);
+	sum_v += horizontal_sum(acc_v);
+#elif USE_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i mask_y = _mm_set1_epi16(0x00ff);
+	const __m128i mask_u = _mm_set1_epi32(0x0000ff00);
+	const __m128i mask_v = _mm_set1_epi32((int)0xff000000);
+	__m128i acc_y = zero, acc_u = zero, acc_v = zero;
+	for ( ; i + 8 <= pixels; i += 8, src += 16) {
+		const __m128i p = _mm_loadu_si128((const __m128i *)src);
+		acc_y = _mm_add_epi64(acc_y, _mm_sad_epu8(_mm_and_si128(p, mask_y), zero));
+		acc_u = _mm_add_epi64(acc_u, _mm_sad_epu8(_mm_and_si128(p, mask_u), zero));
+		acc_v = _mm_add_epi64(acc_v, _mm_sad_epu8(_mm_and_si128(p, mask_v), zero));
+	}
+	sum_y += horizontal_sum(acc_y);
+	sum_u += horizontal_sum(acc_u);
+	sum_v += horizontal_sum(acc_v);
+#endif
+	for ( ; i + 2 <= pixels; i += 2, src += 4) {
+		sum_y += src[0] + src[2];
+		sum_u += src[1];
+		sum_v += src[3];
+	}
+}
+
+void frame_stats_yuyv_means(const uint8_t *data, int width, int height, int step,
+	int row_step, yuv_means_t *means) {
+
+	uint64_t sum_y = 0, sum_u = 0, sum_v = 0;
+	uint32_t lines = 0;
+	const int pixels = width & ~1;
+	if (row_step < 1) row_step = 1;
+	// start from the middle of the first interval
+	for (int y = row_step / 2; y < height; y += row_step, lines++) {
+		sum_yuyv_line(data + y * step, pixels, sum_y, sum_u, sum_v);
+	}
+	means->samples = lines * pixels;
+	if (LIKELY(means->samples)) {
+		const float n = (float)means->samples;
+		means->y = sum_y / n;
+		means->u = sum_u * 2 / n;
+		means->v = sum_v * 2 / n;
+	} else {
+		means->y = means->u = means->v = 0;
+	}
+}
+
+void frame_stats_yuv2rgb(const yuv_means_t *means, float *r, float *g, float *b) {
+	const float u = means->u - 128.0f;
+	const float v = means->v - 128.0f;
+	*r = means->y + 1.402f * v;
+	*g = means->y - 0.344f * u - 0.714f * v;
+	*b = means->y + 1.772f * u;
+}
+
+typedef struct luma_acc {
+	uint64_t sum;
+	int64_t lap_sum;
+	uint64_t lap_sq;
+} luma_acc_t;
+
+#if USE_NEON
+// 8 pixels of luma as 16bit
+static inline uint16x8_t load_luma8(const uint8_t *p, int pixel_stride) {
+	return vmovl_u8(pixel_stride == 2 ? vld2_u8(p).val[0] : vld1_u8(p));
+}
+#elif USE_SSE2
+static inline __m128i load_luma8(const uint8_t *p, int pixel_stride) {
+	return pixel_stride == 2
+		? _mm_and_si128(_mm_loadu_si128((const __m128i *)p), _mm_set1_epi16(0x00ff))
+		: _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)p), _mm_setzero_si128());
+}
+#endif
+
+/**
+ * 一行的亮度统计, FRAME_STATS_FOCUS时上下左右的像素必须存在
+ * Laplacian: 4 * c - left - right - up - down
+ */
+static void luma_stats_line(const uint8_t *p, int pixel_stride, int step, int pixels,
+	int flags, uint32_t *histogram, luma_acc_t &acc) {
+
+	const bool hist = flags & FRAME_STATS_HISTOGRAM;
+	const bool focus = flags & FRAME_STATS_FOCUS;
+	int i = 0;
+#if USE_NEON || USE_SSE2
+	uint16_t luma[8];
+#endif
+#if USE_NEON
+	uint32x4_t acc_sum = vdupq_n_u32(0);
+	int32x4_t acc_lap = vdupq_n_s32(0);
+	uint64x2_t acc_sq = vdupq_n_u64(0);
+	for ( ; i + 8 <= pixels; i += 8, p += pixel_stride * 8) {
+		const uint16x8_t c = load_luma8(p, pixel_stride);
+		acc_sum = vpadalq_u16(acc_sum, c);
+		if (hist) {
+			vst1q_u16(luma, c);
+			for (int j = 0; j < 8; j++) histogram[luma[j] >> 2]++;
+		}
+		if (focus) {
+			const uint16x8_t nb = vaddq_u16(
+				vaddq_u16(load_luma8(p - pixel_stride, pixel_stride), load_luma8(p + pixel_stride, pixel_stride)),
+				vaddq_u16(load_luma8(p - step, pixel_stride), load_luma8(p + step, pixel_stride)));
+			const int16x8_t lap = vsubq_s16(vreinterpretq_s16_u16(vshlq_n_u16(c, 2)), vreinterpretq_s16_u16(nb));
+			acc_lap = vpadalq_s16(acc_lap, lap);
+			acc_sq = vpadalq_u32(acc_sq, vreinterpretq_u32_s32(vmull_s16(vget_low_s16(lap), vget_low_s16(lap))));
+			acc_sq = vpadalq_u32(acc_sq, vreinterpretq_u32_s32(vmull_s16(vget_high_s16(lap), vget_high_s16(lap))));
+		}
+	}
+	acc.sum += horizontal_sum(acc_sum);
+	const int64x2_t lap_sum = vpaddlq_s32(acc_lap);
+	acc.lap_sum += vgetq_lane_s64(lap_sum, 0) + vgetq_lane_s64(lap_sum, 1);
+	acc.lap_sq += vgetq_lane_u64(acc_sq, 0) + vgetq_lane_u64(acc_sq, 1);
+#elif USE_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i ones = _mm_set1_epi16(1);
+	__m128i acc_sum = zero, acc_lap = zero, acc_sq = zero;
+	for ( ; i + 8 <= pixels; i += 8, p += pixel_stride * 8) {
+		const __m128i c = load_luma8(p, pixel_stride);
+		acc_sum = _mm_add_epi64(acc_sum, _mm_sad_epu8(c, zero));	// upper bytes are 0
+		if (hist) {
+			_mm_storeu_si128((__m128i *)luma, c);
+			for (int j = 0; j < 8; j++) histogram[luma[j] >> 2]++;
+		}
+		if (focus) {
+			const __m128i nb = _mm_add_epi16(
+				_mm_add_epi16(load_luma8(p - pixel_stride, pixel_stride), load_luma8(p + pixel_stride, pixel_stride)),
+				_mm_add_epi16(load_luma8(p - step, pixel_stride), load_luma8(p + step, pixel_stride)));
+			const __m128i lap = _mm_sub_epi16(_mm_slli_epi16(c, 2), nb);
+			acc_lap = _mm_add_epi32(acc_lap, _mm_madd_epi16(lap, ones));
+			// |lap| <= 1020, sum of 2 squares fits in int32
+			const __m128i sq = _mm_madd_epi16(lap, lap);
+			acc_sq = _mm_add_epi64(acc_sq, _mm_unpacklo_epi32(sq, zero));
+			acc_sq = _mm_add_epi64(acc_sq, _mm_unpackhi_epi32(sq, zero));
+		}
+	}
+	acc.sum += horizontal_sum(acc_sum);
+	int32_t lap_sum[4];
+	_mm_storeu_si128((__m128i *)lap_sum, acc_lap);
+	acc.lap_sum += (int64_t)lap_sum[0] + lap_sum[1] + lap_sum[2] + lap_sum[3];
+	acc.lap_sq += horizontal_sum(acc_sq);
+#endif
+	for ( ; i < pixels; i++, p += pixel_stride) {
+		const int c = p[0];
+		acc.sum += c;
+		if (hist) histogram[c >> 2]++;
+		if (focus) {
+			const int lap = 4 * c - p[-pixel_stride] - p[pixel_stride] - p[-step] - p[step];
+			acc.lap_sum += lap;
+			acc.lap_sq += lap * lap;
+		}
+	}
+}
+
+int frame_stats_luma(const uint8_t *luma, int pixel_stride,
+	int width, int height, int step,
+	int roi_x, int roi_y, int roi_width, int roi_height,
+	int row_step, int flags, luma_stats_t *stats) {
+
+	if (UNLIKELY(!luma || !stats || (width <= 0) || (height <= 0)
+		|| ((pixel_stride != 1) && (pixel_stride != 2)))) {
+		return UVC_ERROR_INVALID_PARAM;
+	}
+	stats->flags = 0;
+	stats->samples = 0;
+	flags &= FRAME_STATS_ALL;
+	// clip ROI
+	int x0 = roi_x > 0 ? roi_x : 0;
+	int y0 = roi_y > 0 ? roi_y : 0;
+	int x1 = roi_width > 0 ? roi_x + roi_width : width;
+	int y1 = roi_height > 0 ? roi_y + roi_height : height;
+	if (x1 > width) x1 = width;
+	if (y1 > height) y1 = height;
+	if (flags & FRAME_STATS_FOCUS) {
+		// Laplacian needs neighbours, exclude the border of the frame
+		if (x0 < 1) x0 = 1;
+		if (y0 < 1) y0 = 1;
+		if (x1 > width - 1) x1 = width - 1;
+		if (y1 > height - 1) y1 = height - 1;
+	}
+	if (UNLIKELY(!flags || (x0 >= x1) || (y0 >= y1))) {
+		return UVC_ERROR_INVALID_PARAM;
+	}
+	if (row_step < 1) row_step = 1;
+	if (flags & FRAME_STATS_HISTOGRAM) {
+		memset(stats->histogram, 0, sizeof(stats->histogram));
+	}
+
+	luma_acc_t acc;
+	memset(&acc, 0, sizeof(acc));
+	const int pixels = x1 - x0;
+	uint32_t lines = 0;
+	// start from the middle of the first interval if possible
+	int y = y0 + row_step / 2;
+	if (y >= y1) y = y0;
+	for ( ; y < y1; y += row_step, lines++) {
+		luma_stats_line(luma + y * step + x0 * pixel_stride, pixel_stride, step, pixels,
+			flags, stats->histogram, acc);
+	}
+	const uint32_t samples = lines * pixels;
+	const double n = (double)samples;
+	stats->samples = samples;
+	stats->mean = (flags & FRAME_STATS_MEAN) ? (float)(acc.sum / n) : 0.0f;
+	if (flags & FRAME_STATS_FOCUS) {
+		const double m = acc.lap_sum / n;
+		stats->focus = (float)(acc.lap_sq / n - m * m);
+	} else {
+		stats->focus = 0.0f;
+	}
+	stats->flags = flags;
+
+	return 0;
+}
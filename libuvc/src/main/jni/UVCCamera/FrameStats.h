@@ -0,0 +1,81 @@
+/*
+ * UVCCamera
+ * library and sample to access to UVC web camera on non-rooted Android device
+ *
+ * Copyright (c) 2014-2017 saki t_saki@serenegiant.com
+ *
+ * File name: FrameStats.h
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * All files in the folder are under this Apache License, Version 2.0.
+ * Files in the jni/libjpeg, jni/libusb, jin/libuvc, jni/rapidjson folder may have a different license, see the respective files.
+*/
+
+
+#ifndef FRAMESTATS_H_
+#define FRAMESTATS_H_
+
+#include "libUVCCamera.h"
+
+#pragma interface
+
+typedef struct yuv_means {
+	float y;
+	float u;
+	float v;
+	uint32_t samples;	// number of pixels
+} yuv_means_t;
+
+/**
+ * YUYV帧的Y/U/V平均值, 每row_step行取一行(NEON/SSE2)
+ * @param step bytes per line
+ */
+void frame_stats_yuyv_means(const uint8_t *data, int width, int height, int step,
+	int row_step, yuv_means_t *means);
+
+// YUV(BT.601)的平均值换算成RGB的平均值(线性变换, 忽略饱和)
+void frame_stats_yuv2rgb(const yuv_means_t *means, float *r, float *g, float *b);
+
+#define FRAME_STATS_MEAN 0x01
+#define FRAME_STATS_HISTOGRAM 0x02
+#define FRAME_STATS_FOCUS 0x04
+#define FRAME_STATS_ALL (FRAME_STATS_MEAN | FRAME_STATS_HISTOGRAM | FRAME_STATS_FOCUS)
+
+#define FRAME_STATS_BINS 64		// 4 levels per bin
+
+// luma statistics, embedded into frame_metadata_t(layout is shared with Java)
+typedef struct luma_stats {
+	uint32_t flags;			// FRAME_STATS_XXX that were computed, 0: none
+	uint32_t samples;		// number of sampled pixels
+	float mean;				// FRAME_STATS_MEAN
+	float focus;			// FRAME_STATS_FOCUS, variance of Laplacian
+	uint32_t histogram[FRAME_STATS_BINS];	// FRAME_STATS_HISTOGRAM
+} luma_stats_t;
+
+/**
+ * 亮度的平均值/直方图/对焦评价值(Laplacian的方差)(NEON/SSE2)
+ * @param luma 第一个像素的Y
+ * @param pixel_stride 2: YUYV, 1: NV21等的Y plane
+ * @param step bytes per line
+ * @param roi_width, roi_height <=0: 整个帧, 超出帧的部分被裁剪
+ * @param row_step 每row_step行取一行, 行内取全部像素
+ * @param flags FRAME_STATS_XXX
+ * @return 0: 成功, UVC_ERROR_INVALID_PARAM: ROI在帧外等
+ */
+int frame_stats_luma(const uint8_t *luma, int pixel_stride,
+	int width, int height, int step,
+	int roi_x, int roi_y, int roi_width, int roi_height,
+	int row_step, int flags, luma_stats_t *stats);
+
+#endif /* FRAMESTATS_H_ */
@@ -0,0 +1,460 @@
+/*
+ * UVCCamera
+ * library and sample to access to UVC web camera on non-rooted Android device
+ *
+ * Copyright (c) 2014-2017 saki t_saki@serenegiant.com
+ *
+ * File name: MjpegRecorder.cpp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * All files in the folder are under this Apache License, Version 2.0.
+ * Files in the jni/libjpeg, jni/libusb, jin/libuvc, jni/rapidjson folder may have a different license, see the respective files.
+*/
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#if 1	// set 1 if you don't need debug log
+	#ifndef LOG_NDEBUG
+		#define	LOG_NDEBUG		// w/o LOGV/LOGD/MARK
+	#endif
+	#undef USE_LOGALL
+#else
+	#define USE_LOGALL
+	#undef LOG_NDEBUG
+//	#undef NDEBUG
+#endif
+
+#include "utilbase.h"
+#include "MjpegRecorder.h"
+
+#define	LOCAL_DEBUG 0
+
+// Matroska element IDs
+#define MKV_EBML				0x1A45DFA3
+#define MKV_EBML_VERSION		0x4286
+#define MKV_EBML_READ_VERSION	0x42F7
+#define MKV_EBML_MAX_ID_LENGTH	0x42F2
+#define MKV_EBML_MAX_SIZE_LENGTH	0x42F3
+#define MKV_DOCTYPE				0x4282
+#define MKV_DOCTYPE_VERSION		0x4287
+#define MKV_DOCTYPE_READ_VERSION	0x4285
+#define MKV_SEGMENT				0x18538067
+#define MKV_SEEKHEAD			0x114D9B74
+#define MKV_SEEK				0x4DBB
+#define MKV_SEEK_ID				0x53AB
+#define MKV_SEEK_POSITION		0x53AC
+#define MKV_VOID				0xEC
+#define MKV_INFO				0x1549A966
+#define MKV_TIMECODE_SCALE		0x2AD7B1
+#define MKV_MUXING_APP			0x4D80
+#define MKV_WRITING_APP			0x5741
+#define MKV_DURATION			0x4489
+#define MKV_TRACKS				0x1654AE6B
+#define MKV_TRACK_ENTRY			0xAE
+#define MKV_TRACK_NUMBER		0xD7
+#define MKV_TRACK_UID			0x73C5
+#define MKV_TRACK_TYPE			0x83
+#define MKV_FLAG_LACING			0x9C
+#define MKV_CODEC_ID			0x86
+#define MKV_VIDEO				0xE0
+#define MKV_PIXEL_WIDTH			0xB0
+#define MKV_PIXEL_HEIGHT		0xBA
+#define MKV_CLUSTER				0x1F43B675
+#define MKV_TIMECODE			0xE7
+#define MKV_SIMPLE_BLOCK		0xA3
+#define MKV_CUES				0x1C53BB6B
+#define MKV_CUE_POINT			0xBB
+#define MKV_CUE_TIME			0xB3
+#define MKV_CUE_TRACK_POSITIONS	0xB7
+#define MKV_CUE_TRACK			0xF7
+#define MKV_CUE_CLUSTER_POSITION	0xF1
+
+#define MKV_UNKNOWN_SIZE		0x00FFFFFFFFFFFFFFULL
+#define MKV_SIZE_BYTES			8	// all sizes are written as 8 bytes vint so that they can be patched
+#define MKV_CLUSTER_HEADER		(4 + MKV_SIZE_BYTES)
+#define MKV_APP_NAME			"UVCCamera"
+
+static uint8_t *put_be(uint8_t *p, uint64_t val, int bytes) {
+	for (int i = bytes - 1; i >= 0; i--) {
+		*(p++) = (uint8_t)(val >> (i * 8));
+	}
+	return p;
+}
+
+static uint8_t *put_id(uint8_t *p, uint32_t id) {
+	if (id > 0xffffff) *(p++) = (uint8_t)(id >> 24);
+	if (id > 0xffff) *(p++) = (uint8_t)(id >> 16);
+	if (id > 0xff) *(p++) = (uint8_t)(id >> 8);
+	*(p++) = (uint8_t)id;
+	return p;
+}
+
+static uint8_t *put_size(uint8_t *p, uint64_t size) {
+	*(p++) = 0x01;
+	return put_be(p, size, 7);
+}
+
+static uint8_t *put_uint(uint8_t *p, uint32_t id, uint64_t val) {
+	p = put_id(p, id);
+	*(p++) = 0x88;
+	return put_be(p, val, 8);
+}
+
+static uint8_t *put_float(uint8_t *p, uint32_t id, double val) {
+	uint64_t bits;
+	memcpy(&bits, &val, sizeof(bits));
+	return put_uint(p, id, bits);
+}
+
+static uint8_t *put_string(uint8_t *p, uint32_t id, const char *str) {
+	const size_t len = strlen(str);	// shorter than 127
+	p = put_id(p, id);
+	*(p++) = 0x80 | (uint8_t)len;
+	memcpy(p, str, len);
+	return p + len;
+}
+
+// master element with unknown size, call end_master with the returned pointer later
+static uint8_t *begin_master(uint8_t *p, uint32_t id, uint8_t **size_pos) {
+	p = put_id(p, id);
+	*size_pos = p;
+	return put_size(p, MKV_UNKNOWN_SIZE);
+}
+
+static void end_master(uint8_t *size_pos, uint8_t *end) {
+	put_size(size_pos, end - (size_pos + MKV_SIZE_BYTES));
+}
+
+MjpegRecorder::MjpegRecorder()
+:	mWriter(NULL),
+	mIsRecording(false),
+	mFrames(0),
+	mSegmentPos(0),
+	mDurationPos(0),
+	mInfoPos(0),
+	mTracksPos(0),
+	mHeaderWritten(false),
+	mFirstTimeUs(0),
+	mLastTimeMs(0),
+	mClusterTimeMs(0),
+	mCues(NULL),
+	mNumCues(0),
+	mCuesCapacity(0) {
+
+	pthread_mutex_init(&record_mutex, NULL);
+}
+
+MjpegRecorder::~MjpegRecorder() {
+	stop();
+	SAFE_DELETE(mWriter);
+	free(mCues);
+	pthread_mutex_destroy(&record_mutex);
+}
+
+/**
+ * 开始录像, 实际的文件头在收到第一个MJPEG帧时写入
+ * @return 0: 成功, UVC_ERROR_BUSY: 正在录像, <0: -errno
+ */
+int MjpegRecorder::start(const char *path) {
+	ENTER();
+
+	if (UNLIKELY(!path)) {
+		RETURN(UVC_ERROR_INVALID_PARAM, int);
+	}
+	int result;
+	pthread_mutex_lock(&record_mutex);
+	{
+		if (UNLIKELY(mIsRecording || (mWriter && mWriter->isBusy()))) {
+			result = UVC_ERROR_BUSY;
+		} else {
+			if (!mWriter) {
+				mWriter = new AsyncFileWriter();
+			}
+			result = mWriter->open(path, RECORD_QUEUE_BYTES,
+				ASYNC_WRITER_DIRECT, RECORD_SYNC_INTERVAL_MS);
+			if (LIKELY(!result)) {
+				mFrames = 0;
+				mHeaderWritten = false;
+				mLastTimeMs = mClusterTimeMs = 0;
+				mNumCues = 0;
+				mIsRecording = true;
+			}
+		}
+	}
+	pthread_mutex_unlock(&record_mutex);
+
+	RETURN(result, int);
+}
+
+/**
+ * 结束录像, 写完队列中的帧并完成文件之后返回
+ * @return 写入的帧数, <0: 错误
+ */
+int MjpegRecorder::stop() {
+	ENTER();
+
+	int result = UVC_ERROR_INVALID_PARAM;
+	pthread_mutex_lock(&record_mutex);
+	const bool recording = mIsRecording;
+	mIsRecording = false;
+	pthread_mutex_unlock(&record_mutex);
+	if (recording) {
+		// offer does not touch the writer any more, finalize without blocking the frame callback
+		result = finalize();
+		if (LIKELY(!result)) {
+			result = (int)mFrames;
+		}
+		LOGI("recorded frames=%u,err=%d", mFrames, result);
+	}
+
+	RETURN(result, int);
+}
+
+/**
+ * 最近一次录像的写入统计
+ * @return 0: 成功, UVC_ERROR_INVALID_PARAM: 还没有录像
+ */
+int MjpegRecorder::getStats(async_writer_stats_t *stats) {
+	int result = UVC_ERROR_INVALID_PARAM;
+	pthread_mutex_lock(&record_mutex);
+	if (mWriter) {
+		mWriter->getStats(stats);
+		result = 0;
+	}
+	pthread_mutex_unlock(&record_mutex);
+	return result;
+}
+
+/**
+ * 从uvc的回调线程调用, 只复制压缩帧到写入队列
+ */
+void MjpegRecorder::offer(const uvc_frame_t *frame) {
+	if (LIKELY(!mIsRecording
+		|| (frame->frame_format != UVC_FRAME_FORMAT_MJPEG) || !frame->actual_bytes)) {
+		return;
+	}
+	pthread_mutex_lock(&record_mutex);
+	if (LIKELY(mIsRecording)) {
+		write_frame(frame);
+	}
+	pthread_mutex_unlock(&record_mutex);
+}
+
+int MjpegRecorder::write_header(const uvc_frame_t *frame) {
+	uint8_t buf[512];
+	uint8_t *p = buf, *size_pos, *sub_size_pos, *video_size_pos;
+	const uint64_t base = mWriter->position();
+
+	p = begin_master(p, MKV_EBML, &size_pos);
+	{
+		p = put_uint(p, MKV_EBML_VERSION, 1);
+		p = put_uint(p, MKV_EBML_READ_VERSION, 1);
+		p = put_uint(p, MKV_EBML_MAX_ID_LENGTH, 4);
+		p = put_uint(p, MKV_EBML_MAX_SIZE_LENGTH, 8);
+		p = put_string(p, MKV_DOCTYPE, "matroska");
+		p = put_uint(p, MKV_DOCTYPE_VERSION, 4);
+		p = put_uint(p, MKV_DOCTYPE_READ_VERSION, 2);
+	}
+	end_master(size_pos, p);
+	// Segment with unknown size until finalize
+	p = put_id(p, MKV_SEGMENT);
+	p = put_size(p, MKV_UNKNOWN_SIZE);
+	mSegmentPos = base + (p - buf);
+	// space for SeekHead
+	p = put_id(p, MKV_VOID);
+	p = put_size(p, RECORD_SEEKHEAD_RESERVED - 1 - MKV_SIZE_BYTES);
+	memset(p, 0, RECORD_SEEKHEAD_RESERVED - 1 - MKV_SIZE_BYTES);
+	p += RECORD_SEEKHEAD_RESERVED - 1 - MKV_SIZE_BYTES;
+
+	mInfoPos = base + (p - buf);
+	p = begin_master(p, MKV_INFO, &size_pos);
+	{
+		p = put_uint(p, MKV_TIMECODE_SCALE, 1000000);	// 1ms
+		p = put_string(p, MKV_MUXING_APP, MKV_APP_NAME);
+		p = put_string(p, MKV_WRITING_APP, MKV_APP_NAME);
+		mDurationPos = base + (p - buf) + 3;	// 2 bytes id + 1 byte size
+		p = put_float(p, MKV_DURATION, 0.0);
+	}
+	end_master(size_pos, p);
+
+	mTracksPos = base + (p - buf);
+	p = begin_master(p, MKV_TRACKS, &size_pos);
+	{
+		p = begin_master(p, MKV_TRACK_ENTRY, &sub_size_pos);
+		{
+			p = put_uint(p, MKV_TRACK_NUMBER, 1);
+			p = put_uint(p, MKV_TRACK_UID, 1);
+			p = put_uint(p, MKV_TRACK_TYPE, 1);	// video
+			p = put_uint(p, MKV_FLAG_LACING, 0);
+			p = put_string(p, MKV_CODEC_ID, "V_MJPEG");
+			p = begin_master(p, MKV_VIDEO, &video_size_pos);
+			{
+				p = put_uint(p, MKV_PIXEL_WIDTH, frame->width);
+				p = put_uint(p, MKV_PIXEL_HEIGHT, frame->height);
+			}
+			end_master(video_size_pos, p);
+		}
+		end_master(sub_size_pos, p);
+	}
+	end_master(size_pos, p);
+
+	const int result = mWriter->write(buf, p - buf, true);
+	if (LIKELY(!result)) {
+		mFirstTimeUs = (int64_t)frame->capture_time.tv_sec * 1000000LL + frame->capture_time.tv_usec;
+		mHeaderWritten = true;
+	}
+	return result;
+}
+
+// must be called with record_mutex held
+void MjpegRecorder::write_frame(const uvc_frame_t *frame) {
+	if (UNLIKELY(!mHeaderWritten)) {
+		// the queue is empty here, so this never blocks
+		if (UNLIKELY(write_header(frame))) return;
+	}
+	const int64_t capture_time_us = (int64_t)frame->capture_time.tv_sec * 1000000LL
+		+ frame->capture_time.tv_usec;
+	int64_t time_ms = (capture_time_us - mFirstTimeUs) / 1000;
+	if (UNLIKELY(time_ms < mLastTimeMs)) {
+		time_ms = mLastTimeMs;	// keep monotonic
+	}
+
+	uint8_t cluster[32], block[32];
+	uint8_t *p;
+	struct iovec iov[3];
+	int n = 0;
+	const bool new_cluster = !mNumCues || (time_ms - mClusterTimeMs >= RECORD_CLUSTER_MS);
+	const uint64_t position = mWriter->position();
+	if (new_cluster) {
+		if (UNLIKELY(mNumCues >= mCuesCapacity)) {
+			const int capacity = mCuesCapacity ? mCuesCapacity * 2 : 256;
+			record_cue_t *cues = (record_cue_t *)realloc(mCues, sizeof(record_cue_t) * capacity);
+			if (UNLIKELY(!cues)) return;
+			mCues = cues;
+			mCuesCapacity = capacity;
+		}
+		// Cluster also has unknown size until finalize
+		p = put_id(cluster, MKV_CLUSTER);
+		p = put_size(p, MKV_UNKNOWN_SIZE);
+		p = put_uint(p, MKV_TIMECODE, time_ms);
+		iov[n].iov_base = cluster;
+		iov[n++].iov_len = p - cluster;
+	}
+	p = put_id(block, MKV_SIMPLE_BLOCK);
+	p = put_size(p, frame->actual_bytes + 4);
+	*(p++) = 0x81;	// track number 1
+	p = put_be(p, (uint16_t)(int16_t)(time_ms - (new_cluster ? time_ms : mClusterTimeMs)), 2);
+	*(p++) = 0x80;	// keyframe
+	iov[n].iov_base = block;
+	iov[n++].iov_len = p - block;
+	iov[n].iov_base = frame->data;
+	iov[n++].iov_len = frame->actual_bytes;
+	// never block the frame callback, drop the frame when the writer falls behind
+	if (LIKELY(!mWriter->writev(iov, n, false))) {
+		if (new_cluster) {
+			mCues[mNumCues].time_ms = time_ms;
+			mCues[mNumCues].position = position;
+			mNumCues++;
+			mClusterTimeMs = time_ms;
+		}
+		mLastTimeMs = time_ms;
+		mFrames++;
+	}
+}
+
+/**
+ * 追加Cues, 写完剩余的数据后回写Segment/Cluster的大小, Duration和SeekHead
+ * 中途失败时文件仍然保持未知大小的状态(可以播放但不能快速定位)
+ */
+int MjpegRecorder::finalize() {
+	ENTER();
+
+	int result = 0;
+	if (LIKELY(mHeaderWritten)) {
+		uint8_t buf[RECORD_SEEKHEAD_RESERVED];
+		uint8_t *p, *size_pos, *sub_size_pos;
+		// Cues, one CuePoint for each Cluster
+		const uint64_t cues_pos = mWriter->position();
+		p = begin_master(buf, MKV_CUES, &size_pos);
+		end_master(size_pos, size_pos + MKV_SIZE_BYTES + (size_t)mNumCues * 48);
+		result = mWriter->write(buf, p - buf, true);
+		for (int i = 0; !result && (i < mNumCues); i++) {
+			p = begin_master(buf, MKV_CUE_POINT, &size_pos);
+			{
+				p = put_uint(p, MKV_CUE_TIME, mCues[i].time_ms);
+				p = begin_master(p, MKV_CUE_TRACK_POSITIONS, &sub_size_pos);
+				{
+					p = put_uint(p, MKV_CUE_TRACK, 1);
+					p = put_uint(p, MKV_CUE_CLUSTER_POSITION, mCues[i].position - mSegmentPos);
+				}
+				end_master(sub_size_pos, p);
+			}
+			end_master(size_pos, p);
+			result = mWriter->write(buf, p - buf, true);	// 48 bytes
+		}
+		if (LIKELY(!result)) {
+			result = mWriter->flush();
+		}
+		const uint64_t end = mWriter->position();
+
+		for (int i = 0; !result && (i < mNumCues); i++) {
+			const uint64_t next = i + 1 < mNumCues ? mCues[i + 1].position : cues_pos;
+			put_size(buf, next - mCues[i].position - MKV_CLUSTER_HEADER);
+			result = mWriter->patch(mCues[i].position + 4, buf, MKV_SIZE_BYTES);
+		}
+		if (LIKELY(!result)) {
+			put_size(buf, end - mSegmentPos);
+			result = mWriter->patch(mSegmentPos - MKV_SIZE_BYTES, buf, MKV_SIZE_BYTES);
+		}
+		if (LIKELY(!result)) {
+			// add one frame interval to the last timestamp
+			const double duration = mFrames > 1
+				? mLastTimeMs + (double)mLastTimeMs / (mFrames - 1) : (double)mLastTimeMs;
+			uint64_t bits;
+			memcpy(&bits, &duration, sizeof(bits));
+			put_be(buf, bits, 8);
+			result = mWriter->patch(mDurationPos, buf, 8);
+		}
+		if (LIKELY(!result)) {
+			const uint32_t ids[] = { MKV_INFO, MKV_TRACKS, MKV_CUES };
+			const uint64_t positions[] = { mInfoPos, mTracksPos, cues_pos };
+			p = begin_master(buf, MKV_SEEKHEAD, &size_pos);
+			for (int i = 0; i < 3; i++) {
+				p = begin_master(p, MKV_SEEK, &sub_size_pos);
+				{
+					p = put_id(p, MKV_SEEK_ID);
+					*(p++) = 0x84;
+					p = put_be(p, ids[i], 4);
+					p = put_uint(p, MKV_SEEK_POSITION, positions[i] - mSegmentPos);
+				}
+				end_master(sub_size_pos, p);
+			}
+			end_master(size_pos, p);
+			// fill the rest of reserved space with Void
+			const size_t rest = RECORD_SEEKHEAD_RESERVED - (p - buf);
+			p = put_id(p, MKV_VOID);
+			p = put_size(p, rest - 1 - MKV_SIZE_BYTES);
+			memset(p, 0, rest - 1 - MKV_SIZE_BYTES);
+			result = mWriter->patch(mSegmentPos, buf, RECORD_SEEKHEAD_RESERVED);
+		}
+	}
+	const int r = mWriter->close();
+	if (!result) {
+		result = r;
+	}
+
+	RETURN(result, int);
+}
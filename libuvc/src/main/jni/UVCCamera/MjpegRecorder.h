@@ -0,0 +1,82 @@
+/*
+ * UVCCamera
+ * library and sample to access to UVC web camera on non-rooted Android device
+ *
+ * Copyright (c) 2014-2017 saki t_saki@serenegiant.com
+ *
+ * File name: MjpegRecorder.h
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * All files in the folder are under this Apache License, Version 2.0.
+ * Files in the jni/libjpeg, jni/libusb, jin/libuvc, jni/rapidjson folder may have a different license, see the respective files.
+*/
+
+
+
+#ifndef MJPEGRECORDER_H_
+#define MJPEGRECORDER_H_
+
+#include <pthread.h>
+#include "libUVCCamera.h"
+#include "AsyncFileWriter.h"
+
+#pragma interface
+
+#define RECORD_QUEUE_BYTES (32 * 1024 * 1024)	// about 1.5 sec of 1080p60 MJPEG
+#define RECORD_CLUSTER_MS 1000			// must be less than 32767(int16 relative timecode)
+#define RECORD_SYNC_INTERVAL_MS 2000	// fdatasync interval of AsyncFileWriter
+#define RECORD_SEEKHEAD_RESERVED 128
+
+typedef struct record_cue {
+	int64_t time_ms;
+	uint64_t position;			// file offset of the cluster
+} record_cue_t;
+
+/**
+ * MJPEG流的Matroska(V_MJPEG)录像, 不解码/不重新编码
+ * uvc的回调线程只把压缩帧复制到AsyncFileWriter的队列, 写入跟不上时丢弃该帧
+ * Segment/Cluster先以未知大小写入, 进程意外结束时已写入的部分仍然可以播放
+ * 结束时追加Cues并回写各大小/Duration/SeekHead
+ */
+class MjpegRecorder {
+private:
+	pthread_mutex_t record_mutex;
+	AsyncFileWriter *mWriter;
+	volatile bool mIsRecording;
+	// followings are accessed with record_mutex held
+	uint32_t mFrames;
+	uint64_t mSegmentPos;		// file offset of Segment data
+	uint64_t mDurationPos;		// file offset of Duration(float64)
+	uint64_t mInfoPos, mTracksPos;
+	bool mHeaderWritten;
+	int64_t mFirstTimeUs;
+	int64_t mLastTimeMs;
+	int64_t mClusterTimeMs;
+	record_cue_t *mCues;		// one for each cluster
+	int mNumCues, mCuesCapacity;
+	int write_header(const uvc_frame_t *frame);
+	void write_frame(const uvc_frame_t *frame);
+	int finalize();
+public:
+	MjpegRecorder();
+	~MjpegRecorder();
+
+	int start(const char *path);
+	int stop();
+	void offer(const uvc_frame_t *frame);
+	int getStats(async_writer_stats_t *stats);
+	inline bool isRecording() const { return mIsRecording; };
+};
+
+#endif /* MJPEGRECORDER_H_ */
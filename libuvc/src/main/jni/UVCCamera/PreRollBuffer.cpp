@@ -0,0 +1,283 @@
+/*
+ * UVCCamera
+ * library and sample to access to UVC web camera on non-rooted Android device
+ *
+ * Copyright (c) 2014-2017 saki t_saki@serenegiant.com
+ *
+ * File name: PreRollBuffer.cpp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * All files in the folder are under this Apache License, Version 2.0.
+ * Files in the jni/libjpeg, jni/libusb, jin/libuvc, jni/rapidjson folder may have a different license, see the respective files.
+*/
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#if 1	// set 1 if you don't need debug log
+	#ifndef LOG_NDEBUG
+		#define	LOG_NDEBUG		// w/o LOGV/LOGD/MARK
+	#endif
+	#undef USE_LOGALL
+#else
+	#define USE_LOGALL
+	#undef LOG_NDEBUG
+//	#undef NDEBUG
+#endif
+
+#include "utilbase.h"
+#include "PreRollBuffer.h"
+
+#define	LOCAL_DEBUG 0
+#define NO_PIN (~(uint64_t)0)
+
+PreRollBuffer::PreRollBuffer()
+:	mArena(NULL),
+	mBudget(0),
+	mDurationUs(0),
+	mHead(0),
+	mEntries(NULL),
+	mFirst(0),
+	mCount(0),
+	mSerial(0),
+	mPinSerial(NO_PIN),
+	mPinDropped(0),
+	mDataWriter(NULL),
+	mIndexWriter(NULL) {
+
+	pthread_mutex_init(&preroll_mutex, NULL);
+}
+
+PreRollBuffer::~PreRollBuffer() {
+	// wait for the last dump
+	SAFE_DELETE(mDataWriter);
+	SAFE_DELETE(mIndexWriter);
+	pthread_mutex_lock(&preroll_mutex);
+	{
+		free(mArena);
+		mArena = NULL;
+		free(mEntries);
+		mEntries = NULL;
+	}
+	pthread_mutex_unlock(&preroll_mutex);
+	pthread_mutex_destroy(&preroll_mutex);
+}
+
+/**
+ * @param budget_bytes 保留的最大字节数, 预先分配
+ * @param duration_ms 保留的最长时间, 0: 只按字节数
+ * @return 0: 成功
+ */
+int PreRollBuffer::init(size_t budget_bytes, int duration_ms) {
+	ENTER();
+
+	if (UNLIKELY(!budget_bytes)) {
+		RETURN(UVC_ERROR_INVALID_PARAM, int);
+	}
+	uint8_t *arena = (uint8_t *)malloc(budget_bytes);
+	preroll_entry_t *entries = (preroll_entry_t *)malloc(sizeof(preroll_entry_t) * MAX_PREROLL_FRAMES);
+	if (UNLIKELY(!arena || !entries)) {
+		free(arena);
+		free(entries);
+		RETURN(UVC_ERROR_NO_MEM, int);
+	}
+	pthread_mutex_lock(&preroll_mutex);
+	{
+		free(mArena);
+		free(mEntries);
+		mArena = arena;
+		mEntries = entries;
+		mBudget = budget_bytes;
+		mDurationUs = duration_ms > 0 ? duration_ms * 1000LL : 0;
+		mHead = 0;
+		mFirst = mCount = 0;
+	}
+	pthread_mutex_unlock(&preroll_mutex);
+
+	RETURN(0, int);
+}
+
+// must be called with preroll_mutex held
+void PreRollBuffer::evict_oldest() {
+	mFirst = (mFirst + 1) % MAX_PREROLL_FRAMES;
+	mCount--;
+}
+
+/**
+ * 追加帧, 从uvc的回调线程调用
+ * 超过预算/时长的旧帧被丢弃, dump正在复制的旧帧不能覆盖时丢弃新帧
+ */
+void PreRollBuffer::add(const uvc_frame_t *frame) {
+	const size_t bytes = frame->frame_format == UVC_FRAME_FORMAT_MJPEG
+		? frame->actual_bytes : frame->data_bytes;
+	const int64_t capture_time_us = (int64_t)frame->capture_time.tv_sec * 1000000LL
+		+ frame->capture_time.tv_usec;
+
+	pthread_mutex_lock(&preroll_mutex);
+	if (LIKELY(mArena && bytes && (bytes <= mBudget))) {
+		size_t pos = mHead;
+		const bool wrapped = pos + bytes > mBudget;
+		if (wrapped) {
+			pos = 0;
+		}
+		const uint64_t pin = __atomic_load_n(&mPinSerial, __ATOMIC_ACQUIRE);
+		bool pinned = false;
+		for ( ; mCount > 0 ; ) {
+			const preroll_entry_t *oldest = &mEntries[mFirst];
+			const bool overlap = (wrapped && (oldest->offset >= mHead))	// entries beyond previous head belong to the previous lap
+				|| ((oldest->offset < pos + bytes) && (oldest->offset + oldest->bytes > pos));
+			if (!overlap && (mCount < MAX_PREROLL_FRAMES)
+				&& (!mDurationUs || (capture_time_us - oldest->capture_time_us <= mDurationUs))) {
+				break;
+			}
+			if (UNLIKELY(oldest->serial >= pin)) {
+				// dump is copying this frame outside of the lock, keep it
+				pinned = overlap || (mCount >= MAX_PREROLL_FRAMES);
+				break;
+			}
+			evict_oldest();
+		}
+		if (LIKELY(!pinned)) {
+			memcpy(mArena + pos, frame->data, bytes);
+			preroll_entry_t *entry = &mEntries[(mFirst + mCount) % MAX_PREROLL_FRAMES];
+			entry->serial = mSerial++;
+			entry->offset = pos;
+			entry->bytes = bytes;
+			entry->capture_time_us = capture_time_us;
+			entry->sequence = frame->sequence;
+			entry->pts = frame->pts;
+			entry->width = frame->width;
+			entry->height = frame->height;
+			entry->frame_format = frame->frame_format;
+			mCount++;
+			mHead = pos + bytes;
+		} else {
+			mPinDropped++;
+		}
+	}
+	pthread_mutex_unlock(&preroll_mutex);
+}
+
+/**
+ * 把当前保留的帧复制到写入队列, 由AsyncFileWriter的I/O线程写入文件
+ * 锁内只取得帧的快照(索引), 复制在锁外进行, 不阻塞add(uvc的回调线程)
+ * 不能与init或其他dump同时调用
+ * path: 帧数据(MJPEG时为连续的jpeg), path.idx: 每帧的信息(csv)
+ * @return 写入的帧数, <0: 错误, UVC_ERROR_BUSY: 上一次的写入还没有结束
+ */
+int PreRollBuffer::dump(const char *path) {
+	ENTER();
+
+	if (UNLIKELY(!path)) {
+		RETURN(UVC_ERROR_INVALID_PARAM, int);
+	}
+	if (UNLIKELY(isDumping())) {
+		// don't wait here, this may be called while the frame callback is blocked
+		RETURN(UVC_ERROR_BUSY, int);
+	}
+	if (!mDataWriter) {
+		mDataWriter = new AsyncFileWriter();
+	}
+	if (!mIndexWriter) {
+		mIndexWriter = new AsyncFileWriter();
+	}
+	// release the threads of previous dump, already finished
+	mDataWriter->close();
+	mIndexWriter->close();
+
+	preroll_entry_t *entries = (preroll_entry_t *)malloc(sizeof(preroll_entry_t) * MAX_PREROLL_FRAMES);
+	if (UNLIKELY(!entries)) {
+		RETURN(UVC_ERROR_NO_MEM, int);
+	}
+	// all frames in the arena always fit into the queue of the same size
+	int result = mDataWriter->open(path, mBudget ? mBudget : ASYNC_WRITER_ALIGN);
+	int count = 0;
+	if (LIKELY(!result)) {
+		// snapshot and pin the frames
+		pthread_mutex_lock(&preroll_mutex);
+		{
+			count = mCount;
+			for (int i = 0; i < count; i++) {
+				entries[i] = mEntries[(mFirst + i) % MAX_PREROLL_FRAMES];
+			}
+			mPinDropped = 0;
+			if (count) {
+				__atomic_store_n(&mPinSerial, entries[0].serial, __ATOMIC_RELEASE);
+			}
+		}
+		pthread_mutex_unlock(&preroll_mutex);
+		// copy outside of the lock, unpin each frame after copying
+		size_t offset = 0;
+		for (int i = 0; !result && (i < count); i++) {
+			result = mDataWriter->write(mArena + entries[i].offset, entries[i].bytes, false);
+			__atomic_store_n(&mPinSerial, entries[i].serial + 1, __ATOMIC_RELEASE);
+			entries[i].offset = offset;
+			offset += entries[i].bytes;
+		}
+		__atomic_store_n(&mPinSerial, NO_PIN, __ATOMIC_RELEASE);
+		mDataWriter->closeAsync();
+		if (mPinDropped) {
+			LOGW("dropped %u frames while dumping", mPinDropped);
+		}
+	}
+	if (LIKELY(!result)) {
+		result = write_index(mIndexWriter, path, entries, count);
+	}
+	free(entries);
+	if (LIKELY(!result)) {
+		result = count;
+	}
+	RETURN(result, int);
+}
+
+/**
+ * @return true: 上一次的写入还没有结束
+ */
+bool PreRollBuffer::isDumping() {
+	return (mDataWriter && mDataWriter->isBusy())
+		|| (mIndexWriter && mIndexWriter->isBusy());
+}
+
+/*static*/
+int PreRollBuffer::write_index(AsyncFileWriter *writer, const char *path,
+	const preroll_entry_t *entries, int count) {
+
+	const size_t len = strlen(path);
+	char *idx_path = (char *)malloc(len + 5);
+	const size_t capacity = (size_t)count * 128 + 128;
+	char *csv = (char *)malloc(capacity);
+	int result = UVC_ERROR_NO_MEM;
+	if (LIKELY(idx_path && csv)) {
+		memcpy(idx_path, path, len);
+		memcpy(idx_path + len, ".idx", 5);
+		size_t n = snprintf(csv, capacity,
+			"sequence,capture_time_us,pts,width,height,frame_format,offset,bytes\n");
+		for (int i = 0; i < count; i++) {
+			const preroll_entry_t *e = &entries[i];
+			n += snprintf(csv + n, capacity - n, "%u,%lld,%u,%u,%u,%d,%zu,%zu\n",
+				e->sequence, (long long)e->capture_time_us, e->pts,
+				e->width, e->height, e->frame_format, e->offset, e->bytes);
+		}
+		result = writer->open(idx_path, n);
+		if (LIKELY(!result)) {
+			result = writer->write(csv, n, false);
+			writer->closeAsync();
+		}
+	}
+	free(idx_path);
+	free(csv);
+	return result;
+}
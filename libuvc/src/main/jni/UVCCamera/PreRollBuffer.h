@@ -0,0 +1,81 @@
+/*
+ * UVCCamera
+ * library and sample to access to UVC web camera on non-rooted Android device
+ *
+ * Copyright (c) 2014-2017 saki t_saki@serenegiant.com
+ *
+ * File name: PreRollBuffer.h
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * All files in the folder are under this Apache License, Version 2.0.
+ * Files in the jni/libjpeg, jni/libusb, jin/libuvc, jni/rapidjson folder may have a different license, see the respective files.
+*/
+
+
+#ifndef PREROLLBUFFER_H_
+#define PREROLLBUFFER_H_
+
+#include <pthread.h>
+#include "libUVCCamera.h"
+#include "AsyncFileWriter.h"
+
+#pragma interface
+
+#define MAX_PREROLL_FRAMES 4096
+
+typedef struct preroll_entry {
+	uint64_t serial;			// number of the frame added to this buffer
+	size_t offset;				// offset in the arena
+	size_t bytes;
+	int64_t capture_time_us;
+	uint32_t sequence;
+	uint32_t pts;
+	uint32_t width;
+	uint32_t height;
+	int32_t frame_format;
+} preroll_entry_t;
+
+/**
+ * 预录缓冲区, 按字节预算和时长保留最近收到的帧(MJPEG/YUYV as received)
+ * 只复制不解码, dump时把快照复制到AsyncFileWriter的队列, 由其I/O线程写入文件
+ * 复制在锁外进行, 复制中的帧被固定(pin), 需要覆盖固定的帧时add丢弃新帧而不等待
+ */
+class PreRollBuffer {
+private:
+	pthread_mutex_t preroll_mutex;
+	uint8_t *mArena;
+	size_t mBudget;
+	int64_t mDurationUs;		// 0: no limit
+	size_t mHead;				// next write offset
+	preroll_entry_t *mEntries;	// FIFO of MAX_PREROLL_FRAMES
+	int mFirst, mCount;
+	uint64_t mSerial;			// serial of the next frame
+	volatile uint64_t mPinSerial;	// frames with serial >= this are being copied by dump
+	uint32_t mPinDropped;		// frames not added because of pinned frames
+	AsyncFileWriter *mDataWriter;	// frames
+	AsyncFileWriter *mIndexWriter;	// csv
+	void evict_oldest();
+	static int write_index(AsyncFileWriter *writer, const char *path,
+		const preroll_entry_t *entries, int count);
+public:
+	PreRollBuffer();
+	~PreRollBuffer();
+
+	int init(size_t budget_bytes, int duration_ms);
+	void add(const uvc_frame_t *frame);
+	int dump(const char *path);
+	bool isDumping();
+};
+
+#endif /* PREROLLBUFFER_H_ */
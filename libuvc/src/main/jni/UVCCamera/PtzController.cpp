@@ -0,0 +1,446 @@
+/*
+ * UVCCamera
+ * library and sample to access to UVC web camera on non-rooted Android device
+ *
+ * Copyright (c) 2014-2017 saki t_saki@serenegiant.com
+ *
+ * File name: PtzController.cpp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * All files in the folder are under this Apache License, Version 2.0.
+ * Files in the jni/libjpeg, jni/libusb, jin/libuvc, jni/rapidjson folder may have a different license, see the respective files.
+*/
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <time.h>
+#include <sys/time.h>
+
+#if 1	// set 1 if you don't need debug log
+	#ifndef LOG_NDEBUG
+		#define	LOG_NDEBUG		// w/o LOGV/LOGD/MARK
+	#endif
+	#undef USE_LOGALL
+#else
+	#define USE_LOGALL
+	#undef LOG_NDEBUG
+//	#undef NDEBUG
+#endif
+
+#include "utilbase.h"
+#include "PtzController.h"
+#include "UVCCamera.h"
+
+#define	LOCAL_DEBUG 0
+
+static int64_t now_us() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+// absolute/relative control of each axis, PTZ_AXIS_XXX order
+static const int sAxisControls[PTZ_AXIS_NUM][2] = {
+	{ CONTROL_PAN, CONTROL_PAN_REL },
+	{ CONTROL_TILT, CONTROL_TILT_REL },
+	{ CONTROL_ZOOM, CONTROL_ZOOM_REL },
+};
+
+PtzController::PtzController(UVCCamera *camera)
+:	mCamera(camera),
+	ptz_thread(0),
+	mIsRunning(false),
+	mPrepared(false),
+	mPeriodMs(PTZ_DEFAULT_PERIOD_MS) {
+
+	ENTER();
+	pthread_mutex_init(&ptz_mutex, NULL);
+	pthread_cond_init(&ptz_sync, NULL);
+	memset(mAxes, 0, sizeof(mAxes));
+	for (int i = 0; i < PTZ_AXIS_NUM; i++) {
+		mAxes[i].abs_id = sAxisControls[i][0];
+		mAxes[i].rel_id = sAxisControls[i][1];
+	}
+	EXIT();
+}
+
+PtzController::~PtzController() {
+	ENTER();
+	stop();
+	pthread_cond_destroy(&ptz_sync);
+	pthread_mutex_destroy(&ptz_mutex);
+	EXIT();
+}
+
+static inline int32_t clamp_position(const ptz_axis_t &axis, double position) {
+	int32_t value = (int32_t)lround(position);
+	if (axis.res > 1) {
+		value = axis.min + (int32_t)lround((position - axis.min) / axis.res) * axis.res;
+	}
+	return value < axis.min ? axis.min : (value > axis.max ? axis.max : value);
+}
+
+// relative command packed as CONTROL_PAN_REL/TILT_REL([direction][speed]) or CONTROL_ZOOM_REL([zoom][digital zoom][speed])
+static int32_t relative_command(const ptz_axis_t &axis, double velocity) {
+	if (velocity == 0) return 0;
+	int32_t speed = (int32_t)lround(fabs(velocity));
+	speed = speed < axis.min ? axis.min : (speed > axis.max ? axis.max : speed);
+	const int32_t direction = velocity > 0 ? 1 : -1;
+	return axis.rel_id == CONTROL_ZOOM_REL ? direction * 65536 + speed : direction * 256 + speed;
+}
+
+/**
+ * 从能力表取得各轴的范围, 绝对控制的轴读取当前位置(一起发送)
+ * 在ptz_mutex中调用, 之后不再访问能力表
+ */
+int PtzController::prepare() {
+	ENTER();
+	int read_ids[PTZ_AXIS_NUM];
+	int32_t values[PTZ_AXIS_NUM];
+	int results[PTZ_AXIS_NUM];
+	int read_axes[PTZ_AXIS_NUM];
+	int num_read = 0;
+	int ret = UVC_ERROR_NOT_SUPPORTED;
+	for (int i = 0; i < PTZ_AXIS_NUM; i++) {
+		ptz_axis_t &axis = mAxes[i];
+		control_caps_t caps;
+		int r = mCamera->getControlCaps(axis.abs_id, &caps);
+		if (r == UVC_ERROR_INVALID_DEVICE) {
+			RETURN(r, int);
+		}
+		if (!r && ((caps.valid & (CONTROL_CAPS_MIN | CONTROL_CAPS_MAX)) == (CONTROL_CAPS_MIN | CONTROL_CAPS_MAX))
+			&& (caps.max > caps.min)) {
+			axis.supported = axis.absolute = true;
+			axis.min = caps.min;
+			axis.max = caps.max;
+			axis.res = (caps.valid & CONTROL_CAPS_RES) && (caps.res > 0) ? caps.res : 1;
+			axis.position = (caps.valid & CONTROL_CAPS_DEF) ? caps.def : axis.min;
+			read_ids[num_read] = axis.abs_id;
+			read_axes[num_read++] = i;
+		} else if (!mCamera->getControlCaps(axis.rel_id, &caps) && (caps.valid & CONTROL_CAPS_MAX)) {
+			// speed is the last byte
+			axis.supported = true;
+			axis.absolute = false;
+			axis.min = (caps.valid & CONTROL_CAPS_MIN) && (caps.min & 0xff) ? caps.min & 0xff : 1;
+			axis.max = caps.max & 0xff;
+			if (axis.max < axis.min) axis.max = axis.min;
+			axis.res = 1;
+		}
+		if (axis.supported) {
+			ret = UVC_SUCCESS;
+		}
+	}
+	if (num_read && !mCamera->getControls(read_ids, values, results, num_read)) {
+		for (int k = 0; k < num_read; k++) {
+			if (!results[k]) {
+				mAxes[read_axes[k]].position = values[k];
+			}
+		}
+	}
+	for (int i = 0; i < PTZ_AXIS_NUM; i++) {
+		ptz_axis_t &axis = mAxes[i];
+		if (axis.absolute) {
+			axis.sent = clamp_position(axis, axis.position);
+			axis.position = axis.sent;
+		}
+		LOGD("axis%d:supported=%d,absolute=%d,min=%d,max=%d,res=%d",
+			i, axis.supported, axis.absolute, axis.min, axis.max, axis.res);
+	}
+	mPrepared = true;
+	RETURN(ret, int);
+}
+
+// 在ptz_mutex中调用
+int PtzController::start() {
+	int result = UVC_SUCCESS;
+	if (UNLIKELY(!ptz_thread)) {
+		mIsRunning = true;
+		if (UNLIKELY(pthread_create(&ptz_thread, NULL, ptz_thread_func, (void *)this))) {
+			LOGE("failed to create ptz thread");
+			ptz_thread = 0;
+			mIsRunning = false;
+			result = UVC_ERROR_OTHER;
+		}
+	}
+	pthread_cond_signal(&ptz_sync);
+	return result;
+}
+
+/**
+ * 在duration_ms内移动到目标位置(绝对控制), 移动中也可以变更
+ * @param axis PTZ_AXIS_XXX
+ * @param value 超出范围时限制在最小值・最大值之间
+ * @param duration_ms 0: 在下一个周期移动
+ */
+int PtzController::setTarget(int axis, int32_t value, int duration_ms) {
+	ENTER();
+	if (UNLIKELY((axis < 0) || (axis >= PTZ_AXIS_NUM))) {
+		RETURN(UVC_ERROR_INVALID_PARAM, int);
+	}
+	pthread_mutex_lock(&ptz_mutex);
+	int ret = mPrepared ? UVC_SUCCESS : prepare();
+	if (LIKELY(!ret)) {
+		ptz_axis_t &a = mAxes[axis];
+		if (a.supported && a.absolute) {
+			a.target = clamp_position(a, value);
+			a.duration_ms = duration_ms > 0 ? duration_ms : 0;
+			a.mode = PTZ_MODE_TARGET;
+			a.updated = true;
+			ret = start();
+		} else {
+			ret = UVC_ERROR_NOT_SUPPORTED;
+		}
+	}
+	pthread_mutex_unlock(&ptz_mutex);
+	RETURN(ret, int);
+}
+
+/**
+ * 以一定的速度移动, 到达范围的端点或者设置0为止
+ * @param axis PTZ_AXIS_XXX
+ * @param velocity [units/s], 符号是方向, 只支持相对控制时绝对值是设备的速度(限制在最小值・最大值之间)
+ */
+int PtzController::setVelocity(int axis, int32_t velocity) {
+	ENTER();
+	if (UNLIKELY((axis < 0) || (axis >= PTZ_AXIS_NUM))) {
+		RETURN(UVC_ERROR_INVALID_PARAM, int);
+	}
+	pthread_mutex_lock(&ptz_mutex);
+	int ret = mPrepared ? UVC_SUCCESS : prepare();
+	if (LIKELY(!ret)) {
+		ptz_axis_t &a = mAxes[axis];
+		if (a.supported) {
+			a.velocity = velocity;
+			a.mode = PTZ_MODE_VELOCITY;
+			a.updated = true;
+			ret = start();
+		} else {
+			ret = UVC_ERROR_NOT_SUPPORTED;
+		}
+	}
+	pthread_mutex_unlock(&ptz_mutex);
+	RETURN(ret, int);
+}
+
+/**
+ * 所有的轴在当前(插值后)的位置停止
+ */
+int PtzController::halt() {
+	ENTER();
+	pthread_mutex_lock(&ptz_mutex);
+	{
+		for (int i = 0; i < PTZ_AXIS_NUM; i++) {
+			ptz_axis_t &a = mAxes[i];
+			if (a.mode != PTZ_MODE_IDLE) {
+				a.velocity = 0;
+				a.mode = PTZ_MODE_VELOCITY;
+				a.updated = true;
+			}
+		}
+		pthread_cond_signal(&ptz_sync);
+	}
+	pthread_mutex_unlock(&ptz_mutex);
+	RETURN(0, int);
+}
+
+/**
+ * @param period_ms 发送的周期, 最小PTZ_MIN_PERIOD_MS
+ */
+int PtzController::setPeriod(int period_ms) {
+	ENTER();
+	pthread_mutex_lock(&ptz_mutex);
+	{
+		mPeriodMs = period_ms > PTZ_MIN_PERIOD_MS ? period_ms : PTZ_MIN_PERIOD_MS;
+	}
+	pthread_mutex_unlock(&ptz_mutex);
+	RETURN(0, int);
+}
+
+/**
+ * 最后发送的位置(绝对控制)
+ */
+int PtzController::getPosition(int axis, int32_t &value) {
+	ENTER();
+	if (UNLIKELY((axis < 0) || (axis >= PTZ_AXIS_NUM))) {
+		RETURN(UVC_ERROR_INVALID_PARAM, int);
+	}
+	pthread_mutex_lock(&ptz_mutex);
+	int ret = mPrepared ? UVC_SUCCESS : prepare();
+	if (LIKELY(!ret)) {
+		const ptz_axis_t &a = mAxes[axis];
+		if (a.supported && a.absolute) {
+			value = a.sent;
+		} else {
+			ret = UVC_ERROR_NOT_SUPPORTED;
+		}
+	}
+	pthread_mutex_unlock(&ptz_mutex);
+	RETURN(ret, int);
+}
+
+/**
+ * 结束工作线程, 相对控制移动中的轴发送停止
+ */
+void PtzController::stop() {
+	ENTER();
+	pthread_t thread = 0;
+	pthread_mutex_lock(&ptz_mutex);
+	{
+		mIsRunning = false;
+		thread = ptz_thread;
+		pthread_cond_broadcast(&ptz_sync);
+	}
+	pthread_mutex_unlock(&ptz_mutex);
+	if (thread) {
+		if (pthread_join(thread, NULL) != EXIT_SUCCESS) {
+			LOGW("PtzController::stop:pthread_join failed");
+		}
+		ptz_thread = 0;
+	}
+	for (int i = 0; i < PTZ_AXIS_NUM; i++) {
+		ptz_axis_t &a = mAxes[i];
+		if (a.supported && !a.absolute && a.sent) {
+			mCamera->setCtrlValue(a.rel_id, 0);
+			a.sent = 0;
+		}
+		a.mode = PTZ_MODE_IDLE;
+	}
+	EXIT();
+}
+
+/**
+ * 计算这个周期发送的值, 在ptz_mutex中调用
+ * @param dt 离上一个周期的时间[s]
+ * @return true: 需要发送value
+ */
+bool PtzController::update_axis(ptz_axis_t &axis, double dt, int32_t &value) {
+	if (!axis.supported || (axis.mode == PTZ_MODE_IDLE)) return false;
+	if (!axis.absolute) {
+		value = relative_command(axis, axis.velocity);
+		if (value == axis.sent) {
+			if (axis.velocity == 0) axis.mode = PTZ_MODE_IDLE;
+			return false;
+		}
+		return true;
+	}
+	if (axis.updated) {
+		axis.updated = false;
+		if (axis.mode == PTZ_MODE_TARGET) {
+			axis.velocity = axis.duration_ms > 0
+				? fabs(axis.target - axis.position) * 1000.0 / axis.duration_ms : 0;
+		}
+	}
+	if (axis.mode == PTZ_MODE_TARGET) {
+		const double diff = axis.target - axis.position;
+		const double step = axis.velocity * dt;
+		if ((axis.velocity <= 0) || (fabs(diff) <= step)) {
+			axis.position = axis.target;
+		} else {
+			axis.position += diff > 0 ? step : -step;
+		}
+	} else {
+		axis.position += axis.velocity * dt;
+	}
+	if (axis.position < axis.min) axis.position = axis.min;
+	if (axis.position > axis.max) axis.position = axis.max;
+	value = clamp_position(axis, axis.position);
+	if (value == axis.sent) {
+		if (((axis.mode == PTZ_MODE_TARGET) && (axis.position == axis.target))
+			|| ((axis.mode == PTZ_MODE_VELOCITY) && (axis.velocity == 0))) {
+			axis.mode = PTZ_MODE_IDLE;
+		}
+		return false;
+	}
+	return true;
+}
+
+/*static*/
+void *PtzController::ptz_thread_func(void *vptr_args) {
+	ENTER();
+	PtzController *ptz = reinterpret_cast<PtzController *>(vptr_args);
+	if (LIKELY(ptz)) {
+		pthread_setname_np(pthread_self(), "uvc_ptz");
+		ptz->do_ptz();
+	}
+	PRE_EXIT();
+	pthread_exit(NULL);
+}
+
+void PtzController::do_ptz() {
+	ENTER();
+	int ids[PTZ_AXIS_NUM];
+	int32_t values[PTZ_AXIS_NUM];
+	int results[PTZ_AXIS_NUM];
+	int axes[PTZ_AXIS_NUM];
+	int64_t last = now_us();
+	struct timespec ts;
+	pthread_mutex_lock(&ptz_mutex);
+	for ( ; mIsRunning ; ) {
+		bool active = false;
+		for (int i = 0; i < PTZ_AXIS_NUM; i++) {
+			active |= (mAxes[i].mode != PTZ_MODE_IDLE);
+		}
+		if (!active) {
+			pthread_cond_wait(&ptz_sync, &ptz_mutex);
+			last = now_us();
+			continue;
+		}
+		const int64_t now = now_us();
+		const double dt = (now - last) / 1000000.0;
+		last = now;
+		int num = 0;
+		for (int i = 0; i < PTZ_AXIS_NUM; i++) {
+			ptz_axis_t &axis = mAxes[i];
+			if (update_axis(axis, dt, values[num])) {
+				ids[num] = axis.absolute ? axis.abs_id : axis.rel_id;
+				axes[num++] = i;
+			}
+		}
+		const int period_ms = mPeriodMs;
+		pthread_mutex_unlock(&ptz_mutex);
+		// all axes in one batch, pan/tilt are merged into one SET_CUR
+		int ret = UVC_SUCCESS;
+		if (num) {
+			ret = mCamera->setControls(ids, values, results, num, period_ms * 2);
+		}
+		pthread_mutex_lock(&ptz_mutex);
+		for (int k = 0; !ret && (k < num); k++) {
+			if (!results[k]) {
+				mAxes[axes[k]].sent = values[k];
+			} else {
+				LOGD("failed to move:axis=%d,err=%d", axes[k], results[k]);
+			}
+		}
+		// wait for the next tick, new commands are picked up there(rate limit)
+#if _POSIX_TIMERS > 0
+		clock_gettime(CLOCK_REALTIME, &ts);
+#else
+		struct timeval tv;
+		gettimeofday(&tv, NULL);
+		ts.tv_sec = tv.tv_sec;
+		ts.tv_nsec = tv.tv_usec * 1000;
+#endif
+		ts.tv_nsec += period_ms * 1000000L;
+		ts.tv_sec += ts.tv_nsec / 1000000000;
+		ts.tv_nsec %= 1000000000;
+		for ( ; mIsRunning ; ) {
+			if (pthread_cond_timedwait(&ptz_sync, &ptz_mutex, &ts) == ETIMEDOUT) break;
+		}
+	}
+	pthread_mutex_unlock(&ptz_mutex);
+	EXIT();
+}
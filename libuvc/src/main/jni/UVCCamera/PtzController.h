@@ -0,0 +1,98 @@
+/*
+ * UVCCamera
+ * library and sample to access to UVC web camera on non-rooted Android device
+ *
+ * Copyright (c) 2014-2017 saki t_saki@serenegiant.com
+ *
+ * File name: PtzController.h
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * All files in the folder are under this Apache License, Version 2.0.
+ * Files in the jni/libjpeg, jni/libusb, jin/libuvc, jni/rapidjson folder may have a different license, see the respective files.
+*/
+
+
+#ifndef PTZCONTROLLER_H_
+#define PTZCONTROLLER_H_
+
+#include <pthread.h>
+#include "libUVCCamera.h"
+
+#pragma interface
+
+// axis for setTarget/setVelocity, same as UVCCamera.java
+#define PTZ_AXIS_PAN	0
+#define PTZ_AXIS_TILT	1
+#define PTZ_AXIS_ZOOM	2
+#define PTZ_AXIS_NUM	3
+
+#define PTZ_DEFAULT_PERIOD_MS	50	// 20Hz
+#define PTZ_MIN_PERIOD_MS		10
+
+#define PTZ_MODE_IDLE		0
+#define PTZ_MODE_TARGET		1	// move to target(absolute control only)
+#define PTZ_MODE_VELOCITY	2	// move at constant speed until stopped
+
+class UVCCamera;
+
+typedef struct ptz_axis {
+	int abs_id;			// CONTROL_XXX of absolute control
+	int rel_id;			// CONTROL_XXX of relative control
+	bool absolute;		// use absolute control, otherwise relative(velocity only)
+	bool supported;
+	int32_t min, max, res;	// absolute: range of position, relative: range of speed
+	int mode;			// PTZ_MODE_XXX
+	bool updated;		// new target, velocity is calculated on the next tick
+	int duration_ms;	// time to reach the target, 0: immediately
+	double position;	// interpolated position(absolute)
+	double target;
+	double velocity;	// [units/s], relative: sign is direction, absolute value is speed
+	int32_t sent;		// value sent last, absolute: position, relative: packed command
+} ptz_axis_t;
+
+/**
+ * PTZ的运动控制
+ * 调用方只更新目标位置/速度, 工作线程按固定周期插值后发送.
+ * pan/tilt/zoom在同一个周期里一起发送(setControls, pan/tilt合并成一个SET_CUR),
+ * 值没有变化时不发送, 范围使用能力表的最小值・最大值・分辨率.
+ * 只支持相对控制的轴只能设置速度, 方向/速度变化时才发送
+ */
+class PtzController {
+private:
+	UVCCamera *mCamera;
+	pthread_mutex_t ptz_mutex;
+	pthread_cond_t ptz_sync;
+	pthread_t ptz_thread;
+	volatile bool mIsRunning;
+	bool mPrepared;
+	int mPeriodMs;
+	ptz_axis_t mAxes[PTZ_AXIS_NUM];
+	int prepare();
+	int start();
+	bool update_axis(ptz_axis_t &axis, double dt, int32_t &value);
+	static void *ptz_thread_func(void *vptr_args);
+	void do_ptz();
+public:
+	PtzController(UVCCamera *camera);
+	~PtzController();
+
+	int setTarget(int axis, int32_t value, int duration_ms);
+	int setVelocity(int axis, int32_t velocity);
+	int halt();
+	int setPeriod(int period_ms);
+	int getPosition(int axis, int32_t &value);
+	void stop();
+};
+
+#endif /* PTZCONTROLLER_H_ */
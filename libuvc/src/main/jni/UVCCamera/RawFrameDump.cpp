@@ -0,0 +1,209 @@
+/*
+ * UVCCamera
+ * library and sample to access to UVC web camera on non-rooted Android device
+ *
+ * Copyright (c) 2014-2017 saki t_saki@serenegiant.com
+ *
+ * File name: RawFrameDump.cpp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * All files in the folder are under this Apache License, Version 2.0.
+ * Files in the jni/libjpeg, jni/libusb, jin/libuvc, jni/rapidjson folder may have a different license, see the respective files.
+*/
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#if 1	// set 1 if you don't need debug log
+	#ifndef LOG_NDEBUG
+		#define	LOG_NDEBUG		// w/o LOGV/LOGD/MARK
+	#endif
+	#undef USE_LOGALL
+#else
+	#define USE_LOGALL
+	#undef LOG_NDEBUG
+//	#undef NDEBUG
+#endif
+
+#include "utilbase.h"
+#include "RawFrameDump.h"
+
+#define	LOCAL_DEBUG 0
+
+RawFrameDump::RawFrameDump()
+:	mDataWriter(NULL),
+	mIndexWriter(NULL),
+	mIsDumping(false),
+	mStarted(false),
+	mMaxFrames(0),
+	mMaxBytes(0),
+	mFrames(0),
+	mDropped(0),
+	mBytes(0) {
+
+	pthread_mutex_init(&dump_mutex, NULL);
+}
+
+RawFrameDump::~RawFrameDump() {
+	stop();
+	SAFE_DELETE(mDataWriter);
+	SAFE_DELETE(mIndexWriter);
+	pthread_mutex_destroy(&dump_mutex);
+}
+
+/**
+ * @param max_frames 最多写入的帧数, 0: 不限
+ * @param max_bytes 最多写入的字节数, 0: 不限
+ * @return 0: 成功, UVC_ERROR_BUSY: 正在转储或上一次的写入还没有结束
+ */
+int RawFrameDump::start(const char *path, uint32_t max_frames, uint64_t max_bytes) {
+	ENTER();
+
+	if (UNLIKELY(!path)) {
+		RETURN(UVC_ERROR_INVALID_PARAM, int);
+	}
+	const size_t len = strlen(path);
+	char *idx_path = (char *)malloc(len + 5);
+	if (UNLIKELY(!idx_path)) {
+		RETURN(UVC_ERROR_NO_MEM, int);
+	}
+	memcpy(idx_path, path, len);
+	memcpy(idx_path + len, ".idx", 5);
+
+	int result;
+	pthread_mutex_lock(&dump_mutex);
+	{
+		if (UNLIKELY(mIsDumping
+			|| (mDataWriter && mDataWriter->isBusy())
+			|| (mIndexWriter && mIndexWriter->isBusy()))) {
+
+			result = UVC_ERROR_BUSY;
+		} else {
+			if (!mDataWriter) {
+				mDataWriter = new AsyncFileWriter();
+			}
+			if (!mIndexWriter) {
+				mIndexWriter = new AsyncFileWriter();
+			}
+			// release the threads of previous dump, already finished
+			mDataWriter->close();
+			mIndexWriter->close();
+			result = mDataWriter->open(path, RAW_DUMP_QUEUE_BYTES, ASYNC_WRITER_DIRECT);
+			if (LIKELY(!result)) {
+				result = mIndexWriter->open(idx_path, RAW_DUMP_INDEX_QUEUE_BYTES);
+				if (UNLIKELY(result)) {
+					mDataWriter->close();
+				}
+			}
+			if (LIKELY(!result)) {
+				static const char header[]
+					= "sequence,capture_time_us,pts,scr,width,height,frame_format,step,offset,bytes,actual_bytes,bfh_err\n";
+				mIndexWriter->write(header, sizeof(header) - 1, false);
+				mMaxFrames = max_frames;
+				mMaxBytes = max_bytes;
+				mFrames = mDropped = 0;
+				mBytes = 0;
+				mIsDumping = mStarted = true;
+			}
+		}
+	}
+	pthread_mutex_unlock(&dump_mutex);
+	free(idx_path);
+
+	RETURN(result, int);
+}
+
+/**
+ * 结束转储, 写完队列中的数据之后返回
+ * @return 写入的帧数, <0: 错误
+ */
+int RawFrameDump::stop() {
+	ENTER();
+
+	int result = UVC_ERROR_INVALID_PARAM;
+	pthread_mutex_lock(&dump_mutex);
+	const bool started = mStarted;
+	{
+		finish_locked();
+		mStarted = false;
+	}
+	pthread_mutex_unlock(&dump_mutex);
+	if (started) {
+		// offer never touches the writers after finish_locked
+		result = mDataWriter->close();
+		const int r = mIndexWriter->close();
+		if (!result) {
+			result = r;
+		}
+		if (!result) {
+			result = (int)mFrames;
+		}
+	}
+
+	RETURN(result, int);
+}
+
+// must be called with dump_mutex held
+void RawFrameDump::finish_locked() {
+	if (mIsDumping) {
+		mIsDumping = false;
+		mDataWriter->closeAsync();
+		mIndexWriter->closeAsync();
+		LOGI("raw dump frames=%u,bytes=%llu,dropped=%u",
+			mFrames, (unsigned long long)mBytes, mDropped);
+	}
+}
+
+/**
+ * 从uvc的回调线程调用, 包括不完整的帧和有错误位的帧
+ * 有错误位时actual_bytes为0, 所以按received_bytes写入实际收到的数据
+ * 帧数据和索引行要么都写入要么都丢弃
+ */
+void RawFrameDump::offer(const uvc_frame_t *frame) {
+	if (LIKELY(!mIsDumping)) return;
+
+	const size_t bytes = frame->received_bytes > frame->actual_bytes
+		? frame->received_bytes : frame->actual_bytes;
+	pthread_mutex_lock(&dump_mutex);
+	if (LIKELY(mIsDumping)) {
+		if ((mMaxFrames && (mFrames >= mMaxFrames))
+			|| (mMaxBytes && (mBytes + bytes > mMaxBytes))) {
+
+			finish_locked();	// reached the budget
+		} else {
+			const uint64_t offset = mDataWriter->position();
+			char line[192];
+			const int n = snprintf(line, sizeof(line), "%u,%lld,%u,%u,%u,%u,%d,%zu,%llu,%zu,%zu,%u\n",
+				frame->sequence,
+				(long long)frame->capture_time.tv_sec * 1000000LL + frame->capture_time.tv_usec,
+				frame->pts, frame->scr, frame->width, frame->height, frame->frame_format,
+				frame->step, (unsigned long long)offset, bytes, frame->actual_bytes, frame->bfh_err);
+			// offer is the only producer of both writers (under dump_mutex),
+			// so once both have room neither non-blocking write below is rejected
+			if (LIKELY((mDataWriter->available() >= bytes)
+				&& (mIndexWriter->available() >= (size_t)n)
+				&& (!bytes || !mDataWriter->write(frame->data, bytes, false))
+				&& !mIndexWriter->write(line, n, false))) {
+
+				mFrames++;
+				mBytes += bytes;
+			} else {
+				mDropped++;
+			}
+		}
+	}
+	pthread_mutex_unlock(&dump_mutex);
+}
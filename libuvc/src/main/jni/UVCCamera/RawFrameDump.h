@@ -0,0 +1,68 @@
+/*
+ * UVCCamera
+ * library and sample to access to UVC web camera on non-rooted Android device
+ *
+ * Copyright (c) 2014-2017 saki t_saki@serenegiant.com
+ *
+ * File name: RawFrameDump.h
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * All files in the folder are under this Apache License, Version 2.0.
+ * Files in the jni/libjpeg, jni/libusb, jin/libuvc, jni/rapidjson folder may have a different license, see the respective files.
+*/
+
+
+
+#ifndef RAWFRAMEDUMP_H_
+#define RAWFRAMEDUMP_H_
+
+#include <pthread.h>
+#include "libUVCCamera.h"
+#include "AsyncFileWriter.h"
+
+#pragma interface
+
+#define RAW_DUMP_QUEUE_BYTES (64 * 1024 * 1024)
+#define RAW_DUMP_INDEX_QUEUE_BYTES (1024 * 1024)
+
+/**
+ * 原始帧转储, 用于离线分析图像质量
+ * 把_uvc_populate_frame组装的帧(YUYV/UYVY/MJPEG, 不转换)原样连续写入path,
+ * 每帧的信息(sequence, PTS/SCR, actual_bytes, bfh_err等)写入path.idx(csv)
+ * 都通过AsyncFileWriter写入, 写入跟不上时丢弃该帧, 达到帧数/字节数的上限时自动结束
+ */
+class RawFrameDump {
+private:
+	pthread_mutex_t dump_mutex;
+	AsyncFileWriter *mDataWriter;
+	AsyncFileWriter *mIndexWriter;
+	volatile bool mIsDumping;
+	bool mStarted;				// true until stop, even after reaching the budget
+	uint32_t mMaxFrames;		// 0: no limit
+	uint64_t mMaxBytes;			// 0: no limit
+	uint32_t mFrames;
+	uint32_t mDropped;
+	uint64_t mBytes;
+	void finish_locked();
+public:
+	RawFrameDump();
+	~RawFrameDump();
+
+	int start(const char *path, uint32_t max_frames, uint64_t max_bytes);
+	int stop();
+	void offer(const uvc_frame_t *frame);
+	inline bool isDumping() const { return mIsDumping; };
+};
+
+#endif /* RAWFRAMEDUMP_H_ */
@@ -0,0 +1,180 @@
+/*
+ * UVCCamera
+ * library and sample to access to UVC web camera on non-rooted Android device
+ *
+ * Copyright (c) 2014-2017 saki t_saki@serenegiant.com
+ *
+ * File name: SharedFrameRing.cpp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * All files in the folder are under this Apache License, Version 2.0.
+ * Files in the jni/libjpeg, jni/libusb, jin/libuvc, jni/rapidjson folder may have a different license, see the respective files.
+*/
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#if defined(__ANDROID__)
+#include <linux/ashmem.h>
+#endif
+
+#if 1	// set 1 if you don't need debug log
+	#ifndef LOG_NDEBUG
+		#define	LOG_NDEBUG		// w/o LOGV/LOGD/MARK
+	#endif
+	#undef USE_LOGALL
+#else
+	#define USE_LOGALL
+	#undef LOG_NDEBUG
+//	#undef NDEBUG
+#endif
+
+#include "utilbase.h"
+#include "SharedFrameRing.h"
+
+#define	LOCAL_DEBUG 0
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+
+SharedFrameRing::SharedFrameRing()
+:	mFd(-1),
+	mHeader(NULL),
+	mTotalBytes(0),
+	mSkipped(0) {
+}
+
+SharedFrameRing::~SharedFrameRing() {
+	release();
+}
+
+/**
+ * 生成共享内存, 优先使用memfd_create, 不支持时(Linux<3.17)使用ashmem
+ * @return fd, -1: 失败
+ */
+/*static*/
+int SharedFrameRing::create_shm(const char *name, size_t bytes) {
+	int fd = -1;
+#if defined(__NR_memfd_create)
+	// android-14 headers have no wrapper function
+	fd = syscall(__NR_memfd_create, name, MFD_CLOEXEC);
+	if (fd >= 0) {
+		if (UNLIKELY(ftruncate(fd, bytes))) {
+			LOGE("ftruncate failed:errno=%d", errno);
+			close(fd);
+			fd = -1;
+		}
+		return fd;
+	}
+#endif
+#if defined(__ANDROID__)
+	fd = open("/dev/ashmem", O_RDWR | O_CLOEXEC);
+	if (fd >= 0) {
+		ioctl(fd, ASHMEM_SET_NAME, name);
+		if (UNLIKELY(ioctl(fd, ASHMEM_SET_SIZE, bytes) < 0)) {
+			LOGE("ASHMEM_SET_SIZE failed:errno=%d", errno);
+			close(fd);
+			fd = -1;
+		}
+	}
+#endif
+	return fd;
+}
+
+/**
+ * @param num_slots 帧数
+ * @param slot_bytes 每帧的最大字节数, 超过的帧不写入
+ * @return 0: 成功
+ */
+int SharedFrameRing::create(int num_slots, size_t slot_bytes) {
+	ENTER();
+
+	release();
+	if (UNLIKELY((num_slots < MIN_SHM_SLOTS) || (num_slots > MAX_SHM_SLOTS) || !slot_bytes)) {
+		RETURN(UVC_ERROR_INVALID_PARAM, int);
+	}
+	slot_bytes = (slot_bytes + 63) & ~((size_t)63);
+	mTotalBytes = uvc_shm_ring_bytes(num_slots, slot_bytes, NULL);
+	mFd = create_shm("uvc_frame_ring", mTotalBytes);
+	if (UNLIKELY(mFd < 0)) {
+		LOGE("failed to create shared memory:errno=%d", errno);
+		RETURN(UVC_ERROR_NO_MEM, int);
+	}
+	void *addr = mmap(NULL, mTotalBytes, PROT_READ | PROT_WRITE, MAP_SHARED, mFd, 0);
+	if (UNLIKELY(addr == MAP_FAILED)) {
+		LOGE("mmap failed:errno=%d", errno);
+		close(mFd);
+		mFd = -1;
+		RETURN(UVC_ERROR_NO_MEM, int);
+	}
+	mHeader = (uvc_shm_header_t *)addr;
+	uvc_shm_ring_init(mHeader, num_slots, slot_bytes);
+	mSkipped = 0;
+	LOGI("shared frame ring:fd=%d,slots=%d,slot_bytes=%u", mFd, num_slots, (unsigned)slot_bytes);
+
+	RETURN(0, int);
+}
+
+/**
+ * 通知读取侧写入结束并释放映射
+ * 读取侧的映射在uvc_shm_reader_close之前有效
+ */
+void SharedFrameRing::release() {
+	ENTER();
+
+	if (mHeader) {
+		uvc_shm_ring_close(mHeader);
+		munmap(mHeader, mTotalBytes);
+		mHeader = NULL;
+		if (mSkipped) {
+			LOGW("shared frame ring:skipped %u frames larger than slot", mSkipped);
+		}
+	}
+	if (mFd >= 0) {
+		close(mFd);
+		mFd = -1;
+	}
+
+	EXIT();
+}
+
+/**
+ * 写入帧, 不会等待读取侧
+ * @return 0: 成功
+ */
+int SharedFrameRing::publish(const uvc_frame_t *frame) {
+	if (UNLIKELY(!mHeader)) return UVC_ERROR_INVALID_PARAM;
+	const size_t bytes = frame->frame_format == UVC_FRAME_FORMAT_MJPEG
+		? frame->actual_bytes : frame->data_bytes;
+	uvc_shm_slot_t meta;
+	meta.capture_time_us = (int64_t)frame->capture_time.tv_sec * 1000000LL + frame->capture_time.tv_usec;
+	meta.width = frame->width;
+	meta.height = frame->height;
+	meta.frame_format = frame->frame_format;
+	meta.pts = frame->pts;
+	if (UNLIKELY(uvc_shm_ring_publish(mHeader, frame->data, (uint32_t)bytes, &meta))) {
+		mSkipped++;
+		return UVC_ERROR_NO_MEM;
+	}
+	return 0;
+}
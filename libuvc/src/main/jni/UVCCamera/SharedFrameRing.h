@@ -0,0 +1,59 @@
+/*
+ * UVCCamera
+ * library and sample to access to UVC web camera on non-rooted Android device
+ *
+ * Copyright (c) 2014-2017 saki t_saki@serenegiant.com
+ *
+ * File name: SharedFrameRing.h
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * All files in the folder are under this Apache License, Version 2.0.
+ * Files in the jni/libjpeg, jni/libusb, jin/libuvc, jni/rapidjson folder may have a different license, see the respective files.
+*/
+
+
+#ifndef SHAREDFRAMERING_H_
+#define SHAREDFRAMERING_H_
+
+#include "libUVCCamera.h"
+#include "uvc_shm_ring.h"
+
+#pragma interface
+
+#define MIN_SHM_SLOTS 2
+#define MAX_SHM_SLOTS 64
+
+/**
+ * 跨进程共享的帧环(memfd/ashmem)的写入侧
+ * 只映射一次, 每帧只复制一次, 读取侧(libuvcshmreader)不需要复制
+ * 只从uvc的回调线程调用publish
+ */
+class SharedFrameRing {
+private:
+	int mFd;
+	uvc_shm_header_t *mHeader;
+	size_t mTotalBytes;
+	uint32_t mSkipped;			// frames larger than slot
+	static int create_shm(const char *name, size_t bytes);
+public:
+	SharedFrameRing();
+	~SharedFrameRing();
+
+	int create(int num_slots, size_t slot_bytes);
+	void release();
+	int publish(const uvc_frame_t *frame);
+	inline int fd() const { return mFd; };
+};
+
+#endif /* SHAREDFRAMERING_H_ */
@@ -0,0 +1,388 @@
+/*
+ * UVCCamera
+ * library and sample to access to UVC web camera on non-rooted Android device
+ *
+ * Copyright (c) 2014-2017 saki t_saki@serenegiant.com
+ *
+ * File name: StillCapture.cpp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * All files in the folder are under this Apache License, Version 2.0.
+ * Files in the jni/libjpeg, jni/libusb, jin/libuvc, jni/rapidjson folder may have a different license, see the respective files.
+*/
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+#if 1	// set 1 if you don't need debug log
+	#ifndef LOG_NDEBUG
+		#define	LOG_NDEBUG		// w/o LOGV/LOGD/MARK
+	#endif
+	#undef USE_LOGALL
+#else
+	#define USE_LOGALL
+	#undef LOG_NDEBUG
+//	#undef NDEBUG
+#endif
+
+#include "utilbase.h"
+#include "StillCapture.h"
+
+#define	LOCAL_DEBUG 0
+
+StillCapture::StillCapture()
+:	still_thread(0),
+	mIsRunning(false),
+	mState(STILL_IDLE),
+	mPath(NULL),
+	mResult(0),
+	mRetry(0),
+	mFrame(NULL),
+	mQuality(DEFAULT_STILL_QUALITY),
+	mSubsamp(TJSAMP_422),
+	mCompressor(NULL),
+	mPlanes(NULL),
+	mPlanesBytes(0),
+	mJpeg(NULL),
+	mJpegBytes(0) {
+
+	pthread_mutex_init(&still_mutex, NULL);
+	pthread_cond_init(&still_sync, NULL);
+}
+
+StillCapture::~StillCapture() {
+	if (mIsRunning) {
+		pthread_mutex_lock(&still_mutex);
+		{
+			mIsRunning = false;
+			pthread_cond_broadcast(&still_sync);
+		}
+		pthread_mutex_unlock(&still_mutex);
+		if (pthread_join(still_thread, NULL) != EXIT_SUCCESS) {
+			LOGW("StillCapture::terminate still thread: pthread_join failed");
+		}
+	}
+	free(mPath);
+	mPath = NULL;
+	if (mFrame) {
+		uvc_free_frame(mFrame);
+		mFrame = NULL;
+	}
+	if (mCompressor) {
+		tjDestroy(mCompressor);
+		mCompressor = NULL;
+	}
+	free(mPlanes);
+	mPlanes = NULL;
+	if (mJpeg) {
+		tjFree(mJpeg);
+		mJpeg = NULL;
+	}
+	pthread_mutex_destroy(&still_mutex);
+	pthread_cond_destroy(&still_sync);
+}
+
+/**
+ * 请求捕获下一帧
+ * @param timeout_ms 等待写入结束的时间, 0: 不等待
+ * @return 0: 成功(不等待时为请求成功), UVC_ERROR_BUSY: 上一次的请求还没有结束,
+ *         UVC_ERROR_TIMEOUT: 超时(请求继续有效, 预览结束时取消)
+ */
+int StillCapture::request(const char *path, int timeout_ms) {
+	ENTER();
+
+	if (UNLIKELY(!path)) {
+		RETURN(UVC_ERROR_INVALID_PARAM, int);
+	}
+	int result = 0;
+	pthread_mutex_lock(&still_mutex);
+	{
+		if (UNLIKELY(mState != STILL_IDLE)) {
+			result = UVC_ERROR_BUSY;
+			goto END;
+		}
+		if (!mIsRunning) {
+			mIsRunning = true;
+			if (UNLIKELY(pthread_create(&still_thread, NULL, still_thread_func, (void *)this))) {
+				mIsRunning = false;
+				result = UVC_ERROR_OTHER;
+				goto END;
+			}
+		}
+		free(mPath);
+		mPath = strdup(path);
+		mRetry = 0;
+		mResult = 0;
+		__atomic_store_n(&mState, STILL_REQUESTED, __ATOMIC_RELEASE);
+		if (timeout_ms > 0) {
+			struct timespec ts;
+			clock_gettime(CLOCK_REALTIME, &ts);
+			ts.tv_sec += timeout_ms / 1000;
+			ts.tv_nsec += (timeout_ms % 1000) * 1000000L;
+			if (ts.tv_nsec >= 1000000000L) {
+				ts.tv_sec++;
+				ts.tv_nsec -= 1000000000L;
+			}
+			for ( ; mState != STILL_IDLE ; ) {
+				if (pthread_cond_timedwait(&still_sync, &still_mutex, &ts) == ETIMEDOUT) {
+					break;
+				}
+			}
+			result = mState == STILL_IDLE ? mResult : UVC_ERROR_TIMEOUT;
+		}
+	}
+END:
+	pthread_mutex_unlock(&still_mutex);
+
+	RETURN(result, int);
+}
+
+/**
+ * YUYV/UYVY的jpeg压缩设置, 从下一次的请求开始生效
+ * @param quality 1-100
+ * @param subsamp TJSAMP_422 or TJSAMP_420
+ */
+int StillCapture::setQuality(int quality, int subsamp) {
+	if (UNLIKELY((quality < 1) || (quality > 100)
+		|| ((subsamp != TJSAMP_422) && (subsamp != TJSAMP_420)))) {
+		return UVC_ERROR_INVALID_PARAM;
+	}
+	pthread_mutex_lock(&still_mutex);
+	{
+		mQuality = quality;
+		mSubsamp = subsamp;
+	}
+	pthread_mutex_unlock(&still_mutex);
+	return 0;
+}
+
+// must be called with still_mutex held
+void StillCapture::finish_locked(int result) {
+	mResult = result;
+	__atomic_store_n(&mState, STILL_IDLE, __ATOMIC_RELEASE);
+	pthread_cond_broadcast(&still_sync);
+}
+
+/**
+ * 取消还在等待帧的请求(超时后仍然有效的请求), 预览结束时调用
+ * 已经开始写入的不取消
+ */
+void StillCapture::cancel() {
+	pthread_mutex_lock(&still_mutex);
+	{
+		if (mState == STILL_REQUESTED) {
+			finish_locked(UVC_ERROR_INTERRUPTED);
+		}
+	}
+	pthread_mutex_unlock(&still_mutex);
+}
+
+/**
+ * 从uvc的回调线程对每一帧调用, 没有请求时什么也不做
+ */
+void StillCapture::offer(const uvc_frame_t *frame) {
+	if (LIKELY(__atomic_load_n(&mState, __ATOMIC_ACQUIRE) != STILL_REQUESTED)) return;
+
+	pthread_mutex_lock(&still_mutex);
+	if (mState == STILL_REQUESTED) {
+		if (frame->frame_format == UVC_FRAME_FORMAT_MJPEG) {
+			if (UNLIKELY(!mFrame)) {
+				mFrame = uvc_allocate_frame(frame->data_bytes);
+			}
+			// copy as it is, only inserts DHT when the camera omits it
+			const int r = mFrame ? uvc_mjpeg2jpeg(const_cast<uvc_frame_t *>(frame), mFrame) : UVC_ERROR_NO_MEM;
+			if (LIKELY(!r)) {
+				mState = STILL_WRITING;
+				pthread_cond_broadcast(&still_sync);
+			} else if ((r != UVC_ERROR_INVALID_PARAM) || (++mRetry >= MAX_STILL_RETRY)) {
+				finish_locked(r);
+			}
+			// otherwise broken frame, wait for next one
+		} else if ((frame->frame_format == UVC_FRAME_FORMAT_YUYV)
+			|| (frame->frame_format == UVC_FRAME_FORMAT_UYVY)) {
+			if (UNLIKELY(!mFrame)) {
+				mFrame = uvc_allocate_frame(frame->data_bytes);
+			}
+			// only copy here, encode on the worker thread
+			const int r = mFrame ? uvc_duplicate_frame(const_cast<uvc_frame_t *>(frame), mFrame) : UVC_ERROR_NO_MEM;
+			if (LIKELY(!r)) {
+				mState = STILL_WRITING;
+				pthread_cond_broadcast(&still_sync);
+			} else {
+				finish_locked(r);
+			}
+		} else {
+			finish_locked(UVC_ERROR_NOT_SUPPORTED);
+		}
+	}
+	pthread_mutex_unlock(&still_mutex);
+}
+
+/*static*/
+void *StillCapture::still_thread_func(void *vptr_args) {
+	ENTER();
+
+	StillCapture *still = reinterpret_cast<StillCapture *>(vptr_args);
+	if (LIKELY(still)) {
+		still->do_write();
+	}
+	PRE_EXIT();
+	pthread_exit(NULL);
+}
+
+void StillCapture::do_write() {
+	ENTER();
+
+	for ( ; mIsRunning ; ) {
+		pthread_mutex_lock(&still_mutex);
+		{
+			for ( ; mIsRunning && (mState != STILL_WRITING) ; ) {
+				pthread_cond_wait(&still_sync, &still_mutex);
+			}
+		}
+		pthread_mutex_unlock(&still_mutex);
+		if (UNLIKELY(!mIsRunning)) break;
+		// mFrame and mPath are not touched by others while STILL_WRITING
+		const uint8_t *data = (const uint8_t *)mFrame->data;
+		size_t bytes = mFrame->actual_bytes;
+		int result = mFrame->frame_format != UVC_FRAME_FORMAT_MJPEG ? encode(&data, &bytes) : 0;
+		// 单次整帧写入, 不需要AsyncFileWriter的线程和额外拷贝
+		const int fd = result ? -1 : open(mPath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+		if (LIKELY(fd >= 0)) {
+			size_t written = 0;
+			for ( ; written < bytes ; ) {
+				const ssize_t n = write(fd, data + written, bytes - written);
+				if (UNLIKELY(n < 0)) {
+					if (errno == EINTR) continue;
+					result = -errno;
+					break;
+				}
+				written += n;
+			}
+			close(fd);
+		} else if (!result) {
+			result = -errno;
+		}
+		LOGI("still %s:seq=%u,bytes=%u,err=%d", mPath,
+			mFrame->sequence, (unsigned)bytes, result);
+		pthread_mutex_lock(&still_mutex);
+		{
+			finish_locked(result);
+		}
+		pthread_mutex_unlock(&still_mutex);
+	}
+
+	EXIT();
+}
+
+/**
+ * YUYV/UYVY => Y/U/V平面 => jpeg, 只从工作线程调用
+ * 4:2:2时只分离分量, 4:2:0时对两行的色度取平均
+ * @param data 压缩结果(mJpeg), 下一次调用之前有效
+ */
+int StillCapture::encode(const uint8_t **data, size_t *bytes) {
+	ENTER();
+
+	const int width = mFrame->width;
+	const int height = mFrame->height;
+	pthread_mutex_lock(&still_mutex);
+	const int quality = mQuality;
+	const int subsamp = mSubsamp;
+	pthread_mutex_unlock(&still_mutex);
+
+	if (UNLIKELY((width < 2) || (height < 2) || (mFrame->actual_bytes < (size_t)width * height * 2))) {
+		RETURN(UVC_ERROR_INVALID_PARAM, int);
+	}
+	if (UNLIKELY(!mCompressor)) {
+		mCompressor = tjInitCompress();
+		if (UNLIKELY(!mCompressor)) {
+			RETURN(UVC_ERROR_NO_MEM, int);
+		}
+	}
+	const int cw = width / 2;
+	const int ch = subsamp == TJSAMP_420 ? (height + 1) / 2 : height;
+	const size_t need = (size_t)width * height + (size_t)cw * ch * 2;
+	if (UNLIKELY(mPlanesBytes < need)) {
+		free(mPlanes);
+		mPlanes = (uint8_t *)malloc(need);
+		mPlanesBytes = mPlanes ? need : 0;
+		if (UNLIKELY(!mPlanes)) {
+			RETURN(UVC_ERROR_NO_MEM, int);
+		}
+	}
+	uint8_t *y = mPlanes;
+	uint8_t *u = y + width * height;
+	uint8_t *v = u + cw * ch;
+	// offsets of y0/u/y1/v in 4 bytes
+	const bool uyvy = mFrame->frame_format == UVC_FRAME_FORMAT_UYVY;
+	const int oy = uyvy ? 1 : 0, ou = uyvy ? 0 : 1, ov = uyvy ? 2 : 3;
+	const size_t src_step = mFrame->step ? mFrame->step : width * 2;
+	const uint8_t *src = (const uint8_t *)mFrame->data;
+	for (int row = 0; row < height; row++) {
+		const uint8_t *s = src + row * src_step;
+		uint8_t *py = y + row * width;
+		for (int i = 0; i < cw; i++, s += 4) {
+			*(py++) = s[oy];
+			*(py++) = s[oy + 2];
+		}
+		if (subsamp == TJSAMP_420) {
+			if (row & 1) continue;
+			// average with the next row
+			const uint8_t *s0 = src + row * src_step;
+			const uint8_t *s1 = (row + 1 < height) ? s0 + src_step : s0;
+			uint8_t *pu = u + (row / 2) * cw;
+			uint8_t *pv = v + (row / 2) * cw;
+			for (int i = 0; i < cw; i++, s0 += 4, s1 += 4) {
+				*(pu++) = (s0[ou] + s1[ou] + 1) >> 1;
+				*(pv++) = (s0[ov] + s1[ov] + 1) >> 1;
+			}
+		} else {
+			const uint8_t *s0 = src + row * src_step;
+			uint8_t *pu = u + row * cw;
+			uint8_t *pv = v + row * cw;
+			for (int i = 0; i < cw; i++, s0 += 4) {
+				*(pu++) = s0[ou];
+				*(pv++) = s0[ov];
+			}
+		}
+	}
+	// allocate enough output buffer once so that TurboJPEG never reallocates it
+	const unsigned long max_bytes = tjBufSize(width, height, subsamp);
+	if (UNLIKELY(mJpegBytes < max_bytes)) {
+		if (mJpeg) tjFree(mJpeg);
+		mJpeg = tjAlloc(max_bytes);
+		mJpegBytes = mJpeg ? max_bytes : 0;
+		if (UNLIKELY(!mJpeg)) {
+			RETURN(UVC_ERROR_NO_MEM, int);
+		}
+	}
+	const unsigned char *planes[3] = { y, u, v };
+	const int strides[3] = { width, cw, cw };
+	unsigned long jpeg_bytes = mJpegBytes;
+	if (UNLIKELY(tjCompressFromYUVPlanes(mCompressor, planes, width, strides, height,
+		subsamp, &mJpeg, &jpeg_bytes, quality, TJFLAG_NOREALLOC | TJFLAG_FASTDCT))) {
+
+		LOGE("tjCompressFromYUVPlanes:%s", tjGetErrorStr());
+		RETURN(UVC_ERROR_OTHER, int);
+	}
+	*data = mJpeg;
+	*bytes = jpeg_bytes;
+
+	RETURN(0, int);
+}
@@ -0,0 +1,84 @@
+/*
+ * UVCCamera
+ * library and sample to access to UVC web camera on non-rooted Android device
+ *
+ * Copyright (c) 2014-2017 saki t_saki@serenegiant.com
+ *
+ * File name: StillCapture.h
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * All files in the folder are under this Apache License, Version 2.0.
+ * Files in the jni/libjpeg, jni/libusb, jin/libuvc, jni/rapidjson folder may have a different license, see the respective files.
+*/
+
+
+#ifndef STILLCAPTURE_H_
+#define STILLCAPTURE_H_
+
+#include <pthread.h>
+#include "libUVCCamera.h"
+#include "turbojpeg.h"
+
+#pragma interface
+
+// give up when this number of broken frames arrive in a row
+#define MAX_STILL_RETRY 30
+#define DEFAULT_STILL_QUALITY 90
+
+typedef enum still_state {
+	STILL_IDLE = 0,
+	STILL_REQUESTED,	// waiting for next valid frame
+	STILL_WRITING,		// worker thread is writing mFrame
+} still_state_t;
+
+/**
+ * 静止图像捕获
+ * MJPEG: 不解码, 把下一个完整的帧(补上DHT)直接写入文件
+ * YUYV/UYVY: 用TurboJPEG从YUV平面直接压缩(不经过RGB)
+ * 编码和写入在工作线程上进行, 不阻塞uvc的回调线程
+ */
+class StillCapture {
+private:
+	pthread_mutex_t still_mutex;
+	pthread_cond_t still_sync;
+	pthread_t still_thread;
+	volatile bool mIsRunning;
+	volatile int mState;
+	char *mPath;
+	int mResult;
+	int mRetry;
+	uvc_frame_t *mFrame;		// jpeg to write or yuyv/uyvy to encode
+	// for encoding YUYV/UYVY, only accessed from worker thread except settings
+	int mQuality;
+	int mSubsamp;				// TJSAMP_422 or TJSAMP_420
+	tjhandle mCompressor;		// reused
+	uint8_t *mPlanes;			// Y, U, V planes
+	size_t mPlanesBytes;
+	unsigned char *mJpeg;		// allocated by tjAlloc, reused
+	unsigned long mJpegBytes;
+	int encode(const uint8_t **data, size_t *bytes);
+	static void *still_thread_func(void *vptr_args);
+	void do_write();
+	void finish_locked(int result);
+public:
+	StillCapture();
+	~StillCapture();
+
+	int request(const char *path, int timeout_ms);
+	void cancel();
+	int setQuality(int quality, int subsamp);
+	void offer(const uvc_frame_t *frame);
+};
+
+#endif /* STILLCAPTURE_H_ */
@@ -44,6 +44,7 @@
 #include <string.h>
 #include "UVCCamera.h"
 #include "Parameters.h"
+#include "ControlProfile.h"
 #include "libuvc_internal.h"
 
 #define	LOCAL_DEBUG 0
@@ -63,10 +64,21 @@ UVCCamera::UVCCamera()
 	mStatusCallback(NULL),
 	mButtonCallback(NULL),
 	mPreview(NULL),
+	mControlQueue(NULL),
+	mExtensionUnits(NULL),
+	mProfile(NULL),
+	mPtz(NULL),
+	mAeAwb(NULL),
 	mCtrlSupports(0),
-	mPUSupports(0) {
+	mPUSupports(0),
+	mCapsProbed(false) {
 
 	ENTER();
+	pthread_mutexattr_t attr;
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&control_mutex, &attr);
+	pthread_mutexattr_destroy(&attr);
 	clearCameraParams();
 	EXIT();
 }
@@ -77,6 +89,7 @@ UVCCamera::UVCCamera()
 UVCCamera::~UVCCamera() {
 	ENTER();
 	release();
+	SAFE_DELETE(mProfile);
 	if (mContext) {
 		uvc_exit(mContext);
 		mContext = NULL;
@@ -85,6 +98,7 @@ UVCCamera::~UVCCamera() {
 		free(mUsbFs);
 		mUsbFs = NULL;
 	}
+	pthread_mutex_destroy(&control_mutex);
 	EXIT();
 }
 
@@ -92,11 +106,13 @@ UVCCamera::~UVCCamera() {
  * 清除相机参数
  */
 void UVCCamera::clearCameraParams() {
+	pthread_mutex_lock(&control_mutex);
 	mCtrlSupports = mPUSupports = 0;
 	mScanningMode.min = mScanningMode.max = mScanningMode.def = 0;
 	mExposureMode.min = mExposureMode.max = mExposureMode.def = 0;
 	mExposurePriority.min = mExposurePriority.max = mExposurePriority.def = 0;
 	mExposureAbs.min = mExposureAbs.max = mExposureAbs.def = 0;
+	mExposureRel.min = mExposureRel.max = mExposureRel.def = 0;
 	mAutoFocus.min = mAutoFocus.max = mAutoFocus.def = 0;
 	mAutoWhiteBlance.min = mAutoWhiteBlance.max = mAutoWhiteBlance.def = 0;
 	mWhiteBlance.min = mWhiteBlance.max = mWhiteBlance.def = 0;
@@ -131,6 +147,9 @@ void UVCCamera::clearCameraParams() {
 	mMultiplierLimit.min = mMultiplierLimit.max = mMultiplierLimit.def = 0;
 	mAnalogVideoStandard.min = mAnalogVideoStandard.max = mAnalogVideoStandard.def = 0;
 	mAnalogVideoLockState.min = mAnalogVideoLockState.max = mAnalogVideoLockState.def = 0;
+	memset(mCaps, 0, sizeof(mCaps));
+	mCapsProbed = false;
+	pthread_mutex_unlock(&control_mutex);
 }
 
 //======================================================================
@@ -181,6 +200,18 @@ int UVCCamera::connect(int vid, int pid, int fd, int busnum, int devaddr, const
 				mButtonCallback = new UVCButtonCallback(mDeviceHandle);
 				// 初始化预览对象
 				mPreview = new UVCPreview(mDeviceHandle);
+				mControlQueue = new ControlQueue(this);
+				mExtensionUnits = new ExtensionUnits(mDeviceHandle);
+				mPtz = new PtzController(this);
+				mAeAwb = new AeAwbLoop(this, mControlQueue);
+				mPreview->setAeAwbLoop(mAeAwb);
+				// 开始预览之前恢复配置
+				if (mProfile) {
+					const int r = applyControlProfile();
+					if (UNLIKELY(r)) {
+						LOGW("failed to restore control profile:err=%d", r);
+					}
+				}
 			} else {
 				// 如果打开设备失败，记录错误信息并释放设备资源
 				LOGE("could not open camera:err=%d", result);
@@ -212,6 +243,12 @@ int UVCCamera::release() {
 		// ステータスコールバックオブジェクトを破棄
 		SAFE_DELETE(mStatusCallback);
 		SAFE_DELETE(mButtonCallback);
+		// 先に工作线程结束, 之后不再访问设备
+		SAFE_DELETE(mPtz);
+		mPreview->setAeAwbLoop(NULL);
+		SAFE_DELETE(mAeAwb);
+		SAFE_DELETE(mControlQueue);
+		SAFE_DELETE(mExtensionUnits);
 		// プレビューオブジェクトを破棄
 		SAFE_DELETE(mPreview);
 		// カメラをclose
@@ -284,6 +321,18 @@ int UVCCamera::setPreviewSize(int width, int height, int min_fps, int max_fps, i
 	RETURN(result, int);
 }
 
+/**
+ * 预览中切换分辨率/格式(不重启预览)
+ */
+int UVCCamera::reconfigurePreview(int width, int height, int min_fps, int max_fps, int mode, float bandwidth) {
+	ENTER();
+	int result = EXIT_FAILURE;
+	if (mPreview) {
+		result = mPreview->reconfigure(width, height, min_fps, max_fps, mode, bandwidth);
+	}
+	RETURN(result, int);
+}
+
 int UVCCamera::setPreviewDisplay(ANativeWindow *preview_window) {
 	ENTER();
 	int result = EXIT_FAILURE;
@@ -299,15 +348,224 @@ int UVCCamera::setPreviewDisplay(ANativeWindow *preview_window) {
  * @param pixel_format
  * @return
  */
-int UVCCamera::setFrameCallback(JNIEnv *env, jobject frame_callback_obj, int pixel_format) {
+int UVCCamera::setFrameCallback(JNIEnv *env, jobject frame_callback_obj, int pixel_format, int num_buffers) {
+	ENTER();
+	int result = EXIT_FAILURE;
+	if (mPreview) {
+		result = mPreview->setFrameCallback(env, frame_callback_obj, pixel_format, num_buffers);
+	}
+	RETURN(result, int);
+}
+
+jobject UVCCamera::getFrameMetadataBuffer(JNIEnv *env) {
+	ENTER();
+	jobject result = NULL;
+	if (mPreview) {
+		result = mPreview->getFrameMetadataBuffer(env);
+	}
+	RETURN(result, jobject);
+}
+
+int UVCCamera::setFrameStats(int flags, int roi_x, int roi_y, int roi_width, int roi_height, int row_step) {
+	ENTER();
+	int result = EXIT_FAILURE;
+	if (mPreview) {
+		result = mPreview->setFrameStats(flags, roi_x, roi_y, roi_width, roi_height, row_step);
+	}
+	RETURN(result, int);
+}
+
+int UVCCamera::addFrameProcessor(const char *path, const char *args) {
+	ENTER();
+	int result = EXIT_FAILURE;
+	if (mPreview) {
+		result = mPreview->addFrameProcessor(path, args);
+	}
+	RETURN(result, int);
+}
+
+int UVCCamera::removeFrameProcessor(int id) {
+	ENTER();
+	int result = EXIT_FAILURE;
+	if (mPreview) {
+		result = mPreview->removeFrameProcessor(id);
+	}
+	RETURN(result, int);
+}
+
+int UVCCamera::startSharedFrameRing(int num_slots, size_t slot_bytes) {
+	ENTER();
+	int result = EXIT_FAILURE;
+	if (mPreview) {
+		result = mPreview->startSharedFrameRing(num_slots, slot_bytes);
+	}
+	RETURN(result, int);
+}
+
+int UVCCamera::stopSharedFrameRing() {
+	ENTER();
+	int result = EXIT_FAILURE;
+	if (mPreview) {
+		result = mPreview->stopSharedFrameRing();
+	}
+	RETURN(result, int);
+}
+
+int UVCCamera::setPreRoll(size_t budget_bytes, int duration_ms) {
+	ENTER();
+	int result = EXIT_FAILURE;
+	if (mPreview) {
+		result = mPreview->setPreRoll(budget_bytes, duration_ms);
+	}
+	RETURN(result, int);
+}
+
+int UVCCamera::dumpPreRoll(const char *path) {
+	ENTER();
+	int result = EXIT_FAILURE;
+	if (mPreview) {
+		result = mPreview->dumpPreRoll(path);
+	}
+	RETURN(result, int);
+}
+
+int UVCCamera::captureStill(const char *path, int timeout_ms) {
+	ENTER();
+	int result = EXIT_FAILURE;
+	if (mPreview) {
+		result = mPreview->captureStill(path, timeout_ms);
+	}
+	RETURN(result, int);
+}
+
+int UVCCamera::setStillQuality(int quality, int subsamp) {
+	ENTER();
+	int result = EXIT_FAILURE;
+	if (mPreview) {
+		result = mPreview->setStillQuality(quality, subsamp);
+	}
+	RETURN(result, int);
+}
+
+int UVCCamera::startRecording(const char *path) {
+	ENTER();
+	int result = EXIT_FAILURE;
+	if (mPreview) {
+		result = mPreview->startRecording(path);
+	}
+	RETURN(result, int);
+}
+
+int UVCCamera::stopRecording() {
+	ENTER();
+	int result = EXIT_FAILURE;
+	if (mPreview) {
+		result = mPreview->stopRecording();
+	}
+	RETURN(result, int);
+}
+
+int UVCCamera::startRawDump(const char *path, uint32_t max_frames, uint64_t max_bytes) {
+	ENTER();
+	int result = EXIT_FAILURE;
+	if (mPreview) {
+		result = mPreview->startRawDump(path, max_frames, max_bytes);
+	}
+	RETURN(result, int);
+}
+
+int UVCCamera::stopRawDump() {
+	ENTER();
+	int result = EXIT_FAILURE;
+	if (mPreview) {
+		result = mPreview->stopRawDump();
+	}
+	RETURN(result, int);
+}
+
+int UVCCamera::getRecordingStats(async_writer_stats_t *stats) {
+	ENTER();
+	int result = EXIT_FAILURE;
+	if (mPreview) {
+		result = mPreview->getRecordingStats(stats);
+	}
+	RETURN(result, int);
+}
+
+int UVCCamera::releaseFrame(JNIEnv *env, int index) {
+	int result = EXIT_FAILURE;
+	if (mPreview) {
+		result = mPreview->releaseFrame(env, index);
+	}
+	return result;
+}
+
+int UVCCamera::setLowLatency(bool low_latency) {
+	ENTER();
+	int result = EXIT_FAILURE;
+	if (mPreview) {
+		result = mPreview->setLowLatency(low_latency);
+	}
+	RETURN(result, int);
+}
+
+/**
+ * 线程调度设置(nice/SCHED_FIFO优先级, CPU亲和性), 在开始预览时生效
+ * @param type enum uvc_thread_type
+ * @param policy SCHED_OTHER/SCHED_FIFO/SCHED_RR, -1: 不变
+ * @param priority SCHED_OTHER时为nice值, 否则为实时优先级
+ * @param cpu_mask 0: 不变
+ * @return
+ */
+int UVCCamera::setThreadConfig(int type, int policy, int priority, uint32_t cpu_mask) {
+	ENTER();
+	int result = EXIT_FAILURE;
+	if (mContext) {
+		uvc_thread_config_t config;
+		config.policy = policy;
+		config.priority = priority;
+		config.cpu_mask = cpu_mask;
+		result = uvc_set_thread_config(mContext, (enum uvc_thread_type)type, &config);
+	}
+	RETURN(result, int);
+}
+
+int UVCCamera::pausePreview() {
+	ENTER();
+	int result = EXIT_FAILURE;
+	if (mPreview) {
+		result = mPreview->pausePreview();
+	}
+	RETURN(result, int);
+}
+
+int UVCCamera::resumePreview() {
 	ENTER();
 	int result = EXIT_FAILURE;
 	if (mPreview) {
-		result = mPreview->setFrameCallback(env, frame_callback_obj, pixel_format);
+		result = mPreview->resumePreview();
 	}
 	RETURN(result, int);
 }
 
+int64_t UVCCamera::getTimeToFirstFrame() {
+	ENTER();
+	int64_t result = 0;
+	if (mPreview) {
+		result = mPreview->getTimeToFirstFrame();
+	}
+	RETURN(result, int64_t);
+}
+
+int64_t UVCCamera::getPreviewLatency(bool average) {
+	ENTER();
+	int64_t result = 0;
+	if (mPreview) {
+		result = mPreview->getLatency(average);
+	}
+	RETURN(result, int64_t);
+}
+
 int UVCCamera::startPreview() {
 	ENTER();
 
@@ -387,485 +645,1048 @@ int UVCCamera::getProcSupports(uint64_t *supports) {
 	RETURN(ret, int);
 }
 
-//======================================================================
-#define CTRL_BRIGHTNESS		0
-#define CTRL_CONTRAST		1
-#define	CTRL_SHARPNESS		2
-#define CTRL_GAIN			3
-#define CTRL_WHITEBLANCE	4
-#define CTRL_FOCUS			5
-
-static uvc_error_t update_ctrl_values(uvc_device_handle_t *devh, control_value_t &values,
-	paramget_func_i16 get_func) {
+/**
+ * 控制值缓存, getXXX的GET_CUR从缓存返回, 由状态中断(status interrupt)更新
+ * @param enable false: 每次都从设备读取
+ * @param refresh_ms 没有发送过状态中断的控制的有效期[ms], 0: 不过期
+ */
+int UVCCamera::setControlCache(bool enable, int refresh_ms) {
+	ENTER();
+	int ret = UVC_ERROR_INVALID_DEVICE;
+	if (LIKELY(mDeviceHandle)) {
+		ret = uvc_set_ctrl_cache(mDeviceHandle, enable, refresh_ms);
+	}
+	RETURN(ret, int);
+}
 
+int UVCCamera::getControlCacheStats(uint32_t *hits, uint32_t *misses) {
 	ENTER();
+	int ret = UVC_ERROR_INVALID_DEVICE;
+	if (LIKELY(mDeviceHandle)) {
+		ret = uvc_get_ctrl_cache_stats(mDeviceHandle, hits, misses);
+	}
+	RETURN(ret, int);
+}
 
-	uvc_error_t ret = UVC_SUCCESS;
-	if (!values.min && !values.max) {
-		int16_t value;
-		ret = get_func(devh, &value, UVC_GET_MIN);
-		if (LIKELY(!ret)) {
-			values.min = value;
-			LOGV("update_params:min value=%d,min=%d", value, values.min);
-			ret = get_func(devh, &value, UVC_GET_MAX);
-			if (LIKELY(!ret)) {
-				values.max = value;
-				LOGV("update_params:max value=%d,max=%d", value, values.max);
-				ret = get_func(devh, &value, UVC_GET_DEF);
-				if (LIKELY(!ret)) {
-					values.def = value;
-					LOGV("update_params:def value=%d,def=%d", value, values.def);
-				}
-			}
-		}
+/**
+ * 按控制id同步写入
+ * @param id CONTROL_XXX
+ * @param value 设备的值(不是%)
+ */
+int UVCCamera::setControl(int id, int value) {
+	ENTER();
+	int ret;
+	if (id == CONTROL_POWERLINE_FREQUENCY) {
+		ret = setPowerlineFrequency(value);	// <0: default
+	} else {
+		ret = setCtrlValue(id, value);
 	}
-	if (UNLIKELY(ret)) {
-		LOGD("update_params failed:err=%d", ret);
+	RETURN(ret, int);
+}
+
+/**
+ * 异步写入, 对同一个控制的连续写入会被合并
+ * @return ticket(>0), <0: 错误
+ */
+int32_t UVCCamera::setControlAsync(int id, int value) {
+	ENTER();
+	int32_t ret = UVC_ERROR_INVALID_DEVICE;
+	if (UNLIKELY((id < 0) || (id >= CONTROL_NUM))) {
+		ret = UVC_ERROR_INVALID_PARAM;
+	} else if (LIKELY(mControlQueue)) {
+		ret = mControlQueue->enqueue(id, value);
 	}
-	RETURN(ret, uvc_error_t);
+	RETURN(ret, int32_t);
 }
 
-static uvc_error_t update_ctrl_values(uvc_device_handle_t *devh, control_value_t &values,
-	paramget_func_u16 get_func) {
+/**
+ * 等待到ticket为止的异步写入完成
+ * @param timeout_ms <=0: 不超时
+ */
+int UVCCamera::waitControl(int32_t ticket, int timeout_ms) {
+	ENTER();
+	int ret = UVC_ERROR_INVALID_DEVICE;
+	if (LIKELY(mControlQueue)) {
+		ret = mControlQueue->wait(ticket, timeout_ms);
+	}
+	RETURN(ret, int);
+}
 
+int UVCCamera::setControlCallback(JNIEnv *env, jobject control_callback_obj) {
 	ENTER();
+	int ret = EXIT_FAILURE;
+	if (LIKELY(mControlQueue)) {
+		ret = mControlQueue->setCallback(env, control_callback_obj);
+	} else if (control_callback_obj) {
+		env->DeleteGlobalRef(control_callback_obj);
+	}
+	RETURN(ret, int);
+}
 
-	uvc_error_t ret = UVC_SUCCESS;
-	if (!values.min && !values.max) {
-		uint16_t value;
-		ret = get_func(devh, &value, UVC_GET_MIN);
-		if (LIKELY(!ret)) {
-			values.min = value;
-			LOGV("update_params:min value=%d,min=%d", value, values.min);
-			ret = get_func(devh, &value, UVC_GET_MAX);
-			if (LIKELY(!ret)) {
-				values.max = value;
-				LOGV("update_params:max value=%d,max=%d", value, values.max);
-				ret = get_func(devh, &value, UVC_GET_DEF);
-				if (LIKELY(!ret)) {
-					values.def = value;
-					LOGV("update_params:def value=%d,def=%d", value, values.def);
-				}
-			}
+//======================================================================
+// wire size/signedness from the C type of the field
+template <typename T>
+struct control_wire {
+	static const uint8_t size = sizeof(T);
+	static const uint8_t type = (T)-1 < (T)0 ? CONTROL_TYPE_SIGNED : CONTROL_TYPE_UNSIGNED;
+};
+
+#define CONTROL_DESC(UNIT, SELECTOR, T, SUPPORT, VALUE) \
+	{ CONTROL_UNIT_##UNIT, SELECTOR, sizeof(T), 0, control_wire<T>::size, control_wire<T>::type, SUPPORT, &UVCCamera::VALUE }
+#define CONTROL_DESC_ENUM(UNIT, SELECTOR, SUPPORT, VALUE) \
+	{ CONTROL_UNIT_##UNIT, SELECTOR, 1, 0, 1, CONTROL_TYPE_ENUM, SUPPORT, &UVCCamera::VALUE }
+// a part of multi-field control
+#define CONTROL_DESC_PART(UNIT, SELECTOR, LEN, OFFSET, SIZE, TYPE, SUPPORT, VALUE) \
+	{ CONTROL_UNIT_##UNIT, SELECTOR, LEN, OFFSET, SIZE, CONTROL_TYPE_##TYPE, SUPPORT, &UVCCamera::VALUE }
+
+// 各控制的传输格式, 按CONTROL_XXX的顺序, 所有的控制访问都通过这个表
+const control_desc_t UVCCamera::sControlDescs[CONTROL_NUM] = {
+	CONTROL_DESC_ENUM(CT, UVC_CT_SCANNING_MODE_CONTROL, CTRL_SCANNING, mScanningMode),	// CONTROL_SCANNING_MODE
+	CONTROL_DESC_ENUM(CT, UVC_CT_AE_MODE_CONTROL, CTRL_AE, mExposureMode),	// CONTROL_EXPOSURE_MODE
+	CONTROL_DESC_ENUM(CT, UVC_CT_AE_PRIORITY_CONTROL, CTRL_AE_PRIORITY, mExposurePriority),	// CONTROL_EXPOSURE_PRIORITY
+	CONTROL_DESC(CT, UVC_CT_EXPOSURE_TIME_ABSOLUTE_CONTROL, int32_t, CTRL_AE_ABS, mExposureAbs),	// CONTROL_EXPOSURE
+	CONTROL_DESC(CT, UVC_CT_EXPOSURE_TIME_RELATIVE_CONTROL, uint8_t, CTRL_AE_REL, mExposureRel),	// CONTROL_EXPOSURE_REL
+	CONTROL_DESC_ENUM(CT, UVC_CT_FOCUS_AUTO_CONTROL, CTRL_FOCUS_AUTO, mAutoFocus),	// CONTROL_AUTO_FOCUS
+	CONTROL_DESC(CT, UVC_CT_FOCUS_ABSOLUTE_CONTROL, int16_t, CTRL_FOCUS_ABS, mFocus),	// CONTROL_FOCUS
+	CONTROL_DESC_PART(CT, UVC_CT_FOCUS_RELATIVE_CONTROL, 2, 0, 2, PACKED, CTRL_FOCUS_REL, mFocusRel),	// CONTROL_FOCUS_REL
+	CONTROL_DESC(CT, UVC_CT_IRIS_ABSOLUTE_CONTROL, uint16_t, CTRL_IRIS_ABS, mIris),	// CONTROL_IRIS
+	CONTROL_DESC(CT, UVC_CT_IRIS_RELATIVE_CONTROL, uint8_t, CTRL_IRIS_REL, mIrisRel),	// CONTROL_IRIS_REL
+	CONTROL_DESC(CT, UVC_CT_ZOOM_ABSOLUTE_CONTROL, uint16_t, CTRL_ZOOM_ABS, mZoom),	// CONTROL_ZOOM
+	CONTROL_DESC_PART(CT, UVC_CT_ZOOM_RELATIVE_CONTROL, 3, 0, 3, PACKED, CTRL_ZOOM_REL, mZoomRel),	// CONTROL_ZOOM_REL
+	CONTROL_DESC_PART(CT, UVC_CT_PANTILT_ABSOLUTE_CONTROL, 8, 0, 4, SIGNED, CTRL_PANTILT_ABS, mPan),	// CONTROL_PAN
+	CONTROL_DESC_PART(CT, UVC_CT_PANTILT_ABSOLUTE_CONTROL, 8, 4, 4, SIGNED, CTRL_PANTILT_ABS, mTilt),	// CONTROL_TILT
+	CONTROL_DESC(CT, UVC_CT_ROLL_ABSOLUTE_CONTROL, int16_t, CTRL_ROLL_ABS, mRoll),	// CONTROL_ROLL
+	CONTROL_DESC_PART(CT, UVC_CT_PANTILT_RELATIVE_CONTROL, 4, 0, 2, PACKED, CTRL_PANTILT_REL, mPanRel),	// CONTROL_PAN_REL
+	CONTROL_DESC_PART(CT, UVC_CT_PANTILT_RELATIVE_CONTROL, 4, 2, 2, PACKED, CTRL_PANTILT_REL, mTiltRel),	// CONTROL_TILT_REL
+	CONTROL_DESC_PART(CT, UVC_CT_ROLL_RELATIVE_CONTROL, 2, 0, 2, PACKED, CTRL_ROLL_REL, mRollRel),	// CONTROL_ROLL_REL
+	CONTROL_DESC_ENUM(CT, UVC_CT_PRIVACY_CONTROL, CTRL_PRIVACY, mPrivacy),	// CONTROL_PRIVACY
+	CONTROL_DESC_ENUM(PU, UVC_PU_WHITE_BALANCE_TEMPERATURE_AUTO_CONTROL, PU_WB_TEMP_AUTO, mAutoWhiteBlance),	// CONTROL_AUTO_WHITE_BLANCE
+	CONTROL_DESC_ENUM(PU, UVC_PU_WHITE_BALANCE_COMPONENT_AUTO_CONTROL, PU_WB_COMPO_AUTO, mAutoWhiteBlanceCompo),	// CONTROL_AUTO_WHITE_BLANCE_COMPO
+	CONTROL_DESC(PU, UVC_PU_WHITE_BALANCE_TEMPERATURE_CONTROL, uint16_t, PU_WB_TEMP, mWhiteBlance),	// CONTROL_WHITE_BLANCE
+	CONTROL_DESC(PU, UVC_PU_WHITE_BALANCE_COMPONENT_CONTROL, uint32_t, PU_WB_COMPO, mWhiteBlanceCompo),	// CONTROL_WHITE_BLANCE_COMPO
+	CONTROL_DESC(PU, UVC_PU_BACKLIGHT_COMPENSATION_CONTROL, int16_t, PU_BACKLIGHT, mBacklightComp),	// CONTROL_BACKLIGHT_COMP
+	CONTROL_DESC(PU, UVC_PU_BRIGHTNESS_CONTROL, int16_t, PU_BRIGHTNESS, mBrightness),	// CONTROL_BRIGHTNESS
+	CONTROL_DESC(PU, UVC_PU_CONTRAST_CONTROL, uint16_t, PU_CONTRAST, mContrast),	// CONTROL_CONTRAST
+	CONTROL_DESC_ENUM(PU, UVC_PU_CONTRAST_AUTO_CONTROL, PU_CONTRAST_AUTO, mAutoContrast),	// CONTROL_AUTO_CONTRAST
+	CONTROL_DESC(PU, UVC_PU_SHARPNESS_CONTROL, uint16_t, PU_SHARPNESS, mSharpness),	// CONTROL_SHARPNESS
+	CONTROL_DESC(PU, UVC_PU_GAIN_CONTROL, uint16_t, PU_GAIN, mGain),	// CONTROL_GAIN
+	CONTROL_DESC(PU, UVC_PU_GAMMA_CONTROL, uint16_t, PU_GAMMA, mGamma),	// CONTROL_GAMMA
+	CONTROL_DESC(PU, UVC_PU_SATURATION_CONTROL, uint16_t, PU_SATURATION, mSaturation),	// CONTROL_SATURATION
+	CONTROL_DESC(PU, UVC_PU_HUE_CONTROL, int16_t, PU_HUE, mHue),	// CONTROL_HUE
+	CONTROL_DESC_ENUM(PU, UVC_PU_HUE_AUTO_CONTROL, PU_HUE_AUTO, mAutoHue),	// CONTROL_AUTO_HUE
+	CONTROL_DESC_ENUM(PU, UVC_PU_POWER_LINE_FREQUENCY_CONTROL, PU_POWER_LF, mPowerlineFrequency),	// CONTROL_POWERLINE_FREQUENCY
+	CONTROL_DESC(PU, UVC_PU_DIGITAL_MULTIPLIER_CONTROL, uint16_t, PU_DIGITAL_MULT, mMultiplier),	// CONTROL_DIGITAL_MULTIPLIER
+	CONTROL_DESC(PU, UVC_PU_DIGITAL_MULTIPLIER_LIMIT_CONTROL, uint16_t, PU_DIGITAL_LIMIT, mMultiplierLimit),	// CONTROL_DIGITAL_MULTIPLIER_LIMIT
+	CONTROL_DESC_ENUM(PU, UVC_PU_ANALOG_VIDEO_STANDARD_CONTROL, PU_AVIDEO_STD, mAnalogVideoStandard),	// CONTROL_ANALOG_VIDEO_STANDARD
+	CONTROL_DESC_ENUM(PU, UVC_PU_ANALOG_LOCK_STATUS_CONTROL, PU_AVIDEO_LOCK, mAnalogVideoLockState),	// CONTROL_ANALOG_VIDEO_LOCK_STATE
+};
+
+static int32_t decode_control_value(const control_desc_t &desc, const uint8_t *data) {
+	const uint8_t *p = data + desc.offset;
+	int32_t value = 0;
+	switch (desc.type) {
+	case CONTROL_TYPE_PACKED:
+		value = (int8_t)p[0];
+		for (int i = 1; i < desc.size; i++) {
+			value = value * 256 + p[i];
 		}
+		break;
+	case CONTROL_TYPE_SIGNED:
+		switch (desc.size) {
+		case 1: value = (int8_t)p[0]; break;
+		case 2: value = (int16_t)(p[0] | (p[1] << 8)); break;
+		default: value = (int32_t)DW_TO_INT(p); break;
+		}
+		break;
+	default:
+		switch (desc.size) {
+		case 1: value = p[0]; break;
+		case 2: value = (uint16_t)(p[0] | (p[1] << 8)); break;
+		default: value = (int32_t)DW_TO_INT(p); break;
+		}
+		break;
 	}
-	if (UNLIKELY(ret)) {
-		LOGD("update_params failed:err=%d", ret);
-	}
-	RETURN(ret, uvc_error_t);
+	return value;
 }
 
-static uvc_error_t update_ctrl_values(uvc_device_handle_t *devh, control_value_t &values,
-	paramget_func_i8 get_func) {
-
-	ENTER();
+static void encode_control_value(const control_desc_t &desc, int32_t value, uint8_t *data) {
+	uint8_t *p = data + desc.offset;
+	if (desc.type == CONTROL_TYPE_PACKED) {
+		for (int i = desc.size - 1; i >= 0; i--) {
+			p[i] = (uint8_t)(value & 0xff);
+			value >>= 8;
+		}
+	} else {
+		for (int i = 0; i < desc.size; i++) {
+			p[i] = (uint8_t)(value & 0xff);
+			value >>= 8;
+		}
+	}
+}
 
-	uvc_error_t ret = UVC_SUCCESS;
-	if (!values.min && !values.max) {
-		int8_t value;
-		ret = get_func(devh, &value, UVC_GET_MIN);
-		if (LIKELY(!ret)) {
-			values.min = value;
-			LOGV("update_params:min value=%d,min=%d", value, values.min);
-			ret = get_func(devh, &value, UVC_GET_MAX);
-			if (LIKELY(!ret)) {
-				values.max = value;
-				LOGV("update_params:max value=%d,max=%d", value, values.max);
-				ret = get_func(devh, &value, UVC_GET_DEF);
-				if (LIKELY(!ret)) {
-					values.def = value;
-					LOGV("update_params:def value=%d,def=%d", value, values.def);
-				}
+// 限制在min-max的范围内, PACKED的时候每个字段分别限制
+static int32_t clamp_control_value(const control_desc_t &desc, const control_value_t &values, int32_t value) {
+	if (desc.type == CONTROL_TYPE_PACKED) {
+		int32_t result = 0;
+		for (int i = 0; i < desc.size; i++) {
+			const int shift = (desc.size - 1 - i) * 8;
+			int32_t v = (value >> shift) & 0xff;
+			int32_t vmin = (values.min >> shift) & 0xff;
+			int32_t vmax = (values.max >> shift) & 0xff;
+			if (!i) {
+				v = (int8_t)v; vmin = (int8_t)vmin; vmax = (int8_t)vmax;
 			}
+			v = v < vmin ? vmin : (v > vmax ? vmax : v);
+			result = i ? result * 256 + v : v;
 		}
+		return result;
+	} else if (values.min || values.max) {
+		return value < values.min ? values.min : (value > values.max ? values.max : value);
 	}
-	if (UNLIKELY(ret)) {
-		LOGD("update_params failed:err=%d", ret);
-	}
-	RETURN(ret, uvc_error_t);
+	return value;
 }
 
-static uvc_error_t update_ctrl_values(uvc_device_handle_t *devh, control_value_t &values,
-	paramget_func_u8 get_func) {
+// pan/tilt共用一个控制
+static inline bool share_control(const control_desc_t &a, const control_desc_t &b) {
+	return (a.unit == b.unit) && (a.selector == b.selector);
+}
 
-	ENTER();
+#define PROBE_REQS 5	// GET_MIN/MAX/DEF/RES/INFO
 
-	uvc_error_t ret = UVC_SUCCESS;
-	if (!values.min && !values.max) {
-		uint8_t value;
-		ret = get_func(devh, &value, UVC_GET_MIN);
-		if (LIKELY(!ret)) {
-			values.min = value;
-			LOGV("update_params:min value=%d,min=%d", value, values.min);
-			ret = get_func(devh, &value, UVC_GET_MAX);
-			if (LIKELY(!ret)) {
-				values.max = value;
-				LOGV("update_params:max value=%d,max=%d", value, values.max);
-				ret = get_func(devh, &value, UVC_GET_DEF);
-				if (LIKELY(!ret)) {
-					values.def = value;
-					LOGV("update_params:def value=%d,def=%d", value, values.def);
-				}
+/**
+ * 一次性取得所有支持的控制的GET_MIN/MAX/DEF/RES/INFO, 所有请求同时发送(异步传输)
+ * 结果保存到能力表, 同时设置到各控制的control_value_t, 之后的updateXXXLimit不再访问设备
+ * @param timeout_ms 整体的超时
+ */
+int UVCCamera::probeControls(int timeout_ms) {
+	ENTER();
+	if (UNLIKELY(!mDeviceHandle)) {
+		RETURN(UVC_ERROR_INVALID_DEVICE, int);
+	}
+	pthread_mutex_lock(&control_mutex);
+	getCtrlSupports(NULL);
+	getProcSupports(NULL);
+
+	int first[CONTROL_NUM];	// index of the id that owns the requests(pan/tilt share)
+	uvc_ctrl_request_t reqs[CONTROL_NUM * PROBE_REQS];
+	uint8_t data[CONTROL_NUM][PROBE_REQS][CONTROL_MAX_LEN];
+	static const enum uvc_req_code req_codes[PROBE_REQS] = {
+		UVC_GET_MIN, UVC_GET_MAX, UVC_GET_DEF, UVC_GET_RES, UVC_GET_INFO };
+	int num_reqs = 0;
+	memset(mCaps, 0, sizeof(mCaps));
+	for (int id = 0; id < CONTROL_NUM; id++) {
+		const control_desc_t &desc = sControlDescs[id];
+		const uint8_t unit = getCtrlUnitId(id);
+		first[id] = -1;
+		if (!isCtrlSupported(id) || !unit) continue;
+		for (int j = 0; j < id; j++) {
+			if ((first[j] == j) && (sControlDescs[j].unit == desc.unit)
+				&& (sControlDescs[j].selector == desc.selector)) {
+				first[id] = j;
+				break;
 			}
 		}
+		if (first[id] >= 0) continue;
+		first[id] = id;
+		for (int k = 0; k < PROBE_REQS; k++) {
+			uvc_ctrl_request_t &req = reqs[num_reqs++];
+			req.unit = unit;
+			req.selector = desc.selector;
+			req.req_code = req_codes[k];
+			req.len = req_codes[k] == UVC_GET_INFO ? 1 : desc.len;
+			req.data = data[id][k];
+			req.result = 0;
+		}
 	}
-	if (UNLIKELY(ret)) {
-		LOGD("update_params failed:err=%d", ret);
+	int ret = UVC_SUCCESS;
+	if (num_reqs) {
+		ret = uvc_ctrl_transfer_batch(mDeviceHandle, reqs, num_reqs, timeout_ms);
+	}
+	if (LIKELY(!ret)) {
+		for (int id = 0, r = 0; id < CONTROL_NUM; id++) {
+			if (first[id] != id) continue;
+			const uvc_ctrl_request_t *res = &reqs[r];
+			r += PROBE_REQS;
+			// decode all ids that share this control
+			for (int j = id; j < CONTROL_NUM; j++) {
+				if (first[j] != id) continue;
+				const control_desc_t &desc = sControlDescs[j];
+				control_caps_t &caps = mCaps[j];
+				int32_t *fields[] = { &caps.min, &caps.max, &caps.def, &caps.res };
+				for (int k = 0; k < PROBE_REQS - 1; k++) {
+					if (res[k].result == desc.len) {
+						*fields[k] = decode_control_value(desc, data[id][k]);
+						caps.valid |= (1 << k);
+					}
+				}
+				if (res[PROBE_REQS - 1].result == 1) {
+					caps.info = data[id][PROBE_REQS - 1][0];
+					caps.valid |= CONTROL_CAPS_INFO;
+				}
+				if ((caps.valid & (CONTROL_CAPS_MIN | CONTROL_CAPS_MAX)) == (CONTROL_CAPS_MIN | CONTROL_CAPS_MAX)) {
+					control_value_t &values = this->*desc.value;
+					values.min = caps.min;
+					values.max = caps.max;
+					values.def = caps.def;
+					values.res = caps.res;
+				}
+			}
+		}
+		mCapsProbed = true;
 	}
-	RETURN(ret, uvc_error_t);
+	pthread_mutex_unlock(&control_mutex);
+	RETURN(ret, int);
 }
 
-static uvc_error_t update_ctrl_values(uvc_device_handle_t *devh, control_value_t &values,
-	paramget_func_u8u8 get_func) {
-
+/**
+ * 能力表的值, 还没有取得时先调用probeControls
+ * @return 0: 成功, UVC_ERROR_NOT_SUPPORTED: 设备不支持这个控制
+ */
+int UVCCamera::getControlCaps(int id, control_caps_t *caps) {
 	ENTER();
-
-	uvc_error_t ret = UVC_SUCCESS;
-	if (!values.min && !values.max) {
-		uint8_t value1, value2;
-		ret = get_func(devh, &value1, &value2, UVC_GET_MIN);
-		if (LIKELY(!ret)) {
-			values.min = (value1 << 8) + value2;
-			LOGV("update_params:min value1=%d,value2=%d,min=%d", value1, value2, values.min);
-			ret = get_func(devh, &value1, &value2, UVC_GET_MAX);
-			if (LIKELY(!ret)) {
-				values.max = (value1 << 8) + value2;
-				LOGV("update_params:max value1=%d,value2=%d,max=%d", value1, value2, values.max);
-				ret = get_func(devh, &value1, &value2, UVC_GET_DEF);
-				if (LIKELY(!ret)) {
-					values.def = (value1 << 8) + value2;
-					LOGV("update_params:def value1=%d,value2=%ddef=%d", value1, value2, values.def);
-				}
-			}
-		}
+	if (UNLIKELY((id < 0) || (id >= CONTROL_NUM) || !caps)) {
+		RETURN(UVC_ERROR_INVALID_PARAM, int);
 	}
-	if (UNLIKELY(ret)) {
-		LOGD("update_params failed:err=%d", ret);
+	int ret = UVC_SUCCESS;
+	pthread_mutex_lock(&control_mutex);
+	if (!mCapsProbed) {
+		ret = probeControls();
 	}
-	RETURN(ret, uvc_error_t);
+	if (LIKELY(!ret)) {
+		*caps = mCaps[id];
+		if (!caps->valid) {
+			ret = UVC_ERROR_NOT_SUPPORTED;
+		}
+	}
+	pthread_mutex_unlock(&control_mutex);
+	RETURN(ret, int);
 }
 
-static uvc_error_t update_ctrl_values(uvc_device_handle_t *devh, control_value_t &values,
-	paramget_func_i8u8 get_func) {
+//======================================================================
+// 通过sControlDescs访问所有的CT/PU控制
 
-	ENTER();
+bool UVCCamera::isCtrlSupported(int id) {
+	if (UNLIKELY(!mDeviceHandle || (id < 0) || (id >= CONTROL_NUM))) return false;
+	const control_desc_t &desc = sControlDescs[id];
+	const uint64_t supports = desc.unit == CONTROL_UNIT_CT ? mCtrlSupports : mPUSupports;
+	return (supports & desc.support) != 0;
+}
 
-	uvc_error_t ret = UVC_SUCCESS;
-	if (!values.min && !values.max) {
-		int8_t value1;
-		uint8_t value2;
-		ret = get_func(devh, &value1, &value2, UVC_GET_MIN);
-		if (LIKELY(!ret)) {
-			values.min = (value1 << 8) + value2;
-			LOGV("update_params:min value1=%d,value2=%d,min=%d", value1, value2, values.min);
-			ret = get_func(devh, &value1, &value2, UVC_GET_MAX);
-			if (LIKELY(!ret)) {
-				values.max = (value1 << 8) + value2;
-				LOGV("update_params:max value1=%d,value2=%d,max=%d", value1, value2, values.max);
-				ret = get_func(devh, &value1, &value2, UVC_GET_DEF);
-				if (LIKELY(!ret)) {
-					values.def = (value1 << 8) + value2;
-					LOGV("update_params:def value1=%d,value2=%ddef=%d", value1, value2, values.def);
-				}
-			}
+// @return terminal/unit id, 0: not found
+uint8_t UVCCamera::getCtrlUnitId(int id) {
+	if (sControlDescs[id].unit == CONTROL_UNIT_CT) {
+		const uvc_input_terminal_t *it = uvc_get_input_terminals(mDeviceHandle);
+		return it ? it->bTerminalID : 0;
+	} else {
+		const uvc_processing_unit_t *pu = uvc_get_processing_units(mDeviceHandle);
+		return pu ? pu->bUnitID : 0;
+	}
+}
+
+/**
+ * SET_CUR用的数据, 共用同一个控制的其他值(pan/tilt)用当前值填充
+ * 相对值的控制填0(停止)
+ */
+void UVCCamera::fillCtrlPayload(int id, uint8_t *data) {
+	const control_desc_t &desc = sControlDescs[id];
+	memset(data, 0, desc.len);
+	if (desc.size == desc.len) return;
+	for (int j = 0; j < CONTROL_NUM; j++) {
+		const control_desc_t &other = sControlDescs[j];
+		if ((j != id) && share_control(desc, other) && (other.type != CONTROL_TYPE_PACKED)) {
+			const control_value_t &values = this->*other.value;
+			encode_control_value(other, values.current < 0 ? values.def : values.current, data);
 		}
 	}
-	if (UNLIKELY(ret)) {
-		LOGD("update_params failed:err=%d", ret);
+}
+
+// 把取得的值保存到对应的control_value_t, 共用同一个控制的也一起更新
+void UVCCamera::storeCtrlValue(int id, enum uvc_req_code req_code, const uint8_t *data) {
+	int control_value_t::*field;
+	switch (req_code) {
+	case UVC_GET_CUR: field = &control_value_t::current; break;
+	case UVC_GET_MIN: field = &control_value_t::min; break;
+	case UVC_GET_MAX: field = &control_value_t::max; break;
+	case UVC_GET_DEF: field = &control_value_t::def; break;
+	case UVC_GET_RES: field = &control_value_t::res; break;
+	default: return;
+	}
+	const control_desc_t &desc = sControlDescs[id];
+	for (int j = 0; j < CONTROL_NUM; j++) {
+		const control_desc_t &other = sControlDescs[j];
+		if ((j == id) || share_control(desc, other)) {
+			(this->*other.value).*field = decode_control_value(other, data);
+		}
 	}
-	RETURN(ret, uvc_error_t);
 }
 
-static uvc_error_t update_ctrl_values(uvc_device_handle_t *devh, control_value_t &values,
-	paramget_func_i8u8u8 get_func) {
+int UVCCamera::queryCtrlValue(int id, enum uvc_req_code req_code, int32_t &value) {
+	const control_desc_t &desc = sControlDescs[id];
+	const uint8_t unit = getCtrlUnitId(id);
+	if (UNLIKELY(!unit)) {
+		return UVC_ERROR_NOT_SUPPORTED;
+	}
+	uint8_t data[CONTROL_MAX_LEN];
+	int ret = uvc_query_ctrl(mDeviceHandle, unit, desc.selector, req_code, data, desc.len);
+	if (LIKELY(ret == desc.len)) {
+		value = decode_control_value(desc, data);
+		storeCtrlValue(id, req_code, data);
+		ret = UVC_SUCCESS;
+	} else if (ret >= 0) {
+		ret = UVC_ERROR_IO;
+	}
+	return ret;
+}
 
+// 还没有取得最小值・最大值时从设备取得(probeControls之后不访问设备)
+int UVCCamera::updateCtrlValues(int id) {
 	ENTER();
-
-	uvc_error_t ret = UVC_SUCCESS;
+	const control_value_t &values = this->*sControlDescs[id].value;
+	int ret = UVC_SUCCESS;
 	if (!values.min && !values.max) {
-		int8_t value1;
-		uint8_t value2;
-		uint8_t value3;
-		ret = get_func(devh, &value1, &value2, &value3, UVC_GET_MIN);
+		int32_t value;
+		ret = queryCtrlValue(id, UVC_GET_MIN, value);
 		if (LIKELY(!ret)) {
-			values.min = (value1 << 16) + (value2 <<8) +value3;
-			LOGV("update_params:min value1=%d,value2=%d,value3=%d,min=%d", value1, value2, value3, values.min);
-			ret = get_func(devh, &value1, &value2, &value3, UVC_GET_MAX);
+			ret = queryCtrlValue(id, UVC_GET_MAX, value);
 			if (LIKELY(!ret)) {
-				values.max = (value1 << 16) + (value2 <<8) +value3;
-				LOGV("update_params:max value1=%d,value2=%d,value3=%d,max=%d", value1, value2, value3, values.max);
-				ret = get_func(devh, &value1, &value2, &value3, UVC_GET_DEF);
-				if (LIKELY(!ret)) {
-					values.def = (value1 << 16) + (value2 <<8) +value3;
-					LOGV("update_params:def value1=%d,value2=%d,value3=%d,def=%d", value1, value2, value3, values.def);
-				}
+				ret = queryCtrlValue(id, UVC_GET_DEF, value);
 			}
 		}
+		if (UNLIKELY(ret)) {
+			LOGD("updateCtrlValues failed:id=%d,err=%d", id, ret);
+		}
 	}
-	if (UNLIKELY(ret)) {
-		LOGD("update_params failed:err=%d", ret);
-	}
-	RETURN(ret, uvc_error_t);
+	RETURN(ret, int);
 }
 
-static uvc_error_t update_ctrl_values(uvc_device_handle_t *devh, control_value_t &values,
-	paramget_func_i32 get_func) {
+// 能力表取得之后, 不支持或者不能GET/SET的控制返回false
+bool UVCCamera::isCtrlReadWrite(int id) {
+	if (!isCtrlSupported(id)) return false;
+	if (!mCapsProbed) return true;
+	const control_caps_t &caps = mCaps[id];
+	return caps.valid && (!(caps.valid & CONTROL_CAPS_INFO) || ((caps.info & 0x03) == 0x03));
+}
 
-	ENTER();
+// SET_CUR without range check
+int UVCCamera::writeCtrlValue(int id, int32_t value) {
+	const control_desc_t &desc = sControlDescs[id];
+	const uint8_t unit = getCtrlUnitId(id);
+	if (UNLIKELY(!unit)) {
+		return UVC_ERROR_NOT_SUPPORTED;
+	}
+	uint8_t data[CONTROL_MAX_LEN];
+	fillCtrlPayload(id, data);
+	encode_control_value(desc, value, data);
+	int ret = uvc_query_ctrl(mDeviceHandle, unit, desc.selector, UVC_SET_CUR, data, desc.len);
+	if (LIKELY(ret == desc.len)) {
+		(this->*desc.value).current = value;
+		ret = UVC_SUCCESS;
+	} else if (ret >= 0) {
+		ret = UVC_ERROR_IO;
+	}
+	return ret;
+}
 
-	uvc_error_t ret = UVC_SUCCESS;
-	if (!values.min && !values.max) {
-		int32_t value;
-		ret = get_func(devh, &value, UVC_GET_MIN);
+int UVCCamera::updateCtrlLimit(int id, int &min, int &max, int &def) {
+	ENTER();
+	int ret = UVC_ERROR_ACCESS;
+	pthread_mutex_lock(&control_mutex);
+	if (isCtrlSupported(id)) {
+		ret = updateCtrlValues(id);
 		if (LIKELY(!ret)) {
-			values.min = value;
-			LOGV("update_params:min value=%d,min=%d", value, values.min);
-			ret = get_func(devh, &value, UVC_GET_MAX);
-			if (LIKELY(!ret)) {
-				values.max = value;
-				LOGV("update_params:max value=%d,max=%d", value, values.max);
-				ret = get_func(devh, &value, UVC_GET_DEF);
-				if (LIKELY(!ret)) {
-					values.def = value;
-					LOGV("update_params:def value=%d,def=%d", value, values.def);
-				}
-			}
+			const control_value_t &values = this->*sControlDescs[id].value;
+			min = values.min;
+			max = values.max;
+			def = values.def;
 		}
 	}
-	if (UNLIKELY(ret)) {
-		LOGD("update_params failed:err=%d", ret);
-	}
-	RETURN(ret, uvc_error_t);
+	pthread_mutex_unlock(&control_mutex);
+	RETURN(ret, int);
 }
 
-static uvc_error_t update_ctrl_values(uvc_device_handle_t *devh, control_value_t &values,
-	paramget_func_u32 get_func) {
-
+/**
+ * 设置控制值, 有范围的控制先限制在最小值・最大值之间
+ * @param id CONTROL_XXX
+ */
+int UVCCamera::setCtrlValue(int id, int value) {
 	ENTER();
-
-	uvc_error_t ret = UVC_SUCCESS;
-	if (!values.min && !values.max) {
-		uint32_t value;
-		ret = get_func(devh, &value, UVC_GET_MIN);
-		if (LIKELY(!ret)) {
-			values.min = value;
-			LOGV("update_params:min value=%d,min=%d", value, values.min);
-			ret = get_func(devh, &value, UVC_GET_MAX);
+	int ret = UVC_ERROR_ACCESS;
+	pthread_mutex_lock(&control_mutex);
+	if (isCtrlSupported(id)) {
+		const control_desc_t &desc = sControlDescs[id];
+		ret = UVC_SUCCESS;
+		if (desc.type != CONTROL_TYPE_ENUM) {
+			ret = updateCtrlValues(id);
 			if (LIKELY(!ret)) {
-				values.max = value;
-				LOGV("update_params:max value=%d,max=%d", value, values.max);
-				ret = get_func(devh, &value, UVC_GET_DEF);
-				if (LIKELY(!ret)) {
-					values.def = value;
-					LOGV("update_params:def value=%d,def=%d", value, values.def);
-				}
+				value = clamp_control_value(desc, this->*desc.value, value);
 			}
 		}
+		if (LIKELY(!ret)) {
+			ret = writeCtrlValue(id, value);
+		}
 	}
-	if (UNLIKELY(ret)) {
-		LOGD("update_params failed:err=%d", ret);
-	}
-	RETURN(ret, uvc_error_t);
+	pthread_mutex_unlock(&control_mutex);
+	RETURN(ret, int);
 }
 
-static uvc_error_t update_ctrl_values(uvc_device_handle_t *devh, control_value_t &values1, control_value_t &values2,
-	paramget_func_i32i32 get_func) {
-
+// GET_CUR, 经过控制缓存
+int UVCCamera::getCtrlValue(int id, int32_t &value) {
 	ENTER();
+	int ret = UVC_ERROR_ACCESS;
+	pthread_mutex_lock(&control_mutex);
+	if (isCtrlSupported(id)) {
+		ret = queryCtrlValue(id, UVC_GET_CUR, value);
+	}
+	pthread_mutex_unlock(&control_mutex);
+	RETURN(ret, int);
+}
 
-	uvc_error_t ret = UVC_SUCCESS;
-	if ((!values1.min && !values1.max) ||(!values2.min && !values2.max)) {
-		int32_t value1, value2;
-		ret = get_func(devh, &value1, &value2, UVC_GET_MIN);
-		if (LIKELY(!ret)) {
-			values1.min = value1;
-			values2.min = value2;
-			LOGV("update_params:min value1=%d,value2=%d", value1, value2);
-			ret = get_func(devh, &value1, &value2, UVC_GET_MAX);
-			if (LIKELY(!ret)) {
-				values1.max = value1;
-				values2.max = value2;
-				LOGV("update_params:max value1=%d,value2=%d", value1, value2);
-				ret = get_func(devh, &value1, &value2, UVC_GET_DEF);
-				if (LIKELY(!ret)) {
-					values1.def = value1;
-					values2.def = value2;
-					LOGV("update_params:def value1=%d,value2=%d", value1, value2);
-				}
+/**
+ * 一次性取得多个控制的当前值(请求同时发送)
+ * @param results 每个控制的结果, 0: 成功, <0: 错误
+ * @return 0: 请求都执行了(确认results), <0: 错误
+ */
+int UVCCamera::getControls(const int *ids, int32_t *values, int *results, int num, int timeout_ms) {
+	ENTER();
+	if (UNLIKELY(!mDeviceHandle)) {
+		RETURN(UVC_ERROR_INVALID_DEVICE, int);
+	}
+	if (UNLIKELY(!ids || !values || !results || (num <= 0) || (num > CONTROL_NUM))) {
+		RETURN(UVC_ERROR_INVALID_PARAM, int);
+	}
+	pthread_mutex_lock(&control_mutex);
+	uvc_ctrl_request_t reqs[CONTROL_NUM];
+	uint8_t data[CONTROL_NUM][CONTROL_MAX_LEN];
+	int req_index[CONTROL_NUM];
+	int num_reqs = 0;
+	for (int i = 0; i < num; i++) {
+		const int id = ids[i];
+		const uint8_t unit = isCtrlSupported(id) ? getCtrlUnitId(id) : 0;
+		req_index[i] = -1;
+		results[i] = UVC_ERROR_ACCESS;
+		if (UNLIKELY(!unit)) continue;
+		const control_desc_t &desc = sControlDescs[id];
+		uvc_ctrl_request_t &req = reqs[num_reqs];
+		req.unit = unit;
+		req.selector = desc.selector;
+		req.req_code = UVC_GET_CUR;
+		req.len = desc.len;
+		req.data = data[num_reqs];
+		req.result = 0;
+		req_index[i] = num_reqs++;
+	}
+	int ret = UVC_SUCCESS;
+	if (num_reqs) {
+		ret = uvc_ctrl_transfer_batch(mDeviceHandle, reqs, num_reqs, timeout_ms);
+	}
+	if (LIKELY(!ret)) {
+		for (int i = 0; i < num; i++) {
+			const int r = req_index[i];
+			if (r < 0) continue;
+			const control_desc_t &desc = sControlDescs[ids[i]];
+			if (reqs[r].result == desc.len) {
+				values[i] = decode_control_value(desc, data[r]);
+				storeCtrlValue(ids[i], UVC_GET_CUR, data[r]);
+				results[i] = UVC_SUCCESS;
+			} else {
+				results[i] = reqs[r].result < 0 ? reqs[r].result : UVC_ERROR_IO;
 			}
 		}
 	}
-	if (UNLIKELY(ret)) {
-		LOGD("update_params failed:err=%d", ret);
+	pthread_mutex_unlock(&control_mutex);
+	RETURN(ret, int);
+}
+
+/**
+ * 一次性设置多个控制(请求同时发送, 设备按顺序执行)
+ * 有范围的控制先限制在最小值・最大值之间, pan/tilt等共用一个控制的合并成一个请求
+ * @param results 每个控制的结果, 0: 成功, <0: 错误
+ * @return 0: 请求都执行了(确认results), <0: 错误
+ */
+int UVCCamera::setControls(const int *ids, const int32_t *values, int *results, int num, int timeout_ms) {
+	ENTER();
+	if (UNLIKELY(!mDeviceHandle)) {
+		RETURN(UVC_ERROR_INVALID_DEVICE, int);
+	}
+	if (UNLIKELY(!ids || !values || !results || (num <= 0) || (num > CONTROL_NUM))) {
+		RETURN(UVC_ERROR_INVALID_PARAM, int);
+	}
+	pthread_mutex_lock(&control_mutex);
+	uvc_ctrl_request_t reqs[CONTROL_NUM];
+	uint8_t data[CONTROL_NUM][CONTROL_MAX_LEN];
+	int req_index[CONTROL_NUM];
+	int32_t set_values[CONTROL_NUM];
+	int num_reqs = 0;
+	for (int i = 0; i < num; i++) {
+		const int id = ids[i];
+		const uint8_t unit = isCtrlSupported(id) ? getCtrlUnitId(id) : 0;
+		req_index[i] = -1;
+		results[i] = UVC_ERROR_ACCESS;
+		if (UNLIKELY(!unit)) continue;
+		const control_desc_t &desc = sControlDescs[id];
+		int32_t value = values[i];
+		if (desc.type != CONTROL_TYPE_ENUM) {
+			results[i] = updateCtrlValues(id);
+			if (UNLIKELY(results[i])) continue;
+			value = clamp_control_value(desc, this->*desc.value, value);
+		}
+		int r = -1;
+		for (int j = 0; j < num_reqs; j++) {
+			if ((reqs[j].unit == unit) && (reqs[j].selector == desc.selector)) {
+				r = j;
+				break;
+			}
+		}
+		if (r < 0) {
+			r = num_reqs++;
+			uvc_ctrl_request_t &req = reqs[r];
+			req.unit = unit;
+			req.selector = desc.selector;
+			req.req_code = UVC_SET_CUR;
+			req.len = desc.len;
+			req.data = data[r];
+			req.result = 0;
+			fillCtrlPayload(id, data[r]);
+		}
+		encode_control_value(desc, value, data[r]);
+		set_values[i] = value;
+		req_index[i] = r;
+	}
+	int ret = UVC_SUCCESS;
+	if (num_reqs) {
+		ret = uvc_ctrl_transfer_batch(mDeviceHandle, reqs, num_reqs, timeout_ms);
+	}
+	if (LIKELY(!ret)) {
+		for (int i = 0; i < num; i++) {
+			const int r = req_index[i];
+			if (r < 0) continue;
+			const control_desc_t &desc = sControlDescs[ids[i]];
+			if (reqs[r].result == desc.len) {
+				(this->*desc.value).current = set_values[i];
+				results[i] = UVC_SUCCESS;
+			} else {
+				results[i] = reqs[r].result < 0 ? reqs[r].result : UVC_ERROR_IO;
+			}
+		}
 	}
-	RETURN(ret, uvc_error_t);
+	pthread_mutex_unlock(&control_mutex);
+	RETURN(ret, int);
 }
 
-#define UPDATE_CTRL_VALUES(VAL,FUNC) \
-	ret = update_ctrl_values(mDeviceHandle, VAL, FUNC); \
-	if (LIKELY(!ret)) { \
-		min = VAL.min; \
-		max = VAL.max; \
-		def = VAL.def; \
-	} else { \
-		MARK("failed to UPDATE_CTRL_VALUES"); \
-	} \
+//======================================================================
+// 扩展单元(XU)
 
-/** Control UVC Camera with value check
- *
- * @param value
- * @return control result
+/**
+ * @return JSON, 调用方需要free
  */
-int UVCCamera::internalSetCtrlValue(int32_t value, paramset_func_u16 set_func) {
-	int ret = set_func(mDeviceHandle, value);
-	RETURN(ret, int);
+char *UVCCamera::getExtensionUnits() {
+	ENTER();
+	char *result = NULL;
+	if (LIKELY(mExtensionUnits)) {
+		result = mExtensionUnits->getDescriptions();
+	}
+	RETURN(result, char *);
 }
 
 /**
- * カメラコントロール設定の下請け
+ * GET_CUR, len需要和GET_LEN的值一致
+ * @return 传输的字节数, <0: 错误
  */
-int UVCCamera::internalSetCtrlValue(control_value_t &values, int8_t value,
-		paramget_func_i8 get_func, paramset_func_i8 set_func) {
-	int ret = update_ctrl_values(mDeviceHandle, values, get_func);
-	if (LIKELY(!ret)) {	// 正常に最小・最大値を取得出来た時
-		value = value < values.min
-			? values.min
-			: (value > values.max ? values.max : value);
-		set_func(mDeviceHandle, value);
+int UVCCamera::getXuControl(int unit_id, int selector, void *data, int len) {
+	ENTER();
+	int ret = UVC_ERROR_INVALID_DEVICE;
+	if (UNLIKELY((unit_id < 0) || (unit_id > 0xff) || (selector < 0) || (selector > 0xff))) {
+		ret = UVC_ERROR_INVALID_PARAM;
+	} else if (LIKELY(mExtensionUnits)) {
+		ret = mExtensionUnits->get(unit_id, selector, data, len);
 	}
 	RETURN(ret, int);
 }
 
-int UVCCamera::internalSetCtrlValue(control_value_t &values, uint8_t value,
-		paramget_func_u8 get_func, paramset_func_u8 set_func) {
-	int ret = update_ctrl_values(mDeviceHandle, values, get_func);
-	if (LIKELY(!ret)) {	// 正常に最小・最大値を取得出来た時
-		value = value < values.min
-			? values.min
-			: (value > values.max ? values.max : value);
-		set_func(mDeviceHandle, value);
+/**
+ * SET_CUR, len需要和GET_LEN的值一致
+ * @return 传输的字节数, <0: 错误
+ */
+int UVCCamera::setXuControl(int unit_id, int selector, const void *data, int len) {
+	ENTER();
+	int ret = UVC_ERROR_INVALID_DEVICE;
+	if (UNLIKELY((unit_id < 0) || (unit_id > 0xff) || (selector < 0) || (selector > 0xff))) {
+		ret = UVC_ERROR_INVALID_PARAM;
+	} else if (LIKELY(mExtensionUnits)) {
+		ret = mExtensionUnits->set(unit_id, selector, data, len);
 	}
 	RETURN(ret, int);
 }
 
-int UVCCamera::internalSetCtrlValue(control_value_t &values, uint8_t value1, uint8_t value2,
-		paramget_func_u8u8 get_func, paramset_func_u8u8 set_func) {
-	int ret = update_ctrl_values(mDeviceHandle, values, get_func);
-	if (LIKELY(!ret)) {	// 正常に最小・最大値を取得出来た時
-		uint8_t v1min = (uint8_t)((values.min >> 8) & 0xff);
-		uint8_t v2min = (uint8_t)(values.min & 0xff);
-		uint8_t v1max = (uint8_t)((values.max >> 8) & 0xff);
-		uint8_t v2max = (uint8_t)(values.max & 0xff);
-		value1 = value1 < v1min
-			? v1min
-			: (value1 > v1max ? v1max : value1); 
-		value2 = value2 < v2min
-			? v2min
-			: (value2 > v2max ? v2max : value2); 
-		set_func(mDeviceHandle, value1, value2);
+//======================================================================
+// 自动模式/模式切换, 要在对应的手动值之前设置
+static bool is_mode_control(int id) {
+	switch (id) {
+	case CONTROL_SCANNING_MODE:
+	case CONTROL_EXPOSURE_MODE:
+	case CONTROL_EXPOSURE_PRIORITY:
+	case CONTROL_AUTO_FOCUS:
+	case CONTROL_AUTO_WHITE_BLANCE:
+	case CONTROL_AUTO_WHITE_BLANCE_COMPO:
+	case CONTROL_AUTO_CONTRAST:
+	case CONTROL_AUTO_HUE:
+		return true;
+	default:
+		return false;
 	}
-	RETURN(ret, int);
 }
 
-int UVCCamera::internalSetCtrlValue(control_value_t &values, int8_t value1, uint8_t value2,
-		paramget_func_i8u8 get_func, paramset_func_i8u8 set_func) {
-	int ret = update_ctrl_values(mDeviceHandle, values, get_func);
-	if (LIKELY(!ret)) {	// 正常に最小・最大値を取得出来た時
-		int8_t v1min = (int8_t)((values.min >> 8) & 0xff);
-		uint8_t v2min = (uint8_t)(values.min & 0xff);
-		int8_t v1max = (int8_t)((values.max >> 8) & 0xff);
-		uint8_t v2max = (uint8_t)(values.max & 0xff);
-		value1 = value1 < v1min
-			? v1min
-			: (value1 > v1max ? v1max : value1); 
-		value2 = value2 < v2min
-			? v2min
-			: (value2 > v2max ? v2max : value2); 
-		set_func(mDeviceHandle, value1, value2);
+/**
+ * 恢复配置等一次设置多个控制
+ * 根据能力表检查(不支持/不能SET的控制不发送), 自动模式先设置, 然后所有的SET_CUR一起发送
+ * @param results 每个控制的结果(和ids的顺序相同), 0: 成功, <0: 错误
+ * @return 0: 请求都执行了(确认results), <0: 错误
+ */
+int UVCCamera::applyControls(const int *ids, const int32_t *values, int *results, int num) {
+	ENTER();
+	if (UNLIKELY(!mDeviceHandle)) {
+		RETURN(UVC_ERROR_INVALID_DEVICE, int);
+	}
+	if (UNLIKELY(!ids || !values || !results || (num <= 0) || (num > CONTROL_NUM))) {
+		RETURN(UVC_ERROR_INVALID_PARAM, int);
+	}
+	pthread_mutex_lock(&control_mutex);
+	if (!mCapsProbed) {
+		probeControls();
+	}
+	int order[CONTROL_NUM];		// index of ids in the sending order
+	int send_ids[CONTROL_NUM];
+	int32_t send_values[CONTROL_NUM];
+	int send_results[CONTROL_NUM];
+	int num_send = 0;
+	// auto/mode controls first, keep the order of the caller otherwise
+	for (int pass = 0; pass < 2; pass++) {
+		for (int i = 0; i < num; i++) {
+			const int id = ids[i];
+			if (is_mode_control(id) != !pass) continue;
+			if (UNLIKELY((id < 0) || (id >= CONTROL_NUM))) {
+				results[i] = UVC_ERROR_INVALID_PARAM;
+				continue;
+			}
+			const control_caps_t &caps = mCaps[id];
+			if (mCapsProbed && (!caps.valid
+				|| ((caps.valid & CONTROL_CAPS_INFO) && !(caps.info & 0x02)))) {
+				// not supported or read only
+				results[i] = UVC_ERROR_ACCESS;
+				continue;
+			}
+			int32_t value = values[i];
+			if ((id == CONTROL_POWERLINE_FREQUENCY) && (value < 0)) {
+				value = mPowerlineFrequency.def;
+			}
+			order[num_send] = i;
+			send_ids[num_send] = id;
+			send_values[num_send] = value;
+			num_send++;
+		}
 	}
+	int ret = UVC_SUCCESS;
+	if (num_send) {
+		ret = setControls(send_ids, send_values, send_results, num_send);
+		if (LIKELY(!ret)) {
+			for (int k = 0; k < num_send; k++) {
+				results[order[k]] = send_results[k];
+			}
+		}
+	}
+	pthread_mutex_unlock(&control_mutex);
 	RETURN(ret, int);
 }
 
-int UVCCamera::internalSetCtrlValue(control_value_t &values, int8_t value1, uint8_t value2, uint8_t value3,
-		paramget_func_i8u8u8 get_func, paramset_func_i8u8u8 set_func) {
-	int ret = update_ctrl_values(mDeviceHandle, values, get_func);
-	if (LIKELY(!ret)) {	// 正常に最小・最大値を取得出来た時
-		int8_t v1min = (int8_t)((values.min >> 16) & 0xff);
-		uint8_t v2min = (uint8_t)((values.min >> 8) & 0xff);
-		uint8_t v3min = (uint8_t)(values.min & 0xff);
-		int8_t v1max = (int8_t)((values.max >> 16) & 0xff);
-		uint8_t v2max = (uint8_t)((values.max >> 8) & 0xff);
-		uint8_t v3max = (uint8_t)(values.max & 0xff);
-		value1 = value1 < v1min
-			? v1min
-			: (value1 > v1max ? v1max : value1); 
-		value2 = value2 < v2min
-			? v2min
-			: (value2 > v2max ? v2max : value2); 
-		value3 = value3 < v3min
-			? v3min
-			: (value3 > v3max ? v3max : value3); 
-		set_func(mDeviceHandle, value1, value2, value3);
+//======================================================================
+// 控制的配置(快照)
+
+// 保存到配置的控制, 相对值(一次性的移动)和状态不保存
+static bool is_profile_control(int id) {
+	switch (id) {
+	case CONTROL_EXPOSURE_REL:
+	case CONTROL_FOCUS_REL:
+	case CONTROL_IRIS_REL:
+	case CONTROL_ZOOM_REL:
+	case CONTROL_PAN_REL:
+	case CONTROL_TILT_REL:
+	case CONTROL_ROLL_REL:
+	case CONTROL_ANALOG_VIDEO_LOCK_STATE:
+		return false;
+	default:
+		return true;
+	}
+}
+
+// 配置中的自动模式有效时设备不接受对应的手动值(GET_INFO D2), 不发送
+static bool is_disabled_by_auto(int id, const ControlProfile &profile) {
+	switch (id) {
+	case CONTROL_EXPOSURE:	// auto(0x02), aperture priority(0x08)
+		return (profile.get(CONTROL_EXPOSURE_MODE) & 0x0a) != 0;
+	case CONTROL_IRIS:		// auto(0x02), shutter priority(0x04)
+		return (profile.get(CONTROL_EXPOSURE_MODE) & 0x06) != 0;
+	case CONTROL_FOCUS:
+		return profile.get(CONTROL_AUTO_FOCUS) != 0;
+	case CONTROL_WHITE_BLANCE:
+		return profile.get(CONTROL_AUTO_WHITE_BLANCE) != 0;
+	case CONTROL_WHITE_BLANCE_COMPO:
+		return profile.get(CONTROL_AUTO_WHITE_BLANCE_COMPO) != 0;
+	case CONTROL_CONTRAST:
+		return profile.get(CONTROL_AUTO_CONTRAST) != 0;
+	case CONTROL_HUE:
+		return profile.get(CONTROL_AUTO_HUE) != 0;
+	default:
+		return false;
+	}
+}
+
+#define REGION_CONTROLS 2
+#define REGION_MAX_LEN (PROFILE_WINDOW_FIELDS * 2)
+
+/**
+ * digital window/ROI(UVC1.5)的GET_CUR/SET_CUR, 有多个字段所以不在sControlDescs中
+ * 两个请求同时发送, GET_CUR时结果保存到profile, SET_CUR时只发送profile中有的
+ */
+int UVCCamera::transferRegionControls(ControlProfile &profile, enum uvc_req_code req_code, int timeout_ms) {
+	const uvc_input_terminal_t *it = uvc_get_input_terminals(mDeviceHandle);
+	if (UNLIKELY(!it)) {
+		return UVC_ERROR_NOT_SUPPORTED;
+	}
+	const bool is_set = req_code == UVC_SET_CUR;
+	struct {
+		uint8_t selector;
+		uint64_t support;
+		uint16_t *fields;
+		int num_fields;
+		bool *has;
+	} regions[REGION_CONTROLS] = {
+		{ UVC_CT_DIGITAL_WINDOW_CONTROL, CTRL_WINDOW, profile.window, PROFILE_WINDOW_FIELDS, &profile.hasWindow },
+		{ UVC_CT_REGION_OF_INTEREST_CONTROL, CTRL_ROI, profile.roi, PROFILE_ROI_FIELDS, &profile.hasRoi },
+	};
+	uvc_ctrl_request_t reqs[REGION_CONTROLS];
+	uint8_t data[REGION_CONTROLS][REGION_MAX_LEN];
+	int req_index[REGION_CONTROLS];
+	int num_reqs = 0;
+	for (int i = 0; i < REGION_CONTROLS; i++) {
+		req_index[i] = -1;
+		if (!(mCtrlSupports & regions[i].support) || (is_set && !*regions[i].has)) continue;
+		uvc_ctrl_request_t &req = reqs[num_reqs];
+		req.unit = it->bTerminalID;
+		req.selector = regions[i].selector;
+		req.req_code = req_code;
+		req.len = regions[i].num_fields * 2;
+		req.data = data[num_reqs];
+		req.result = 0;
+		if (is_set) {
+			for (int k = 0; k < regions[i].num_fields; k++) {
+				data[num_reqs][k * 2] = (uint8_t)(regions[i].fields[k] & 0xff);
+				data[num_reqs][k * 2 + 1] = (uint8_t)(regions[i].fields[k] >> 8);
+			}
+		}
+		req_index[i] = num_reqs++;
+	}
+	int ret = UVC_SUCCESS;
+	if (num_reqs) {
+		ret = uvc_ctrl_transfer_batch(mDeviceHandle, reqs, num_reqs, timeout_ms);
+	}
+	for (int i = 0; !ret && (i < REGION_CONTROLS); i++) {
+		const int r = req_index[i];
+		if (r < 0) continue;
+		if (reqs[r].result != reqs[r].len) {
+			LOGD("region control failed:selector=%d,err=%d", regions[i].selector, reqs[r].result);
+		} else if (!is_set) {
+			for (int k = 0; k < regions[i].num_fields; k++) {
+				regions[i].fields[k] = (uint16_t)(data[r][k * 2] | (data[r][k * 2 + 1] << 8));
+			}
+			*regions[i].has = true;
+		}
+	}
+	return ret;
+}
+
+/**
+ * 所有支持的控制的当前值(GET_CUR一起发送)作为配置输出, 包括pan/tilt, digital window, ROI
+ * @return JSON, 调用方需要free, 未连接时为NULL
+ */
+char *UVCCamera::exportControlProfile(int timeout_ms) {
+	ENTER();
+	if (UNLIKELY(!mDeviceHandle)) {
+		RETURN(NULL, char *);
+	}
+	if (!mCapsProbed) {
+		probeControls(timeout_ms);
+	}
+	int ids[CONTROL_NUM];
+	int32_t values[CONTROL_NUM];
+	int results[CONTROL_NUM];
+	int num = 0;
+	for (int id = 0; id < CONTROL_NUM; id++) {
+		if (is_profile_control(id) && isCtrlReadWrite(id)) {
+			ids[num++] = id;
+		}
+	}
+	ControlProfile profile;
+	if (num && !getControls(ids, values, results, num, timeout_ms)) {
+		for (int i = 0; i < num; i++) {
+			if (!results[i]) {
+				profile.set(ids[i], values[i]);
+			}
+		}
+	}
+	transferRegionControls(profile, UVC_GET_CUR, timeout_ms);
+	RETURN(profile.toJSON(), char *);
+}
+
+/**
+ * 设置connect时恢复的配置, 已经连接时马上恢复
+ * @param profile exportControlProfile输出的JSON, NULL或者空字符串时清除
+ * @return 0: 成功, <0: 格式错误或者恢复失败
+ */
+int UVCCamera::importControlProfile(const char *profile) {
+	ENTER();
+	int ret = UVC_SUCCESS;
+	if (!profile || !*profile) {
+		SAFE_DELETE(mProfile);
+		RETURN(ret, int);
+	}
+	ControlProfile *p = new ControlProfile();
+	ret = p->parse(profile);
+	if (LIKELY(!ret)) {
+		SAFE_DELETE(mProfile);
+		mProfile = p;
+		if (mDeviceHandle) {
+			ret = applyControlProfile();
+		}
+	} else {
+		SAFE_DELETE(p);
 	}
 	RETURN(ret, int);
 }
 
 /**
- * カメラコントロール設定の下請け
+ * 恢复mProfile, connect时在开始预览之前调用
+ * 先一起读取当前值, 只发送不同的控制(自动模式有效时对应的手动值不发送),
+ * 自动模式先设置, 其他的SET_CUR一起发送(pan/tilt合并成一个请求), 最后是window/ROI
  */
-int UVCCamera::internalSetCtrlValue(control_value_t &values, int16_t value,
-		paramget_func_i16 get_func, paramset_func_i16 set_func) {
-	int ret = update_ctrl_values(mDeviceHandle, values, get_func);
-	if (LIKELY(!ret)) {	// 正常に最小・最大値を取得出来た時
-		value = value < values.min
-			? values.min
-			: (value > values.max ? values.max : value);
-		set_func(mDeviceHandle, value);
+int UVCCamera::applyControlProfile(int timeout_ms) {
+	ENTER();
+	if (UNLIKELY(!mDeviceHandle || !mProfile)) {
+		RETURN(UVC_ERROR_INVALID_PARAM, int);
+	}
+	// 读取当前值到发送之间不能插入其他写入
+	pthread_mutex_lock(&control_mutex);
+	if (!mCapsProbed) {
+		probeControls(timeout_ms);
+	}
+	const ControlProfile &profile = *mProfile;
+	int ids[CONTROL_NUM];
+	int32_t values[CONTROL_NUM];
+	int32_t current[CONTROL_NUM];
+	int results[CONTROL_NUM];
+	int num = 0;
+	for (int id = 0; id < CONTROL_NUM; id++) {
+		if (profile.has(id) && is_profile_control(id)
+			&& isCtrlReadWrite(id) && !is_disabled_by_auto(id, profile)) {
+			ids[num++] = id;
+		}
+	}
+	int ret = UVC_SUCCESS;
+	if (num) {
+		const bool has_current = !getControls(ids, current, results, num, timeout_ms);
+		int num_send = 0;
+		for (int i = 0; i < num; i++) {
+			const int32_t value = profile.get(ids[i]);
+			if (has_current && !results[i] && (current[i] == value)) continue;
+			ids[num_send] = ids[i];
+			values[num_send++] = value;
+		}
+		MARK("restore %d/%d controls", num_send, num);
+		if (num_send) {
+			ret = applyControls(ids, values, results, num_send);
+			for (int i = 0; !ret && (i < num_send); i++) {
+				if (results[i]) {
+					LOGD("failed to restore:id=%d,err=%d", ids[i], results[i]);
+				}
+			}
+		}
+	}
+	if (LIKELY(!ret) && (profile.hasWindow || profile.hasRoi)) {
+		ret = transferRegionControls(*mProfile, UVC_SET_CUR, timeout_ms);
 	}
+	pthread_mutex_unlock(&control_mutex);
 	RETURN(ret, int);
 }
 
+//======================================================================
+// PTZ运动控制(工作线程按固定周期发送)
+
 /**
- * カメラコントロール設定の下請け
+ * @param axis PTZ_AXIS_XXX
+ * @param duration_ms 到达目标的时间, 0: 立即
  */
-int UVCCamera::internalSetCtrlValue(control_value_t &values, uint16_t value,
-		paramget_func_u16 get_func, paramset_func_u16 set_func) {
-	int ret = update_ctrl_values(mDeviceHandle, values, get_func);
-	if (LIKELY(!ret)) {	// 正常に最小・最大値を取得出来た時
-		value = value < values.min
-			? values.min
-			: (value > values.max ? values.max : value);
-		set_func(mDeviceHandle, value);
+int UVCCamera::setPtzTarget(int axis, int value, int duration_ms) {
+	ENTER();
+	int ret = UVC_ERROR_INVALID_DEVICE;
+	if (LIKELY(mPtz)) {
+		ret = mPtz->setTarget(axis, value, duration_ms);
 	}
 	RETURN(ret, int);
 }
 
 /**
- * カメラコントロール設定の下請け
+ * @param axis PTZ_AXIS_XXX
+ * @param velocity [units/s], 0: 停止
  */
-int UVCCamera::internalSetCtrlValue(control_value_t &values, int32_t value,
-		paramget_func_i32 get_func, paramset_func_i32 set_func) {
-	int ret = update_ctrl_values(mDeviceHandle, values, get_func);
-	if (LIKELY(!ret)) {	// 正常に最小・最大値を取得出来た時
-		value = value < values.min
-			? values.min
-			: (value > values.max ? values.max : value);
-		set_func(mDeviceHandle, value);
+int UVCCamera::setPtzVelocity(int axis, int velocity) {
+	ENTER();
+	int ret = UVC_ERROR_INVALID_DEVICE;
+	if (LIKELY(mPtz)) {
+		ret = mPtz->setVelocity(axis, velocity);
 	}
 	RETURN(ret, int);
 }
 
+int UVCCamera::haltPtz() {
+	ENTER();
+	int ret = UVC_ERROR_INVALID_DEVICE;
+	if (LIKELY(mPtz)) {
+		ret = mPtz->halt();
+	}
+	RETURN(ret, int);
+}
+
+int UVCCamera::setPtzPeriod(int period_ms) {
+	ENTER();
+	int ret = UVC_ERROR_INVALID_DEVICE;
+	if (LIKELY(mPtz)) {
+		ret = mPtz->setPeriod(period_ms);
+	}
+	RETURN(ret, int);
+}
+
+int UVCCamera::getPtzPosition(int axis, int32_t &value) {
+	ENTER();
+	int ret = UVC_ERROR_INVALID_DEVICE;
+	if (LIKELY(mPtz)) {
+		ret = mPtz->getPosition(axis, value);
+	}
+	RETURN(ret, int);
+}
+
+//======================================================================
+// 软件AE/AWB(设备的自动曝光/白平衡不好或者没有时)
+
 /**
- * カメラコントロール設定の下請け
+ * @param flags SOFT_AE/SOFT_AWB, 0: 结束(恢复设备的自动模式)
+ * @param target 目标平均亮度, <=0: 默认值
+ * @param interval 每几帧计算一次, <=0: 默认值
+ * @return 实际开始的SOFT_XXX, <0: 错误
  */
-int UVCCamera::internalSetCtrlValue(control_value_t &values, uint32_t value,
-		paramget_func_u32 get_func, paramset_func_u32 set_func) {
-	int ret = update_ctrl_values(mDeviceHandle, values, get_func);
-	if (LIKELY(!ret)) {	// 正常に最小・最大値を取得出来た時
-		value = value < values.min
-			? values.min
-			: (value > values.max ? values.max : value);
-		set_func(mDeviceHandle, value);
+int UVCCamera::setSoftwareAeAwb(int flags, int target, int interval) {
+	ENTER();
+	int ret = UVC_ERROR_INVALID_DEVICE;
+	if (LIKELY(mAeAwb)) {
+		ret = mAeAwb->start(flags, target, interval);
 	}
 	RETURN(ret, int);
 }
@@ -874,639 +1695,320 @@ int UVCCamera::internalSetCtrlValue(control_value_t &values, uint32_t value,
 // スキャニングモード
 int UVCCamera::updateScanningModeLimit(int &min, int &max, int &def) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & CTRL_SCANNING) {
-		UPDATE_CTRL_VALUES(mScanningMode, uvc_get_scanning_mode);
-	}
-	RETURN(ret, int);
+	RETURN(updateCtrlLimit(CONTROL_SCANNING_MODE, min, max, def), int);
 }
 
-// スキャニングモードをセット
 int UVCCamera::setScanningMode(int mode) {
 	ENTER();
-	int r = UVC_ERROR_ACCESS;
-	if LIKELY((mDeviceHandle) && (mCtrlSupports & CTRL_SCANNING)) {
-//		LOGI("ae:%d", mode);
-		r = uvc_set_scanning_mode(mDeviceHandle, mode/* & 0xff*/);
-	}
-	RETURN(r, int);
+	RETURN(setCtrlValue(CONTROL_SCANNING_MODE, mode), int);
 }
 
-// スキャニングモード設定を取得
 int UVCCamera::getScanningMode() {
-
 	ENTER();
-	int r = UVC_ERROR_ACCESS;
-	if LIKELY((mDeviceHandle) && (mCtrlSupports & CTRL_SCANNING)) {
-		uint8_t mode;
-		r = uvc_get_scanning_mode(mDeviceHandle, &mode, UVC_GET_CUR);
-//		LOGI("ae:%d", mode);
-		if (LIKELY(!r)) {
-			r = mode;
-		}
-	}
-	RETURN(r, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_SCANNING_MODE, value);
+	RETURN(LIKELY(!ret) ? value : ret, int);
 }
 
 //======================================================================
 // 露出モード
 int UVCCamera::updateExposureModeLimit(int &min, int &max, int &def) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & CTRL_AE) {
-		UPDATE_CTRL_VALUES(mExposureMode, uvc_get_ae_mode);
-	}
-	RETURN(ret, int);
+	RETURN(updateCtrlLimit(CONTROL_EXPOSURE_MODE, min, max, def), int);
 }
 
-// 露出をセット
 int UVCCamera::setExposureMode(int mode) {
 	ENTER();
-	int r = UVC_ERROR_ACCESS;
-	if LIKELY((mDeviceHandle) && (mCtrlSupports & CTRL_AE)) {
-//		LOGI("ae:%d", mode);
-		r = uvc_set_ae_mode(mDeviceHandle, mode/* & 0xff*/);
-	}
-	RETURN(r, int);
+	RETURN(setCtrlValue(CONTROL_EXPOSURE_MODE, mode), int);
 }
 
-// 露出設定を取得
 int UVCCamera::getExposureMode() {
-
 	ENTER();
-	int r = UVC_ERROR_ACCESS;
-	if LIKELY((mDeviceHandle) && (mCtrlSupports & CTRL_AE)) {
-		uint8_t mode;
-		r = uvc_get_ae_mode(mDeviceHandle, &mode, UVC_GET_CUR);
-//		LOGI("ae:%d", mode);
-		if (LIKELY(!r)) {
-			r = mode;
-		}
-	}
-	RETURN(r, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_EXPOSURE_MODE, value);
+	RETURN(LIKELY(!ret) ? value : ret, int);
 }
 
 //======================================================================
 // 露出優先設定
 int UVCCamera::updateExposurePriorityLimit(int &min, int &max, int &def) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & CTRL_AE_PRIORITY) {
-		UPDATE_CTRL_VALUES(mExposurePriority, uvc_get_ae_priority);
-	}
-	RETURN(ret, int);
+	RETURN(updateCtrlLimit(CONTROL_EXPOSURE_PRIORITY, min, max, def), int);
 }
 
-// 露出優先設定をセット
 int UVCCamera::setExposurePriority(int priority) {
 	ENTER();
-	int r = UVC_ERROR_ACCESS;
-	if LIKELY((mDeviceHandle) && (mCtrlSupports & CTRL_AE_PRIORITY)) {
-//		LOGI("ae priority:%d", priority);
-		r = uvc_set_ae_priority(mDeviceHandle, priority/* & 0xff*/);
-	}
-	RETURN(r, int);
+	RETURN(setCtrlValue(CONTROL_EXPOSURE_PRIORITY, priority), int);
 }
 
-// 露出優先設定を取得
 int UVCCamera::getExposurePriority() {
-
 	ENTER();
-	int r = UVC_ERROR_ACCESS;
-	if LIKELY((mDeviceHandle) && (mCtrlSupports & CTRL_AE_PRIORITY)) {
-		uint8_t priority;
-		r = uvc_get_ae_priority(mDeviceHandle, &priority, UVC_GET_CUR);
-//		LOGI("ae priority:%d", priority);
-		if (LIKELY(!r)) {
-			r = priority;
-		}
-	}
-	RETURN(r, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_EXPOSURE_PRIORITY, value);
+	RETURN(LIKELY(!ret) ? value : ret, int);
 }
 
 //======================================================================
 // 露出(絶対値)設定
 int UVCCamera::updateExposureLimit(int &min, int &max, int &def) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & CTRL_AE_ABS) {
-		UPDATE_CTRL_VALUES(mExposureAbs, uvc_get_exposure_abs);
-	}
-	RETURN(ret, int);
+	RETURN(updateCtrlLimit(CONTROL_EXPOSURE, min, max, def), int);
 }
 
-// 露出(絶対値)設定をセット
 int UVCCamera::setExposure(int ae_abs) {
 	ENTER();
-	int r = UVC_ERROR_ACCESS;
-	if LIKELY((mDeviceHandle) && (mCtrlSupports & CTRL_AE_ABS)) {
-//		LOGI("ae_abs:%d", ae_abs);
-		r = uvc_set_exposure_abs(mDeviceHandle, ae_abs/* & 0xff*/);
-	}
-	RETURN(r, int);
+	RETURN(setCtrlValue(CONTROL_EXPOSURE, ae_abs), int);
 }
 
-// 露出(絶対値)設定を取得
 int UVCCamera::getExposure() {
-
 	ENTER();
-	int r = UVC_ERROR_ACCESS;
-	if LIKELY((mDeviceHandle) && (mCtrlSupports & CTRL_AE_ABS)) {
-		int ae_abs;
-		r = uvc_get_exposure_abs(mDeviceHandle, &ae_abs, UVC_GET_CUR);
-//		LOGI("ae_abs:%d", ae_abs);
-		if (LIKELY(!r)) {
-			r = ae_abs;
-		}
-	}
-	RETURN(r, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_EXPOSURE, value);
+	RETURN(LIKELY(!ret) ? value : ret, int);
 }
 
 //======================================================================
 // 露出(相対値)設定
 int UVCCamera::updateExposureRelLimit(int &min, int &max, int &def) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & CTRL_AE_REL) {
-		UPDATE_CTRL_VALUES(mExposureAbs, uvc_get_exposure_rel);
-	}
-	RETURN(ret, int);
+	RETURN(updateCtrlLimit(CONTROL_EXPOSURE_REL, min, max, def), int);
 }
 
-// 露出(相対値)設定をセット
 int UVCCamera::setExposureRel(int ae_rel) {
 	ENTER();
-	int r = UVC_ERROR_ACCESS;
-	if LIKELY((mDeviceHandle) && (mCtrlSupports & CTRL_AE_REL)) {
-//		LOGI("ae_rel:%d", ae_rel);
-		r = uvc_set_exposure_rel(mDeviceHandle, ae_rel/* & 0xff*/);
-	}
-	RETURN(r, int);
+	RETURN(setCtrlValue(CONTROL_EXPOSURE_REL, ae_rel), int);
 }
 
-// 露出(相対値)設定を取得
 int UVCCamera::getExposureRel() {
-
 	ENTER();
-	int r = UVC_ERROR_ACCESS;
-	if LIKELY((mDeviceHandle) && (mCtrlSupports & CTRL_AE_REL)) {
-		int ae_rel;
-		r = uvc_get_exposure_rel(mDeviceHandle, &ae_rel, UVC_GET_CUR);
-//		LOGI("ae_rel:%d", ae_rel);
-		if (LIKELY(!r)) {
-			r = ae_rel;
-		}
-	}
-	RETURN(r, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_EXPOSURE_REL, value);
+	RETURN(LIKELY(!ret) ? value : ret, int);
 }
 
 //======================================================================
 // オートフォーカス
 int UVCCamera::updateAutoFocusLimit(int &min, int &max, int &def) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & CTRL_FOCUS_AUTO) {
-		UPDATE_CTRL_VALUES(mAutoFocus, uvc_get_focus_auto);
-	}
-	RETURN(ret, int);
+	RETURN(updateCtrlLimit(CONTROL_AUTO_FOCUS, min, max, def), int);
 }
 
-// オートフォーカスをon/off
 int UVCCamera::setAutoFocus(bool autoFocus) {
 	ENTER();
-
-	int r = UVC_ERROR_ACCESS;
-	if LIKELY((mDeviceHandle) && (mCtrlSupports & CTRL_FOCUS_AUTO)) {
-		r = uvc_set_focus_auto(mDeviceHandle, autoFocus);
-	}
-	RETURN(r, int);
+	RETURN(setCtrlValue(CONTROL_AUTO_FOCUS, autoFocus), int);
 }
 
-// オートフォーカスのon/off状態を取得
 bool UVCCamera::getAutoFocus() {
 	ENTER();
-	int r = UVC_ERROR_ACCESS;
-	if LIKELY((mDeviceHandle) && (mCtrlSupports & CTRL_FOCUS_AUTO)) {
-		uint8_t autoFocus;
-		r = uvc_get_focus_auto(mDeviceHandle, &autoFocus, UVC_GET_CUR);
-		if (LIKELY(!r))
-			r = autoFocus;
-	}
-	RETURN(r, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_AUTO_FOCUS, value);
+	RETURN(LIKELY(!ret) ? value : ret, int);
 }
 
 //======================================================================
 // フォーカス(絶対値)調整
-int UVCCamera::updateFocusLimit(int &min, int &max, int &def) {
-	ENTER();
-	int ret = UVC_ERROR_ACCESS;
-	if (mCtrlSupports & CTRL_FOCUS_ABS) {
-		UPDATE_CTRL_VALUES(mFocus, uvc_get_focus_abs);
-	}
-	RETURN(ret, int);
-}
-
-// フォーカス(絶対値)を設定
-int UVCCamera::setFocus(int focus) {
-	ENTER();
-	int ret = UVC_ERROR_ACCESS;
-	if (mCtrlSupports & CTRL_FOCUS_ABS) {
-		ret = internalSetCtrlValue(mFocus, focus, uvc_get_focus_abs, uvc_set_focus_abs);
-	}
-	RETURN(ret, int);
-}
-
-// フォーカス(絶対値)の現在値を取得
-int UVCCamera::getFocus() {
-	ENTER();
-	if (mCtrlSupports & CTRL_FOCUS_ABS) {
-		int ret = update_ctrl_values(mDeviceHandle, mFocus, uvc_get_focus_abs);
-		if (LIKELY(!ret)) {	// 正常に最小・最大値を取得出来た時
-			int16_t value;
-			ret = uvc_get_focus_abs(mDeviceHandle, &value, UVC_GET_CUR);
-			if (LIKELY(!ret))
-				return value;
-		}
-	}
-	RETURN(0, int);
-}
-
-//======================================================================
-// フォーカス(相対値)調整
-int UVCCamera::updateFocusRelLimit(int &min, int &max, int &def) {
-	ENTER();
-	int ret = UVC_ERROR_ACCESS;
-	if (mCtrlSupports & CTRL_FOCUS_REL) {
-		UPDATE_CTRL_VALUES(mFocusRel, uvc_get_focus_rel);
-	}
-	RETURN(ret, int);
+int UVCCamera::updateFocusLimit(int &min, int &max, int &def) {
+	ENTER();
+	RETURN(updateCtrlLimit(CONTROL_FOCUS, min, max, def), int);
 }
 
-// フォーカス(相対値)を設定
-int UVCCamera::setFocusRel(int focus_rel) {
+int UVCCamera::setFocus(int focus) {
 	ENTER();
-	int ret = UVC_ERROR_ACCESS;
-	if (mCtrlSupports & CTRL_FOCUS_REL) {
-		ret = internalSetCtrlValue(mFocusRel, (int8_t)((focus_rel >> 8) & 0xff), (uint8_t)(focus_rel &0xff), uvc_get_focus_rel, uvc_set_focus_rel);
-	}
-	RETURN(ret, int);
+	RETURN(setCtrlValue(CONTROL_FOCUS, focus), int);
 }
 
-// フォーカス(相対値)の現在値を取得
-int UVCCamera::getFocusRel() {
+int UVCCamera::getFocus() {
 	ENTER();
-	if (mCtrlSupports & CTRL_FOCUS_REL) {
-		int ret = update_ctrl_values(mDeviceHandle, mFocusRel, uvc_get_focus_abs);
-		if (LIKELY(!ret)) {	// 正常に最小・最大値を取得出来た時
-			int8_t focus;
-			uint8_t speed;
-			ret = uvc_get_focus_rel(mDeviceHandle, &focus, &speed, UVC_GET_CUR);
-			if (LIKELY(!ret))
-				return (focus <<8) + speed;
-		}
-	}
-	RETURN(0, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_FOCUS, value);
+	RETURN(LIKELY(!ret) ? value : 0, int);
 }
 
 //======================================================================
-/*
-// フォーカス(シンプル)調整
-int UVCCamera::updateFocusSimpleLimit(int &min, int &max, int &def) {
+// フォーカス(相対値)調整
+int UVCCamera::updateFocusRelLimit(int &min, int &max, int &def) {
 	ENTER();
-	int ret = UVC_ERROR_ACCESS;
-	if (mCtrlSupports & CTRL_FOCUS_SIMPLE) {
-		UPDATE_CTRL_VALUES(mFocusSimple, uvc_get_focus_simple_range);
-	}
-	RETURN(ret, int);
+	RETURN(updateCtrlLimit(CONTROL_FOCUS_REL, min, max, def), int);
 }
 
-// フォーカス(シンプル)を設定
-int UVCCamera::setFocusSimple(int focus) {
+int UVCCamera::setFocusRel(int focus_rel) {
 	ENTER();
-	int ret = UVC_ERROR_ACCESS;
-	if (mCtrlSupports & CTRL_FOCUS_SIMPLE) {
-		ret = internalSetCtrlValue(mFocusSimple, focus, uvc_get_focus_simple_range, uvc_set_focus_simple_range);
-	}
-	RETURN(ret, int);
+	RETURN(setCtrlValue(CONTROL_FOCUS_REL, focus_rel), int);
 }
 
-// フォーカス(シンプル)の現在値を取得
-int UVCCamera::getFocusSimple() {
+int UVCCamera::getFocusRel() {
 	ENTER();
-	if (mCtrlSupports & CTRL_FOCUS_SIMPLE) {
-		int ret = update_ctrl_values(mDeviceHandle, mFocusSimple, uvc_get_focus_abs);
-		if (LIKELY(!ret)) {	// 正常に最小・最大値を取得出来た時
-			uint8_t value;
-			ret = uvc_get_focus_simple_range(mDeviceHandle, &value, UVC_GET_CUR);
-			if (LIKELY(!ret))
-				return value;
-		}
-	}
-	RETURN(0, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_FOCUS_REL, value);
+	RETURN(LIKELY(!ret) ? value : 0, int);
 }
-*/
 
 //======================================================================
 // 絞り(絶対値)調整
 int UVCCamera::updateIrisLimit(int &min, int &max, int &def) {
 	ENTER();
-	int ret = UVC_ERROR_ACCESS;
-	if (mCtrlSupports & CTRL_IRIS_ABS) {
-		UPDATE_CTRL_VALUES(mIris, uvc_get_iris_abs);
-	}
-	RETURN(ret, int);
+	RETURN(updateCtrlLimit(CONTROL_IRIS, min, max, def), int);
 }
 
-// 絞り(絶対値)を設定
 int UVCCamera::setIris(int iris) {
 	ENTER();
-	int ret = UVC_ERROR_ACCESS;
-	if (mCtrlSupports & CTRL_IRIS_ABS) {
-		ret = internalSetCtrlValue(mIris, iris, uvc_get_iris_abs, uvc_set_iris_abs);
-	}
-	RETURN(ret, int);
+	RETURN(setCtrlValue(CONTROL_IRIS, iris), int);
 }
 
-// 絞り(絶対値)の現在値を取得
 int UVCCamera::getIris() {
 	ENTER();
-	if (mCtrlSupports & CTRL_IRIS_ABS) {
-		int ret = update_ctrl_values(mDeviceHandle, mIris, uvc_get_iris_abs);
-		if (LIKELY(!ret)) {	// 正常に最小・最大値を取得出来た時
-			uint16_t value;
-			ret = uvc_get_iris_abs(mDeviceHandle, &value, UVC_GET_CUR);
-			if (LIKELY(!ret))
-				return value;
-		}
-	}
-	RETURN(0, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_IRIS, value);
+	RETURN(LIKELY(!ret) ? value : 0, int);
 }
 
 //======================================================================
 // 絞り(相対値)調整
 int UVCCamera::updateIrisRelLimit(int &min, int &max, int &def) {
 	ENTER();
-	int ret = UVC_ERROR_ACCESS;
-	if (mCtrlSupports & CTRL_IRIS_REL) {
-		UPDATE_CTRL_VALUES(mIris, uvc_get_iris_rel);
-	}
-	RETURN(ret, int);
+	RETURN(updateCtrlLimit(CONTROL_IRIS_REL, min, max, def), int);
 }
 
-// 絞り(相対値)を設定
 int UVCCamera::setIrisRel(int iris_rel) {
 	ENTER();
-	int ret = UVC_ERROR_ACCESS;
-	if (mCtrlSupports & CTRL_IRIS_REL) {
-		ret = internalSetCtrlValue(mIris, iris_rel, uvc_get_iris_rel, uvc_set_iris_rel);
-	}
-	RETURN(ret, int);
+	RETURN(setCtrlValue(CONTROL_IRIS_REL, iris_rel), int);
 }
 
-// 絞り(相対値)の現在値を取得
 int UVCCamera::getIrisRel() {
 	ENTER();
-	if (mCtrlSupports & CTRL_IRIS_REL) {
-		int ret = update_ctrl_values(mDeviceHandle, mIris, uvc_get_iris_rel);
-		if (LIKELY(!ret)) {	// 正常に最小・最大値を取得出来た時
-			uint8_t iris_rel;
-			ret = uvc_get_iris_rel(mDeviceHandle, &iris_rel, UVC_GET_CUR);
-			if (LIKELY(!ret))
-				return iris_rel;
-		}
-	}
-	RETURN(0, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_IRIS_REL, value);
+	RETURN(LIKELY(!ret) ? value : 0, int);
 }
 
 //======================================================================
 // Pan(絶対値)調整
 int UVCCamera::updatePanLimit(int &min, int &max, int &def) {
 	ENTER();
-	int ret = UVC_ERROR_ACCESS;
-	if (mCtrlSupports & CTRL_PANTILT_ABS) {
-		update_ctrl_values(mDeviceHandle, mPan, mTilt, uvc_get_pantilt_abs);
-	}
-	RETURN(ret, int);
+	RETURN(updateCtrlLimit(CONTROL_PAN, min, max, def), int);
 }
 
-// Pan(絶対値)を設定
 int UVCCamera::setPan(int pan) {
 	ENTER();
-	int ret = UVC_ERROR_ACCESS;
-	if (mCtrlSupports & CTRL_PANTILT_ABS) {
-		ret = update_ctrl_values(mDeviceHandle, mPan, mTilt, uvc_get_pantilt_abs);
-		if (LIKELY(!ret)) {
-			pan = pan < mPan.min
-					? mPan.min
-					: (pan > mPan.max ? mPan.max : pan);
-			int tilt = mTilt.current < 0 ? mTilt.def : mTilt.current;
-			ret = uvc_set_pantilt_abs(mDeviceHandle, pan, tilt);
-			if (LIKELY(!ret)) {
-				mPan.current = pan;
-				mTilt.current = tilt;
-			}
-		}
-	}
-	RETURN(ret, int);
+	RETURN(setCtrlValue(CONTROL_PAN, pan), int);
 }
 
-// Pan(絶対値)の現在値を取得
 int UVCCamera::getPan() {
 	ENTER();
-	if (mCtrlSupports & CTRL_PANTILT_ABS) {
-		int ret = update_ctrl_values(mDeviceHandle, mPan, mTilt, uvc_get_pantilt_abs);
-		if (LIKELY(!ret)) {	// 正常に最小・最大値を取得出来た時
-			int32_t pan, tilt;
-			ret = uvc_get_pantilt_abs(mDeviceHandle, &pan, &tilt, UVC_GET_CUR);
-			if (LIKELY(!ret)) {
-				mPan.current = pan;
-				mTilt.current = tilt;
-				return pan;
-			}
-		}
-	}
-	RETURN(0, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_PAN, value);
+	RETURN(LIKELY(!ret) ? value : 0, int);
 }
 
 //======================================================================
 // Tilt(絶対値)調整
 int UVCCamera::updateTiltLimit(int &min, int &max, int &def) {
 	ENTER();
-	int ret = UVC_ERROR_ACCESS;
-	if (mCtrlSupports & CTRL_PANTILT_ABS) {
-		update_ctrl_values(mDeviceHandle, mPan, mTilt, uvc_get_pantilt_abs);
-	}
-	RETURN(ret, int);
+	RETURN(updateCtrlLimit(CONTROL_TILT, min, max, def), int);
 }
 
-// Tilt(絶対値)を設定
 int UVCCamera::setTilt(int tilt) {
 	ENTER();
-	int ret = UVC_ERROR_ACCESS;
-	if (mCtrlSupports & CTRL_PANTILT_ABS) {
-		ret = update_ctrl_values(mDeviceHandle, mPan, mTilt, uvc_get_pantilt_abs);
-		if (LIKELY(!ret)) {
-			tilt = tilt < mTilt.min
-					? mTilt.min
-					: (tilt > mTilt.max ? mTilt.max : tilt);
-			int pan = mPan.current < 0 ? mPan.def : mPan.current;
-			ret = uvc_set_pantilt_abs(mDeviceHandle, pan, tilt);
-			if (LIKELY(!ret)) {
-				mPan.current = pan;
-				mTilt.current = tilt;
-			}
-		}
-	}
-	RETURN(ret, int);
+	RETURN(setCtrlValue(CONTROL_TILT, tilt), int);
 }
 
-// Tilt(絶対値)の現在値を取得
 int UVCCamera::getTilt() {
 	ENTER();
-	if (mCtrlSupports & CTRL_PANTILT_ABS) {
-		int ret = update_ctrl_values(mDeviceHandle, mPan, mTilt, uvc_get_pantilt_abs);
-		if (LIKELY(!ret)) {	// 正常に最小・最大値を取得出来た時
-			int32_t pan, tilt;
-			ret = uvc_get_pantilt_abs(mDeviceHandle, &pan, &tilt, UVC_GET_CUR);
-			if (LIKELY(!ret)) {
-				mPan.current = pan;
-				mTilt.current = tilt;
-				return tilt;
-			}
-		}
-	}
-	RETURN(0, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_TILT, value);
+	RETURN(LIKELY(!ret) ? value : 0, int);
 }
 
 //======================================================================
 // Roll(絶対値)調整
 int UVCCamera::updateRollLimit(int &min, int &max, int &def) {
 	ENTER();
-	int ret = UVC_ERROR_ACCESS;
-	if (mCtrlSupports & CTRL_ROLL_ABS) {
-		UPDATE_CTRL_VALUES(mRoll, uvc_get_roll_abs);
-	}
-	RETURN(ret, int);
+	RETURN(updateCtrlLimit(CONTROL_ROLL, min, max, def), int);
 }
 
-// Roll(絶対値)を設定
 int UVCCamera::setRoll(int roll) {
 	ENTER();
-	int ret = UVC_ERROR_ACCESS;
-	if (mCtrlSupports & CTRL_ROLL_ABS) {
-		ret = internalSetCtrlValue(mRoll, roll, uvc_get_roll_abs, uvc_set_roll_abs);
-	}
-	RETURN(ret, int);
+	RETURN(setCtrlValue(CONTROL_ROLL, roll), int);
 }
 
-// Roll(絶対値)の現在値を取得
 int UVCCamera::getRoll() {
 	ENTER();
-	if (mCtrlSupports & CTRL_ROLL_ABS) {
-		int ret = update_ctrl_values(mDeviceHandle, mRoll, uvc_get_roll_abs);
-		if (LIKELY(!ret)) {	// 正常に最小・最大値を取得出来た時
-			int16_t roll;
-			ret = uvc_get_roll_abs(mDeviceHandle, &roll, UVC_GET_CUR);
-			if (LIKELY(!ret)) {
-				mRoll.current = roll;
-				return roll;
-			}
-		}
-	}
-	RETURN(0, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_ROLL, value);
+	RETURN(LIKELY(!ret) ? value : 0, int);
 }
 
 //======================================================================
 int UVCCamera::updatePanRelLimit(int &min, int &max, int &def) {
 	ENTER();
-	// FIXME not implemented yet
-	RETURN(UVC_ERROR_ACCESS, int);
+	RETURN(updateCtrlLimit(CONTROL_PAN_REL, min, max, def), int);
 }
 
 int UVCCamera::setPanRel(int pan_rel) {
 	ENTER();
-	// FIXME not implemented yet
-	RETURN(UVC_ERROR_ACCESS, int);
+	RETURN(setCtrlValue(CONTROL_PAN_REL, pan_rel), int);
 }
 
 int UVCCamera::getPanRel() {
 	ENTER();
-	// FIXME not implemented yet
-	RETURN(UVC_ERROR_ACCESS, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_PAN_REL, value);
+	RETURN(LIKELY(!ret) ? value : 0, int);
 }
-	
+
 //======================================================================
 int UVCCamera::updateTiltRelLimit(int &min, int &max, int &def) {
 	ENTER();
-	// FIXME not implemented yet
-	RETURN(UVC_ERROR_ACCESS, int);
+	RETURN(updateCtrlLimit(CONTROL_TILT_REL, min, max, def), int);
 }
 
 int UVCCamera::setTiltRel(int tilt_rel) {
 	ENTER();
-	// FIXME not implemented yet
-	RETURN(UVC_ERROR_ACCESS, int);
+	RETURN(setCtrlValue(CONTROL_TILT_REL, tilt_rel), int);
 }
 
 int UVCCamera::getTiltRel() {
 	ENTER();
-	// FIXME not implemented yet
-	RETURN(UVC_ERROR_ACCESS, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_TILT_REL, value);
+	RETURN(LIKELY(!ret) ? value : 0, int);
 }
-	
+
 //======================================================================
 int UVCCamera::updateRollRelLimit(int &min, int &max, int &def) {
 	ENTER();
-	// FIXME not implemented yet
-	RETURN(UVC_ERROR_ACCESS, int);
+	RETURN(updateCtrlLimit(CONTROL_ROLL_REL, min, max, def), int);
 }
 
 int UVCCamera::setRollRel(int roll_rel) {
 	ENTER();
-	// FIXME not implemented yet
-	RETURN(UVC_ERROR_ACCESS, int);
+	RETURN(setCtrlValue(CONTROL_ROLL_REL, roll_rel), int);
 }
 
 int UVCCamera::getRollRel() {
 	ENTER();
-	// FIXME not implemented yet
-	RETURN(UVC_ERROR_ACCESS, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_ROLL_REL, value);
+	RETURN(LIKELY(!ret) ? value : 0, int);
 }
 
 //======================================================================
 // プライバシーモード
 int UVCCamera::updatePrivacyLimit(int &min, int &max, int &def) {
 	ENTER();
-	int ret = UVC_ERROR_ACCESS;
-	if (mCtrlSupports & CTRL_PRIVACY) {
-		UPDATE_CTRL_VALUES(mPrivacy, uvc_get_focus_abs);
-	}
-	RETURN(ret, int);
+	RETURN(updateCtrlLimit(CONTROL_PRIVACY, min, max, def), int);
 }
 
-// プライバシーモードを設定
 int UVCCamera::setPrivacy(int privacy) {
 	ENTER();
-	int ret = UVC_ERROR_ACCESS;
-	if (mCtrlSupports & CTRL_PRIVACY) {
-		ret = internalSetCtrlValue(mPrivacy, privacy, uvc_get_privacy, uvc_set_privacy);
-	}
-	RETURN(ret, int);
+	RETURN(setCtrlValue(CONTROL_PRIVACY, privacy), int);
 }
 
-// プライバシーモードの現在値を取得
 int UVCCamera::getPrivacy() {
 	ENTER();
-	if (mCtrlSupports & CTRL_PRIVACY) {
-		int ret = update_ctrl_values(mDeviceHandle, mPrivacy, uvc_get_privacy);
-		if (LIKELY(!ret)) {	// 正常に最小・最大値を取得出来た時
-			uint8_t privacy;
-			ret = uvc_get_privacy(mDeviceHandle, &privacy, UVC_GET_CUR);
-			if (LIKELY(!ret))
-				return privacy;
-		}
-	}
-	RETURN(0, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_PRIVACY, value);
+	RETURN(LIKELY(!ret) ? value : 0, int);
 }
 
 //======================================================================
@@ -1561,592 +2063,332 @@ int UVCCamera::getDigitalRoi(int &top, int &reft, int &bottom, int &right) {
 // backlight_compensation
 int UVCCamera::updateBacklightCompLimit(int &min, int &max, int &def) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & PU_BACKLIGHT) {
-		UPDATE_CTRL_VALUES(mBacklightComp, uvc_get_backlight_compensation);
-	}
-	RETURN(ret, int);
+	RETURN(updateCtrlLimit(CONTROL_BACKLIGHT_COMP, min, max, def), int);
 }
 
-// backlight_compensationを設定
 int UVCCamera::setBacklightComp(int backlight) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & PU_BACKLIGHT) {
-		ret = internalSetCtrlValue(mBacklightComp, backlight, uvc_get_backlight_compensation, uvc_set_backlight_compensation);
-	}
-	RETURN(ret, int);
+	RETURN(setCtrlValue(CONTROL_BACKLIGHT_COMP, backlight), int);
 }
 
-// backlight_compensationの現在値を取得
 int UVCCamera::getBacklightComp() {
 	ENTER();
-	if (mPUSupports & PU_BACKLIGHT) {
-		int ret = update_ctrl_values(mDeviceHandle, mBacklightComp, uvc_get_backlight_compensation);
-		if (LIKELY(!ret)) {	// 正常に最小・最大値を取得出来た時
-			int16_t value;
-			ret = uvc_get_backlight_compensation(mDeviceHandle, &value, UVC_GET_CUR);
-			if (LIKELY(!ret))
-				return value;
-		}
-	}
-	RETURN(0, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_BACKLIGHT_COMP, value);
+	RETURN(LIKELY(!ret) ? value : 0, int);
 }
 
-
 //======================================================================
 // 明るさ
 int UVCCamera::updateBrightnessLimit(int &min, int &max, int &def) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & PU_BRIGHTNESS) {
-		UPDATE_CTRL_VALUES(mBrightness, uvc_get_brightness);
-	}
-	RETURN(ret, int);
+	RETURN(updateCtrlLimit(CONTROL_BRIGHTNESS, min, max, def), int);
 }
 
 int UVCCamera::setBrightness(int brightness) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & PU_BRIGHTNESS) {
-		ret = internalSetCtrlValue(mBrightness, brightness, uvc_get_brightness, uvc_set_brightness);
-	}
-	RETURN(ret, int);
+	RETURN(setCtrlValue(CONTROL_BRIGHTNESS, brightness), int);
 }
 
-// 明るさの現在値を取得
 int UVCCamera::getBrightness() {
 	ENTER();
-	if (mPUSupports & PU_BRIGHTNESS) {
-		int ret = update_ctrl_values(mDeviceHandle, mBrightness, uvc_get_brightness);
-		if (LIKELY(!ret)) {	// 正常に最小・最大値を取得出来た時
-			int16_t value;
-			ret = uvc_get_brightness(mDeviceHandle, &value, UVC_GET_CUR);
-			if (LIKELY(!ret))
-				return value;
-		}
-	}
-	RETURN(0, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_BRIGHTNESS, value);
+	RETURN(LIKELY(!ret) ? value : 0, int);
 }
 
 //======================================================================
 // コントラスト調整
 int UVCCamera::updateContrastLimit(int &min, int &max, int &def) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & PU_CONTRAST) {
-		UPDATE_CTRL_VALUES(mContrast, uvc_get_contrast);
-	}
-	RETURN(ret, int);
+	RETURN(updateCtrlLimit(CONTROL_CONTRAST, min, max, def), int);
 }
 
-// コントラストを設定
 int UVCCamera::setContrast(uint16_t contrast) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & PU_CONTRAST) {
-		ret = internalSetCtrlValue(mContrast, contrast, uvc_get_contrast, uvc_set_contrast);
-	}
-	RETURN(ret, int);
+	RETURN(setCtrlValue(CONTROL_CONTRAST, contrast), int);
 }
 
-// コントラストの現在値を取得
 int UVCCamera::getContrast() {
 	ENTER();
-	if (mPUSupports & PU_CONTRAST) {
-		int ret = update_ctrl_values(mDeviceHandle, mContrast, uvc_get_contrast);
-		if (LIKELY(!ret)) {	// 正常に最小・最大値を取得出来た時
-			uint16_t value;
-			ret = uvc_get_contrast(mDeviceHandle, &value, UVC_GET_CUR);
-			if (LIKELY(!ret))
-				return value;
-		}
-	}
-	RETURN(0, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_CONTRAST, value);
+	RETURN(LIKELY(!ret) ? value : 0, int);
 }
 
 //======================================================================
 // オートコントラスト
 int UVCCamera::updateAutoContrastLimit(int &min, int &max, int &def) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & PU_CONTRAST_AUTO) {
-		UPDATE_CTRL_VALUES(mAutoFocus, uvc_get_contrast_auto);
-	}
-	RETURN(ret, int);
+	RETURN(updateCtrlLimit(CONTROL_AUTO_CONTRAST, min, max, def), int);
 }
 
-// オートコントラストをon/off
 int UVCCamera::setAutoContrast(bool autoContrast) {
 	ENTER();
-
-	int r = UVC_ERROR_ACCESS;
-	if LIKELY((mDeviceHandle) && (mPUSupports & PU_CONTRAST_AUTO)) {
-		r = uvc_set_contrast_auto(mDeviceHandle, autoContrast);
-	}
-	RETURN(r, int);
+	RETURN(setCtrlValue(CONTROL_AUTO_CONTRAST, autoContrast), int);
 }
 
-// オートコントラストのon/off状態を取得
 bool UVCCamera::getAutoContrast() {
 	ENTER();
-	int r = UVC_ERROR_ACCESS;
-	if LIKELY((mDeviceHandle) && (mPUSupports & PU_CONTRAST_AUTO)) {
-		uint8_t autoContrast;
-		r = uvc_get_contrast_auto(mDeviceHandle, &autoContrast, UVC_GET_CUR);
-		if (LIKELY(!r))
-			r = autoContrast;
-	}
-	RETURN(r, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_AUTO_CONTRAST, value);
+	RETURN(LIKELY(!ret) ? value : ret, int);
 }
 
 //======================================================================
 // シャープネス調整
 int UVCCamera::updateSharpnessLimit(int &min, int &max, int &def) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & PU_SHARPNESS) {
-		UPDATE_CTRL_VALUES(mSharpness, uvc_get_sharpness);
-	}
-	RETURN(ret, int);
+	RETURN(updateCtrlLimit(CONTROL_SHARPNESS, min, max, def), int);
 }
 
-// シャープネスを設定
 int UVCCamera::setSharpness(int sharpness) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & PU_SHARPNESS) {
-		ret = internalSetCtrlValue(mSharpness, sharpness, uvc_get_sharpness, uvc_set_sharpness);
-	}
-	RETURN(ret, int);
+	RETURN(setCtrlValue(CONTROL_SHARPNESS, sharpness), int);
 }
 
-// シャープネスの現在値を取得
 int UVCCamera::getSharpness() {
 	ENTER();
-	if (mPUSupports & PU_SHARPNESS) {
-		int ret = update_ctrl_values(mDeviceHandle, mSharpness, uvc_get_sharpness);
-		if (LIKELY(!ret)) {	// 正常に最小・最大値を取得出来た時
-			uint16_t value;
-			ret = uvc_get_sharpness(mDeviceHandle, &value, UVC_GET_CUR);
-			if (LIKELY(!ret))
-				return value;
-		}
-	}
-	RETURN(0, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_SHARPNESS, value);
+	RETURN(LIKELY(!ret) ? value : 0, int);
 }
 
 //======================================================================
 // ゲイン調整
 int UVCCamera::updateGainLimit(int &min, int &max, int &def) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & PU_GAIN) {
-		UPDATE_CTRL_VALUES(mGain, uvc_get_gain)
-	}
-	RETURN(ret, int);
+	RETURN(updateCtrlLimit(CONTROL_GAIN, min, max, def), int);
 }
 
-// ゲインを設定
 int UVCCamera::setGain(int gain) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & PU_GAIN) {
-//		LOGI("gain:%d", gain);
-		ret = internalSetCtrlValue(mGain, gain, uvc_get_gain, uvc_set_gain);
-	}
-	RETURN(ret, int);
+	RETURN(setCtrlValue(CONTROL_GAIN, gain), int);
 }
 
-// ゲインの現在値を取得
 int UVCCamera::getGain() {
 	ENTER();
-	if (mPUSupports & PU_GAIN) {
-		int ret = update_ctrl_values(mDeviceHandle, mGain, uvc_get_gain);
-		if (LIKELY(!ret)) {	// 正常に最小・最大値を取得出来た時
-			uint16_t value;
-			ret = uvc_get_gain(mDeviceHandle, &value, UVC_GET_CUR);
-//			LOGI("gain:%d", value);
-			if (LIKELY(!ret))
-				return value;
-		}
-	}
-	RETURN(0, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_GAIN, value);
+	RETURN(LIKELY(!ret) ? value : 0, int);
 }
 
 //======================================================================
 // オートホワイトバランス(temp)
 int UVCCamera::updateAutoWhiteBlanceLimit(int &min, int &max, int &def) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & PU_WB_TEMP_AUTO) {
-		UPDATE_CTRL_VALUES(mAutoWhiteBlance, uvc_get_white_balance_temperature_auto);
-	}
-	RETURN(ret, int);
+	RETURN(updateCtrlLimit(CONTROL_AUTO_WHITE_BLANCE, min, max, def), int);
 }
 
-// オートホワイトバランス(temp)をon/off
 int UVCCamera::setAutoWhiteBlance(bool autoWhiteBlance) {
 	ENTER();
-	int r = UVC_ERROR_ACCESS;
-	if LIKELY((mDeviceHandle) && (mPUSupports & PU_WB_TEMP_AUTO)) {
-		r = uvc_set_white_balance_temperature_auto(mDeviceHandle, autoWhiteBlance);
-	}
-	RETURN(r, int);
+	RETURN(setCtrlValue(CONTROL_AUTO_WHITE_BLANCE, autoWhiteBlance), int);
 }
 
-// オートホワイトバランス(temp)のon/off状態を取得
 bool UVCCamera::getAutoWhiteBlance() {
 	ENTER();
-	int r = UVC_ERROR_ACCESS;
-	if LIKELY((mDeviceHandle) && (mPUSupports & PU_WB_TEMP_AUTO)) {
-		uint8_t autoWhiteBlance;
-		r = uvc_get_white_balance_temperature_auto(mDeviceHandle, &autoWhiteBlance, UVC_GET_CUR);
-		if (LIKELY(!r))
-			r = autoWhiteBlance;
-	}
-	RETURN(r, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_AUTO_WHITE_BLANCE, value);
+	RETURN(LIKELY(!ret) ? value : ret, int);
 }
 
 //======================================================================
 // オートホワイトバランス(compo)
 int UVCCamera::updateAutoWhiteBlanceCompoLimit(int &min, int &max, int &def) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & PU_WB_COMPO_AUTO) {
-		UPDATE_CTRL_VALUES(mAutoWhiteBlanceCompo, uvc_get_white_balance_component_auto);
-	}
-	RETURN(ret, int);
+	RETURN(updateCtrlLimit(CONTROL_AUTO_WHITE_BLANCE_COMPO, min, max, def), int);
 }
 
-// オートホワイトバランス(compo)をon/off
 int UVCCamera::setAutoWhiteBlanceCompo(bool autoWhiteBlanceCompo) {
 	ENTER();
-	int r = UVC_ERROR_ACCESS;
-	if LIKELY((mDeviceHandle) && (mPUSupports & PU_WB_COMPO_AUTO)) {
-		r = uvc_set_white_balance_component_auto(mDeviceHandle, autoWhiteBlanceCompo);
-	}
-	RETURN(r, int);
+	RETURN(setCtrlValue(CONTROL_AUTO_WHITE_BLANCE_COMPO, autoWhiteBlanceCompo), int);
 }
 
-// オートホワイトバランス(compo)のon/off状態を取得
 bool UVCCamera::getAutoWhiteBlanceCompo() {
 	ENTER();
-	int r = UVC_ERROR_ACCESS;
-	if LIKELY((mDeviceHandle) && (mPUSupports & PU_WB_COMPO_AUTO)) {
-		uint8_t autoWhiteBlanceCompo;
-		r = uvc_get_white_balance_component_auto(mDeviceHandle, &autoWhiteBlanceCompo, UVC_GET_CUR);
-		if (LIKELY(!r))
-			r = autoWhiteBlanceCompo;
-	}
-	RETURN(r, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_AUTO_WHITE_BLANCE_COMPO, value);
+	RETURN(LIKELY(!ret) ? value : ret, int);
 }
 
 //======================================================================
 // ホワイトバランス色温度調整
 int UVCCamera::updateWhiteBlanceLimit(int &min, int &max, int &def) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & PU_WB_TEMP) {
-		UPDATE_CTRL_VALUES(mWhiteBlance, uvc_get_white_balance_temperature)
-	}
-	RETURN(ret, int);
+	RETURN(updateCtrlLimit(CONTROL_WHITE_BLANCE, min, max, def), int);
 }
 
-// ホワイトバランス色温度を設定
 int UVCCamera::setWhiteBlance(int white_blance) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & PU_WB_TEMP) {
-		ret = internalSetCtrlValue(mWhiteBlance, white_blance,
-			uvc_get_white_balance_temperature, uvc_set_white_balance_temperature);
-	}
-	RETURN(ret, int);
+	RETURN(setCtrlValue(CONTROL_WHITE_BLANCE, white_blance), int);
 }
 
-// ホワイトバランス色温度の現在値を取得
 int UVCCamera::getWhiteBlance() {
 	ENTER();
-	if (mPUSupports & PU_WB_TEMP) {
-		int ret = update_ctrl_values(mDeviceHandle, mWhiteBlance, uvc_get_white_balance_temperature);
-		if (LIKELY(!ret)) {	// 正常に最小・最大値を取得出来た時
-			uint16_t value;
-			ret = uvc_get_white_balance_temperature(mDeviceHandle, &value, UVC_GET_CUR);
-			if (LIKELY(!ret))
-				return value;
-		}
-	}
-	RETURN(0, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_WHITE_BLANCE, value);
+	RETURN(LIKELY(!ret) ? value : 0, int);
 }
 
 //======================================================================
 // ホワイトバランスcompo調整
 int UVCCamera::updateWhiteBlanceCompoLimit(int &min, int &max, int &def) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & PU_WB_COMPO) {
-		UPDATE_CTRL_VALUES(mWhiteBlanceCompo, uvc_get_white_balance_component)
-	}
-	RETURN(ret, int);
+	RETURN(updateCtrlLimit(CONTROL_WHITE_BLANCE_COMPO, min, max, def), int);
 }
 
-// ホワイトバランスcompoを設定
 int UVCCamera::setWhiteBlanceCompo(int white_blance_compo) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & PU_WB_COMPO) {
-		ret = internalSetCtrlValue(mWhiteBlanceCompo, white_blance_compo,
-			uvc_get_white_balance_component, uvc_set_white_balance_component);
-	}
-	RETURN(ret, int);
+	RETURN(setCtrlValue(CONTROL_WHITE_BLANCE_COMPO, white_blance_compo), int);
 }
 
-// ホワイトバランスcompoの現在値を取得
 int UVCCamera::getWhiteBlanceCompo() {
 	ENTER();
-	if (mPUSupports & PU_WB_COMPO) {
-		int ret = update_ctrl_values(mDeviceHandle, mWhiteBlanceCompo, uvc_get_white_balance_component);
-		if (LIKELY(!ret)) {	// 正常に最小・最大値を取得出来た時
-			uint32_t white_blance_compo;
-			ret = uvc_get_white_balance_component(mDeviceHandle, &white_blance_compo, UVC_GET_CUR);
-			if (LIKELY(!ret))
-				return white_blance_compo;
-		}
-	}
-	RETURN(0, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_WHITE_BLANCE_COMPO, value);
+	RETURN(LIKELY(!ret) ? value : 0, int);
 }
 
 //======================================================================
 // ガンマ調整
 int UVCCamera::updateGammaLimit(int &min, int &max, int &def) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & PU_GAMMA) {
-		UPDATE_CTRL_VALUES(mGamma, uvc_get_gamma)
-	}
-	RETURN(ret, int);
+	RETURN(updateCtrlLimit(CONTROL_GAMMA, min, max, def), int);
 }
 
-// ガンマを設定
 int UVCCamera::setGamma(int gamma) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & PU_GAMMA) {
-//		LOGI("gamma:%d", gamma);
-		ret = internalSetCtrlValue(mGamma, gamma, uvc_get_gamma, uvc_set_gamma);
-	}
-	RETURN(ret, int);
+	RETURN(setCtrlValue(CONTROL_GAMMA, gamma), int);
 }
 
-// ガンマの現在値を取得
 int UVCCamera::getGamma() {
 	ENTER();
-	if (mPUSupports & PU_GAMMA) {
-		int ret = update_ctrl_values(mDeviceHandle, mGamma, uvc_get_gamma);
-		if (LIKELY(!ret)) {	// 正常に最小・最大値を取得出来た時
-			uint16_t value;
-			ret = uvc_get_gamma(mDeviceHandle, &value, UVC_GET_CUR);
-//			LOGI("gamma:%d", ret);
-			if (LIKELY(!ret))
-				return value;
-		}
-	}
-	RETURN(0, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_GAMMA, value);
+	RETURN(LIKELY(!ret) ? value : 0, int);
 }
 
 //======================================================================
 // 彩度調整
 int UVCCamera::updateSaturationLimit(int &min, int &max, int &def) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & PU_SATURATION) {
-		UPDATE_CTRL_VALUES(mSaturation, uvc_get_saturation)
-	}
-	RETURN(ret, int);
+	RETURN(updateCtrlLimit(CONTROL_SATURATION, min, max, def), int);
 }
 
-// 彩度を設定
 int UVCCamera::setSaturation(int saturation) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & PU_SATURATION) {
-		ret = internalSetCtrlValue(mSaturation, saturation, uvc_get_saturation, uvc_set_saturation);
-	}
-	RETURN(ret, int);
+	RETURN(setCtrlValue(CONTROL_SATURATION, saturation), int);
 }
 
-// 彩度の現在値を取得
 int UVCCamera::getSaturation() {
 	ENTER();
-	if (mPUSupports & PU_SATURATION) {
-		int ret = update_ctrl_values(mDeviceHandle, mSaturation, uvc_get_saturation);
-		if (LIKELY(!ret)) {	// 正常に最小・最大値を取得出来た時
-			uint16_t value;
-			ret = uvc_get_saturation(mDeviceHandle, &value, UVC_GET_CUR);
-			if (LIKELY(!ret))
-				return value;
-		}
-	}
-	RETURN(0, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_SATURATION, value);
+	RETURN(LIKELY(!ret) ? value : 0, int);
 }
 
 //======================================================================
 // 色相調整
 int UVCCamera::updateHueLimit(int &min, int &max, int &def) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & PU_HUE) {
-		UPDATE_CTRL_VALUES(mHue, uvc_get_hue)
-	}
-	RETURN(ret, int);
+	RETURN(updateCtrlLimit(CONTROL_HUE, min, max, def), int);
 }
 
-// 色相を設定
 int UVCCamera::setHue(int hue) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & PU_HUE) {
-		ret = internalSetCtrlValue(mHue, hue, uvc_get_hue, uvc_set_hue);
-	}
-	RETURN(ret, int);
+	RETURN(setCtrlValue(CONTROL_HUE, hue), int);
 }
 
-// 色相の現在値を取得
 int UVCCamera::getHue() {
 	ENTER();
-	if (mPUSupports & PU_HUE) {
-		int ret = update_ctrl_values(mDeviceHandle, mHue, uvc_get_hue);
-		if (LIKELY(!ret)) {	// 正常に最小・最大値を取得出来た時
-			int16_t value;
-			ret = uvc_get_hue(mDeviceHandle, &value, UVC_GET_CUR);
-			if (LIKELY(!ret))
-				return value;
-		}
-	}
-	RETURN(0, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_HUE, value);
+	RETURN(LIKELY(!ret) ? value : 0, int);
 }
 
 //======================================================================
 // オート色相
 int UVCCamera::updateAutoHueLimit(int &min, int &max, int &def) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & PU_HUE_AUTO) {
-		UPDATE_CTRL_VALUES(mAutoHue, uvc_get_hue_auto);
-	}
-	RETURN(ret, int);
+	RETURN(updateCtrlLimit(CONTROL_AUTO_HUE, min, max, def), int);
 }
 
-// オート色相をon/off
 int UVCCamera::setAutoHue(bool autoHue) {
 	ENTER();
-
-	int r = UVC_ERROR_ACCESS;
-	if LIKELY((mDeviceHandle) && (mPUSupports & PU_HUE_AUTO)) {
-		r = uvc_set_hue_auto(mDeviceHandle, autoHue);
-	}
-	RETURN(r, int);
+	RETURN(setCtrlValue(CONTROL_AUTO_HUE, autoHue), int);
 }
 
-// オート色相のon/off状態を取得
 bool UVCCamera::getAutoHue() {
 	ENTER();
-	int r = UVC_ERROR_ACCESS;
-	if LIKELY((mDeviceHandle) && (mPUSupports & PU_HUE_AUTO)) {
-		uint8_t autoHue;
-		r = uvc_get_hue_auto(mDeviceHandle, &autoHue, UVC_GET_CUR);
-		if (LIKELY(!r))
-			r = autoHue;
-	}
-	RETURN(r, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_AUTO_HUE, value);
+	RETURN(LIKELY(!ret) ? value : ret, int);
 }
 
 //======================================================================
 // 電源周波数によるチラつき補正
 int UVCCamera::updatePowerlineFrequencyLimit(int &min, int &max, int &def) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mCtrlSupports & PU_POWER_LF) {
-		UPDATE_CTRL_VALUES(mPowerlineFrequency, uvc_get_powerline_freqency)
-	}
-	RETURN(ret, int);
+	RETURN(updateCtrlLimit(CONTROL_POWERLINE_FREQUENCY, min, max, def), int);
 }
 
-// 電源周波数によるチラつき補正を設定
+// frequency<0の時はデフォルト値
 int UVCCamera::setPowerlineFrequency(int frequency) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & PU_POWER_LF) {
+	int ret = UVC_ERROR_ACCESS;
+	pthread_mutex_lock(&control_mutex);
+	if (isCtrlSupported(CONTROL_POWERLINE_FREQUENCY)) {
+		ret = UVC_SUCCESS;
 		if (frequency < 0) {
-			uint8_t value;
-			ret = uvc_get_powerline_freqency(mDeviceHandle, &value, UVC_GET_DEF);
-			if LIKELY(ret)
-				frequency = value;
-			else
-				RETURN(ret, int);
+			int32_t value;
+			ret = queryCtrlValue(CONTROL_POWERLINE_FREQUENCY, UVC_GET_DEF, value);
+			frequency = value;
+		}
+		if (LIKELY(!ret)) {
+			LOGD("frequency:%d", frequency);
+			ret = writeCtrlValue(CONTROL_POWERLINE_FREQUENCY, frequency);
 		}
-		LOGD("frequency:%d", frequency);
-		ret = uvc_set_powerline_freqency(mDeviceHandle, frequency);
 	}
-
+	pthread_mutex_unlock(&control_mutex);
 	RETURN(ret, int);
 }
 
-// 電源周波数によるチラつき補正値を取得
 int UVCCamera::getPowerlineFrequency() {
 	ENTER();
-	if (mPUSupports & PU_POWER_LF) {
-		uint8_t value;
-		int ret = uvc_get_powerline_freqency(mDeviceHandle, &value, UVC_GET_CUR);
-		LOGD("frequency:%d", ret);
-		if (LIKELY(!ret))
-			return value;
-	}
-	RETURN(0, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_POWERLINE_FREQUENCY, value);
+	RETURN(LIKELY(!ret) ? value : 0, int);
 }
 
 //======================================================================
 // ズーム(abs)調整
 int UVCCamera::updateZoomLimit(int &min, int &max, int &def) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mCtrlSupports & CTRL_ZOOM_ABS) {
-		UPDATE_CTRL_VALUES(mZoom, uvc_get_zoom_abs)
-	}
-	RETURN(ret, int);
+	RETURN(updateCtrlLimit(CONTROL_ZOOM, min, max, def), int);
 }
 
-// ズーム(abs)を設定
 int UVCCamera::setZoom(int zoom) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mCtrlSupports & CTRL_ZOOM_ABS) {
-		ret = internalSetCtrlValue(mZoom, zoom, uvc_get_zoom_abs, uvc_set_zoom_abs);
-	}
-	RETURN(ret, int);
+	RETURN(setCtrlValue(CONTROL_ZOOM, zoom), int);
 }
 
-// ズーム(abs)の現在値を取得
 int UVCCamera::getZoom() {
 	ENTER();
-	if (mCtrlSupports & CTRL_ZOOM_ABS) {
-		int ret = update_ctrl_values(mDeviceHandle, mZoom, uvc_get_zoom_abs);
-		if (LIKELY(!ret)) {	// 正常に最小・最大値を取得出来た時
-			uint16_t value;
-			ret = uvc_get_zoom_abs(mDeviceHandle, &value, UVC_GET_CUR);
-			if (LIKELY(!ret))
-				return value;
-		}
-	}
-	RETURN(0, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_ZOOM, value);
+	RETURN(LIKELY(!ret) ? value : 0, int);
 }
 
 //======================================================================
 // Control UVC Camera
 int UVCCamera::sendCommand(int command) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	ret = internalSetCtrlValue(command, uvc_set_zoom_abs);
+	int ret = UVC_ERROR_INVALID_DEVICE;
+	if (LIKELY(mDeviceHandle)) {
+		pthread_mutex_lock(&control_mutex);
+		ret = writeCtrlValue(CONTROL_ZOOM, command);	// without range check
+		pthread_mutex_unlock(&control_mutex);
+	}
 	RETURN(ret, int);
 }
 
@@ -2154,186 +2396,93 @@ int UVCCamera::sendCommand(int command) {
 // ズーム(相対値)調整
 int UVCCamera::updateZoomRelLimit(int &min, int &max, int &def) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mCtrlSupports & CTRL_ZOOM_REL) {
-		UPDATE_CTRL_VALUES(mZoomRel, uvc_get_zoom_rel)
-	}
-	RETURN(ret, int);
+	RETURN(updateCtrlLimit(CONTROL_ZOOM_REL, min, max, def), int);
 }
 
-// ズーム(相対値)を設定
 int UVCCamera::setZoomRel(int zoom) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mCtrlSupports & CTRL_ZOOM_REL) {
-		ret = internalSetCtrlValue(mZoomRel,
-			(int8_t)((zoom >> 16) & 0xff), (uint8_t)((zoom >> 8) & 0xff), (uint8_t)(zoom & 0xff),
-			uvc_get_zoom_rel, uvc_set_zoom_rel);
-	}
-	RETURN(ret, int);
+	RETURN(setCtrlValue(CONTROL_ZOOM_REL, zoom), int);
 }
 
-// ズーム(相対値)の現在値を取得
 int UVCCamera::getZoomRel() {
 	ENTER();
-	if (mCtrlSupports & CTRL_ZOOM_REL) {
-		int ret = update_ctrl_values(mDeviceHandle, mZoomRel, uvc_get_zoom_rel);
-		if (LIKELY(!ret)) {	// 正常に最小・最大値を取得出来た時
-			int8_t zoom;
-			uint8_t isdigital;
-			uint8_t speed;
-			ret = uvc_get_zoom_rel(mDeviceHandle, &zoom, &isdigital, &speed, UVC_GET_CUR);
-			if (LIKELY(!ret))
-				return (zoom << 16) +(isdigital << 8) + speed;
-		}
-	}
-	RETURN(0, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_ZOOM_REL, value);
+	RETURN(LIKELY(!ret) ? value : 0, int);
 }
 
 //======================================================================
 // digital multiplier調整
 int UVCCamera::updateDigitalMultiplierLimit(int &min, int &max, int &def) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & PU_DIGITAL_MULT) {
-		UPDATE_CTRL_VALUES(mMultiplier, uvc_get_digital_multiplier)
-	}
-	RETURN(ret, int);
+	RETURN(updateCtrlLimit(CONTROL_DIGITAL_MULTIPLIER, min, max, def), int);
 }
 
-// digital multiplierを設定
 int UVCCamera::setDigitalMultiplier(int multiplier) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & PU_DIGITAL_MULT) {
-//		LOGI("multiplier:%d", multiplier);
-		ret = internalSetCtrlValue(mMultiplier, multiplier, uvc_get_digital_multiplier, uvc_set_digital_multiplier);
-	}
-	RETURN(ret, int);
+	RETURN(setCtrlValue(CONTROL_DIGITAL_MULTIPLIER, multiplier), int);
 }
 
-// digital multiplierの現在値を取得
 int UVCCamera::getDigitalMultiplier() {
 	ENTER();
-	if (mPUSupports & PU_DIGITAL_MULT) {
-		int ret = update_ctrl_values(mDeviceHandle, mMultiplier, uvc_get_digital_multiplier);
-		if (LIKELY(!ret)) {	// 正常に最小・最大値を取得出来た時
-			uint16_t multiplier;
-			ret = uvc_get_digital_multiplier(mDeviceHandle, &multiplier, UVC_GET_CUR);
-//			LOGI("multiplier:%d", multiplier);
-			if (LIKELY(!ret))
-				return multiplier;
-		}
-	}
-	RETURN(0, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_DIGITAL_MULTIPLIER, value);
+	RETURN(LIKELY(!ret) ? value : 0, int);
 }
 
 //======================================================================
 // digital multiplier limit調整
 int UVCCamera::updateDigitalMultiplierLimitLimit(int &min, int &max, int &def) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & PU_DIGITAL_LIMIT) {
-		UPDATE_CTRL_VALUES(mMultiplierLimit, uvc_get_digital_multiplier_limit)
-	}
-	RETURN(ret, int);
+	RETURN(updateCtrlLimit(CONTROL_DIGITAL_MULTIPLIER_LIMIT, min, max, def), int);
 }
 
-// digital multiplier limitを設定
 int UVCCamera::setDigitalMultiplierLimit(int multiplier_limit) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & PU_DIGITAL_LIMIT) {
-//		LOGI("multiplier limit:%d", multiplier_limit);
-		ret = internalSetCtrlValue(mMultiplierLimit, multiplier_limit, uvc_get_digital_multiplier_limit, uvc_set_digital_multiplier_limit);
-	}
-	RETURN(ret, int);
+	RETURN(setCtrlValue(CONTROL_DIGITAL_MULTIPLIER_LIMIT, multiplier_limit), int);
 }
 
-// digital multiplier limitの現在値を取得
 int UVCCamera::getDigitalMultiplierLimit() {
 	ENTER();
-	if (mPUSupports & PU_DIGITAL_LIMIT) {
-		int ret = update_ctrl_values(mDeviceHandle, mMultiplierLimit, uvc_get_digital_multiplier_limit);
-		if (LIKELY(!ret)) {	// 正常に最小・最大値を取得出来た時
-			uint16_t multiplier_limit;
-			ret = uvc_get_digital_multiplier_limit(mDeviceHandle, &multiplier_limit, UVC_GET_CUR);
-//			LOGI("multiplier_limit:%d", multiplier_limit);
-			if (LIKELY(!ret))
-				return multiplier_limit;
-		}
-	}
-	RETURN(0, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_DIGITAL_MULTIPLIER_LIMIT, value);
+	RETURN(LIKELY(!ret) ? value : 0, int);
 }
 
 //======================================================================
 // AnalogVideoStandard
 int UVCCamera::updateAnalogVideoStandardLimit(int &min, int &max, int &def) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & PU_AVIDEO_STD) {
-		UPDATE_CTRL_VALUES(mAnalogVideoStandard, uvc_get_analog_video_standard)
-	}
-	RETURN(ret, int);
+	RETURN(updateCtrlLimit(CONTROL_ANALOG_VIDEO_STANDARD, min, max, def), int);
 }
 
 int UVCCamera::setAnalogVideoStandard(int standard) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & PU_AVIDEO_STD) {
-//		LOGI("standard:%d", standard);
-		ret = internalSetCtrlValue(mAnalogVideoStandard, standard, uvc_get_analog_video_standard, uvc_set_analog_video_standard);
-	}
-	RETURN(ret, int);
+	RETURN(setCtrlValue(CONTROL_ANALOG_VIDEO_STANDARD, standard), int);
 }
 
 int UVCCamera::getAnalogVideoStandard() {
 	ENTER();
-	if (mPUSupports & PU_AVIDEO_STD) {
-		int ret = update_ctrl_values(mDeviceHandle, mAnalogVideoStandard, uvc_get_analog_video_standard);
-		if (LIKELY(!ret)) {	// 正常に最小・最大値を取得出来た時
-			uint8_t standard;
-			ret = uvc_get_analog_video_standard(mDeviceHandle, &standard, UVC_GET_CUR);
-//			LOGI("standard:%d", standard);
-			if (LIKELY(!ret))
-				return standard;
-		}
-	}
-	RETURN(0, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_ANALOG_VIDEO_STANDARD, value);
+	RETURN(LIKELY(!ret) ? value : 0, int);
 }
 
 //======================================================================
 // AnalogVideoLoackStatus
 int UVCCamera::updateAnalogVideoLockStateLimit(int &min, int &max, int &def) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & PU_AVIDEO_LOCK) {
-		UPDATE_CTRL_VALUES(mAnalogVideoLockState, uvc_get_analog_video_lockstate)
-	}
-	RETURN(ret, int);
+	RETURN(updateCtrlLimit(CONTROL_ANALOG_VIDEO_LOCK_STATE, min, max, def), int);
 }
 
 int UVCCamera::setAnalogVideoLockState(int state) {
 	ENTER();
-	int ret = UVC_ERROR_IO;
-	if (mPUSupports & PU_AVIDEO_LOCK) {
-//		LOGI("status:%d", status);
-		ret = internalSetCtrlValue(mAnalogVideoLockState, state, uvc_get_analog_video_lockstate, uvc_set_analog_video_lockstate);
-	}
-	RETURN(ret, int);
+	RETURN(setCtrlValue(CONTROL_ANALOG_VIDEO_LOCK_STATE, state), int);
 }
 
 int UVCCamera::getAnalogVideoLockState() {
 	ENTER();
-	if (mPUSupports & PU_AVIDEO_LOCK) {
-		int ret = update_ctrl_values(mDeviceHandle, mAnalogVideoLockState, uvc_get_analog_video_lockstate);
-		if (LIKELY(!ret)) {	// 正常に最小・最大値を取得出来た時
-			uint8_t status;
-			ret = uvc_get_analog_video_lockstate(mDeviceHandle, &status, UVC_GET_CUR);
-//			LOGI("status:%d", status);
-			if (LIKELY(!ret))
-				return status;
-		}
-	}
-	RETURN(0, int);
+	int32_t value;
+	const int ret = getCtrlValue(CONTROL_ANALOG_VIDEO_LOCK_STATE, value);
+	RETURN(LIKELY(!ret) ? value : 0, int);
 }
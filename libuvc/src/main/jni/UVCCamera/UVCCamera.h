@@ -34,6 +34,10 @@
 #include "UVCStatusCallback.h"
 #include "UVCButtonCallback.h"
 #include "UVCPreview.h"
+#include "ControlQueue.h"
+#include "ExtensionUnits.h"
+#include "PtzController.h"
+#include "AeAwbLoop.h"
 
 #define	CTRL_SCANNING		0x000001	// D0:  Scanning Mode
 #define	CTRL_AE				0x000002	// D1:  Auto-Exposure Mode
@@ -56,6 +60,7 @@
 #define CTRL_PRIVACY		0x040000	// D18: Privacy
 #define CTRL_FOCUS_SIMPLE	0x080000	// D19: Focus, Simple
 #define CTRL_WINDOW			0x100000	// D20: Window
+#define CTRL_ROI			0x200000	// D21: Region of Interest
 
 #define PU_BRIGHTNESS		0x000001	// D0: Brightness
 #define PU_CONTRAST			0x000002	// D1: Contrast
@@ -77,35 +82,95 @@
 #define PU_AVIDEO_LOCK		0x020000	// D17: Analog Video Lock Status
 #define PU_CONTRAST_AUTO	0x040000	// D18: Contrast, Auto
 
+// control id for setControl/setControlAsync, same as UVCCamera.java
+#define CONTROL_SCANNING_MODE				0
+#define CONTROL_EXPOSURE_MODE				1
+#define CONTROL_EXPOSURE_PRIORITY			2
+#define CONTROL_EXPOSURE					3
+#define CONTROL_EXPOSURE_REL				4
+#define CONTROL_AUTO_FOCUS					5
+#define CONTROL_FOCUS						6
+#define CONTROL_FOCUS_REL					7
+#define CONTROL_IRIS						8
+#define CONTROL_IRIS_REL					9
+#define CONTROL_ZOOM						10
+#define CONTROL_ZOOM_REL					11
+#define CONTROL_PAN							12
+#define CONTROL_TILT						13
+#define CONTROL_ROLL						14
+#define CONTROL_PAN_REL						15
+#define CONTROL_TILT_REL					16
+#define CONTROL_ROLL_REL					17
+#define CONTROL_PRIVACY						18
+#define CONTROL_AUTO_WHITE_BLANCE			19
+#define CONTROL_AUTO_WHITE_BLANCE_COMPO		20
+#define CONTROL_WHITE_BLANCE				21
+#define CONTROL_WHITE_BLANCE_COMPO			22
+#define CONTROL_BACKLIGHT_COMP				23
+#define CONTROL_BRIGHTNESS					24
+#define CONTROL_CONTRAST					25
+#define CONTROL_AUTO_CONTRAST				26
+#define CONTROL_SHARPNESS					27
+#define CONTROL_GAIN						28
+#define CONTROL_GAMMA						29
+#define CONTROL_SATURATION					30
+#define CONTROL_HUE							31
+#define CONTROL_AUTO_HUE					32
+#define CONTROL_POWERLINE_FREQUENCY			33
+#define CONTROL_DIGITAL_MULTIPLIER			34
+#define CONTROL_DIGITAL_MULTIPLIER_LIMIT	35
+#define CONTROL_ANALOG_VIDEO_STANDARD		36
+#define CONTROL_ANALOG_VIDEO_LOCK_STATE		37
+#define CONTROL_NUM							38
+
 typedef struct control_value {
-	int res;	// unused
+	int res;	// filled by probeControls
 	int min;
 	int max;
 	int def;
 	int current;
 } control_value_t;
 
-typedef uvc_error_t (*paramget_func_i8)(uvc_device_handle_t *devh, int8_t *value, enum uvc_req_code req_code);
-typedef uvc_error_t (*paramget_func_i16)(uvc_device_handle_t *devh, int16_t *value, enum uvc_req_code req_code);
-typedef uvc_error_t (*paramget_func_i32)(uvc_device_handle_t *devh, int32_t *value, enum uvc_req_code req_code);
-typedef uvc_error_t (*paramget_func_u8)(uvc_device_handle_t *devh, uint8_t *value, enum uvc_req_code req_code);
-typedef uvc_error_t (*paramget_func_u16)(uvc_device_handle_t *devh, uint16_t *value, enum uvc_req_code req_code);
-typedef uvc_error_t (*paramget_func_u32)(uvc_device_handle_t *devh, uint32_t *value, enum uvc_req_code req_code);
-typedef uvc_error_t (*paramget_func_u8u8)(uvc_device_handle_t *devh, uint8_t *value1, uint8_t *value2, enum uvc_req_code req_code);
-typedef uvc_error_t (*paramget_func_i8u8)(uvc_device_handle_t *devh, int8_t *value1, uint8_t *value2, enum uvc_req_code req_code);
-typedef uvc_error_t (*paramget_func_i8u8u8)(uvc_device_handle_t *devh, int8_t *value1, uint8_t *value2, uint8_t *value3, enum uvc_req_code req_code);
-typedef uvc_error_t (*paramget_func_i32i32)(uvc_device_handle_t *devh, int32_t *value1, int32_t *value2, enum uvc_req_code req_code);
-
-typedef uvc_error_t (*paramset_func_i8)(uvc_device_handle_t *devh, int8_t value);
-typedef uvc_error_t (*paramset_func_i16)(uvc_device_handle_t *devh, int16_t value);
-typedef uvc_error_t (*paramset_func_i32)(uvc_device_handle_t *devh, int32_t value);
-typedef uvc_error_t (*paramset_func_u8)(uvc_device_handle_t *devh, uint8_t value);
-typedef uvc_error_t (*paramset_func_u16)(uvc_device_handle_t *devh, uint16_t value);
-typedef uvc_error_t (*paramset_func_u32)(uvc_device_handle_t *devh, uint32_t value);
-typedef uvc_error_t (*paramset_func_u8u8)(uvc_device_handle_t *devh, uint8_t value1, uint8_t value2);
-typedef uvc_error_t (*paramset_func_i8u8)(uvc_device_handle_t *devh, int8_t value1, uint8_t value2);
-typedef uvc_error_t (*paramset_func_i8u8u8)(uvc_device_handle_t *devh, int8_t value1, uint8_t value2, uint8_t value3);
-typedef uvc_error_t (*paramset_func_i32i32)(uvc_device_handle_t *devh, int32_t value1, int32_t value2);
+class UVCCamera;
+class ControlProfile;
+
+#define CONTROL_UNIT_CT		0	// camera terminal
+#define CONTROL_UNIT_PU		1	// processing unit
+
+#define CONTROL_TYPE_UNSIGNED	0	// little endian
+#define CONTROL_TYPE_SIGNED		1	// little endian
+#define CONTROL_TYPE_PACKED		2	// byte fields packed into int as big endian, first one is signed
+#define CONTROL_TYPE_ENUM		3	// unsigned, mode/bitmap/on-off without range, not clamped
+
+#define CONTROL_MAX_LEN			8	// longest wLength of CT/PU controls here(pan/tilt)
+
+// wire format of a control
+typedef struct control_desc {
+	uint8_t unit;		// CONTROL_UNIT_XXX
+	uint8_t selector;	// UVC_CT_XXX/UVC_PU_XXX
+	uint8_t len;		// wLength
+	uint8_t offset;		// offset of the value in the payload, pan/tilt share one control
+	uint8_t size;		// bytes of the value
+	uint8_t type;		// CONTROL_TYPE_XXX
+	uint32_t support;	// bit in mCtrlSupports/mPUSupports
+	control_value_t UVCCamera::*value;
+} control_desc_t;
+
+#define CONTROL_CAPS_MIN	0x01
+#define CONTROL_CAPS_MAX	0x02
+#define CONTROL_CAPS_DEF	0x04
+#define CONTROL_CAPS_RES	0x08
+#define CONTROL_CAPS_INFO	0x10
+
+// capability of a control, filled by probeControls
+typedef struct control_caps {
+	int32_t min;
+	int32_t max;
+	int32_t def;
+	int32_t res;
+	uint8_t info;		// GET_INFO, D0: GET, D1: SET, D2: disabled by auto mode, D3: autoupdate, D4: asynchronous
+	uint8_t valid;		// CONTROL_CAPS_XXX that the device answered, 0: unsupported or not probed
+} control_caps_t;
 
 class UVCCamera {
 	char *mUsbFs; // USB 文件系统路径的指针，可能用于访问设备文件
@@ -118,12 +183,18 @@ class UVCCamera {
 
 	// 预览视频流对象
 	UVCPreview *mPreview;
+	ControlQueue *mControlQueue;
+	ExtensionUnits *mExtensionUnits;
+	ControlProfile *mProfile;	// connect时恢复的配置
+	PtzController *mPtz;
+	AeAwbLoop *mAeAwb;
 	uint64_t mCtrlSupports; // 设备支持的控制功能（控制类型的支持位掩码）。
 	uint64_t mPUSupports;	// 表示处理单元（Processing Unit）支持的功能位掩码。
 	control_value_t mScanningMode; // 表示扫描模式控制值。
 	control_value_t mExposureMode; // 表示曝光模式控制值。
 	control_value_t mExposurePriority; // 表示曝光优先级控制值。
 	control_value_t mExposureAbs;	// 表示绝对曝光时间控制值。
+	control_value_t mExposureRel;	// 表示相对曝光时间控制值。
 	control_value_t mAutoFocus;	// 表示自动对焦控制值。
 	control_value_t mAutoWhiteBlance; // 表示自动白平衡控制值。
 	control_value_t mAutoWhiteBlanceCompo; // 表示自动白平衡分量控制值。
@@ -158,27 +229,23 @@ class UVCCamera {
 	control_value_t mMultiplierLimit; // 表示乘数限制控制值。
 	control_value_t mAnalogVideoStandard; // 表示模拟视频标准控制值。
 	control_value_t mAnalogVideoLockState; // 表示模拟视频锁定状态控制值。
+	static const control_desc_t sControlDescs[CONTROL_NUM];
+	control_caps_t mCaps[CONTROL_NUM];	// 能力表, probeControls一次性取得
+	// 保护control_value_t/能力表, Java的setter, 异步写入队列, PTZ工作线程, 配置恢复都经过这里(递归锁)
+	pthread_mutex_t control_mutex;
+	bool mCapsProbed;
 
 	void clearCameraParams();
-    int internalSetCtrlValue(int32_t value, paramset_func_u16 set_func);
-	int internalSetCtrlValue(control_value_t &values, int8_t value,
-		paramget_func_i8 get_func, paramset_func_i8 set_func);
-	int internalSetCtrlValue(control_value_t &values, uint8_t value,
-		paramget_func_u8 get_func, paramset_func_u8 set_func);
-	int internalSetCtrlValue(control_value_t &values, uint8_t value1, uint8_t value2,
-		paramget_func_u8u8 get_func, paramset_func_u8u8 set_func);
-	int internalSetCtrlValue(control_value_t &values, int8_t value1, uint8_t value2,
-		paramget_func_i8u8 get_func, paramset_func_i8u8 set_func);
-	int internalSetCtrlValue(control_value_t &values, int8_t value1, uint8_t value2, uint8_t value3,
-		paramget_func_i8u8u8 get_func, paramset_func_i8u8u8 set_func);
-	int internalSetCtrlValue(control_value_t &values, int16_t value,
-		paramget_func_i16 get_func, paramset_func_i16 set_func);
-	int internalSetCtrlValue(control_value_t &values, uint16_t value,
-		paramget_func_u16 get_func, paramset_func_u16 set_func);
-	int internalSetCtrlValue(control_value_t &values, int32_t value,
-		paramget_func_i32 get_func, paramset_func_i32 set_func);
-	int internalSetCtrlValue(control_value_t &values, uint32_t value,
-		paramget_func_u32 get_func, paramset_func_u32 set_func);
+	bool isCtrlSupported(int id);
+	uint8_t getCtrlUnitId(int id);
+	void fillCtrlPayload(int id, uint8_t *data);
+	void storeCtrlValue(int id, enum uvc_req_code req_code, const uint8_t *data);
+	int queryCtrlValue(int id, enum uvc_req_code req_code, int32_t &value);
+	int updateCtrlValues(int id);
+	int writeCtrlValue(int id, int32_t value);
+	bool isCtrlReadWrite(int id);
+	int transferRegionControls(ControlProfile &profile, enum uvc_req_code req_code, int timeout_ms);
+	int applyControlProfile(int timeout_ms = 1000);
 public:
 	UVCCamera();
 	~UVCCamera();
@@ -191,14 +258,62 @@ public:
 
 	char *getSupportedSize();
 	int setPreviewSize(int width, int height, int min_fps, int max_fps, int mode, float bandwidth = DEFAULT_BANDWIDTH);
+	int reconfigurePreview(int width, int height, int min_fps, int max_fps, int mode, float bandwidth = DEFAULT_BANDWIDTH);
 	int setPreviewDisplay(ANativeWindow *preview_window);
-	int setFrameCallback(JNIEnv *env, jobject frame_callback_obj, int pixel_format);
+	int setFrameCallback(JNIEnv *env, jobject frame_callback_obj, int pixel_format, int num_buffers = 0);
+	int releaseFrame(JNIEnv *env, int index);
+	jobject getFrameMetadataBuffer(JNIEnv *env);
+	int setFrameStats(int flags, int roi_x, int roi_y, int roi_width, int roi_height, int row_step);
+	int addFrameProcessor(const char *path, const char *args);
+	int removeFrameProcessor(int id);
+	int startSharedFrameRing(int num_slots, size_t slot_bytes);
+	int stopSharedFrameRing();
+	int setPreRoll(size_t budget_bytes, int duration_ms);
+	int dumpPreRoll(const char *path);
+	int captureStill(const char *path, int timeout_ms);
+	int setStillQuality(int quality, int subsamp);
+	int startRecording(const char *path);
+	int stopRecording();
+	int getRecordingStats(async_writer_stats_t *stats);
+	int startRawDump(const char *path, uint32_t max_frames, uint64_t max_bytes);
+	int stopRawDump();
+	int setLowLatency(bool low_latency);
+	int setThreadConfig(int type, int policy, int priority, uint32_t cpu_mask);
+	int64_t getPreviewLatency(bool average);
+	int64_t getTimeToFirstFrame();
 	int startPreview();
 	int stopPreview();
+	int pausePreview();
+	int resumePreview();
 	int setCaptureDisplay(ANativeWindow *capture_window);
 
 	int getCtrlSupports(uint64_t *supports);
 	int getProcSupports(uint64_t *supports);
+	int setControlCache(bool enable, int refresh_ms);
+	int getControlCacheStats(uint32_t *hits, uint32_t *misses);
+	int setControl(int id, int value);
+	int32_t setControlAsync(int id, int value);
+	int waitControl(int32_t ticket, int timeout_ms);
+	int setControlCallback(JNIEnv *env, jobject control_callback_obj);
+	int probeControls(int timeout_ms = 1000);
+	int getControlCaps(int id, control_caps_t *caps);
+	int updateCtrlLimit(int id, int &min, int &max, int &def);
+	int setCtrlValue(int id, int value);
+	int getCtrlValue(int id, int32_t &value);
+	int getControls(const int *ids, int32_t *values, int *results, int num, int timeout_ms = 1000);
+	int setControls(const int *ids, const int32_t *values, int *results, int num, int timeout_ms = 1000);
+	int applyControls(const int *ids, const int32_t *values, int *results, int num);
+	char *getExtensionUnits();
+	int getXuControl(int unit_id, int selector, void *data, int len);
+	int setXuControl(int unit_id, int selector, const void *data, int len);
+	char *exportControlProfile(int timeout_ms = 1000);
+	int importControlProfile(const char *profile);
+	int setPtzTarget(int axis, int value, int duration_ms);
+	int setPtzVelocity(int axis, int velocity);
+	int haltPtz();
+	int setPtzPeriod(int period_ms);
+	int getPtzPosition(int axis, int32_t &value);
+	int setSoftwareAeAwb(int flags, int target, int interval);
 
 	int updateScanningModeLimit(int &min, int &max, int &def);
 	int setScanningMode(int mode);
@@ -24,6 +24,7 @@
 
 #include <stdlib.h>
 #include <linux/time.h>
+#include <sys/time.h>
 #include <unistd.h>
 
 #if 1	// set 1 if you don't need debug log
@@ -39,6 +40,7 @@
 
 #include "utilbase.h"
 #include "UVCPreview.h"
+#include "UVCStreamCtrlCache.h"
 #include "libuvc_internal.h"
 
 #define	LOCAL_DEBUG 0
@@ -66,11 +68,36 @@ UVCPreview::UVCPreview(uvc_device_handle_t *devh)
 	previewBytes(DEFAULT_PREVIEW_WIDTH * DEFAULT_PREVIEW_HEIGHT * PREVIEW_PIXEL_BYTES),
 	previewFormat(WINDOW_FORMAT_RGBA_8888),
 	mIsRunning(false),
+	mIsPaused(false),
+	mLowLatency(false),
+	latestFrame(NULL),
+	mLatencyUs(0),
+	mAvgLatencyUs(0),
+	mClockFrequency(0),
+	mStreamCtrlCached(false),
+	mWaitFirstFrame(false),
+	mFirstFrameUs(0),
 	mIsCapturing(false),
 	captureQueu(NULL),
 	mFrameCallbackObj(NULL),
 	mFrameCallbackFunc(NULL),
-	callbackPixelBytes(2) {
+	callbackPixelBytes(2),
+	mCallbackRing(NULL),
+	mNumCallbackBuffers(0),
+	mRingGeneration(0),
+	mFrameMetadata((frame_metadata_t *)calloc(FRAME_METADATA_SLOTS, sizeof(frame_metadata_t))),
+	mLastCallbackSeq(0),
+	mStatsFlags(0),
+	mStatsRoiX(0), mStatsRoiY(0), mStatsRoiWidth(0), mStatsRoiHeight(0),
+	mStatsRowStep(1),
+	mNumFrameProcessors(0),
+	mProcessorId(0),
+	mSharedRing(NULL),
+	mPreRoll(NULL),
+	mStillCapture(new StillCapture()),
+	mRecorder(new MjpegRecorder()),
+	mRawDump(new RawFrameDump()),
+	mAeAwb(NULL) {
 
 	ENTER();
 	pthread_cond_init(&preview_sync, NULL);
@@ -82,6 +109,12 @@ UVCPreview::UVCPreview(uvc_device_handle_t *devh)
 	pthread_mutex_init(&capture_mutex, NULL);
 
 	pthread_mutex_init(&pool_mutex, NULL);
+	pthread_mutex_init(&ring_mutex, NULL);
+	pthread_mutex_init(&processor_mutex, NULL);
+	pthread_mutex_init(&shm_mutex, NULL);
+	pthread_mutex_init(&preroll_mutex, NULL);
+	pthread_mutex_init(&preroll_dump_mutex, NULL);
+	iframecallback_fields.onFrame = iframecallback_fields.onBufferedFrame = NULL;
 	EXIT();
 }
 
@@ -97,6 +130,41 @@ UVCPreview::~UVCPreview() {
 	clearPreviewFrame();
 	clearCaptureFrame();
 	clear_pool();
+	pthread_mutex_lock(&processor_mutex);
+	{
+		mNumFrameProcessors = 0;
+		for (int i = 0; i < mFrameProcessors.size(); i++) {
+			delete mFrameProcessors[i];
+		}
+		mFrameProcessors.clear();
+	}
+	pthread_mutex_unlock(&processor_mutex);
+	pthread_mutex_destroy(&processor_mutex);
+	stopSharedFrameRing();
+	pthread_mutex_destroy(&shm_mutex);
+	setPreRoll(0, 0);
+	pthread_mutex_destroy(&preroll_mutex);
+	pthread_mutex_destroy(&preroll_dump_mutex);
+	SAFE_DELETE(mStillCapture);
+	SAFE_DELETE(mRecorder);
+	SAFE_DELETE(mRawDump);
+	pthread_mutex_lock(&ring_mutex);
+	{
+		JNIEnv *env = getEnv();
+		if (mCallbackRing) {
+			mCallbackRing->release(env);
+			SAFE_DELETE(mCallbackRing);
+		}
+		for (int i = 0; i < mRetiredRings.size(); i++) {
+			mRetiredRings[i]->release(env);
+			delete mRetiredRings[i];
+		}
+		mRetiredRings.clear();
+	}
+	pthread_mutex_unlock(&ring_mutex);
+	pthread_mutex_destroy(&ring_mutex);
+	free(mFrameMetadata);
+	mFrameMetadata = NULL;
 	pthread_mutex_lock(&preview_mutex);
 	pthread_mutex_destroy(&preview_mutex);
 	pthread_cond_destroy(&preview_sync);
@@ -210,14 +278,122 @@ int UVCPreview::setPreviewSize(int width, int height, int min_fps, int max_fps,
 		requestBandwidth = bandwidth;
 
 		uvc_stream_ctrl_t ctrl;
-		result = uvc_get_stream_ctrl_format_size_fps(mDeviceHandle, &ctrl,
-			!requestMode ? UVC_FRAME_FORMAT_YUYV : UVC_FRAME_FORMAT_MJPEG,
-			requestWidth, requestHeight, requestMinFps, requestMaxFps);
+		bool cached;
+		// negotiated result is kept in UVCStreamCtrlCache and reused by prepare_preview
+		result = get_stream_ctrl(&ctrl, requestWidth, requestHeight,
+			requestMinFps, requestMaxFps, requestMode, &cached);
 	}
 	
 	RETURN(result, int);
 }
 
+/**
+ * 获取流控制配置, 优先使用缓存的协商结果(不需要probe)
+ * @param cached true: 来自缓存, commit失败时需要删除并重新协商
+ * @return
+ */
+int UVCPreview::get_stream_ctrl(uvc_stream_ctrl_t *ctrl, int width, int height,
+	int min_fps, int max_fps, int mode, bool *cached) {
+
+	*cached = UVCStreamCtrlCache::get(mDeviceHandle, mode, width, height, min_fps, max_fps, ctrl);
+	if (*cached) {
+		return UVC_SUCCESS;
+	}
+	int result = uvc_get_stream_ctrl_format_size_fps(mDeviceHandle, ctrl,
+		!mode ? UVC_FRAME_FORMAT_YUYV : UVC_FRAME_FORMAT_MJPEG,
+		width, height, min_fps, max_fps);
+	if (LIKELY(!result)) {
+		UVCStreamCtrlCache::put(mDeviceHandle, mode, width, height, min_fps, max_fps, ctrl);
+	}
+	return result;
+}
+
+void UVCPreview::startFirstFrameTimer() {
+	clock_gettime(CLOCK_MONOTONIC, &mStartTime);
+	__atomic_store_n(&mFirstFrameUs, 0, __ATOMIC_RELAXED);
+	mWaitFirstFrame = true;
+}
+
+/**
+ * startPreview/reconfigure到收到第一帧的时间[us], 0: 还没有收到
+ */
+int64_t UVCPreview::getTimeToFirstFrame() {
+	return __atomic_load_n(&mFirstFrameUs, __ATOMIC_RELAXED);
+}
+
+/**
+ * 预览中切换分辨率/格式, 不停止预览线程/捕获线程, 也不释放窗口
+ * 重新协商后只重新选择altsetting并重新提交传输
+ * 不在预览中时与setPreviewSize相同
+ * @return
+ */
+int UVCPreview::reconfigure(int width, int height, int min_fps, int max_fps, int mode, float bandwidth) {
+	ENTER();
+
+	if (!isRunning()) {
+		RETURN(setPreviewSize(width, height, min_fps, max_fps, mode, bandwidth), int);
+	}
+	uvc_stream_ctrl_t ctrl;
+	bool cached;
+	int result = get_stream_ctrl(&ctrl, width, height, min_fps, max_fps, mode, &cached);
+	if (LIKELY(!result)) {
+		uvc_frame_desc_t *frame_desc;
+		result = uvc_get_frame_desc(mDeviceHandle, &ctrl, &frame_desc);
+		if (LIKELY(!result)) {
+			// libuvc restarts with previous stream control if commit failed,
+			// so apply new size only after successful commit
+			const int frame_width = frame_desc->wWidth;
+			const int frame_height = frame_desc->wHeight;
+			startFirstFrameTimer();
+			mIsPaused = false;	// reconfigure also resumes paused stream
+			result = uvc_reconfigure_streaming(mDeviceHandle, &ctrl, bandwidth);
+			if (UNLIKELY(result && cached)) {
+				// cached result may be stale, negotiate again
+				UVCStreamCtrlCache::remove(mDeviceHandle, mode, width, height, min_fps, max_fps);
+				result = get_stream_ctrl(&ctrl, width, height, min_fps, max_fps, mode, &cached);
+				if (LIKELY(!result)) {
+					result = uvc_reconfigure_streaming(mDeviceHandle, &ctrl, bandwidth);
+				}
+			}
+			if (LIKELY(!result)) {
+				requestWidth = width;
+				requestHeight = height;
+				requestMinFps = min_fps;
+				requestMaxFps = max_fps;
+				requestMode = mode;
+				requestBandwidth = bandwidth;
+				pthread_mutex_lock(&preview_mutex);
+				{
+					frameWidth = frame_width;
+					frameHeight = frame_height;
+					frameMode = mode;
+					frameBytes = frameWidth * frameHeight * (!mode ? 2 : 4);
+					previewBytes = frameWidth * frameHeight * PREVIEW_PIXEL_BYTES;
+					if (LIKELY(mPreviewWindow)) {
+						ANativeWindow_setBuffersGeometry(mPreviewWindow,
+							frameWidth, frameHeight, previewFormat);
+					}
+				}
+				pthread_mutex_unlock(&preview_mutex);
+				LOGI("reconfigure:frameSize=(%d,%d)@%s", frameWidth, frameHeight, (!mode ? "YUYV" : "MJPEG"));
+				// drop frames with previous size and resize pool
+				clearPreviewFrame();
+				clearCaptureFrame();
+				init_pool(frameBytes);
+				pthread_mutex_lock(&capture_mutex);
+				{
+					callbackPixelFormatChanged();
+				}
+				pthread_mutex_unlock(&capture_mutex);
+			}
+		}
+	}
+	if (UNLIKELY(result)) {
+		LOGE("failed to reconfigure:err=%d", result);
+	}
+	RETURN(result, int);
+}
+
 /**
  * 设置预览窗口
  * @param preview_window
@@ -254,7 +430,12 @@ int UVCPreview::setPreviewDisplay(ANativeWindow *preview_window) {
  * @param pixel_format
  * @return
  */
-int UVCPreview::setFrameCallback(JNIEnv *env, jobject frame_callback_obj, int pixel_format) {
+/**
+ * 设置帧回调
+ * @param num_buffers 0: IFrameCallback, 每帧生成ByteBuffer
+ *                    >0: IBufferedFrameCallback, 使用常驻的ByteBuffer环, Java侧需要调用releaseFrame
+ */
+int UVCPreview::setFrameCallback(JNIEnv *env, jobject frame_callback_obj, int pixel_format, int num_buffers) {
 	
 	ENTER();
 	pthread_mutex_lock(&capture_mutex);
@@ -270,16 +451,33 @@ int UVCPreview::setFrameCallback(JNIEnv *env, jobject frame_callback_obj, int pi
 		}
 
         // 检查传入的回调对象是否与当前帧回调对象相同
-		if (!env->IsSameObject(mFrameCallbackObj, frame_callback_obj))	{
+		const bool same_object = env->IsSameObject(mFrameCallbackObj, frame_callback_obj);
+		// IFrameCallback <=> IBufferedFrameCallback, onFrame has different signature
+		const bool mode_changed = (num_buffers > 0) != (mNumCallbackBuffers > 0);
+		if (!same_object || mode_changed)	{
             // 重置帧回调方法
 			iframecallback_fields.onFrame = NULL;
+			iframecallback_fields.onBufferedFrame = NULL;
+			// ByteBuffers of previous callback are released after Java returns them
+			pthread_mutex_lock(&ring_mutex);
+			{
+				retire_callback_ring(env, mCallbackRing);
+				mCallbackRing = NULL;
+			}
+			pthread_mutex_unlock(&ring_mutex);
 
-            // 如果已有回调对象，删除其全局引用
-			if (mFrameCallbackObj) {
-				env->DeleteGlobalRef(mFrameCallbackObj);
+			if (!same_object) {
+				// 如果已有回调对象，删除其全局引用
+				if (mFrameCallbackObj) {
+					env->DeleteGlobalRef(mFrameCallbackObj);
+				}
+				// 更新帧回调对象
+				mFrameCallbackObj = frame_callback_obj;
+			} else if (frame_callback_obj) {
+				// keep current global ref
+				env->DeleteGlobalRef(frame_callback_obj);
+				frame_callback_obj = mFrameCallbackObj;
 			}
-            // 更新帧回调对象
-            mFrameCallbackObj = frame_callback_obj;
 
 			if (frame_callback_obj) {
 				// get method IDs of Java object for callback
@@ -287,22 +485,32 @@ int UVCPreview::setFrameCallback(JNIEnv *env, jobject frame_callback_obj, int pi
 				jclass clazz = env->GetObjectClass(frame_callback_obj);
 				if (LIKELY(clazz)) {
                     // 查找Java中的 `onFrame` 方法，签名为接受 `ByteBuffer` 参数
-					iframecallback_fields.onFrame = env->GetMethodID(clazz,
-						"onFrame",	"(Ljava/nio/ByteBuffer;)V");
+					if (num_buffers > 0) {
+						iframecallback_fields.onBufferedFrame = env->GetMethodID(clazz,
+							"onFrame",	"(Ljava/nio/ByteBuffer;II)V");
+					} else {
+						iframecallback_fields.onFrame = env->GetMethodID(clazz,
+							"onFrame",	"(Ljava/nio/ByteBuffer;)V");
+					}
 				} else {
 					LOGW("failed to get object class");
 				}
 				env->ExceptionClear();
-				if (!iframecallback_fields.onFrame) {
+				if (!iframecallback_fields.onFrame && !iframecallback_fields.onBufferedFrame) {
 					LOGE("Can't find IFrameCallback#onFrame");
 					env->DeleteGlobalRef(frame_callback_obj);
 					mFrameCallbackObj = frame_callback_obj = NULL;
 				}
 			}
+		} else if (frame_callback_obj && (frame_callback_obj != mFrameCallbackObj)) {
+			// same object and same mode, keep current global ref
+			env->DeleteGlobalRef(frame_callback_obj);
+			frame_callback_obj = mFrameCallbackObj;
 		}
         // 如果帧回调对象有效，更新像素格式并触发格式更改回调
 		if (frame_callback_obj) {
 			mPixelFormat = pixel_format;
+			mNumCallbackBuffers = num_buffers;
 			callbackPixelFormatChanged(); // 通知像素格式发生改变
 		}
 	}
@@ -310,6 +518,65 @@ int UVCPreview::setFrameCallback(JNIEnv *env, jobject frame_callback_obj, int pi
 	RETURN(0, int);
 }
 
+/**
+ * 低延迟模式: 只保留最新一帧, 到达后立即绘制(MJPEG时立即解码)
+ * @param low_latency
+ * @return
+ */
+int UVCPreview::setLowLatency(bool low_latency) {
+	ENTER();
+	mLowLatency = low_latency;
+	pthread_mutex_lock(&preview_mutex);
+	{
+		pthread_cond_signal(&preview_sync);
+	}
+	pthread_mutex_unlock(&preview_mutex);
+	RETURN(0, int);
+}
+
+/**
+ * 软件AE/AWB, 预览线程把解码后的帧交给它(只计算平均值, 写入是异步的)
+ * @param loop NULL: 解除
+ */
+void UVCPreview::setAeAwbLoop(AeAwbLoop *loop) {
+	ENTER();
+	mAeAwb = loop;
+	EXIT();
+}
+
+/**
+ * 曝光开始(PTS)到绘制结束的延迟[us]
+ * 设备侧(PTS => SCR的STC, dwClockFrequency)+主机侧(帧接收完成 => 绘制结束)
+ * 没有PTS/SCR时只有主机侧
+ * @param average true: 平滑后的平均值, false: 最后一帧
+ * @return
+ */
+int64_t UVCPreview::getLatency(bool average) {
+	return __atomic_load_n(average ? &mAvgLatencyUs : &mLatencyUs, __ATOMIC_RELAXED);
+}
+
+void UVCPreview::updateLatency(const uvc_frame_t *frame) {
+	if (UNLIKELY(!frame->capture_mono_us)) return;
+	// CLOCK_MONOTONIC, not affected by NTP/manual change of the wall clock
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	int64_t latency = (int64_t)now.tv_sec * 1000000LL + now.tv_nsec / 1000 - frame->capture_mono_us;
+	if (frame->pts && frame->scr && mClockFrequency) {
+		// both are device clock, wrap around is handled by unsigned subtraction
+		const int64_t device_us = (int64_t)(uint32_t)(frame->scr - frame->pts) * 1000000LL / mClockFrequency;
+		if (LIKELY(device_us < 1000000LL)) {	// ignore non-conforming devices
+			latency += device_us;
+		}
+	}
+	int64_t avg = __atomic_load_n(&mAvgLatencyUs, __ATOMIC_RELAXED);
+	avg = avg ? avg + (latency - avg) / 8 : latency;
+	__atomic_store_n(&mLatencyUs, latency, __ATOMIC_RELAXED);
+	__atomic_store_n(&mAvgLatencyUs, avg, __ATOMIC_RELAXED);
+#if LOCAL_DEBUG
+	LOGD("seq=%u,latency=%lldus,avg=%lldus", frame->sequence, (long long)latency, (long long)avg);
+#endif
+}
+
 void UVCPreview::callbackPixelFormatChanged() {
 	mFrameCallbackFunc = NULL;
     // 分辨率
@@ -397,6 +664,8 @@ int UVCPreview::startPreview() {
 	// 检查预览线程是否未运行
 	if (!isRunning()) {
 		mIsRunning = true;  // 标记预览正在运行
+		mIsPaused = false;
+		startFirstFrameTimer();
 
 		// 锁定预览的互斥锁，确保线程安全
 		pthread_mutex_lock(&preview_mutex);
@@ -426,6 +695,47 @@ int UVCPreview::startPreview() {
 	RETURN(result, int);
 }
 
+/**
+ * 暂停预览(warm standby)
+ * 只停止提交传输, 保留传输缓冲区/altsetting/预览线程/捕获线程/帧池/窗口
+ * 恢复时只需要重新提交传输
+ * @return
+ */
+int UVCPreview::pausePreview() {
+	ENTER();
+
+	int result = EXIT_FAILURE;
+	if (LIKELY(isRunning())) {
+		if (mIsPaused) {
+			RETURN(EXIT_SUCCESS, int);
+		}
+		result = uvc_pause_streaming(mDeviceHandle);
+		if (LIKELY(!result)) {
+			mIsPaused = true;
+			// drop queued frames, preview/capture thread just wait for next frame
+			clearPreviewFrame();
+		}
+	}
+	RETURN(result, int);
+}
+
+int UVCPreview::resumePreview() {
+	ENTER();
+
+	int result = EXIT_FAILURE;
+	if (LIKELY(isRunning())) {
+		if (!mIsPaused) {
+			RETURN(EXIT_SUCCESS, int);
+		}
+		startFirstFrameTimer();
+		result = uvc_resume_streaming(mDeviceHandle);
+		if (LIKELY(!result)) {
+			mIsPaused = false;
+		}
+	}
+	RETURN(result, int);
+}
+
 int UVCPreview::stopPreview() {
 	ENTER();
 	bool b = isRunning();
@@ -445,6 +755,11 @@ int UVCPreview::stopPreview() {
 		}
 		clearDisplay();
 	}
+	// no more frames after the preview thread terminated, finalize the file
+	mRecorder->stop();
+	stopRawDump();
+	// the next session must not write its first frame to the stale path
+	mStillCapture->cancel();
 	mHasCapturing = false;
 	clearPreviewFrame();
 	clearCaptureFrame();
@@ -476,6 +791,10 @@ void UVCPreview::uvc_preview_frame_callback(uvc_frame_t *frame, void *vptr_args)
 	// preview->isRunning()
 	// !frame || !frame->frame_format || !frame->data || !frame->data_bytes  验证帧的格式、数据指针以及数据大小是否有效
 	if UNLIKELY(!preview->isRunning() || !frame || !frame->frame_format || !frame->data || !frame->data_bytes) return;
+	// raw dump receives frames exactly as assembled, including broken ones
+	preview->mRawDump->offer(frame);
+	// frames with error bits are only delivered while raw dump is active
+	if (UNLIKELY(frame->bfh_err)) return;
 	if (UNLIKELY(
 		((frame->frame_format != UVC_FRAME_FORMAT_MJPEG) && (frame->actual_bytes < preview->frameBytes))
 		|| (frame->width != preview->frameWidth) || (frame->height != preview->frameHeight) )) {
@@ -487,6 +806,45 @@ void UVCPreview::uvc_preview_frame_callback(uvc_frame_t *frame, void *vptr_args)
 #endif
 		return;
 	}
+	if (UNLIKELY(preview->mWaitFirstFrame)) {
+		preview->mWaitFirstFrame = false;
+		struct timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		const int64_t us = (now.tv_sec - preview->mStartTime.tv_sec) * 1000000LL
+			+ (now.tv_nsec - preview->mStartTime.tv_nsec) / 1000;
+		__atomic_store_n(&preview->mFirstFrameUs, us, __ATOMIC_RELAXED);
+		LOGI("time to first frame=%lldus(cached stream control=%d)", (long long)us, preview->mStreamCtrlCached);
+	}
+	// native frame processors receive frames without JVM
+	if (UNLIKELY(preview->mNumFrameProcessors)) {
+		pthread_mutex_lock(&preview->processor_mutex);
+		{
+			for (int i = 0; i < preview->mFrameProcessors.size(); i++) {
+				preview->mFrameProcessors[i]->post(frame);
+			}
+		}
+		pthread_mutex_unlock(&preview->processor_mutex);
+	}
+	if (UNLIKELY(preview->mSharedRing)) {
+		pthread_mutex_lock(&preview->shm_mutex);
+		{
+			if (preview->mSharedRing) {
+				preview->mSharedRing->publish(frame);
+			}
+		}
+		pthread_mutex_unlock(&preview->shm_mutex);
+	}
+	if (UNLIKELY(preview->mPreRoll)) {
+		pthread_mutex_lock(&preview->preroll_mutex);
+		{
+			if (preview->mPreRoll) {
+				preview->mPreRoll->add(frame);
+			}
+		}
+		pthread_mutex_unlock(&preview->preroll_mutex);
+	}
+	preview->mStillCapture->offer(frame);
+	preview->mRecorder->offer(frame);
 	// 如果帧通过了验证，函数会从 preview 获取一个空的帧缓冲区来复制该帧的数据：
 	if (LIKELY(preview->isRunning())) {
 		uvc_frame_t *copy = preview->get_frame(frame->data_bytes);
@@ -513,6 +871,19 @@ void UVCPreview::uvc_preview_frame_callback(uvc_frame_t *frame, void *vptr_args)
  */
 void UVCPreview::addPreviewFrame(uvc_frame_t *frame) {
 
+	if (mLowLatency) {
+		// 只保留最新一帧, 旧帧不等待预览线程直接回收
+		uvc_frame_t *old = __atomic_exchange_n(&latestFrame, frame, __ATOMIC_ACQ_REL);
+		pthread_mutex_lock(&preview_mutex);
+		{
+			pthread_cond_signal(&preview_sync);
+		}
+		pthread_mutex_unlock(&preview_mutex);
+		if (old) {
+			recycle_frame(old);
+		}
+		return;
+	}
 	pthread_mutex_lock(&preview_mutex);
 	if (isRunning() && (previewFrames.size() < MAX_FRAME)) {
 		previewFrames.put(frame);
@@ -539,6 +910,25 @@ uvc_frame_t *UVCPreview::waitPreviewFrame() {
     // 初始化帧指针为空
 	uvc_frame_t *frame = NULL;
 
+	if (mLowLatency) {
+		frame = __atomic_exchange_n(&latestFrame, (uvc_frame_t *)NULL, __ATOMIC_ACQ_REL);
+		if (!frame) {
+			pthread_mutex_lock(&preview_mutex);
+			{
+				if (isRunning() && mLowLatency
+					&& !__atomic_load_n(&latestFrame, __ATOMIC_ACQUIRE)) {
+					pthread_cond_wait(&preview_sync, &preview_mutex);
+				}
+			}
+			pthread_mutex_unlock(&preview_mutex);
+			frame = __atomic_exchange_n(&latestFrame, (uvc_frame_t *)NULL, __ATOMIC_ACQ_REL);
+		}
+		if (UNLIKELY(frame && !isRunning())) {
+			recycle_frame(frame);
+			frame = NULL;
+		}
+		return frame;
+	}
     // 锁定互斥锁以进入临界区
 	pthread_mutex_lock(&preview_mutex);
 	{
@@ -558,6 +948,10 @@ uvc_frame_t *UVCPreview::waitPreviewFrame() {
 }
 
 void UVCPreview::clearPreviewFrame() {
+	uvc_frame_t *frame = __atomic_exchange_n(&latestFrame, (uvc_frame_t *)NULL, __ATOMIC_ACQ_REL);
+	if (frame) {
+		recycle_frame(frame);
+	}
 	pthread_mutex_lock(&preview_mutex);
 	{
 		for (int i = 0; i < previewFrames.size(); i++)
@@ -579,6 +973,7 @@ void *UVCPreview::preview_thread_func(void *vptr_args) {
     // 从 vptr_args 中获取 UVCPreview 对象
 	UVCPreview *preview = reinterpret_cast<UVCPreview *>(vptr_args);
 	if (LIKELY(preview)) {
+		uvc_apply_thread_config(preview->mDeviceHandle->dev->ctx, UVC_THREAD_PREVIEW);
 		uvc_stream_ctrl_t ctrl;
 		result = preview->prepare_preview(&ctrl);
 		if (LIKELY(!result)) {
@@ -597,11 +992,9 @@ int UVCPreview::prepare_preview(uvc_stream_ctrl_t *ctrl) {
 	uvc_error_t result;
 
 	ENTER();
-    // 获取流控制配置
-	result = uvc_get_stream_ctrl_format_size_fps(mDeviceHandle, ctrl,
-		!requestMode ? UVC_FRAME_FORMAT_YUYV : UVC_FRAME_FORMAT_MJPEG,
-		requestWidth, requestHeight, requestMinFps, requestMaxFps
-	);
+    // 获取流控制配置(优先使用缓存, 命中时不需要probe)
+	result = (uvc_error_t)get_stream_ctrl(ctrl, requestWidth, requestHeight,
+		requestMinFps, requestMaxFps, requestMode, &mStreamCtrlCached);
 	if (LIKELY(!result)) {
 #if LOCAL_DEBUG
 		uvc_print_stream_ctrl(ctrl, stderr);
@@ -647,14 +1040,29 @@ void UVCPreview::do_preview(uvc_stream_ctrl_t *ctrl) {
 	uvc_frame_t *frame_mjpeg = NULL;
 
     // 启动 UVC 流媒体
+	mClockFrequency = ctrl->dwClockFrequency;
 	uvc_error_t result = uvc_start_streaming_bandwidth(
 		mDeviceHandle, ctrl, uvc_preview_frame_callback, (void *)this, requestBandwidth, 0);
+	if (UNLIKELY(result && mStreamCtrlCached)) {
+		// commit with cached stream control failed, negotiate again
+		LOGW("cached stream control rejected:err=%d", result);
+		UVCStreamCtrlCache::remove(mDeviceHandle, requestMode, requestWidth, requestHeight,
+			requestMinFps, requestMaxFps);
+		result = (uvc_error_t)get_stream_ctrl(ctrl, requestWidth, requestHeight,
+			requestMinFps, requestMaxFps, requestMode, &mStreamCtrlCached);
+		if (LIKELY(!result)) {
+			result = uvc_start_streaming_bandwidth(
+				mDeviceHandle, ctrl, uvc_preview_frame_callback, (void *)this, requestBandwidth, 0);
+		}
+	}
 
     // jiangdg:fix stopview crash
     // use mHasCapturing flag confirm capture_thread was be created
     mHasCapturing = false;
 	if (LIKELY(!result)) {
 		clearPreviewFrame();
+		__atomic_store_n(&mLatencyUs, 0, __ATOMIC_RELAXED);
+		__atomic_store_n(&mAvgLatencyUs, 0, __ATOMIC_RELAXED);
         // 如果流媒体成功启动,函数会尝试创建捕获线程 capture_thread 来处理摄像头的预览帧：
 		if (pthread_create(&capture_thread, NULL, capture_thread_func, (void *)this) == 0) {
 		    mHasCapturing = true;
@@ -663,37 +1071,31 @@ void UVCPreview::do_preview(uvc_stream_ctrl_t *ctrl) {
 #if LOCAL_DEBUG
 		LOGI("Streaming...");
 #endif
-        // 根据预览模式（MJPEG 或 YUYV），有两个不同的帧处理循环
-		if (frameMode) {
-			// MJPEG mode
-			for ( ; LIKELY(isRunning()) ; ) {
-                // 通过 waitPreviewFrame() 函数等待新的 MJPEG 帧。
-				frame_mjpeg = waitPreviewFrame();
-				if (LIKELY(frame_mjpeg)) {
-                    // 获取最新一帧
-					frame = get_frame(frame_mjpeg->width * frame_mjpeg->height * 2);
-                    // 调用 uvc_mjpeg2yuyv 将 MJPEG 格式的帧转换为 YUYV 格式
-					result = uvc_mjpeg2yuyv(frame_mjpeg, frame);   // MJPEG => yuyv
-					recycle_frame(frame_mjpeg);
-					if (LIKELY(!result)) {
-                        // 将处理后的帧交给 draw_preview_one 函数绘制到窗口 , 并将其转换为 RGBX 格式。
-						frame = draw_preview_one(frame, &mPreviewWindow, uvc_any2rgbx, 4);
-                        // 调用 addCaptureFrame(frame) 将处理后的帧添加到捕获队列中
-						addCaptureFrame(frame);
-					} else {
-						recycle_frame(frame);
-					}
+        // 按帧格式处理（MJPEG 或 YUYV），预览中可能通过 reconfigure 切换格式
+		for ( ; LIKELY(isRunning()) ; ) {
+			frame = waitPreviewFrame();
+			if (UNLIKELY(!frame)) continue;
+			if (frame->frame_format == UVC_FRAME_FORMAT_MJPEG) {
+				// MJPEG mode
+				frame_mjpeg = frame;
+				// 获取最新一帧
+				frame = get_frame(frame_mjpeg->width * frame_mjpeg->height * 2);
+				// 调用 uvc_mjpeg2yuyv 将 MJPEG 格式的帧转换为 YUYV 格式
+				result = uvc_mjpeg2yuyv(frame_mjpeg, frame);   // MJPEG => yuyv
+				recycle_frame(frame_mjpeg);
+				if (UNLIKELY(result)) {
+					recycle_frame(frame);
+					continue;
 				}
 			}
-		} else {
-			// yuvyv mode
-			for ( ; LIKELY(isRunning()) ; ) {
-				frame = waitPreviewFrame();
-				if (LIKELY(frame)) {
-					frame = draw_preview_one(frame, &mPreviewWindow, uvc_any2rgbx, 4);
-					addCaptureFrame(frame);
-				}
+			if (UNLIKELY(mAeAwb)) {
+				mAeAwb->offer(frame);
 			}
+			// 将处理后的帧交给 draw_preview_one 函数绘制到窗口 , 并将其转换为 RGBX 格式。
+			frame = draw_preview_one(frame, &mPreviewWindow, uvc_any2rgbx, 4);
+			updateLatency(frame);
+			// 调用 addCaptureFrame(frame) 将处理后的帧添加到捕获队列中
+			addCaptureFrame(frame);
 		}
 
         // 当预览停止时,唤醒捕获线程：
@@ -924,6 +1326,7 @@ void *UVCPreview::capture_thread_func(void *vptr_args) {
 	ENTER();
 	UVCPreview *preview = reinterpret_cast<UVCPreview *>(vptr_args);
 	if (LIKELY(preview)) {
+		uvc_apply_thread_config(preview->mDeviceHandle->dev->ctx, UVC_THREAD_CAPTURE);
 		JavaVM *vm = getVM();
 		JNIEnv *env;
 		// attach to JavaVM
@@ -1025,7 +1428,9 @@ void UVCPreview::do_capture_surface(JNIEnv *env) {
 void UVCPreview::do_capture_callback(JNIEnv *env, uvc_frame_t *frame) {
 	ENTER();
 
-	if (LIKELY(frame)) {
+	if (LIKELY(frame) && iframecallback_fields.onBufferedFrame) {
+		do_capture_callback_ring(env, frame);
+	} else if (LIKELY(frame)) {
 		uvc_frame_t *callback_frame = frame;
         // 如果回调对象 mFrameCallbackObj 存在，函数会通过 JNI 将处理后的帧数据传递给 Java 层
 		if (mFrameCallbackObj) {
@@ -1035,6 +1440,9 @@ void UVCPreview::do_capture_callback(JNIEnv *env, uvc_frame_t *frame) {
 				if (LIKELY(callback_frame)) {
                     // 调用回调函数转换帧
 					int b = mFrameCallbackFunc(frame, callback_frame);
+					if (LIKELY(!b)) {
+						update_frame_stats(MAX_CALLBACK_BUFFERS, frame, callback_frame);
+					}
                     // 回收帧
 					recycle_frame(frame);
 					if (UNLIKELY(b)) {
@@ -1046,9 +1454,15 @@ void UVCPreview::do_capture_callback(JNIEnv *env, uvc_frame_t *frame) {
 					callback_frame = frame;
 					goto SKIP;
 				}
+			} else {
+				update_frame_stats(MAX_CALLBACK_BUFFERS, frame, frame);
 			}
             // 将帧数据转换为 Java 中的 ByteBuffer 对象，允许直接访问底层的帧数据。
-			jobject buf = env->NewDirectByteBuffer(callback_frame->data, callbackPixelBytes);
+			// 切换分辨率时callbackPixelBytes可能与帧大小不一致
+			const size_t bytes = callbackPixelBytes <= callback_frame->data_bytes
+				? callbackPixelBytes : callback_frame->data_bytes;
+			fill_frame_metadata(MAX_CALLBACK_BUFFERS, callback_frame, bytes);
+			jobject buf = env->NewDirectByteBuffer(callback_frame->data, bytes);
 
             if (iframecallback_fields.onFrame) {
 				env->CallVoidMethod(mFrameCallbackObj, iframecallback_fields.onFrame, buf);
@@ -1061,3 +1475,484 @@ void UVCPreview::do_capture_callback(JNIEnv *env, uvc_frame_t *frame) {
 	}
 	EXIT();
 }
+
+/**
+ * 取得当前的ByteBuffer环并确保一个slot, 帧大小或缓冲区数改变时重新生成
+ * 在ring_mutex内acquire, 所以setFrameCallback不会删除使用中的环
+ * 只从捕获线程调用
+ * @param slot 确保的slot, -1: 所有缓冲区都被Java侧持有
+ */
+CallbackBufferRing *UVCPreview::prepare_callback_ring(JNIEnv *env, int &slot) {
+	CallbackBufferRing *ring;
+
+	pthread_mutex_lock(&ring_mutex);
+	{
+		if (UNLIKELY(!mCallbackRing
+			|| (mCallbackRing->bufferBytes() != callbackPixelBytes)
+			|| (mCallbackRing->numBuffers() != mNumCallbackBuffers))) {
+
+			retire_callback_ring(env, mCallbackRing);
+			mRingGeneration = (mRingGeneration + 1) & 0x7fff;
+			mCallbackRing = new CallbackBufferRing(mRingGeneration, mNumCallbackBuffers, callbackPixelBytes);
+			if (UNLIKELY(mCallbackRing->init(env))) {
+				LOGE("failed to allocate callback buffers");
+				mCallbackRing->release(env);
+				SAFE_DELETE(mCallbackRing);
+			}
+		}
+		ring = mCallbackRing;
+		slot = LIKELY(ring) ? ring->acquire() : -1;
+	}
+	pthread_mutex_unlock(&ring_mutex);
+
+	return ring;
+}
+
+/**
+ * 不再使用的ByteBuffer环, Java侧还持有缓冲区时等待releaseFrame
+ * 需要在ring_mutex锁定状态下调用
+ */
+void UVCPreview::retire_callback_ring(JNIEnv *env, CallbackBufferRing *ring) {
+	if (ring) {
+		if (ring->isIdle()) {
+			ring->release(env);
+			delete ring;
+		} else {
+			mRetiredRings.put(ring);
+		}
+	}
+}
+
+/**
+ * IBufferedFrameCallback用, 转换结果直接写入常驻的ByteBuffer
+ * 每帧不需要JNI分配, Java侧可以不复制地持有帧直到releaseFrame
+ */
+void UVCPreview::do_capture_callback_ring(JNIEnv *env, uvc_frame_t *frame) {
+	ENTER();
+
+	int slot;
+	CallbackBufferRing *ring = prepare_callback_ring(env, slot);
+	if (LIKELY(slot >= 0)) {
+		uvc_frame_t *callback_frame = ring->frame(slot);
+		size_t bytes;
+		if (mFrameCallbackFunc) {
+			if (UNLIKELY(mFrameCallbackFunc(frame, callback_frame))) {
+				LOGW("failed to convert for callback frame");
+				// ring may be retired meanwhile
+				releaseFrame(env, ring->index(slot));
+				goto SKIP;
+			}
+			bytes = callbackPixelBytes;
+			update_frame_stats(slot, frame, callback_frame);
+			fill_frame_metadata(slot, callback_frame, bytes);
+		} else {
+			bytes = frame->actual_bytes < ring->bufferBytes() ? frame->actual_bytes : ring->bufferBytes();
+			memcpy(callback_frame->data, frame->data, bytes);
+			update_frame_stats(slot, frame, frame);
+			fill_frame_metadata(slot, frame, bytes);
+		}
+		env->CallVoidMethod(mFrameCallbackObj, iframecallback_fields.onBufferedFrame,
+			ring->buffer(slot), ring->index(slot), (jint)bytes);
+		env->ExceptionClear();
+	} else {
+		// all buffers are held by Java side
+		LOGV("drop callback frame");
+	}
+SKIP:
+	recycle_frame(frame);
+
+	EXIT();
+}
+
+/**
+ * 写入帧元数据, 只从捕获线程调用
+ * Java侧直接读取共享的direct ByteBuffer, 不需要每个字段的JNI调用
+ * @param slot IBufferedFrameCallback的slot或MAX_CALLBACK_BUFFERS(IFrameCallback)
+ * @param frame 回调数据(转换后)的帧
+ */
+void UVCPreview::fill_frame_metadata(int slot, const uvc_frame_t *frame, size_t bytes) {
+	if (UNLIKELY(!mFrameMetadata)) return;
+
+	frame_metadata_t *meta = &mFrameMetadata[slot];
+	uint32_t step;
+	switch (mPixelFormat) {
+	case PIXEL_FORMAT_RGBX:
+		step = frame->width * 4;
+		break;
+	case PIXEL_FORMAT_RGB565:
+		step = frame->width * 2;
+		break;
+	case PIXEL_FORMAT_YUV20SP:
+	case PIXEL_FORMAT_NV21:
+		step = frame->width;	// Y plane
+		break;
+	default:	// PIXEL_FORMAT_RAW, PIXEL_FORMAT_YUV
+		step = frame->frame_format == UVC_FRAME_FORMAT_MJPEG ? 0 : frame->width * 2;
+		break;
+	}
+	meta->sequence = frame->sequence;
+	meta->pts = frame->pts;
+	meta->scr = frame->scr;
+	meta->capture_time_us = (int64_t)frame->capture_time.tv_sec * 1000000LL + frame->capture_time.tv_usec;
+	meta->width = frame->width;
+	meta->height = frame->height;
+	meta->step = step;
+	meta->pixel_format = mPixelFormat;
+	meta->frame_format = frame->frame_format;
+	meta->data_bytes = (uint32_t)bytes;
+	meta->dropped = (mLastCallbackSeq && (frame->sequence > mLastCallbackSeq + 1))
+		? frame->sequence - mLastCallbackSeq - 1 : 0;
+	mLastCallbackSeq = frame->sequence;
+}
+
+/**
+ * 计算亮度统计并写入帧元数据, 只从捕获线程调用
+ * NV21/YUV420SP时使用回调数据的Y plane, RGB等使用转换前的YUYV帧
+ * @param frame 转换前的帧
+ * @param callback_frame 回调数据(转换后)的帧, 不转换时与frame相同
+ */
+void UVCPreview::update_frame_stats(int slot, const uvc_frame_t *frame, const uvc_frame_t *callback_frame) {
+	if (UNLIKELY(!mFrameMetadata)) return;
+
+	luma_stats_t *stats = &mFrameMetadata[slot].stats;
+	const int flags = mStatsFlags;
+	stats->flags = 0;
+	if (LIKELY(!flags)) return;
+
+	const uvc_frame_t *src;
+	int pixel_stride, step;
+	if (((mPixelFormat == PIXEL_FORMAT_NV21) || (mPixelFormat == PIXEL_FORMAT_YUV20SP))
+		&& (callback_frame != frame)) {
+		src = callback_frame;
+		pixel_stride = 1;
+		step = callback_frame->width;	// Y plane
+	} else if (frame->frame_format == UVC_FRAME_FORMAT_YUYV) {
+		src = frame;
+		pixel_stride = 2;
+		step = frame->step ? frame->step : frame->width * 2;
+	} else if (frame->frame_format == UVC_FRAME_FORMAT_GRAY8) {
+		src = frame;
+		pixel_stride = 1;
+		step = frame->step ? frame->step : frame->width;
+	} else {
+		return;	// MJPEG etc.
+	}
+	if (UNLIKELY((size_t)step * src->height > src->data_bytes)) return;
+
+	frame_stats_luma((const uint8_t *)src->data, pixel_stride,
+		src->width, src->height, step,
+		mStatsRoiX, mStatsRoiY, mStatsRoiWidth, mStatsRoiHeight,
+		mStatsRowStep, flags, stats);
+}
+
+/**
+ * 设置附加到帧元数据的亮度统计, 在捕获线程计算
+ * @param flags FRAME_STATS_XXX, 0: 不计算
+ * @param roi_x, roi_y, roi_width, roi_height 回调帧上的像素坐标, roi_width/roi_height<=0: 整个帧
+ * @param row_step 每row_step行取一行
+ * @return
+ */
+int UVCPreview::setFrameStats(int flags, int roi_x, int roi_y, int roi_width, int roi_height, int row_step) {
+	ENTER();
+
+	if (UNLIKELY(flags & ~FRAME_STATS_ALL)) {
+		RETURN(UVC_ERROR_INVALID_PARAM, int);
+	}
+	// disable first not to mix old and new settings
+	mStatsFlags = 0;
+	mStatsRoiX = roi_x;
+	mStatsRoiY = roi_y;
+	mStatsRoiWidth = roi_width;
+	mStatsRoiHeight = roi_height;
+	mStatsRowStep = row_step > 0 ? row_step : 1;
+	__atomic_store_n(&mStatsFlags, flags, __ATOMIC_RELEASE);
+
+	RETURN(0, int);
+}
+
+/**
+ * 帧元数据的共享缓冲区, UVCPreview销毁之前有效
+ * @return direct ByteBuffer(local ref)
+ */
+jobject UVCPreview::getFrameMetadataBuffer(JNIEnv *env) {
+	if (UNLIKELY(!mFrameMetadata)) return NULL;
+	return env->NewDirectByteBuffer(mFrameMetadata, FRAME_METADATA_SLOTS * sizeof(frame_metadata_t));
+}
+
+/**
+ * 追加本地帧处理插件, 不在预览中也可以追加
+ * @param path 插件.so的路径
+ * @param args 传给插件的字符串, 可以是NULL
+ * @return >0: 插件id, <0: 错误
+ */
+int UVCPreview::addFrameProcessor(const char *path, const char *args) {
+	ENTER();
+
+	if (UNLIKELY(!path)) {
+		RETURN(UVC_ERROR_INVALID_PARAM, int);
+	}
+	pthread_mutex_lock(&processor_mutex);
+	const int id = ++mProcessorId;
+	pthread_mutex_unlock(&processor_mutex);
+
+	// load outside of processor_mutex not to block the frame callback
+	FrameProcessor *processor = new FrameProcessor(id);
+	int result = processor->load(path, args);
+	if (LIKELY(!result)) {
+		pthread_mutex_lock(&processor_mutex);
+		{
+			mFrameProcessors.put(processor);
+			mNumFrameProcessors = mFrameProcessors.size();
+		}
+		pthread_mutex_unlock(&processor_mutex);
+		result = id;
+	} else {
+		delete processor;
+	}
+	RETURN(result, int);
+}
+
+/**
+ * 移除本地帧处理插件
+ * @param id addFrameProcessor的返回值
+ * @return 0: 成功
+ */
+int UVCPreview::removeFrameProcessor(int id) {
+	ENTER();
+
+	FrameProcessor *processor = NULL;
+	pthread_mutex_lock(&processor_mutex);
+	{
+		for (int i = 0; i < mFrameProcessors.size(); i++) {
+			if (mFrameProcessors[i]->id() == id) {
+				processor = mFrameProcessors.remove(i);
+				break;
+			}
+		}
+		mNumFrameProcessors = mFrameProcessors.size();
+	}
+	pthread_mutex_unlock(&processor_mutex);
+	const int result = processor ? 0 : UVC_ERROR_NOT_FOUND;
+	// plugin may take a while to finish current frame
+	SAFE_DELETE(processor);
+	RETURN(result, int);
+}
+
+/**
+ * 开始向跨进程共享的帧环写入帧(MJPEG/YUYV as received)
+ * 其他进程通过返回的fd(经Binder传递)用libuvcshmreader读取
+ * @param num_slots 帧数
+ * @param slot_bytes 每帧的最大字节数, 0: 当前的帧大小
+ * @return fd(UVCPreview持有, 调用侧需要dup), <0: 错误
+ */
+int UVCPreview::startSharedFrameRing(int num_slots, size_t slot_bytes) {
+	ENTER();
+
+	SharedFrameRing *ring = new SharedFrameRing();
+	int result = ring->create(num_slots, slot_bytes ? slot_bytes : frameBytes);
+	if (LIKELY(!result)) {
+		result = ring->fd();
+		pthread_mutex_lock(&shm_mutex);
+		{
+			SAFE_DELETE(mSharedRing);
+			mSharedRing = ring;
+		}
+		pthread_mutex_unlock(&shm_mutex);
+	} else {
+		delete ring;
+	}
+	RETURN(result, int);
+}
+
+int UVCPreview::stopSharedFrameRing() {
+	ENTER();
+
+	pthread_mutex_lock(&shm_mutex);
+	{
+		SAFE_DELETE(mSharedRing);
+	}
+	pthread_mutex_unlock(&shm_mutex);
+
+	RETURN(0, int);
+}
+
+/**
+ * 设置预录缓冲区, 保留最近收到的帧(MJPEG/YUYV as received, 不解码)
+ * @param budget_bytes 最大字节数, 0: 停止预录并释放缓冲区
+ * @param duration_ms 最长时间, 0: 只按字节数
+ * @return 0: 成功
+ */
+int UVCPreview::setPreRoll(size_t budget_bytes, int duration_ms) {
+	ENTER();
+
+	PreRollBuffer *preroll = NULL;
+	int result = 0;
+	if (budget_bytes) {
+		preroll = new PreRollBuffer();
+		result = preroll->init(budget_bytes, duration_ms);
+		if (UNLIKELY(result)) {
+			SAFE_DELETE(preroll);
+		}
+	}
+	if (LIKELY(!result)) {
+		pthread_mutex_lock(&preroll_dump_mutex);
+		{
+			pthread_mutex_lock(&preroll_mutex);
+			{
+				PreRollBuffer *prev = mPreRoll;
+				mPreRoll = preroll;
+				preroll = prev;
+			}
+			pthread_mutex_unlock(&preroll_mutex);
+		}
+		pthread_mutex_unlock(&preroll_dump_mutex);
+		// wait for the dump thread of previous buffer outside of the lock
+		SAFE_DELETE(preroll);
+	}
+	RETURN(result, int);
+}
+
+/**
+ * 把预录缓冲区的帧写入文件, 复制快照后由后台线程写入
+ * @return 写入的帧数, <0: 错误, UVC_ERROR_BUSY: 上一次的写入还没有结束
+ */
+int UVCPreview::dumpPreRoll(const char *path) {
+	ENTER();
+
+	int result = UVC_ERROR_INVALID_PARAM;
+	// not preroll_mutex, copying the frames must not block the frame callback
+	pthread_mutex_lock(&preroll_dump_mutex);
+	{
+		if (mPreRoll) {
+			result = mPreRoll->dump(path);
+		}
+	}
+	pthread_mutex_unlock(&preroll_dump_mutex);
+
+	RETURN(result, int);
+}
+
+/**
+ * 把下一个完整的帧作为静止图像写入文件
+ * MJPEG时不解码/不重新编码, 只在缺少时补上DHT
+ * YUYV/UYVY时用TurboJPEG编码
+ * @param timeout_ms 等待写入结束的时间, 0: 不等待
+ * @return 0: 成功, UVC_ERROR_NOT_SUPPORTED: 不支持的帧格式
+ */
+int UVCPreview::captureStill(const char *path, int timeout_ms) {
+	ENTER();
+
+	int result = UVC_ERROR_INVALID_PARAM;
+	if (LIKELY(isRunning())) {
+		result = mStillCapture->request(path, timeout_ms);
+	}
+	RETURN(result, int);
+}
+
+/**
+ * 设置YUYV静止图像的jpeg质量
+ * @param quality 1-100
+ * @param subsamp TJSAMP_422 or TJSAMP_420
+ */
+int UVCPreview::setStillQuality(int quality, int subsamp) {
+	ENTER();
+
+	int result = mStillCapture->setQuality(quality, subsamp);
+	RETURN(result, int);
+}
+
+/**
+ * 开始MJPEG录像(Matroska), 不解码/不重新编码, 时间戳为帧的接收时间
+ * @return 0: 成功, UVC_ERROR_NOT_SUPPORTED: 不是MJPEG, UVC_ERROR_BUSY: 正在录像
+ */
+int UVCPreview::startRecording(const char *path) {
+	ENTER();
+
+	int result = UVC_ERROR_INVALID_PARAM;
+	if (LIKELY(isRunning())) {
+		result = frameMode ? mRecorder->start(path) : UVC_ERROR_NOT_SUPPORTED;
+	}
+	RETURN(result, int);
+}
+
+/**
+ * 结束录像, 完成文件之后返回
+ * @return 写入的帧数, <0: 错误
+ */
+int UVCPreview::stopRecording() {
+	ENTER();
+
+	int result = mRecorder->stop();
+	RETURN(result, int);
+}
+
+/**
+ * 录像的写入统计(吞吐量, 队列深度等), 结束之后返回最后一次的值
+ */
+int UVCPreview::getRecordingStats(async_writer_stats_t *stats) {
+	return mRecorder->getStats(stats);
+}
+
+/**
+ * 开始原始帧转储, 不转换地写入收到的帧和每帧的信息(path.idx)
+ * 转储中有错误位的帧也从libuvc传过来
+ * @param max_frames 0: 不限
+ * @param max_bytes 0: 不限
+ */
+int UVCPreview::startRawDump(const char *path, uint32_t max_frames, uint64_t max_bytes) {
+	ENTER();
+
+	int result = UVC_ERROR_INVALID_PARAM;
+	if (LIKELY(isRunning())) {
+		result = mRawDump->start(path, max_frames, max_bytes);
+		if (LIKELY(!result)) {
+			uvc_set_error_frames(mDeviceHandle, 1);
+		}
+	}
+	RETURN(result, int);
+}
+
+/**
+ * @return 写入的帧数, <0: 错误
+ */
+int UVCPreview::stopRawDump() {
+	ENTER();
+
+	uvc_set_error_frames(mDeviceHandle, 0);
+	int result = mRawDump->stop();
+	RETURN(result, int);
+}
+
+/**
+ * 归还IBufferedFrameCallback#onFrame收到的缓冲区
+ * @param index IBufferedFrameCallback#onFrame的index
+ * @return 0: 成功
+ */
+int UVCPreview::releaseFrame(JNIEnv *env, int index) {
+	int result = UVC_ERROR_INVALID_PARAM;
+	const int generation = (index >> 16) & 0x7fff;
+	const int slot = index & 0xffff;
+
+	pthread_mutex_lock(&ring_mutex);
+	{
+		if (mCallbackRing && (mCallbackRing->generation() == generation)) {
+			result = mCallbackRing->release(slot);
+		} else {
+			for (int i = 0; i < mRetiredRings.size(); i++) {
+				CallbackBufferRing *ring = mRetiredRings[i];
+				if (ring->generation() == generation) {
+					result = ring->release(slot);
+					if (ring->isIdle()) {
+						mRetiredRings.remove(i);
+						ring->release(env);
+						delete ring;
+					}
+					break;
+				}
+			}
+		}
+	}
+	pthread_mutex_unlock(&ring_mutex);
+
+	return result;
+}
@@ -26,9 +26,19 @@
 #define UVCPREVIEW_H_
 
 #include "libUVCCamera.h"
+#include <stddef.h>
 #include <pthread.h>
 #include <android/native_window.h>
 #include "objectarray.h"
+#include "CallbackBufferRing.h"
+#include "FrameProcessor.h"
+#include "SharedFrameRing.h"
+#include "PreRollBuffer.h"
+#include "StillCapture.h"
+#include "MjpegRecorder.h"
+#include "RawFrameDump.h"
+#include "AeAwbLoop.h"
+#include "FrameStats.h"
 
 #pragma interface
 
@@ -48,9 +58,49 @@ typedef uvc_error_t (*convFunc_t)(uvc_frame_t *in, uvc_frame_t *out);
 #define PIXEL_FORMAT_YUV20SP 4
 #define PIXEL_FORMAT_NV21 5		// YVU420SemiPlanar
 
+// frame metadata, shared with Java as a direct ByteBuffer(native byte order)
+// layout must match com.wardtn.uvccamera.uvc.FrameMetadata
+typedef struct frame_metadata {
+	uint32_t sequence;			// frame number of libuvc
+	uint32_t pts;				// dwPresentationTime, 0 if not present
+	int64_t capture_time_us;	// host time when the frame was completed [us]
+	uint32_t width;
+	uint32_t height;
+	uint32_t step;				// bytes per line of callback data, 0 for MJPEG
+	int32_t pixel_format;		// PIXEL_FORMAT_XXX
+	int32_t frame_format;		// enum uvc_frame_format of callback data
+	uint32_t data_bytes;
+	uint32_t dropped;			// frames skipped since the previous callback
+	uint32_t scr;				// STC part of SCR, 0 if not present
+	luma_stats_t stats;			// setFrameStats, stats.flags == 0 if not computed
+} frame_metadata_t;
+
+// FrameMetadata.BYTES/OFFSET_XXX, changing the layout must fail here instead of breaking Java reads
+static_assert(sizeof(frame_metadata_t) == 320, "FrameMetadata.BYTES");
+static_assert(offsetof(frame_metadata_t, sequence) == 0, "FrameMetadata.OFFSET_SEQUENCE");
+static_assert(offsetof(frame_metadata_t, pts) == 4, "FrameMetadata.OFFSET_PTS");
+static_assert(offsetof(frame_metadata_t, capture_time_us) == 8, "FrameMetadata.OFFSET_CAPTURE_TIME");
+static_assert(offsetof(frame_metadata_t, width) == 16, "FrameMetadata.OFFSET_WIDTH");
+static_assert(offsetof(frame_metadata_t, height) == 20, "FrameMetadata.OFFSET_HEIGHT");
+static_assert(offsetof(frame_metadata_t, step) == 24, "FrameMetadata.OFFSET_STEP");
+static_assert(offsetof(frame_metadata_t, pixel_format) == 28, "FrameMetadata.OFFSET_PIXEL_FORMAT");
+static_assert(offsetof(frame_metadata_t, frame_format) == 32, "FrameMetadata.OFFSET_FRAME_FORMAT");
+static_assert(offsetof(frame_metadata_t, data_bytes) == 36, "FrameMetadata.OFFSET_DATA_BYTES");
+static_assert(offsetof(frame_metadata_t, dropped) == 40, "FrameMetadata.OFFSET_DROPPED");
+static_assert(offsetof(frame_metadata_t, scr) == 44, "FrameMetadata.OFFSET_SCR");
+static_assert(offsetof(frame_metadata_t, stats.flags) == 48, "FrameMetadata.OFFSET_STATS_FLAGS");
+static_assert(offsetof(frame_metadata_t, stats.samples) == 52, "FrameMetadata.OFFSET_STATS_SAMPLES");
+static_assert(offsetof(frame_metadata_t, stats.mean) == 56, "FrameMetadata.OFFSET_LUMA_MEAN");
+static_assert(offsetof(frame_metadata_t, stats.focus) == 60, "FrameMetadata.OFFSET_FOCUS");
+static_assert(offsetof(frame_metadata_t, stats.histogram) == 64, "FrameMetadata.OFFSET_HISTOGRAM");
+
+// slot 0..MAX_CALLBACK_BUFFERS-1: IBufferedFrameCallback, MAX_CALLBACK_BUFFERS: IFrameCallback
+#define FRAME_METADATA_SLOTS (MAX_CALLBACK_BUFFERS + 1)
+
 // for callback to Java object
 typedef struct {
 	jmethodID onFrame;
+	jmethodID onBufferedFrame;	// IBufferedFrameCallback#onFrame(ByteBuffer, int, int)
 } Fields_iframecallback;
 
 class UVCPreview {
@@ -58,6 +108,7 @@ private:
 	uvc_device_handle_t *mDeviceHandle;
 	ANativeWindow *mPreviewWindow; // 预览窗口
 	volatile bool mIsRunning;
+	volatile bool mIsPaused;		// warm standby, keep streaming resources
 	int requestWidth, requestHeight, requestMode;
 	int requestMinFps, requestMaxFps;
 	float requestBandwidth;
@@ -70,6 +121,15 @@ private:
 	ObjectArray<uvc_frame_t *> previewFrames;
 	int previewFormat; // 预览格式
 	size_t previewBytes;
+	// low latency mode: keep only the latest frame in single slot instead of previewFrames
+	volatile bool mLowLatency;
+	uvc_frame_t *latestFrame;			// swapped atomically
+	int64_t mLatencyUs, mAvgLatencyUs;	// PTS(or host time of frame completion) => drawn
+	uint32_t mClockFrequency;			// dwClockFrequency for PTS/SCR
+	bool mStreamCtrlCached;				// current stream control came from UVCStreamCtrlCache
+	struct timespec mStartTime;			// for time to first frame
+	volatile bool mWaitFirstFrame;
+	int64_t mFirstFrameUs;
 //
 	volatile bool mIsCapturing;
 	volatile bool mHasCapturing;
@@ -85,6 +145,34 @@ private:
 	Fields_iframecallback iframecallback_fields;
 	int mPixelFormat;
 	size_t callbackPixelBytes; //回调帧 数据大小
+	// persistent ByteBuffer ring for IBufferedFrameCallback
+	pthread_mutex_t ring_mutex;
+	CallbackBufferRing *mCallbackRing;
+	ObjectArray<CallbackBufferRing *> mRetiredRings;	// waiting for releaseFrame
+	int mNumCallbackBuffers;
+	int mRingGeneration;
+	frame_metadata_t *mFrameMetadata;	// [FRAME_METADATA_SLOTS]
+	uint32_t mLastCallbackSeq;
+	// luma statistics for frame metadata, read by capture thread without lock
+	volatile int mStatsFlags;			// FRAME_STATS_XXX, 0: disabled
+	volatile int mStatsRoiX, mStatsRoiY, mStatsRoiWidth, mStatsRoiHeight;
+	volatile int mStatsRowStep;
+	// native frame processor plugins
+	pthread_mutex_t processor_mutex;
+	ObjectArray<FrameProcessor *> mFrameProcessors;
+	volatile int mNumFrameProcessors;
+	int mProcessorId;
+	// cross-process shared frame ring
+	pthread_mutex_t shm_mutex;
+	SharedFrameRing *mSharedRing;
+	// pre-roll buffer for event-triggered recording
+	pthread_mutex_t preroll_mutex;		// taken by the frame callback
+	pthread_mutex_t preroll_dump_mutex;	// keeps mPreRoll alive while dumping
+	PreRollBuffer *mPreRoll;
+	StillCapture *mStillCapture;
+	MjpegRecorder *mRecorder;
+	RawFrameDump *mRawDump;
+	AeAwbLoop * volatile mAeAwb;		// owned by UVCCamera
 // improve performance by reducing memory allocation
 	pthread_mutex_t pool_mutex;
 	ObjectArray<uvc_frame_t *> mFramePool;
@@ -99,9 +187,13 @@ private:
 	uvc_frame_t *waitPreviewFrame();
 	void clearPreviewFrame();
 	static void *preview_thread_func(void *vptr_args);
+	int get_stream_ctrl(uvc_stream_ctrl_t *ctrl, int width, int height,
+		int min_fps, int max_fps, int mode, bool *cached);
+	void startFirstFrameTimer();
 	int prepare_preview(uvc_stream_ctrl_t *ctrl);
 	void do_preview(uvc_stream_ctrl_t *ctrl);
 	uvc_frame_t *draw_preview_one(uvc_frame_t *frame, ANativeWindow **window, convFunc_t func, int pixelBytes);
+	void updateLatency(const uvc_frame_t *frame);
 //
 	void addCaptureFrame(uvc_frame_t *frame);
 	uvc_frame_t *waitCaptureFrame();
@@ -111,6 +203,11 @@ private:
 	void do_capture_surface(JNIEnv *env);
 	void do_capture_idle_loop(JNIEnv *env);
 	void do_capture_callback(JNIEnv *env, uvc_frame_t *frame);
+	void do_capture_callback_ring(JNIEnv *env, uvc_frame_t *frame);
+	CallbackBufferRing *prepare_callback_ring(JNIEnv *env, int &slot);
+	void retire_callback_ring(JNIEnv *env, CallbackBufferRing *ring);
+	void fill_frame_metadata(int slot, const uvc_frame_t *frame, size_t bytes);
+	void update_frame_stats(int slot, const uvc_frame_t *frame, const uvc_frame_t *callback_frame);
 	void callbackPixelFormatChanged();
 public:
 	UVCPreview(uvc_device_handle_t *devh);
@@ -118,10 +215,33 @@ public:
 
 	inline const bool isRunning() const;
 	int setPreviewSize(int width, int height, int min_fps, int max_fps, int mode, float bandwidth = 1.0f);
+	int reconfigure(int width, int height, int min_fps, int max_fps, int mode, float bandwidth = 1.0f);
 	int setPreviewDisplay(ANativeWindow *preview_window);
-	int setFrameCallback(JNIEnv *env, jobject frame_callback_obj, int pixel_format);
+	int setFrameCallback(JNIEnv *env, jobject frame_callback_obj, int pixel_format, int num_buffers = 0);
+	int releaseFrame(JNIEnv *env, int index);
+	jobject getFrameMetadataBuffer(JNIEnv *env);
+	int setFrameStats(int flags, int roi_x, int roi_y, int roi_width, int roi_height, int row_step);
+	int addFrameProcessor(const char *path, const char *args);
+	int removeFrameProcessor(int id);
+	int startSharedFrameRing(int num_slots, size_t slot_bytes);
+	int stopSharedFrameRing();
+	int setPreRoll(size_t budget_bytes, int duration_ms);
+	int dumpPreRoll(const char *path);
+	int captureStill(const char *path, int timeout_ms);
+	int setStillQuality(int quality, int subsamp);
+	int startRecording(const char *path);
+	int stopRecording();
+	int getRecordingStats(async_writer_stats_t *stats);
+	int startRawDump(const char *path, uint32_t max_frames, uint64_t max_bytes);
+	int stopRawDump();
+	int setLowLatency(bool low_latency);
+	void setAeAwbLoop(AeAwbLoop *loop);
+	int64_t getLatency(bool average);
+	int64_t getTimeToFirstFrame();
 	int startPreview();
 	int stopPreview();
+	int pausePreview();
+	int resumePreview();
 	inline const bool isCapturing() const;
 	int setCaptureDisplay(ANativeWindow *capture_window);
 };
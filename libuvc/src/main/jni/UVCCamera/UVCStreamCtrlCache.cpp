@@ -0,0 +1,264 @@
+/*
+ * UVCCamera
+ * library and sample to access to UVC web camera on non-rooted Android device
+ *
+ * Copyright (c) 2014-2017 saki t_saki@serenegiant.com
+ *
+ * File name: UVCStreamCtrlCache.cpp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * All files in the folder are under this Apache License, Version 2.0.
+ * Files in the jni/libjpeg, jni/libusb, jin/libuvc, jni/rapidjson folder may have a different license, see the respective files.
+*/
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#if 1	// set 1 if you don't need debug log
+	#ifndef LOG_NDEBUG
+		#define	LOG_NDEBUG		// w/o LOGV/LOGD/MARK
+	#endif
+	#undef USE_LOGALL
+#else
+	#define USE_LOGALL
+	#undef LOG_NDEBUG
+//	#undef NDEBUG
+#endif
+
+#include "utilbase.h"
+#include "UVCStreamCtrlCache.h"
+#include "libuvc_internal.h"
+
+#define	LOCAL_DEBUG 0
+#define CACHE_MAGIC 0x43435655	// "UVCC"
+#define CACHE_VERSION 1
+#define MAX_CACHE_ENTRIES 64
+
+typedef struct cache_file_header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t entry_bytes;	// sizeof(stream_ctrl_entry_t), reject files from other ABI
+	uint32_t count;
+} cache_file_header_t;
+
+pthread_mutex_t UVCStreamCtrlCache::cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+ObjectArray<stream_ctrl_entry_t *> UVCStreamCtrlCache::mEntries;
+char *UVCStreamCtrlCache::mPath = NULL;
+
+bool UVCStreamCtrlCache::make_key(uvc_device_handle_t *devh, int mode, int width, int height,
+	int min_fps, int max_fps, stream_ctrl_key_t *key) {
+
+	struct libusb_device_descriptor desc;
+	if (UNLIKELY(!devh || libusb_get_device_descriptor(devh->dev->usb_dev, &desc))) {
+		return false;
+	}
+	memset(key, 0, sizeof(*key));
+	key->vid = desc.idVendor;
+	key->pid = desc.idProduct;
+	key->bcdDevice = desc.bcdDevice;
+	key->mode = mode ? 1 : 0;
+	key->width = width;
+	key->height = height;
+	key->min_fps = min_fps;
+	key->max_fps = max_fps;
+	return true;
+}
+
+// must be called with cache_mutex held
+int UVCStreamCtrlCache::find(const stream_ctrl_key_t *key) {
+	const int n = mEntries.size();
+	for (int i = 0; i < n; i++) {
+		if (!memcmp(&mEntries[i]->key, key, sizeof(*key))) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+/**
+ * 查找缓存的协商结果
+ * @return true: 命中
+ */
+bool UVCStreamCtrlCache::get(uvc_device_handle_t *devh, int mode, int width, int height,
+	int min_fps, int max_fps, uvc_stream_ctrl_t *ctrl) {
+
+	stream_ctrl_key_t key;
+	bool result = false;
+	if (LIKELY(make_key(devh, mode, width, height, min_fps, max_fps, &key))) {
+		pthread_mutex_lock(&cache_mutex);
+		{
+			const int ix = find(&key);
+			if (ix >= 0) {
+				*ctrl = mEntries[ix]->ctrl;
+				result = true;
+			}
+		}
+		pthread_mutex_unlock(&cache_mutex);
+	}
+#if LOCAL_DEBUG
+	LOGD("(%d,%d)@%d:%s", width, height, mode, result ? "hit" : "miss");
+#endif
+	return result;
+}
+
+void UVCStreamCtrlCache::put(uvc_device_handle_t *devh, int mode, int width, int height,
+	int min_fps, int max_fps, const uvc_stream_ctrl_t *ctrl) {
+
+	stream_ctrl_key_t key;
+	if (UNLIKELY(!make_key(devh, mode, width, height, min_fps, max_fps, &key))) return;
+	pthread_mutex_lock(&cache_mutex);
+	{
+		const int ix = find(&key);
+		if (ix >= 0) {
+			mEntries[ix]->ctrl = *ctrl;
+		} else {
+			if (UNLIKELY(mEntries.size() >= MAX_CACHE_ENTRIES)) {
+				free(mEntries.remove(0));	// drop oldest
+			}
+			stream_ctrl_entry_t *entry = (stream_ctrl_entry_t *)malloc(sizeof(stream_ctrl_entry_t));
+			if (LIKELY(entry)) {
+				entry->key = key;
+				entry->ctrl = *ctrl;
+				mEntries.put(entry);
+			}
+		}
+		save_locked();
+	}
+	pthread_mutex_unlock(&cache_mutex);
+}
+
+/**
+ * 删除缓存的协商结果(commit失败时)
+ */
+void UVCStreamCtrlCache::remove(uvc_device_handle_t *devh, int mode, int width, int height,
+	int min_fps, int max_fps) {
+
+	stream_ctrl_key_t key;
+	if (UNLIKELY(!make_key(devh, mode, width, height, min_fps, max_fps, &key))) return;
+	pthread_mutex_lock(&cache_mutex);
+	{
+		const int ix = find(&key);
+		if (ix >= 0) {
+			free(mEntries.remove(ix));
+			save_locked();
+		}
+	}
+	pthread_mutex_unlock(&cache_mutex);
+}
+
+/**
+ * 设置保存缓存的文件路径并读入, NULL: 只保存在内存中
+ */
+int UVCStreamCtrlCache::setPath(const char *path) {
+	ENTER();
+	int result = 0;
+	pthread_mutex_lock(&cache_mutex);
+	{
+		SAFE_FREE(mPath);
+		if (path && path[0]) {
+			mPath = strdup(path);
+			result = load_locked();
+		}
+	}
+	pthread_mutex_unlock(&cache_mutex);
+	RETURN(result, int);
+}
+
+void UVCStreamCtrlCache::clear() {
+	pthread_mutex_lock(&cache_mutex);
+	{
+		clear_locked();
+		save_locked();
+	}
+	pthread_mutex_unlock(&cache_mutex);
+}
+
+void UVCStreamCtrlCache::clear_locked() {
+	const int n = mEntries.size();
+	for (int i = 0; i < n; i++) {
+		free(mEntries[i]);
+	}
+	mEntries.clear();
+}
+
+// merge entries in the file into memory, must be called with cache_mutex held
+int UVCStreamCtrlCache::load_locked() {
+	FILE *fp = fopen(mPath, "rb");
+	if (!fp) return 0;	// not saved yet
+	int result = -1;
+	cache_file_header_t header;
+	if ((fread(&header, sizeof(header), 1, fp) == 1)
+		&& (header.magic == CACHE_MAGIC)
+		&& (header.version == CACHE_VERSION)
+		&& (header.entry_bytes == sizeof(stream_ctrl_entry_t))
+		&& (header.count <= MAX_CACHE_ENTRIES)) {
+
+		stream_ctrl_entry_t entry;
+		result = 0;
+		for (uint32_t i = 0; i < header.count; i++) {
+			if (UNLIKELY(fread(&entry, sizeof(entry), 1, fp) != 1)) {
+				result = -1;
+				break;
+			}
+			if ((find(&entry.key) < 0) && (mEntries.size() < MAX_CACHE_ENTRIES)) {
+				stream_ctrl_entry_t *e = (stream_ctrl_entry_t *)malloc(sizeof(stream_ctrl_entry_t));
+				if (LIKELY(e)) {
+					*e = entry;
+					mEntries.put(e);
+				}
+			}
+		}
+	}
+	fclose(fp);
+	if (UNLIKELY(result)) {
+		LOGW("ignore broken cache file:%s", mPath);
+	}
+	return result;
+}
+
+// write to temporary file and rename it, must be called with cache_mutex held
+int UVCStreamCtrlCache::save_locked() {
+	if (!mPath) return 0;
+	const size_t len = strlen(mPath) + 5;
+	char *tmp = (char *)malloc(len);
+	if (UNLIKELY(!tmp)) return -1;
+	snprintf(tmp, len, "%s.tmp", mPath);
+	int result = -1;
+	FILE *fp = fopen(tmp, "wb");
+	if (LIKELY(fp)) {
+		cache_file_header_t header;
+		header.magic = CACHE_MAGIC;
+		header.version = CACHE_VERSION;
+		header.entry_bytes = sizeof(stream_ctrl_entry_t);
+		header.count = mEntries.size();
+		bool ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+		for (int i = 0; ok && (i < mEntries.size()); i++) {
+			ok = fwrite(mEntries[i], sizeof(stream_ctrl_entry_t), 1, fp) == 1;
+		}
+		ok = (fclose(fp) == 0) && ok;
+		if (LIKELY(ok && !rename(tmp, mPath))) {
+			result = 0;
+		} else {
+			unlink(tmp);
+		}
+	}
+	if (UNLIKELY(result)) {
+		LOGW("failed to save cache file:%s", mPath);
+	}
+	free(tmp);
+	return result;
+}
@@ -0,0 +1,79 @@
+/*
+ * UVCCamera
+ * library and sample to access to UVC web camera on non-rooted Android device
+ *
+ * Copyright (c) 2014-2017 saki t_saki@serenegiant.com
+ *
+ * File name: UVCStreamCtrlCache.h
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * All files in the folder are under this Apache License, Version 2.0.
+ * Files in the jni/libjpeg, jni/libusb, jin/libuvc, jni/rapidjson folder may have a different license, see the respective files.
+*/
+
+
+#ifndef UVCSTREAMCTRLCACHE_H_
+#define UVCSTREAMCTRLCACHE_H_
+
+#include "libUVCCamera.h"
+#include <pthread.h>
+#include "objectarray.h"
+
+#pragma interface
+
+// key of negotiated(committed) stream control
+typedef struct stream_ctrl_key {
+	uint16_t vid;
+	uint16_t pid;
+	uint16_t bcdDevice;
+	uint16_t mode;			// 0: YUYV, 1: MJPEG
+	uint16_t width;
+	uint16_t height;
+	int16_t min_fps;
+	int16_t max_fps;
+} stream_ctrl_key_t;
+
+typedef struct stream_ctrl_entry {
+	stream_ctrl_key_t key;
+	uvc_stream_ctrl_t ctrl;
+} stream_ctrl_entry_t;
+
+/**
+ * 协商结果(uvc_stream_ctrl_t)缓存, 进程内共享
+ * 命中时可以跳过probe, 只需要commit
+ * 设置路径后会保存到文件, 下次启动时读入
+ */
+class UVCStreamCtrlCache {
+private:
+	static pthread_mutex_t cache_mutex;
+	static ObjectArray<stream_ctrl_entry_t *> mEntries;
+	static char *mPath;
+	static bool make_key(uvc_device_handle_t *devh, int mode, int width, int height,
+		int min_fps, int max_fps, stream_ctrl_key_t *key);
+	static int find(const stream_ctrl_key_t *key);
+	static void clear_locked();
+	static int load_locked();
+	static int save_locked();
+public:
+	static bool get(uvc_device_handle_t *devh, int mode, int width, int height,
+		int min_fps, int max_fps, uvc_stream_ctrl_t *ctrl);
+	static void put(uvc_device_handle_t *devh, int mode, int width, int height,
+		int min_fps, int max_fps, const uvc_stream_ctrl_t *ctrl);
+	static void remove(uvc_device_handle_t *devh, int mode, int width, int height,
+		int min_fps, int max_fps);
+	static int setPath(const char *path);
+	static void clear();
+};
+
+#endif /* UVCSTREAMCTRLCACHE_H_ */
@@ -39,6 +39,7 @@
 
 #include "libUVCCamera.h"
 #include "UVCCamera.h"
+#include "UVCStreamCtrlCache.h"
 
 /**
  * set the value into the long field
@@ -240,6 +241,17 @@ static jint nativeSetPreviewSize(JNIEnv *env, jobject thiz,
 	RETURN(JNI_ERR, jint);
 }
 
+static jint nativeReconfigurePreview(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera, jint width, jint height, jint min_fps, jint max_fps, jint mode, jfloat bandwidth) {
+
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera)) {
+		return camera->reconfigurePreview(width, height, min_fps, max_fps, mode, bandwidth);
+	}
+	RETURN(JNI_ERR, jint);
+}
+
 static jint nativeStartPreview(JNIEnv *env, jobject thiz,
 	ID_TYPE id_camera) {
 
@@ -299,6 +311,335 @@ static jint nativeSetFrameCallback(JNIEnv *env, jobject thiz,
 	RETURN(result, jint);
 }
 
+static jint nativeSetLowLatency(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera, jboolean low_latency) {
+
+	jint result = JNI_ERR;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera)) {
+		result = camera->setLowLatency(low_latency);
+	}
+	RETURN(result, jint);
+}
+
+// 暂停预览, 保留传输缓冲区/线程等以便快速恢复
+static jint nativePausePreview(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera) {
+
+	jint result = JNI_ERR;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera)) {
+		result = camera->pausePreview();
+	}
+	RETURN(result, jint);
+}
+
+static jint nativeResumePreview(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera) {
+
+	jint result = JNI_ERR;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera)) {
+		result = camera->resumePreview();
+	}
+	RETURN(result, jint);
+}
+
+static jint nativeSetBufferedFrameCallback(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera, jobject jIBufferedFrameCallback, jint pixel_format, jint num_buffers) {
+
+	jint result = JNI_ERR;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera)) {
+		jobject frame_callback_obj = env->NewGlobalRef(jIBufferedFrameCallback);
+		result = camera->setFrameCallback(env, frame_callback_obj, pixel_format, num_buffers);
+	}
+	RETURN(result, jint);
+}
+
+// 每帧调用, 不输出ENTER/RETURN日志
+static jint nativeReleaseFrame(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera, jint index) {
+
+	jint result = JNI_ERR;
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera)) {
+		result = camera->releaseFrame(env, index);
+	}
+	return result;
+}
+
+static jobject nativeGetFrameMetadataBuffer(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera) {
+
+	jobject result = NULL;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera)) {
+		result = camera->getFrameMetadataBuffer(env);
+	}
+	RETURN(result, jobject);
+}
+
+// 附加到帧元数据的亮度统计(平均值/直方图/对焦评价值)
+static jint nativeSetFrameStats(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera, jint flags, jint roi_x, jint roi_y, jint roi_width, jint roi_height, jint row_step) {
+
+	jint result = JNI_ERR;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera)) {
+		result = camera->setFrameStats(flags, roi_x, roi_y, roi_width, roi_height, row_step);
+	}
+	RETURN(result, jint);
+}
+
+// 本地帧处理插件, 在本地工作线程上接收帧, 不经过Java
+static jint nativeAddFrameProcessor(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera, jstring path_str, jstring args_str) {
+
+	jint result = JNI_ERR;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera && path_str)) {
+		const char *c_path = env->GetStringUTFChars(path_str, JNI_FALSE);
+		const char *c_args = args_str ? env->GetStringUTFChars(args_str, JNI_FALSE) : NULL;
+		result = camera->addFrameProcessor(c_path, c_args);
+		if (c_args) {
+			env->ReleaseStringUTFChars(args_str, c_args);
+		}
+		env->ReleaseStringUTFChars(path_str, c_path);
+	}
+	RETURN(result, jint);
+}
+
+static jint nativeRemoveFrameProcessor(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera, jint id) {
+
+	jint result = JNI_ERR;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera)) {
+		result = camera->removeFrameProcessor(id);
+	}
+	RETURN(result, jint);
+}
+
+// 跨进程共享的帧环, 返回共享内存的fd
+static jint nativeStartSharedFrameRing(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera, jint num_slots, jint slot_bytes) {
+
+	jint result = JNI_ERR;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera)) {
+		result = camera->startSharedFrameRing(num_slots, slot_bytes > 0 ? slot_bytes : 0);
+	}
+	RETURN(result, jint);
+}
+
+static jint nativeStopSharedFrameRing(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera) {
+
+	jint result = JNI_ERR;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera)) {
+		result = camera->stopSharedFrameRing();
+	}
+	RETURN(result, jint);
+}
+
+// 预录缓冲区
+static jint nativeSetPreRoll(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera, jint budget_bytes, jint duration_ms) {
+
+	jint result = JNI_ERR;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera)) {
+		result = camera->setPreRoll(budget_bytes > 0 ? budget_bytes : 0, duration_ms);
+	}
+	RETURN(result, jint);
+}
+
+static jint nativeDumpPreRoll(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera, jstring path_str) {
+
+	jint result = JNI_ERR;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera && path_str)) {
+		const char *c_path = env->GetStringUTFChars(path_str, JNI_FALSE);
+		result = camera->dumpPreRoll(c_path);
+		env->ReleaseStringUTFChars(path_str, c_path);
+	}
+	RETURN(result, jint);
+}
+
+// 静止图像, MJPEG时直接写入收到的jpeg, YUYV时用TurboJPEG编码
+static jint nativeCaptureStill(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera, jstring path_str, jint timeout_ms) {
+
+	jint result = JNI_ERR;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera && path_str)) {
+		const char *c_path = env->GetStringUTFChars(path_str, JNI_FALSE);
+		result = camera->captureStill(c_path, timeout_ms);
+		env->ReleaseStringUTFChars(path_str, c_path);
+	}
+	RETURN(result, jint);
+}
+
+static jint nativeSetStillQuality(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera, jint quality, jint subsamp) {
+
+	jint result = JNI_ERR;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera)) {
+		result = camera->setStillQuality(quality, subsamp);
+	}
+	RETURN(result, jint);
+}
+
+// MJPEG录像(Matroska), 不重新编码
+static jint nativeStartRecording(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera, jstring path_str) {
+
+	jint result = JNI_ERR;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera && path_str)) {
+		const char *c_path = env->GetStringUTFChars(path_str, JNI_FALSE);
+		result = camera->startRecording(c_path);
+		env->ReleaseStringUTFChars(path_str, c_path);
+	}
+	RETURN(result, jint);
+}
+
+static jint nativeStopRecording(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera) {
+
+	jint result = JNI_ERR;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera)) {
+		result = camera->stopRecording();
+	}
+	RETURN(result, jint);
+}
+
+// 原始帧转储(不转换), 用于离线分析
+static jint nativeStartRawDump(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera, jstring path_str, jint max_frames, jlong max_bytes) {
+
+	jint result = JNI_ERR;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera && path_str && (max_frames >= 0) && (max_bytes >= 0))) {
+		const char *c_path = env->GetStringUTFChars(path_str, JNI_FALSE);
+		result = camera->startRawDump(c_path, (uint32_t)max_frames, (uint64_t)max_bytes);
+		env->ReleaseStringUTFChars(path_str, c_path);
+	}
+	RETURN(result, jint);
+}
+
+static jint nativeStopRawDump(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera) {
+
+	jint result = JNI_ERR;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera)) {
+		result = camera->stopRawDump();
+	}
+	RETURN(result, jint);
+}
+
+// {bytes_written, bytes_queued, max_queued, throughput, writes, syncs, dropped}
+static jlongArray nativeGetRecordingStats(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera) {
+
+	jlongArray result = NULL;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	async_writer_stats_t stats;
+	if (LIKELY(camera && !camera->getRecordingStats(&stats))) {
+		const jlong values[] = {
+			(jlong)stats.bytes_written, (jlong)stats.bytes_queued, (jlong)stats.max_queued,
+			(jlong)stats.throughput, stats.writes, stats.syncs, stats.dropped,
+		};
+		const jsize n = sizeof(values) / sizeof(values[0]);
+		result = env->NewLongArray(n);
+		if (LIKELY(result)) {
+			env->SetLongArrayRegion(result, 0, n, values);
+		}
+	}
+	RETURN(result, jlongArray);
+}
+
+static jlong nativeGetTimeToFirstFrame(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera) {
+
+	jlong result = 0;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera)) {
+		result = camera->getTimeToFirstFrame();
+	}
+	RETURN(result, jlong);
+}
+
+// 协商结果缓存的保存路径, null: 只保存在内存中
+static jint nativeSetStreamCtrlCachePath(JNIEnv *env, jobject thiz,
+	jstring path_str) {
+
+	jint result;
+	ENTER();
+	const char *c_path = path_str ? env->GetStringUTFChars(path_str, JNI_FALSE) : NULL;
+	result = UVCStreamCtrlCache::setPath(c_path);
+	if (c_path) {
+		env->ReleaseStringUTFChars(path_str, c_path);
+	}
+	RETURN(result, jint);
+}
+
+static jint nativeClearStreamCtrlCache(JNIEnv *env, jobject thiz) {
+	ENTER();
+	UVCStreamCtrlCache::clear();
+	RETURN(0, jint);
+}
+
+static jint nativeSetThreadConfig(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera, jint type, jint policy, jint priority, jint cpu_mask) {
+
+	jint result = JNI_ERR;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera)) {
+		result = camera->setThreadConfig(type, policy, priority, (uint32_t)cpu_mask);
+	}
+	RETURN(result, jint);
+}
+
+static jlong nativeGetPreviewLatency(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera, jboolean average) {
+
+	jlong result = 0;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera)) {
+		result = camera->getPreviewLatency(average);
+	}
+	RETURN(result, jlong);
+}
+
 static jint nativeSetCaptureDisplay(JNIEnv *env, jobject thiz,
 	ID_TYPE id_camera, jobject jSurface) {
 
@@ -345,6 +686,321 @@ static jlong nativeGetProcSupports(JNIEnv *env, jobject thiz,
 	RETURN(result, jlong);
 }
 
+// 控制值缓存
+static jint nativeSetControlCache(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera, jboolean enable, jint refresh_ms) {
+
+	jint result = JNI_ERR;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera)) {
+		result = camera->setControlCache(enable, refresh_ms);
+	}
+	RETURN(result, jint);
+}
+
+// {hits, misses}
+static jlongArray nativeGetControlCacheStats(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera) {
+
+	jlongArray result = NULL;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	uint32_t hits, misses;
+	if (LIKELY(camera && !camera->getControlCacheStats(&hits, &misses))) {
+		const jlong values[] = { hits, misses };
+		result = env->NewLongArray(2);
+		if (LIKELY(result)) {
+			env->SetLongArrayRegion(result, 0, 2, values);
+		}
+	}
+	RETURN(result, jlongArray);
+}
+
+// 按控制id写入(同步)
+static jint nativeSetControl(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera, jint id, jint value) {
+
+	jint result = JNI_ERR;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera)) {
+		result = camera->setControl(id, value);
+	}
+	RETURN(result, jint);
+}
+
+// 按控制id写入(异步), 返回ticket
+static jint nativeSetControlAsync(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera, jint id, jint value) {
+
+	jint result = JNI_ERR;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera)) {
+		result = camera->setControlAsync(id, value);
+	}
+	RETURN(result, jint);
+}
+
+static jint nativeWaitControl(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera, jint ticket, jint timeout_ms) {
+
+	jint result = JNI_ERR;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera)) {
+		result = camera->waitControl(ticket, timeout_ms);
+	}
+	RETURN(result, jint);
+}
+
+static jint nativeSetControlCallback(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera, jobject jIControlCallback) {
+
+	jint result = JNI_ERR;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera)) {
+		jobject control_callback_obj = env->NewGlobalRef(jIControlCallback);
+		result = camera->setControlCallback(env, control_callback_obj);
+	}
+	RETURN(result, jint);
+}
+
+static jint nativeProbeControls(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera, jint timeout_ms) {
+
+	jint result = JNI_ERR;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera)) {
+		result = camera->probeControls(timeout_ms);
+	}
+	RETURN(result, jint);
+}
+
+/**
+ * @return {min, max, def, res, info, valid}, null if not supported
+ */
+static jintArray nativeGetControlCaps(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera, jint control_id) {
+
+	jintArray result = NULL;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera)) {
+		control_caps_t caps;
+		if (!camera->getControlCaps(control_id, &caps)) {
+			const jint values[6] = { caps.min, caps.max, caps.def, caps.res, (jint)caps.info, (jint)caps.valid };
+			result = env->NewIntArray(6);
+			if (LIKELY(result)) {
+				env->SetIntArrayRegion(result, 0, 6, values);
+			}
+		}
+	}
+	RETURN(result, jintArray);
+}
+
+/**
+ * @return result of each control, null if failed
+ */
+static jintArray nativeApplyControls(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera, jintArray ids_array, jintArray values_array) {
+
+	jintArray result = NULL;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	const jsize num = ids_array ? env->GetArrayLength(ids_array) : 0;
+	const jsize num_values = values_array ? env->GetArrayLength(values_array) : 0;
+	if (LIKELY(camera && (num > 0) && (num <= CONTROL_NUM) && (num_values == num))) {
+
+		jint ids[CONTROL_NUM], values[CONTROL_NUM], results[CONTROL_NUM];
+		env->GetIntArrayRegion(ids_array, 0, num, ids);
+		env->GetIntArrayRegion(values_array, 0, num, values);
+		if (!camera->applyControls(ids, values, results, num)) {
+			result = env->NewIntArray(num);
+			if (LIKELY(result)) {
+				env->SetIntArrayRegion(result, 0, num, results);
+			}
+		}
+	}
+	RETURN(result, jintArray);
+}
+
+static jobject nativeGetExtensionUnits(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera) {
+
+	ENTER();
+	jstring result = NULL;
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera)) {
+		char *c_str = camera->getExtensionUnits();
+		if (LIKELY(c_str)) {
+			result = env->NewStringUTF(c_str);
+			free(c_str);
+		}
+	}
+	RETURN(result, jobject);
+}
+
+#define XU_STACK_BUFFER 256	// most XU controls are shorter than this
+
+static jint nativeGetXuControl(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera, jint unit_id, jint selector, jbyteArray data_array) {
+
+	jint result = JNI_ERR;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	const jsize len = data_array ? env->GetArrayLength(data_array) : 0;
+	if (LIKELY(camera && (len > 0))) {
+		jbyte stack_buf[XU_STACK_BUFFER];
+		jbyte *buf = len <= XU_STACK_BUFFER ? stack_buf : (jbyte *)malloc(len);
+		if (LIKELY(buf)) {
+			result = camera->getXuControl(unit_id, selector, buf, len);
+			if (result > 0) {
+				env->SetByteArrayRegion(data_array, 0, result, buf);
+			}
+			if (buf != stack_buf) {
+				free(buf);
+			}
+		}
+	}
+	RETURN(result, jint);
+}
+
+static jint nativeSetXuControl(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera, jint unit_id, jint selector, jbyteArray data_array) {
+
+	jint result = JNI_ERR;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	const jsize len = data_array ? env->GetArrayLength(data_array) : 0;
+	if (LIKELY(camera && (len > 0))) {
+		jbyte stack_buf[XU_STACK_BUFFER];
+		jbyte *buf = len <= XU_STACK_BUFFER ? stack_buf : (jbyte *)malloc(len);
+		if (LIKELY(buf)) {
+			env->GetByteArrayRegion(data_array, 0, len, buf);
+			result = camera->setXuControl(unit_id, selector, buf, len);
+			if (buf != stack_buf) {
+				free(buf);
+			}
+		}
+	}
+	RETURN(result, jint);
+}
+
+//======================================================================
+// 控制的配置(快照)
+static jobject nativeExportControlProfile(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera) {
+
+	ENTER();
+	jstring result = NULL;
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera)) {
+		char *c_str = camera->exportControlProfile();
+		if (LIKELY(c_str)) {
+			result = env->NewStringUTF(c_str);
+			free(c_str);
+		}
+	}
+	RETURN(result, jobject);
+}
+
+static jint nativeImportControlProfile(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera, jstring profile_str) {
+
+	jint result = JNI_ERR;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera)) {
+		const char *c_profile = profile_str ? env->GetStringUTFChars(profile_str, JNI_FALSE) : NULL;
+		result = camera->importControlProfile(c_profile);
+		if (c_profile) {
+			env->ReleaseStringUTFChars(profile_str, c_profile);
+		}
+	}
+	RETURN(result, jint);
+}
+
+//======================================================================
+// PTZ运动控制
+static jint nativeSetPtzTarget(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera, jint axis, jint value, jint duration_ms) {
+
+	jint result = JNI_ERR;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera)) {
+		result = camera->setPtzTarget(axis, value, duration_ms);
+	}
+	RETURN(result, jint);
+}
+
+static jint nativeSetPtzVelocity(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera, jint axis, jint velocity) {
+
+	jint result = JNI_ERR;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera)) {
+		result = camera->setPtzVelocity(axis, velocity);
+	}
+	RETURN(result, jint);
+}
+
+static jint nativeHaltPtz(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera) {
+
+	jint result = JNI_ERR;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera)) {
+		result = camera->haltPtz();
+	}
+	RETURN(result, jint);
+}
+
+static jint nativeSetPtzPeriod(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera, jint period_ms) {
+
+	jint result = JNI_ERR;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera)) {
+		result = camera->setPtzPeriod(period_ms);
+	}
+	RETURN(result, jint);
+}
+
+static jint nativeSetSoftwareAeAwb(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera, jint flags, jint target, jint interval) {
+
+	jint result = JNI_ERR;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera)) {
+		result = camera->setSoftwareAeAwb(flags, target, interval);
+	}
+	RETURN(result, jint);
+}
+
+static jint nativeGetPtzPosition(JNIEnv *env, jobject thiz,
+	ID_TYPE id_camera, jint axis) {
+
+	jint result = 0;
+	ENTER();
+	UVCCamera *camera = reinterpret_cast<UVCCamera *>(id_camera);
+	if (LIKELY(camera)) {
+		int32_t value;
+		if (!camera->getPtzPosition(axis, value)) {
+			result = value;
+		}
+	}
+	RETURN(result, jint);
+}
+
 //======================================================================
 // Java mnethod correspond to this function should not be a static mathod
 static jint nativeUpdateScanningModeLimit(JNIEnv *env, jobject thiz,
@@ -2060,15 +2716,61 @@ static JNINativeMethod methods[] = {
 
 	{ "nativeGetSupportedSize",			"(J)Ljava/lang/String;", (void *) nativeGetSupportedSize },
 	{ "nativeSetPreviewSize",			"(JIIIIIF)I", (void *) nativeSetPreviewSize },
+	{ "nativeReconfigurePreview",		"(JIIIIIF)I", (void *) nativeReconfigurePreview },
 	{ "nativeStartPreview",				"(J)I", (void *) nativeStartPreview },
 	{ "nativeStopPreview",				"(J)I", (void *) nativeStopPreview },
 	{ "nativeSetPreviewDisplay",		"(JLandroid/view/Surface;)I", (void *) nativeSetPreviewDisplay },
 	{ "nativeSetFrameCallback",			"(JLcom/wardtn/uvccamera/uvc/IFrameCallback;I)I", (void *) nativeSetFrameCallback },
+	{ "nativeSetBufferedFrameCallback",	"(JLcom/wardtn/uvccamera/uvc/IBufferedFrameCallback;II)I", (void *) nativeSetBufferedFrameCallback },
+	{ "nativeReleaseFrame",				"(JI)I", (void *) nativeReleaseFrame },
+	{ "nativeGetFrameMetadataBuffer",	"(J)Ljava/nio/ByteBuffer;", (void *) nativeGetFrameMetadataBuffer },
+	{ "nativeSetFrameStats",			"(JIIIIII)I", (void *) nativeSetFrameStats },
+	{ "nativeAddFrameProcessor",		"(JLjava/lang/String;Ljava/lang/String;)I", (void *) nativeAddFrameProcessor },
+	{ "nativeRemoveFrameProcessor",		"(JI)I", (void *) nativeRemoveFrameProcessor },
+	{ "nativeStartSharedFrameRing",		"(JII)I", (void *) nativeStartSharedFrameRing },
+	{ "nativeStopSharedFrameRing",		"(J)I", (void *) nativeStopSharedFrameRing },
+	{ "nativeSetPreRoll",				"(JII)I", (void *) nativeSetPreRoll },
+	{ "nativeDumpPreRoll",				"(JLjava/lang/String;)I", (void *) nativeDumpPreRoll },
+	{ "nativeCaptureStill",				"(JLjava/lang/String;I)I", (void *) nativeCaptureStill },
+	{ "nativeSetStillQuality",			"(JII)I", (void *) nativeSetStillQuality },
+	{ "nativeStartRecording",			"(JLjava/lang/String;)I", (void *) nativeStartRecording },
+	{ "nativeStopRecording",			"(J)I", (void *) nativeStopRecording },
+	{ "nativeGetRecordingStats",		"(J)[J", (void *) nativeGetRecordingStats },
+	{ "nativeStartRawDump",				"(JLjava/lang/String;IJ)I", (void *) nativeStartRawDump },
+	{ "nativeStopRawDump",				"(J)I", (void *) nativeStopRawDump },
 
 	{ "nativeSetCaptureDisplay",		"(JLandroid/view/Surface;)I", (void *) nativeSetCaptureDisplay },
+	{ "nativeSetLowLatency",			"(JZ)I", (void *) nativeSetLowLatency },
+	{ "nativeGetPreviewLatency",		"(JZ)J", (void *) nativeGetPreviewLatency },
+	{ "nativeSetThreadConfig",			"(JIIII)I", (void *) nativeSetThreadConfig },
+	{ "nativeGetTimeToFirstFrame",		"(J)J", (void *) nativeGetTimeToFirstFrame },
+	{ "nativePausePreview",				"(J)I", (void *) nativePausePreview },
+	{ "nativeResumePreview",			"(J)I", (void *) nativeResumePreview },
+	{ "nativeSetStreamCtrlCachePath",	"(Ljava/lang/String;)I", (void *) nativeSetStreamCtrlCachePath },
+	{ "nativeClearStreamCtrlCache",		"()I", (void *) nativeClearStreamCtrlCache },
 
 	{ "nativeGetCtrlSupports",			"(J)J", (void *) nativeGetCtrlSupports },
 	{ "nativeGetProcSupports",			"(J)J", (void *) nativeGetProcSupports },
+	{ "nativeSetControlCache",			"(JZI)I", (void *) nativeSetControlCache },
+	{ "nativeGetControlCacheStats",		"(J)[J", (void *) nativeGetControlCacheStats },
+	{ "nativeSetControl",				"(JII)I", (void *) nativeSetControl },
+	{ "nativeSetControlAsync",			"(JII)I", (void *) nativeSetControlAsync },
+	{ "nativeWaitControl",				"(JII)I", (void *) nativeWaitControl },
+	{ "nativeSetControlCallback",		"(JLcom/wardtn/uvccamera/uvc/IControlCallback;)I", (void *) nativeSetControlCallback },
+	{ "nativeProbeControls",			"(JI)I", (void *) nativeProbeControls },
+	{ "nativeGetControlCaps",			"(JI)[I", (void *) nativeGetControlCaps },
+	{ "nativeApplyControls",			"(J[I[I)[I", (void *) nativeApplyControls },
+	{ "nativeGetExtensionUnits",		"(J)Ljava/lang/String;", (void *) nativeGetExtensionUnits },
+	{ "nativeGetXuControl",				"(JII[B)I", (void *) nativeGetXuControl },
+	{ "nativeSetXuControl",				"(JII[B)I", (void *) nativeSetXuControl },
+	{ "nativeExportControlProfile",		"(J)Ljava/lang/String;", (void *) nativeExportControlProfile },
+	{ "nativeImportControlProfile",		"(JLjava/lang/String;)I", (void *) nativeImportControlProfile },
+	{ "nativeSetPtzTarget",				"(JIII)I", (void *) nativeSetPtzTarget },
+	{ "nativeSetPtzVelocity",			"(JII)I", (void *) nativeSetPtzVelocity },
+	{ "nativeHaltPtz",					"(J)I", (void *) nativeHaltPtz },
+	{ "nativeSetPtzPeriod",				"(JI)I", (void *) nativeSetPtzPeriod },
+	{ "nativeGetPtzPosition",			"(JI)I", (void *) nativeGetPtzPosition },
+	{ "nativeSetSoftwareAeAwb",			"(JIII)I", (void *) nativeSetSoftwareAeAwb },
 
 	{ "nativeUpdateScanningModeLimit",	"(J)I", (void *) nativeUpdateScanningModeLimit },
 	{ "nativeSetScanningMode",			"(JI)I", (void *) nativeSetScanningMode },
@@ -0,0 +1,176 @@
+/*
+ * UVCCamera
+ * library and sample to access to UVC web camera on non-rooted Android device
+ *
+ * Copyright (c) 2014-2017 saki t_saki@serenegiant.com
+ *
+ * File name: test/uvc_shm_ring_test.c
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * All files in the folder are under this Apache License, Version 2.0.
+ * Files in the jni/libjpeg, jni/libusb, jin/libuvc, jni/rapidjson folder may have a different license, see the respective files.
+*/
+
+
+
+/*
+ * test of shared memory frame ring on plain Linux(no Android/libuvc needed)
+ *
+ *   cd UVCCamera/test
+ *   cc -std=gnu99 -O2 -I.. -o uvc_shm_ring_test uvc_shm_ring_test.c ../uvc_shm_reader.c
+ *   ./uvc_shm_ring_test
+ *
+ * writer(parent) and reader(child) are different processes sharing a memfd
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+
+#include "uvc_shm_ring.h"
+
+#define NUM_SLOTS 4
+#define SLOT_BYTES 4096
+#define NUM_FRAMES 2000
+
+#define CHECK(cond) do { if (!(cond)) { \
+	fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+	exit(1); } } while (0)
+
+static int create_ring(uvc_shm_header_t **header, size_t *total_bytes) {
+	const uint64_t bytes = uvc_shm_ring_bytes(NUM_SLOTS, SLOT_BYTES, NULL);
+	const int fd = syscall(__NR_memfd_create, "uvc_shm_ring_test", 0);
+	CHECK(fd >= 0);
+	CHECK(!ftruncate(fd, bytes));
+	void *addr = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	CHECK(addr != MAP_FAILED);
+	*header = (uvc_shm_header_t *)addr;
+	*total_bytes = bytes;
+	uvc_shm_ring_init(*header, NUM_SLOTS, SLOT_BYTES);
+	return fd;
+}
+
+/* frame n is filled with (n & 0xff) and its size depends on n */
+static uint32_t frame_bytes(uint64_t n) {
+	return 64 + (uint32_t)(n * 37 % (SLOT_BYTES - 64));
+}
+
+static int read_frames(int fd) {
+	uvc_shm_reader_t *reader = uvc_shm_reader_open(fd);
+	uvc_shm_frame_t frame;
+	uint64_t last = 0;
+	int received = 0, stale = 0, r;
+
+	CHECK(reader);
+	for ( ; ; ) {
+		r = uvc_shm_reader_acquire(reader, &frame, 5000);
+		if (r == -EPIPE) break;
+		CHECK(r == 0);
+		CHECK(frame.seq > last);
+		CHECK(frame.dropped == frame.seq - last - 1);
+		last = frame.seq;
+		const uint8_t *p = (const uint8_t *)frame.data;
+		const uint32_t bytes = frame.data_bytes;
+		int ok = (bytes == frame_bytes(frame.seq)) && (frame.width == (uint32_t)frame.seq);
+		uint32_t i;
+		for (i = 0; ok && (i < bytes); i++) {
+			ok = p[i] == (uint8_t)frame.seq;
+		}
+		// data may be broken only if the writer overwrote the slot
+		if (uvc_shm_reader_release(reader, &frame) == -ESTALE) {
+			stale++;
+		} else {
+			CHECK(ok);
+			received++;
+		}
+	}
+	uvc_shm_reader_close(reader);
+	printf("reader:received=%d,stale=%d,last=%llu\n", received, stale, (unsigned long long)last);
+	CHECK(received > 0);
+	return 0;
+}
+
+static void test_publish_and_read(void) {
+	uvc_shm_header_t *header;
+	size_t total_bytes;
+	const int fd = create_ring(&header, &total_bytes);
+	static uint8_t buf[SLOT_BYTES + 1];
+	uvc_shm_slot_t meta;
+	uint64_t n;
+	int status;
+
+	const pid_t pid = fork();
+	CHECK(pid >= 0);
+	if (!pid) {
+		exit(read_frames(fd));
+	}
+	usleep(100000);	// wait until the reader registers
+	memset(&meta, 0, sizeof(meta));
+	for (n = 1; n <= NUM_FRAMES; n++) {
+		const uint32_t bytes = frame_bytes(n);
+		memset(buf, (uint8_t)n, bytes);
+		meta.width = (uint32_t)n;
+		CHECK(!uvc_shm_ring_publish(header, buf, bytes, &meta));
+		if (!(n % 16)) usleep(1000);
+	}
+	CHECK(uvc_shm_ring_publish(header, buf, SLOT_BYTES + 1, &meta) < 0);
+	uvc_shm_ring_close(header);
+	CHECK(waitpid(pid, &status, 0) == pid);
+	CHECK(WIFEXITED(status) && !WEXITSTATUS(status));
+	munmap(header, total_bytes);
+	close(fd);
+}
+
+/* readers that exit without uvc_shm_reader_close must not keep their slot */
+static void test_reclaim_dead_reader(void) {
+	uvc_shm_header_t *header;
+	size_t total_bytes;
+	const int fd = create_ring(&header, &total_bytes);
+	uvc_shm_reader_t *readers[UVC_SHM_MAX_READERS];
+	int i, status;
+
+	for (i = 0; i < UVC_SHM_MAX_READERS; i++) {
+		const pid_t pid = fork();
+		CHECK(pid >= 0);
+		if (!pid) {
+			_exit(uvc_shm_reader_open(fd) ? 0 : 1);	// crash without close
+		}
+		CHECK(waitpid(pid, &status, 0) == pid);
+		CHECK(WIFEXITED(status) && !WEXITSTATUS(status));
+	}
+	for (i = 0; i < UVC_SHM_MAX_READERS; i++) {
+		readers[i] = uvc_shm_reader_open(fd);
+		CHECK(readers[i]);
+	}
+	// all slots are used by live readers now
+	CHECK(!uvc_shm_reader_open(fd) && (errno == EBUSY));
+	for (i = 0; i < UVC_SHM_MAX_READERS; i++) {
+		uvc_shm_reader_close(readers[i]);
+	}
+	munmap(header, total_bytes);
+	close(fd);
+	printf("reclaim:ok\n");
+}
+
+int main(void) {
+	test_publish_and_read();
+	test_reclaim_dead_reader();
+	printf("all tests passed\n");
+	return 0;
+}
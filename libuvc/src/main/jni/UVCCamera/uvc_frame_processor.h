@@ -0,0 +1,77 @@
+/*
+ * UVCCamera
+ * library and sample to access to UVC web camera on non-rooted Android device
+ *
+ * Copyright (c) 2014-2017 saki t_saki@serenegiant.com
+ *
+ * File name: uvc_frame_processor.h
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * All files in the folder are under this Apache License, Version 2.0.
+ * Files in the jni/libjpeg, jni/libusb, jin/libuvc, jni/rapidjson folder may have a different license, see the respective files.
+*/
+
+
+#ifndef UVC_FRAME_PROCESSOR_H_
+#define UVC_FRAME_PROCESSOR_H_
+
+/*
+ * C ABI of native frame processor plugin
+ * plugin .so is loaded by UVCCamera#addFrameProcessor with dlopen and
+ * receives frames from camera on its own native worker thread without JVM.
+ *
+ * plugin should export UVC_FRAME_PROCESSOR_ENTRY_NAME like this:
+ *
+ *   static const uvc_frame_processor_t processor = {
+ *     UVC_FRAME_PROCESSOR_ABI_VERSION, "motion", my_create, my_on_frame, my_destroy
+ *   };
+ *   extern "C" const uvc_frame_processor_t *uvc_frame_processor_entry(void) {
+ *     return &processor;
+ *   }
+ */
+
+#include <stdint.h>
+#include "libuvc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UVC_FRAME_PROCESSOR_ABI_VERSION 1
+#define UVC_FRAME_PROCESSOR_ENTRY_NAME "uvc_frame_processor_entry"
+
+typedef struct uvc_frame_processor {
+	/** must be UVC_FRAME_PROCESSOR_ABI_VERSION */
+	uint32_t abi_version;
+	/** name for log */
+	const char *name;
+	/** called once after loading, returns plugin context(can be NULL)
+	 * @param args string passed to UVCCamera#addFrameProcessor, can be NULL
+	 * @param result set non-zero to reject */
+	void *(*create)(const char *args, int *result);
+	/** called on the worker thread for each frame(MJPEG/YUYV as received)
+	 * the frame is valid only while this call,
+	 * frames that arrive while this is running are dropped except the latest one */
+	void (*on_frame)(void *ctx, const uvc_frame_t *frame);
+	/** called on removing the processor or closing camera */
+	void (*destroy)(void *ctx);
+} uvc_frame_processor_t;
+
+typedef const uvc_frame_processor_t *(*uvc_frame_processor_entry_t)(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UVC_FRAME_PROCESSOR_H_ */
@@ -0,0 +1,191 @@
+/*
+ * UVCCamera
+ * library and sample to access to UVC web camera on non-rooted Android device
+ *
+ * Copyright (c) 2014-2017 saki t_saki@serenegiant.com
+ *
+ * File name: uvc_shm_reader.c
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * All files in the folder are under this Apache License, Version 2.0.
+ * Files in the jni/libjpeg, jni/libusb, jin/libuvc, jni/rapidjson folder may have a different license, see the respective files.
+*/
+
+
+/*
+ * reader library of shared memory frame ring
+ * built as libuvcshmreader, only depends on libc
+ */
+
+#include <stdlib.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "uvc_shm_ring.h"
+
+struct uvc_shm_reader {
+	uvc_shm_header_t *header;
+	size_t total_bytes;
+	int reader_id;
+	uint64_t cursor;
+};
+
+/* claim a free reader slot, or a slot of a process that died without close */
+static int claim_reader(uvc_shm_header_t *header, uint32_t pid) {
+	int i;
+
+	for (i = 0; i < UVC_SHM_MAX_READERS; i++) {
+		uint32_t expected = 0;
+		if (__atomic_compare_exchange_n(&header->readers[i].pid, &expected, pid,
+			0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+			return i;
+		}
+	}
+	for (i = 0; i < UVC_SHM_MAX_READERS; i++) {
+		uint32_t owner = __atomic_load_n(&header->readers[i].pid, __ATOMIC_ACQUIRE);
+		if (owner && (kill((pid_t)owner, 0) < 0) && (errno == ESRCH)
+			&& __atomic_compare_exchange_n(&header->readers[i].pid, &owner, pid,
+				0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+static int futex_wait(uint32_t *addr, uint32_t val, int timeout_ms) {
+	struct timespec ts;
+	if (timeout_ms >= 0) {
+		ts.tv_sec = timeout_ms / 1000;
+		ts.tv_nsec = (timeout_ms % 1000) * 1000000L;
+	}
+	// not FUTEX_PRIVATE_FLAG, the word is shared between processes
+	return syscall(__NR_futex, addr, FUTEX_WAIT, val, timeout_ms >= 0 ? &ts : NULL, NULL, 0);
+}
+
+uvc_shm_reader_t *uvc_shm_reader_open(int fd) {
+	struct stat st;
+	uvc_shm_header_t *header;
+	uvc_shm_reader_t *reader;
+	uint32_t pid = (uint32_t)getpid();
+
+	if (fstat(fd, &st) || (st.st_size < (off_t)sizeof(uvc_shm_header_t))) {
+		errno = EINVAL;
+		return NULL;
+	}
+	header = (uvc_shm_header_t *)mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (header == MAP_FAILED) {
+		return NULL;
+	}
+	if ((header->magic != UVC_SHM_MAGIC) || (header->version != UVC_SHM_VERSION)
+		|| (header->total_bytes > (uint64_t)st.st_size)) {
+
+		munmap(header, st.st_size);
+		errno = EPROTO;
+		return NULL;
+	}
+	reader = (uvc_shm_reader_t *)calloc(1, sizeof(uvc_shm_reader_t));
+	if (!reader) {
+		munmap(header, st.st_size);
+		errno = ENOMEM;
+		return NULL;
+	}
+	reader->header = header;
+	reader->total_bytes = st.st_size;
+	reader->reader_id = claim_reader(header, pid);
+	if (reader->reader_id < 0) {
+		munmap(header, st.st_size);
+		free(reader);
+		errno = EBUSY;
+		return NULL;
+	}
+	// start from the next frame
+	reader->cursor = __atomic_load_n(&header->write_seq, __ATOMIC_ACQUIRE);
+	__atomic_store_n(&header->readers[reader->reader_id].cursor, reader->cursor, __ATOMIC_RELAXED);
+	return reader;
+}
+
+int uvc_shm_reader_acquire(uvc_shm_reader_t *reader, uvc_shm_frame_t *frame, int timeout_ms) {
+	uvc_shm_header_t *header = reader->header;
+	const uint32_t num_slots = header->num_slots;
+	uint64_t write_seq, n;
+	uint32_t futex_val, ix;
+	uvc_shm_slot_t *slot;
+
+	for ( ; ; ) {
+		futex_val = __atomic_load_n(&header->futex, __ATOMIC_ACQUIRE);
+		write_seq = __atomic_load_n(&header->write_seq, __ATOMIC_ACQUIRE);
+		if (write_seq <= reader->cursor) {
+			if (__atomic_load_n(&header->writer_closed, __ATOMIC_ACQUIRE)) {
+				return -EPIPE;
+			}
+			__atomic_add_fetch(&header->num_waiters, 1, __ATOMIC_SEQ_CST);
+			const int r = futex_wait(&header->futex, futex_val, timeout_ms);
+			const int err = errno;
+			__atomic_sub_fetch(&header->num_waiters, 1, __ATOMIC_SEQ_CST);
+			if (r && (err == ETIMEDOUT)) {
+				return -EAGAIN;
+			}
+			continue;
+		}
+		n = reader->cursor + 1;
+		// the oldest slot is the next one the writer overwrites, skip it
+		if (write_seq >= n + num_slots - 1) {
+			n = write_seq + 2 > num_slots ? write_seq + 2 - num_slots : 1;
+			if (n > write_seq) n = write_seq;
+		}
+		ix = (uint32_t)((n - 1) % num_slots);
+		slot = uvc_shm_slot(header, ix);
+		if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != n * 2) {
+			// overwritten meanwhile, try again with newer write_seq
+			reader->cursor = n;
+			continue;
+		}
+		frame->data = uvc_shm_data(header, ix);
+		frame->seq = n;
+		frame->capture_time_us = slot->capture_time_us;
+		frame->data_bytes = slot->data_bytes;
+		frame->width = slot->width;
+		frame->height = slot->height;
+		frame->frame_format = slot->frame_format;
+		frame->pts = slot->pts;
+		frame->dropped = (uint32_t)(n - reader->cursor - 1);
+		reader->cursor = n;
+		return 0;
+	}
+}
+
+int uvc_shm_reader_release(uvc_shm_reader_t *reader, const uvc_shm_frame_t *frame) {
+	uvc_shm_header_t *header = reader->header;
+	uvc_shm_slot_t *slot = uvc_shm_slot(header, (uint32_t)((frame->seq - 1) % header->num_slots));
+
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	const int stale = __atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != frame->seq * 2;
+	__atomic_store_n(&header->readers[reader->reader_id].cursor, frame->seq, __ATOMIC_RELEASE);
+	return stale ? -ESTALE : 0;
+}
+
+void uvc_shm_reader_close(uvc_shm_reader_t *reader) {
+	if (reader) {
+		__atomic_store_n(&reader->header->readers[reader->reader_id].pid, 0, __ATOMIC_RELEASE);
+		munmap(reader->header, reader->total_bytes);
+		free(reader);
+	}
+}
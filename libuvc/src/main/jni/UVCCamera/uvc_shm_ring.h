@@ -0,0 +1,205 @@
+/*
+ * UVCCamera
+ * library and sample to access to UVC web camera on non-rooted Android device
+ *
+ * Copyright (c) 2014-2017 saki t_saki@serenegiant.com
+ *
+ * File name: uvc_shm_ring.h
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * All files in the folder are under this Apache License, Version 2.0.
+ * Files in the jni/libjpeg, jni/libusb, jin/libuvc, jni/rapidjson folder may have a different license, see the respective files.
+*/
+
+
+#ifndef UVC_SHM_RING_H_
+#define UVC_SHM_RING_H_
+
+/*
+ * shared memory frame ring(memfd/ashmem) for cross-process frame sharing
+ * single writer(UVCPreview) and up to UVC_SHM_MAX_READERS readers
+ *
+ * writer never blocks: frame n is written to slot (n - 1) % num_slots and
+ * the slot's seq is odd while writing, so readers can detect the frame was
+ * overwritten while they read it(seqlock).
+ * readers wait on header->futex, which is incremented on every publish.
+ *
+ * the writer does not read the reader cursors, they only show how far each
+ * reader got(for diagnostics). a reader that is slower than the writer is not
+ * protected by its cursor, consistency of the frame data relies only on the
+ * slot's seq: uvc_shm_reader_release returns -ESTALE if the slot was
+ * overwritten while the reader accessed it and the reader must discard it.
+ *
+ * reader slots are claimed with the reader's pid. a slot whose process died
+ * without uvc_shm_reader_close is reclaimed by the next uvc_shm_reader_open.
+ *
+ * this header is shared with the reader library(libuvcshmreader)
+ * and does not depend on libuvc/JNI.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UVC_SHM_MAGIC 0x52485355	// "USHR"
+#define UVC_SHM_VERSION 1
+#define UVC_SHM_MAX_READERS 8
+
+typedef struct uvc_shm_slot {
+	uint64_t seq;				// 2n - 1 while writing frame n, 2n after written
+	int64_t capture_time_us;	// host time when the frame was completed
+	uint32_t data_bytes;
+	uint32_t width;
+	uint32_t height;
+	int32_t frame_format;		// enum uvc_frame_format
+	uint32_t pts;
+	uint32_t reserved[7];
+} uvc_shm_slot_t;	// 64 bytes
+
+typedef struct uvc_shm_reader_state {
+	uint32_t pid;				// 0: free
+	uint32_t reserved;
+	uint64_t cursor;			// number of the last released frame
+} uvc_shm_reader_state_t;
+
+typedef struct uvc_shm_header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t num_slots;
+	uint32_t slot_bytes;		// capacity of data area of each slot
+	uint64_t data_offset;		// offset of data area of slot 0 from the top of header
+	uint64_t total_bytes;
+	uint64_t write_seq;			// number of published frames
+	uint32_t futex;				// incremented on every publish/close
+	uint32_t num_waiters;
+	uint32_t writer_closed;
+	uint32_t reserved0;
+	uvc_shm_reader_state_t readers[UVC_SHM_MAX_READERS];
+	// uvc_shm_slot_t slots[num_slots] follows
+} uvc_shm_header_t;
+
+static inline uvc_shm_slot_t *uvc_shm_slot(uvc_shm_header_t *header, uint32_t ix) {
+	return (uvc_shm_slot_t *)((uint8_t *)header + sizeof(uvc_shm_header_t)) + ix;
+}
+
+static inline uint8_t *uvc_shm_data(uvc_shm_header_t *header, uint32_t ix) {
+	return (uint8_t *)header + header->data_offset + (uint64_t)ix * header->slot_bytes;
+}
+
+/* writer side, used by SharedFrameRing and the Linux test */
+
+#define UVC_SHM_PAGE_SIZE 4096
+
+/** total bytes of the ring, slot_bytes should be multiple of 64 */
+static inline uint64_t uvc_shm_ring_bytes(uint32_t num_slots, uint32_t slot_bytes, uint64_t *data_offset) {
+	const uint64_t offset = (sizeof(uvc_shm_header_t) + sizeof(uvc_shm_slot_t) * num_slots
+		+ UVC_SHM_PAGE_SIZE - 1) & ~((uint64_t)UVC_SHM_PAGE_SIZE - 1);
+	if (data_offset) *data_offset = offset;
+	return offset + (uint64_t)slot_bytes * num_slots;
+}
+
+/** initialize mapped ring, magic is written last */
+static inline void uvc_shm_ring_init(uvc_shm_header_t *header, uint32_t num_slots, uint32_t slot_bytes) {
+	uint64_t data_offset;
+	const uint64_t total_bytes = uvc_shm_ring_bytes(num_slots, slot_bytes, &data_offset);
+	memset(header, 0, data_offset);
+	header->num_slots = num_slots;
+	header->slot_bytes = slot_bytes;
+	header->data_offset = data_offset;
+	header->total_bytes = total_bytes;
+	header->version = UVC_SHM_VERSION;
+	__atomic_store_n(&header->magic, UVC_SHM_MAGIC, __ATOMIC_RELEASE);
+}
+
+static inline void uvc_shm_ring_wake(uvc_shm_header_t *header) {
+	syscall(__NR_futex, &header->futex, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+/** write one frame, never waits for readers. only one thread may call this
+ * @param meta capture_time_us/width/height/frame_format/pts of the frame, seq and data_bytes are ignored
+ * @return 0: success, -1: larger than slot */
+static inline int uvc_shm_ring_publish(uvc_shm_header_t *header,
+	const void *data, uint32_t bytes, const uvc_shm_slot_t *meta) {
+
+	if (bytes > header->slot_bytes) return -1;
+	const uint64_t n = header->write_seq + 1;	// only the writer writes write_seq
+	const uint32_t ix = (uint32_t)((n - 1) % header->num_slots);
+	uvc_shm_slot_t *slot = uvc_shm_slot(header, ix);
+
+	// seqlock: odd while writing
+	__atomic_store_n(&slot->seq, n * 2 - 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	memcpy(uvc_shm_data(header, ix), data, bytes);
+	slot->capture_time_us = meta->capture_time_us;
+	slot->data_bytes = bytes;
+	slot->width = meta->width;
+	slot->height = meta->height;
+	slot->frame_format = meta->frame_format;
+	slot->pts = meta->pts;
+	__atomic_store_n(&slot->seq, n * 2, __ATOMIC_RELEASE);
+	__atomic_store_n(&header->write_seq, n, __ATOMIC_RELEASE);
+	__atomic_add_fetch(&header->futex, 1, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&header->num_waiters, __ATOMIC_SEQ_CST)) {
+		uvc_shm_ring_wake(header);
+	}
+	return 0;
+}
+
+/** tell readers that no more frames come */
+static inline void uvc_shm_ring_close(uvc_shm_header_t *header) {
+	__atomic_store_n(&header->writer_closed, 1, __ATOMIC_RELEASE);
+	__atomic_add_fetch(&header->futex, 1, __ATOMIC_RELEASE);
+	uvc_shm_ring_wake(header);
+}
+
+/* reader library */
+
+typedef struct uvc_shm_reader uvc_shm_reader_t;
+
+typedef struct uvc_shm_frame {
+	const void *data;			// points into shared memory, valid until released
+	uint64_t seq;				// frame number
+	int64_t capture_time_us;
+	uint32_t data_bytes;
+	uint32_t width;
+	uint32_t height;
+	int32_t frame_format;
+	uint32_t pts;
+	uint32_t dropped;			// frames skipped since previous acquire
+} uvc_shm_frame_t;
+
+/** map the ring and register as a reader, fd can be closed after this call
+ * @return NULL on error(errno is set) */
+uvc_shm_reader_t *uvc_shm_reader_open(int fd);
+/** wait for the next frame and access it without copying
+ * @param timeout_ms -1: wait forever
+ * @return 0: success, -EAGAIN: timeout, -EPIPE: writer closed */
+int uvc_shm_reader_acquire(uvc_shm_reader_t *reader, uvc_shm_frame_t *frame, int timeout_ms);
+/** finish accessing the frame
+ * @return 0: data was not changed while accessing, -ESTALE: overwritten by writer, discard results */
+int uvc_shm_reader_release(uvc_shm_reader_t *reader, const uvc_shm_frame_t *frame);
+void uvc_shm_reader_close(uvc_shm_reader_t *reader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UVC_SHM_RING_H_ */
@@ -105,6 +105,10 @@ enum uvc_frame_format {
     UVC_FRAME_FORMAT_MJPEG,
     UVC_FRAME_FORMAT_GRAY8,
     UVC_FRAME_FORMAT_BY8,
+    /** Y plane followed by interleaved U/V plane, output of uvc_yuyv2yuv420SP */
+    UVC_FRAME_FORMAT_NV12,
+    /** Y plane followed by interleaved V/U plane, output of uvc_yuyv2iyuv420SP */
+    UVC_FRAME_FORMAT_NV21,
     /** Number of formats understood */
     UVC_FRAME_FORMAT_COUNT,
 };
@@ -538,6 +542,16 @@ typedef struct uvc_frame {
     uint32_t sequence;
     /** Estimate of system time when the device started capturing the image */
     struct timeval capture_time;
+    /** CLOCK_MONOTONIC time [us] when the frame was completed, 0 if unknown */
+    int64_t capture_mono_us;
+    /** Presentation time stamp from the payload header(dwPresentationTime), 0 if not present */
+    uint32_t pts;
+    /** Source clock reference(STC part of SCR) of the last payload, 0 if not present */
+    uint32_t scr;
+    /** Error bits(UVC_STREAM_ERR) of the payload headers, actual_bytes is 0 when this is not 0 */
+    uint8_t bfh_err;
+    /** Size of received data even when bfh_err is not 0, only set on frames from the stream */
+    size_t received_bytes;
     /** Handle on the device that produced the image.
      * @warning You must not call any uvc_* functions during a callback. */
     uvc_device_handle_t *source;
@@ -587,12 +601,46 @@ typedef struct uvc_stream_ctrl {
     uint8_t bInterfaceNumber;
 } uvc_stream_ctrl_t;
 
+/** Threads whose scheduling can be configured with #uvc_set_thread_config
+ * @ingroup init
+ */
+enum uvc_thread_type {
+    /** libusb event handler thread (one per context) */
+    UVC_THREAD_EVENT = 0,
+    /** thread that calls uvc_frame_callback_t */
+    UVC_THREAD_CALLBACK = 1,
+    /** threads owned by the application (preview/capture) */
+    UVC_THREAD_PREVIEW = 2,
+    UVC_THREAD_CAPTURE = 3,
+    UVC_THREAD_NUM
+};
+
+/** Scheduling setup of a thread
+ * @ingroup init
+ */
+typedef struct uvc_thread_config {
+    /** SCHED_OTHER/SCHED_FIFO/SCHED_RR, -1 keeps current policy and priority */
+    int policy;
+    /** nice value for SCHED_OTHER, real-time priority for SCHED_FIFO/SCHED_RR */
+    int priority;
+    /** bit n => cpu n, 0 keeps current affinity */
+    uint32_t cpu_mask;
+} uvc_thread_config_t;
+
 uvc_error_t uvc_init(uvc_context_t **ctx, struct libusb_context *usb_ctx);
 
 uvc_error_t uvc_init2(uvc_context_t **ctx, struct libusb_context *usb_ctx, const char *usbfs);
 
 void uvc_exit(uvc_context_t *ctx);
 
+uvc_error_t uvc_set_thread_config(uvc_context_t *ctx, enum uvc_thread_type type,
+                                  const uvc_thread_config_t *config);
+
+uvc_error_t uvc_get_thread_config(uvc_context_t *ctx, enum uvc_thread_type type,
+                                  uvc_thread_config_t *config);
+
+uvc_error_t uvc_apply_thread_config(uvc_context_t *ctx, enum uvc_thread_type type);
+
 uvc_error_t uvc_get_device_list(uvc_context_t *ctx, uvc_device_t ***list);
 
 void uvc_free_device_list(uvc_device_t **list, uint8_t unref_devices);
@@ -678,6 +726,15 @@ uvc_error_t uvc_start_iso_streaming(uvc_device_handle_t *devh,
                                     uvc_stream_ctrl_t *ctrl, uvc_frame_callback_t *cb,
                                     void *user_ptr);
 
+uvc_error_t uvc_pause_streaming(uvc_device_handle_t *devh);
+
+uvc_error_t uvc_resume_streaming(uvc_device_handle_t *devh);
+
+uvc_error_t uvc_set_error_frames(uvc_device_handle_t *devh, int enable);
+
+uvc_error_t uvc_reconfigure_streaming(uvc_device_handle_t *devh,
+                                      uvc_stream_ctrl_t *ctrl, float bandwidth_factor);
+
 void uvc_stop_streaming(uvc_device_handle_t *devh);
 
 uvc_error_t uvc_stream_open_ctrl(uvc_device_handle_t *devh,
@@ -698,11 +755,45 @@ uvc_error_t uvc_stream_start_iso(uvc_stream_handle_t *strmh,
 uvc_error_t uvc_stream_get_frame(uvc_stream_handle_t *strmh,
                                  uvc_frame_t **frame, int32_t timeout_us);
 
+uvc_error_t uvc_stream_pause(uvc_stream_handle_t *strmh);
+
+uvc_error_t uvc_stream_resume(uvc_stream_handle_t *strmh);
+
+uvc_error_t uvc_stream_reconfigure(uvc_stream_handle_t *strmh,
+                                   uvc_stream_ctrl_t *ctrl, float bandwidth_factor);
+
 uvc_error_t uvc_stream_stop(uvc_stream_handle_t *strmh);
 
 void uvc_stream_close(uvc_stream_handle_t *strmh);
 
 // Generic Controls
+/** One request of uvc_ctrl_transfer_batch */
+typedef struct uvc_ctrl_request {
+  /** Terminal or unit ID */
+  uint8_t unit;
+  /** Control selector */
+  uint8_t selector;
+  /** UVC_GET_XXX or UVC_SET_CUR */
+  enum uvc_req_code req_code;
+  /** wLength */
+  uint16_t len;
+  /** Value to send(SET_CUR) or buffer to receive(GET_XXX), at least len bytes */
+  void *data;
+  /** Transferred bytes or uvc_error_t, set by uvc_ctrl_transfer_batch */
+  int result;
+  /** @internal */
+  void *priv;
+} uvc_ctrl_request_t;
+
+int uvc_query_ctrl(uvc_device_handle_t *devh, uint8_t unit, uint8_t selector,
+                 enum uvc_req_code req_code, void *data, uint16_t len);
+uvc_error_t uvc_ctrl_transfer_batch(uvc_device_handle_t *devh,
+                 uvc_ctrl_request_t *reqs, int num_reqs, int timeout_ms);
+uvc_error_t uvc_set_ctrl_cache(uvc_device_handle_t *devh, int enable, int refresh_ms);
+void uvc_invalidate_ctrl_cache(uvc_device_handle_t *devh);
+uvc_error_t uvc_get_ctrl_cache_stats(uvc_device_handle_t *devh,
+                 uint32_t *hits, uint32_t *misses);
+
 int uvc_get_ctrl_len(uvc_device_handle_t *devh, uint8_t unit, uint8_t ctrl);
 
 int uvc_get_ctrl(uvc_device_handle_t *devh, uint8_t unit, uint8_t ctrl,
@@ -1008,6 +1099,7 @@ uvc_error_t uvc_mjpeg2bgr(uvc_frame_t *in, uvc_frame_t *out);		// XXX
 uvc_error_t uvc_mjpeg2rgb565(uvc_frame_t *in, uvc_frame_t *out);	// XXX
 uvc_error_t uvc_mjpeg2rgbx(uvc_frame_t *in, uvc_frame_t *out);		// XXX
 uvc_error_t uvc_mjpeg2yuyv(uvc_frame_t *in, uvc_frame_t *out);		// XXX
+uvc_error_t uvc_mjpeg2jpeg(uvc_frame_t *in, uvc_frame_t *out);		// XXX
 #endif
 
 uvc_error_t uvc_yuyv2rgb565(uvc_frame_t *in, uvc_frame_t *out);        // XXX
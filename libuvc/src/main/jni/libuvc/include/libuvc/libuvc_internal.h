@@ -258,6 +258,14 @@ struct uvc_stream_handle {
 
   /** if true, stream is running (streaming video to host) */
   uint8_t running;
+  /** if true, transfers are not resubmitted while reconfiguring the stream */
+  uint8_t suspended;
+  /** if true, transfers are kept(parked) without resubmitting for quick resume */
+  uint8_t paused;
+  /** bit n => transfers[n] is parked */
+  uint32_t parked_mask;
+  /** bit n => transfers[n] was cancelled by uvc_stream_pause and is not parked yet */
+  uint32_t pause_cancel_mask;
   /** Current control block */
   struct uvc_stream_ctrl cur_ctrl;
 
@@ -268,6 +276,8 @@ struct uvc_stream_handle {
   uint32_t seq, hold_seq;
   uint32_t pts, hold_pts;
   uint32_t last_scr, hold_last_scr;
+  struct timeval hold_time;	// XXX host time when the frame was completed
+  int64_t hold_mono_us;		// same as hold_time but CLOCK_MONOTONIC, for measuring intervals
   size_t got_bytes, hold_bytes;
   size_t size_buf;	// XXX add for boundary check
   uint8_t *outbuf, *holdbuf;
@@ -283,6 +293,19 @@ struct uvc_stream_handle {
   enum uvc_frame_format frame_format;
 };
 
+/** cached GET_CUR value of a terminal/unit control(XXX added for control cache) */
+#define UVC_CTRL_CACHE_ENTRIES 64
+#define UVC_CTRL_CACHE_MAX_LEN 16
+#define UVC_CTRL_CACHE_REFRESH_MS 1000
+typedef struct uvc_ctrl_cache_entry {
+  uint16_t index;		// wIndex = unit/terminal ID << 8 | interface number
+  uint8_t selector;
+  uint8_t len;			// 0: invalid
+  uint8_t status;		// 1: the device reports changes of this control by status interrupt
+  int64_t time_ms;		// when the value was fetched from the device
+  uint8_t data[UVC_CTRL_CACHE_MAX_LEN];
+} uvc_ctrl_cache_entry_t;
+
 /** Handle on an open UVC device
  *
  * @todo move most of this into a uvc_device struct?
@@ -307,6 +330,16 @@ struct uvc_device_handle {
   /** Whether the camera is an iSight that sends one header per frame */
   uint8_t is_isight;
   uint8_t reset_on_release_if;	// XXX whether interface alt setting needs to reset to 0.
+  /** deliver frames with error bits to the user callback(for diagnostics) */
+  uint8_t error_frames;
+  /** GET_CUR cache, kept coherent by SET_CUR and status interrupts */
+  pthread_mutex_t ctrl_cache_mutex;
+  uint8_t ctrl_cache_enabled;
+  int ctrl_cache_refresh_ms;	// expiry of controls that never sent status, 0: never expire
+  uint32_t ctrl_cache_gen;		// incremented on every SET_CUR/status update
+  uint32_t ctrl_cache_hits, ctrl_cache_misses;
+  int ctrl_cache_num;
+  uvc_ctrl_cache_entry_t ctrl_cache[UVC_CTRL_CACHE_ENTRIES];
 };
 
 /** Context within which we communicate with devices */
@@ -318,9 +351,15 @@ struct uvc_context {
   /** List of open devices in this context */
   uvc_device_handle_t *open_devices;
   pthread_t handler_thread;
+  pid_t handler_tid;
   uint8_t kill_handler_thread;
+  /** scheduling setup of threads, applied when they start or when streaming starts */
+  uvc_thread_config_t thread_config[UVC_THREAD_NUM];
 };
 
+void uvc_ctrl_cache_status(uvc_device_handle_t *devh, uint8_t originator,
+    uint8_t selector, uint8_t attribute, const void *content, size_t content_len);
+
 uvc_error_t uvc_query_stream_ctrl(
     uvc_device_handle_t *devh,
     uvc_stream_ctrl_t *ctrl,
@@ -328,6 +367,7 @@ uvc_error_t uvc_query_stream_ctrl(
     enum uvc_req_code req);
 
 void uvc_start_handler_thread(uvc_context_t *ctx);
+void uvc_apply_handler_thread_config(uvc_context_t *ctx);
 uvc_error_t uvc_claim_if(uvc_device_handle_t *devh, int idx);
 uvc_error_t uvc_release_if(uvc_device_handle_t *devh, int idx);
 
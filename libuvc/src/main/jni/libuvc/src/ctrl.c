@@ -44,6 +44,8 @@
  * with the device's input, processing and output units.
  */
 
+#include <errno.h>
+#include <time.h>
 #include "libuvc/libuvc.h"
 #include "libuvc/libuvc_internal.h"
 
@@ -52,6 +54,484 @@ static const int REQ_TYPE_GET = 0xa1;
 
 #define CTRL_TIMEOUT_MILLIS 0
 
+/***** CONTROL CACHE *****/
+// XXX GET_CUR of terminal/unit controls are served from per-device cache.
+// SET_CUR invalidates the entry(the device may round the value) and the entries of manual
+// controls driven by it when it is a mode control(AE mode, auto WB/focus...), status interrupts
+// update it, controls that never sent status are fetched again after ctrl_cache_refresh_ms.
+
+static inline int64_t ctrl_cache_now_ms(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/** @internal must be called while holding ctrl_cache_mutex */
+static uvc_ctrl_cache_entry_t *ctrl_cache_find(uvc_device_handle_t *devh,
+		uint16_t index, uint8_t selector, int create) {
+	uvc_ctrl_cache_entry_t *entry = devh->ctrl_cache;
+	int i;
+	for (i = 0; i < devh->ctrl_cache_num; i++, entry++) {
+		if ((entry->index == index) && (entry->selector == selector))
+			return entry;
+	}
+	if (create && (devh->ctrl_cache_num < UVC_CTRL_CACHE_ENTRIES)) {
+		entry = &devh->ctrl_cache[devh->ctrl_cache_num++];
+		memset(entry, 0, sizeof(*entry));
+		entry->index = index;
+		entry->selector = selector;
+		return entry;
+	}
+	return NULL;
+}
+
+/** @internal
+ * vendor specific controls of extension units are never cached,
+ * they may be register windows etc. whose value changes without status interrupt
+ */
+static int ctrl_cache_is_xu(uvc_device_handle_t *devh, uint8_t unit) {
+	const uvc_extension_unit_t *xu;
+	DL_FOREACH(devh->info->ctrl_if.extension_unit_descs, xu) {
+		if (xu->bUnitID == unit)
+			return 1;
+	}
+	return 0;
+}
+
+/** @internal
+ * manual controls that the device drives while their mode control is auto,
+ * their cached values are stale once the mode control is changed
+ */
+typedef struct ctrl_cache_dep {
+	uint8_t mode;
+	uint8_t deps[3];	// 0 terminated
+} ctrl_cache_dep_t;
+
+static const ctrl_cache_dep_t ctrl_cache_ct_deps[] = {
+	{ UVC_CT_AE_MODE_CONTROL, { UVC_CT_EXPOSURE_TIME_ABSOLUTE_CONTROL,
+		UVC_CT_EXPOSURE_TIME_RELATIVE_CONTROL, UVC_CT_IRIS_ABSOLUTE_CONTROL } },
+	{ UVC_CT_AE_PRIORITY_CONTROL, { UVC_CT_EXPOSURE_TIME_ABSOLUTE_CONTROL, 0 } },
+	{ UVC_CT_FOCUS_AUTO_CONTROL, { UVC_CT_FOCUS_ABSOLUTE_CONTROL,
+		UVC_CT_FOCUS_RELATIVE_CONTROL, UVC_CT_FOCUS_SIMPLE_CONTROL } },
+};
+
+static const ctrl_cache_dep_t ctrl_cache_pu_deps[] = {
+	{ UVC_PU_WHITE_BALANCE_TEMPERATURE_AUTO_CONTROL, { UVC_PU_WHITE_BALANCE_TEMPERATURE_CONTROL, 0 } },
+	{ UVC_PU_WHITE_BALANCE_COMPONENT_AUTO_CONTROL, { UVC_PU_WHITE_BALANCE_COMPONENT_CONTROL, 0 } },
+	{ UVC_PU_HUE_AUTO_CONTROL, { UVC_PU_HUE_CONTROL, 0 } },
+	{ UVC_PU_CONTRAST_AUTO_CONTROL, { UVC_PU_CONTRAST_CONTROL, 0 } },
+};
+
+/** @internal must be called while holding ctrl_cache_mutex */
+static void ctrl_cache_drop(uvc_device_handle_t *devh, uint16_t index, uint8_t selector) {
+	uvc_ctrl_cache_entry_t *entry = ctrl_cache_find(devh, index, selector, 0);
+	if (entry)
+		entry->len = 0;
+}
+
+/** @internal
+ * drop the entry of the control and of the manual controls that depend on it
+ * must be called while holding ctrl_cache_mutex
+ */
+static void ctrl_cache_invalidate(uvc_device_handle_t *devh, uint16_t index, uint8_t selector) {
+	uvc_input_terminal_t *it;
+	uvc_processing_unit_t *pu;
+	const ctrl_cache_dep_t *deps = NULL;
+	int i, j, num = 0;
+
+	devh->ctrl_cache_gen++;
+	ctrl_cache_drop(devh, index, selector);
+	DL_FOREACH(devh->info->ctrl_if.input_term_descs, it) {
+		if (it->request == index) {
+			deps = ctrl_cache_ct_deps;
+			num = sizeof(ctrl_cache_ct_deps) / sizeof(ctrl_cache_ct_deps[0]);
+			break;
+		}
+	}
+	if (!deps) {
+		DL_FOREACH(devh->info->ctrl_if.processing_unit_descs, pu) {
+			if (pu->request == index) {
+				deps = ctrl_cache_pu_deps;
+				num = sizeof(ctrl_cache_pu_deps) / sizeof(ctrl_cache_pu_deps[0]);
+				break;
+			}
+		}
+	}
+	for (i = 0; i < num; i++) {
+		if (deps[i].mode != selector) continue;
+		for (j = 0; (j < 3) && deps[i].deps[j]; j++)
+			ctrl_cache_drop(devh, index, deps[i].deps[j]);
+	}
+	// auto exposure also drives the gain of processing units
+	if ((deps == ctrl_cache_ct_deps) && (selector == UVC_CT_AE_MODE_CONTROL)) {
+		DL_FOREACH(devh->info->ctrl_if.processing_unit_descs, pu) {
+			ctrl_cache_drop(devh, pu->request, UVC_PU_GAIN_CONTROL);
+		}
+	}
+}
+
+/** @internal
+ * libusb_control_transfer with GET_CUR cache, all requests in this file should come through here
+ */
+static int uvc_ctrl_transfer(uvc_device_handle_t *devh, uint8_t request_type,
+		uint8_t req_code, uint16_t wValue, uint16_t wIndex,
+		unsigned char *data, uint16_t len, unsigned int timeout) {
+
+	uvc_ctrl_cache_entry_t *entry;
+	const uint8_t selector = wValue >> 8;
+	// only controls on terminal/unit, the VideoControl interface itself has error code control etc.
+	const int cacheable = devh->ctrl_cache_enabled && (wIndex >> 8)
+		&& (len <= UVC_CTRL_CACHE_MAX_LEN) && !ctrl_cache_is_xu(devh, wIndex >> 8);
+	uint32_t gen = 0;
+	int ret;
+
+	if (cacheable && (request_type == REQ_TYPE_GET) && (req_code == UVC_GET_CUR)) {
+		pthread_mutex_lock(&devh->ctrl_cache_mutex);
+		{
+			entry = ctrl_cache_find(devh, wIndex, selector, 0);
+			if (entry && (entry->len == len)
+				&& (entry->status || !devh->ctrl_cache_refresh_ms
+					|| (ctrl_cache_now_ms() - entry->time_ms < devh->ctrl_cache_refresh_ms))) {
+				memcpy(data, entry->data, len);
+				devh->ctrl_cache_hits++;
+				pthread_mutex_unlock(&devh->ctrl_cache_mutex);
+				return len;
+			}
+			devh->ctrl_cache_misses++;
+			gen = devh->ctrl_cache_gen;
+		}
+		pthread_mutex_unlock(&devh->ctrl_cache_mutex);
+		ret = libusb_control_transfer(devh->usb_devh, request_type, req_code,
+			wValue, wIndex, data, len, timeout);
+		if (ret == len) {
+			pthread_mutex_lock(&devh->ctrl_cache_mutex);
+			// discard the value if SET_CUR/status interrupt came while transferring
+			if (gen == devh->ctrl_cache_gen) {
+				entry = ctrl_cache_find(devh, wIndex, selector, 1);
+				if (entry) {
+					memcpy(entry->data, data, len);
+					entry->len = len;
+					entry->time_ms = ctrl_cache_now_ms();
+				}
+			}
+			pthread_mutex_unlock(&devh->ctrl_cache_mutex);
+		}
+		return ret;
+	}
+
+	ret = libusb_control_transfer(devh->usb_devh, request_type, req_code,
+		wValue, wIndex, data, len, timeout);
+
+	if (cacheable && (request_type == REQ_TYPE_SET)) {
+		pthread_mutex_lock(&devh->ctrl_cache_mutex);
+		{
+			ctrl_cache_invalidate(devh, wIndex, selector);
+		}
+		pthread_mutex_unlock(&devh->ctrl_cache_mutex);
+	}
+	return ret;
+}
+
+/** @internal
+ * @brief Update the control cache with a control change status from the interrupt endpoint
+ *
+ * @param devh UVC device handle
+ * @param originator ID of the terminal/unit that sent the status
+ * @param selector control selector
+ * @param attribute bAttribute, 0: value change, 1: info change, 2: failure change
+ * @param content new value of the control for value change
+ * @param content_len length of content
+ */
+void uvc_ctrl_cache_status(uvc_device_handle_t *devh, uint8_t originator,
+		uint8_t selector, uint8_t attribute, const void *content, size_t content_len) {
+
+	uvc_ctrl_cache_entry_t *entry;
+	const uint16_t index = (originator << 8) | devh->info->ctrl_if.bInterfaceNumber;
+
+	pthread_mutex_lock(&devh->ctrl_cache_mutex);
+	{
+		// the device does not always send status for the dependent manual controls
+		ctrl_cache_invalidate(devh, index, selector);
+		entry = ctrl_cache_find(devh, index, selector, attribute == 0);
+		if (entry) {
+			entry->status = 1;
+			if ((attribute == 0) && content_len && (content_len <= UVC_CTRL_CACHE_MAX_LEN)) {
+				memcpy(entry->data, content, content_len);
+				entry->len = content_len;
+				entry->time_ms = ctrl_cache_now_ms();
+			} else {
+				entry->len = 0;
+			}
+		}
+	}
+	pthread_mutex_unlock(&devh->ctrl_cache_mutex);
+}
+
+/**
+ * @brief Enable/disable GET_CUR cache of terminal/unit controls
+ * @ingroup ctrl
+ *
+ * Cached values are updated by status interrupts, controls that never sent status
+ * are fetched from the device again when they are older than refresh_ms.
+ * @param devh UVC device handle
+ * @param enable 0: disable and clear the cache, 1: enable(default)
+ * @param refresh_ms expiry of controls without status interrupt, 0: never expire
+ */
+uvc_error_t uvc_set_ctrl_cache(uvc_device_handle_t *devh, int enable, int refresh_ms) {
+	if (UNLIKELY(!devh || (refresh_ms < 0)))
+		return UVC_ERROR_INVALID_PARAM;
+	pthread_mutex_lock(&devh->ctrl_cache_mutex);
+	{
+		devh->ctrl_cache_enabled = enable ? 1 : 0;
+		devh->ctrl_cache_refresh_ms = refresh_ms;
+		devh->ctrl_cache_gen++;
+		if (!enable)
+			devh->ctrl_cache_num = 0;
+	}
+	pthread_mutex_unlock(&devh->ctrl_cache_mutex);
+	return UVC_SUCCESS;
+}
+
+/**
+ * @brief Drop all cached control values, e.g. after the device was reset
+ * @ingroup ctrl
+ */
+void uvc_invalidate_ctrl_cache(uvc_device_handle_t *devh) {
+	if (UNLIKELY(!devh)) return;
+	pthread_mutex_lock(&devh->ctrl_cache_mutex);
+	{
+		devh->ctrl_cache_gen++;
+		devh->ctrl_cache_num = 0;
+	}
+	pthread_mutex_unlock(&devh->ctrl_cache_mutex);
+}
+
+/**
+ * @brief Get hit/miss count of the control cache
+ * @ingroup ctrl
+ */
+uvc_error_t uvc_get_ctrl_cache_stats(uvc_device_handle_t *devh,
+		uint32_t *hits, uint32_t *misses) {
+	if (UNLIKELY(!devh))
+		return UVC_ERROR_INVALID_PARAM;
+	pthread_mutex_lock(&devh->ctrl_cache_mutex);
+	{
+		if (hits) *hits = devh->ctrl_cache_hits;
+		if (misses) *misses = devh->ctrl_cache_misses;
+	}
+	pthread_mutex_unlock(&devh->ctrl_cache_mutex);
+	return UVC_SUCCESS;
+}
+
+/***** BATCHED CONTROL TRANSFERS *****/
+typedef struct ctrl_batch {
+	pthread_mutex_t mutex;
+	pthread_cond_t sync;
+	int pending;
+} ctrl_batch_t;
+
+static void LIBUSB_CALL _uvc_ctrl_batch_callback(struct libusb_transfer *transfer) {
+	uvc_ctrl_request_t *req = (uvc_ctrl_request_t *)transfer->user_data;
+	ctrl_batch_t *batch = (ctrl_batch_t *)req->priv;
+	int result;
+
+	switch (transfer->status) {
+	case LIBUSB_TRANSFER_COMPLETED:
+		result = transfer->actual_length;
+		if (req->req_code != UVC_SET_CUR)
+			memcpy(req->data, libusb_control_transfer_get_data(transfer), transfer->actual_length);
+		break;
+	case LIBUSB_TRANSFER_STALL:
+		result = UVC_ERROR_PIPE;
+		break;
+	case LIBUSB_TRANSFER_TIMED_OUT:
+	case LIBUSB_TRANSFER_CANCELLED:
+		result = UVC_ERROR_TIMEOUT;
+		break;
+	case LIBUSB_TRANSFER_NO_DEVICE:
+		result = UVC_ERROR_NO_DEVICE;
+		break;
+	default:
+		result = UVC_ERROR_IO;
+		break;
+	}
+	pthread_mutex_lock(&batch->mutex);
+	{
+		req->result = result;
+		batch->pending--;
+		pthread_cond_signal(&batch->sync);
+	}
+	pthread_mutex_unlock(&batch->mutex);
+}
+
+/**
+ * @brief Perform one GET_XXX/SET_CUR request of a terminal/unit control
+ * @ingroup ctrl
+ *
+ * Goes through the control cache like the typed accessors.
+ * @param devh UVC device handle
+ * @param unit terminal or unit ID
+ * @param selector control selector
+ * @param req_code UVC_SET_CUR or UVC_GET_XXX
+ * @param data value to send or buffer to receive, at least len bytes
+ * @param len wLength
+ * @return transferred bytes or uvc_error_t
+ */
+int uvc_query_ctrl(uvc_device_handle_t *devh, uint8_t unit, uint8_t selector,
+		enum uvc_req_code req_code, void *data, uint16_t len) {
+
+	if (UNLIKELY(!devh || !data || !len))
+		return UVC_ERROR_INVALID_PARAM;
+	return uvc_ctrl_transfer(devh,
+			req_code == UVC_SET_CUR ? REQ_TYPE_SET : REQ_TYPE_GET, req_code,
+			selector << 8, unit << 8 | devh->info->ctrl_if.bInterfaceNumber,
+			data, len, CTRL_TIMEOUT_MILLIS);
+}
+
+/**
+ * @brief Perform GET_XXX/SET_CUR requests of terminal/unit controls with async transfers in flight together
+ * @ingroup ctrl
+ *
+ * All requests are submitted at once and the device processes them in the order of reqs,
+ * so this takes one round trip instead of num_reqs. The event handler thread of libuvc
+ * must be running(it is when libuvc owns the libusb context).
+ * GET_CUR results update and SET_CUR invalidates the control cache.
+ * @param devh UVC device handle
+ * @param reqs requests, each result is set to transferred bytes or uvc_error_t
+ * @param num_reqs number of requests
+ * @param timeout_ms timeout of whole batch, remaining transfers are cancelled, 0: wait forever
+ * @return UVC_SUCCESS if all requests were executed(check each result), otherwise error
+ */
+uvc_error_t uvc_ctrl_transfer_batch(uvc_device_handle_t *devh,
+		uvc_ctrl_request_t *reqs, int num_reqs, int timeout_ms) {
+
+	ctrl_batch_t batch;
+	struct libusb_transfer **transfers;
+	struct timespec ts;
+	uvc_ctrl_cache_entry_t *entry;
+	uvc_error_t ret = UVC_SUCCESS;
+	uint32_t gen;
+	int i, timedout = 0;
+
+	UVC_ENTER();
+
+	if (UNLIKELY(!devh || !reqs || (num_reqs <= 0))) {
+		UVC_EXIT(UVC_ERROR_INVALID_PARAM);
+		return UVC_ERROR_INVALID_PARAM;
+	}
+	transfers = calloc(num_reqs, sizeof(*transfers));
+	if (UNLIKELY(!transfers)) {
+		UVC_EXIT(UVC_ERROR_NO_MEM);
+		return UVC_ERROR_NO_MEM;
+	}
+	pthread_mutex_init(&batch.mutex, NULL);
+	pthread_cond_init(&batch.sync, NULL);
+	batch.pending = 0;
+	pthread_mutex_lock(&devh->ctrl_cache_mutex);
+	gen = devh->ctrl_cache_gen;
+	pthread_mutex_unlock(&devh->ctrl_cache_mutex);
+
+	for (i = 0; i < num_reqs; i++) {
+		uvc_ctrl_request_t *req = &reqs[i];
+		const int is_set = req->req_code == UVC_SET_CUR;
+		const uint16_t index = (req->unit << 8) | devh->info->ctrl_if.bInterfaceNumber;
+		unsigned char *buf;
+		struct libusb_transfer *transfer = libusb_alloc_transfer(0);
+		buf = transfer ? malloc(LIBUSB_CONTROL_SETUP_SIZE + req->len) : NULL;
+		if (UNLIKELY(!buf)) {
+			if (transfer)
+				libusb_free_transfer(transfer);
+			req->result = UVC_ERROR_NO_MEM;
+			continue;
+		}
+		libusb_fill_control_setup(buf, is_set ? REQ_TYPE_SET : REQ_TYPE_GET, req->req_code,
+			req->selector << 8, index, req->len);
+		if (is_set)
+			memcpy(buf + LIBUSB_CONTROL_SETUP_SIZE, req->data, req->len);
+		libusb_fill_control_transfer(transfer, devh->usb_devh, buf,
+			_uvc_ctrl_batch_callback, req, 0);
+		transfer->flags = LIBUSB_TRANSFER_FREE_BUFFER;
+		req->priv = &batch;
+		pthread_mutex_lock(&batch.mutex);
+		// the callback may already have set req->result when submit returns
+		const int submitted = libusb_submit_transfer(transfer);
+		if (LIKELY(!submitted)) {
+			transfers[i] = transfer;
+			batch.pending++;
+		} else {
+			req->result = submitted;
+		}
+		pthread_mutex_unlock(&batch.mutex);
+		if (UNLIKELY(submitted)) {
+			libusb_free_transfer(transfer);
+			if (submitted == LIBUSB_ERROR_NO_DEVICE) {
+				ret = UVC_ERROR_NO_DEVICE;
+				break;
+			}
+		}
+	}
+
+	if (timeout_ms > 0) {
+		clock_gettime(CLOCK_REALTIME, &ts);
+		ts.tv_sec += timeout_ms / 1000;
+		ts.tv_nsec += (timeout_ms % 1000) * 1000000;
+		if (ts.tv_nsec >= 1000000000) {
+			ts.tv_sec++;
+			ts.tv_nsec -= 1000000000;
+		}
+	}
+	pthread_mutex_lock(&batch.mutex);
+	for ( ; batch.pending > 0 ; ) {
+		if ((timeout_ms > 0) && !timedout) {
+			if (pthread_cond_timedwait(&batch.sync, &batch.mutex, &ts) == ETIMEDOUT) {
+				// callbacks still come for cancelled transfers, wait them without timeout
+				timedout = 1;
+				for (i = 0; i < num_reqs; i++) {
+					if (transfers[i])
+						libusb_cancel_transfer(transfers[i]);
+				}
+			}
+		} else {
+			pthread_cond_wait(&batch.sync, &batch.mutex);
+		}
+	}
+	pthread_mutex_unlock(&batch.mutex);
+
+	for (i = 0; i < num_reqs; i++) {
+		if (transfers[i])
+			libusb_free_transfer(transfers[i]);
+	}
+	free(transfers);
+	pthread_cond_destroy(&batch.sync);
+	pthread_mutex_destroy(&batch.mutex);
+
+	// keep the control cache coherent
+	if (devh->ctrl_cache_enabled) {
+		pthread_mutex_lock(&devh->ctrl_cache_mutex);
+		// discard GET_CUR results if SET_CUR/status interrupt came while transferring
+		const int stale = gen != devh->ctrl_cache_gen;
+		for (i = 0; i < num_reqs; i++) {
+			uvc_ctrl_request_t *req = &reqs[i];
+			const uint16_t index = (req->unit << 8) | devh->info->ctrl_if.bInterfaceNumber;
+			if (req->req_code == UVC_SET_CUR) {
+				ctrl_cache_invalidate(devh, index, req->selector);
+			} else if (!stale && (req->req_code == UVC_GET_CUR) && (req->result == req->len)
+				&& (req->len <= UVC_CTRL_CACHE_MAX_LEN) && !ctrl_cache_is_xu(devh, req->unit)) {
+				entry = ctrl_cache_find(devh, index, req->selector, 1);
+				if (entry) {
+					memcpy(entry->data, req->data, req->len);
+					entry->len = req->len;
+					entry->time_ms = ctrl_cache_now_ms();
+				}
+			}
+		}
+		pthread_mutex_unlock(&devh->ctrl_cache_mutex);
+	}
+
+	UVC_EXIT(ret);
+	return ret;
+}
+
 /***** GENERIC CONTROLS *****/
 /**
  * @brief Get the length of a control on a terminal or unit.
@@ -66,9 +546,9 @@ static const int REQ_TYPE_GET = 0xa1;
 int uvc_get_ctrl_len(uvc_device_handle_t *devh, uint8_t unit, uint8_t ctrl) {
 	unsigned char buf[2];
 
-	int ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, UVC_GET_LEN,
+	int ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, UVC_GET_LEN,
 			ctrl << 8,
-			unit << 8,	// FIXME this will work wrong, invalid wIndex value
+			unit << 8 | devh->info->ctrl_if.bInterfaceNumber,
 			buf, 2, CTRL_TIMEOUT_MILLIS);
 
 	if (UNLIKELY(ret < 0))
@@ -92,9 +572,9 @@ int uvc_get_ctrl_len(uvc_device_handle_t *devh, uint8_t unit, uint8_t ctrl) {
  */
 int uvc_get_ctrl(uvc_device_handle_t *devh, uint8_t unit, uint8_t ctrl,
 		void *data, int len, enum uvc_req_code req_code) {
-	return libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	return uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			ctrl << 8,
-			unit << 8,	// FIXME this will work wrong, invalid wIndex value
+			unit << 8 | devh->info->ctrl_if.bInterfaceNumber,
 			data, len, CTRL_TIMEOUT_MILLIS);
 }
 
@@ -112,9 +592,9 @@ int uvc_get_ctrl(uvc_device_handle_t *devh, uint8_t unit, uint8_t ctrl,
  */
 int uvc_set_ctrl(uvc_device_handle_t *devh, uint8_t unit, uint8_t ctrl,
 		void *data, int len) {
-	return libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	return uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			ctrl << 8,
-			unit << 8,	// FIXME this will work wrong, invalid wIndex value
+			unit << 8 | devh->info->ctrl_if.bInterfaceNumber,
 			data, len, CTRL_TIMEOUT_MILLIS);
 }
 
@@ -125,7 +605,7 @@ uvc_error_t uvc_vc_get_error_code(uvc_device_handle_t *devh,
 	uint8_t error_char = 0;
 	uvc_error_t ret = UVC_SUCCESS;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_VC_REQUEST_ERROR_CODE_CONTROL << 8,
 			devh->info->ctrl_if.bInterfaceNumber,	// XXX saki
 			&error_char, sizeof(error_char), CTRL_TIMEOUT_MILLIS);
@@ -145,7 +625,7 @@ uvc_error_t uvc_vs_get_error_code(uvc_device_handle_t *devh,
 	uvc_error_t ret = UVC_SUCCESS;
 
 #if 0 // This code may cause hang-up on some combinations of device and camera and temporary disabled.
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_VS_STREAM_ERROR_CODE_CONTROL << 8,
 			devh->info->stream_ifs->bInterfaceNumber,	// XXX is this OK?
 			&error_char, sizeof(error_char), CTRL_TIMEOUT_MILLIS);
@@ -166,7 +646,7 @@ uvc_error_t uvc_get_power_mode(uvc_device_handle_t *devh,
 	uint8_t mode_char = 0;
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_VC_VIDEO_POWER_MODE_CONTROL << 8,
 			devh->info->ctrl_if.bInterfaceNumber,	// XXX saki
 			&mode_char, sizeof(mode_char), CTRL_TIMEOUT_MILLIS);
@@ -184,7 +664,7 @@ uvc_error_t uvc_set_power_mode(uvc_device_handle_t *devh,
 	uint8_t mode_char = mode;
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_VC_VIDEO_POWER_MODE_CONTROL << 8,
 			devh->info->ctrl_if.bInterfaceNumber,	// XXX saki
 			&mode_char, sizeof(mode_char), CTRL_TIMEOUT_MILLIS);
@@ -201,7 +681,7 @@ uvc_error_t uvc_get_ae_mode(uvc_device_handle_t *devh, uint8_t *mode,
 	uint8_t data[1];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_CT_AE_MODE_CONTROL << 8,
 //			1 << 8, /* = fixed ID(00) and wrong VideoControl interface descriptor subtype(UVC_VC_HEADER) on original libuvc */
 			devh->info->ctrl_if.input_term_descs->request,
@@ -221,7 +701,7 @@ uvc_error_t uvc_set_ae_mode(uvc_device_handle_t *devh, uint8_t mode) {
 
 	data[0] = mode;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_CT_AE_MODE_CONTROL << 8,
 //			1 << 8, /* = fixed ID(00) and wrong VideoControl interface descriptor subtype(UVC_VC_HEADER) on original libuvc */
 			devh->info->ctrl_if.input_term_descs->request,
@@ -239,7 +719,7 @@ uvc_error_t uvc_get_ae_priority(uvc_device_handle_t *devh, uint8_t *priority,
 	uint8_t data[1];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_CT_AE_PRIORITY_CONTROL << 8,
 //			1 << 8, /* = fixed ID(00) and wrong VideoControl interface descriptor subtype(UVC_VC_HEADER) on original libuvc */
 			devh->info->ctrl_if.input_term_descs->request,
@@ -259,7 +739,7 @@ uvc_error_t uvc_set_ae_priority(uvc_device_handle_t *devh, uint8_t priority) {
 
 	data[0] = priority;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_CT_AE_PRIORITY_CONTROL << 8,
 //			1 << 8, /* = fixed ID(00) and wrong VideoControl interface descriptor subtype(UVC_VC_HEADER) on original libuvc */
 			devh->info->ctrl_if.input_term_descs->request,
@@ -277,7 +757,7 @@ uvc_error_t uvc_get_exposure_abs(uvc_device_handle_t *devh, int *time,
 	uint8_t data[4];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_CT_EXPOSURE_TIME_ABSOLUTE_CONTROL << 8,
 //			1 << 8, /* = fixed ID(00) and wrong VideoControl interface descriptor subtype(UVC_VC_HEADER) on original libuvc */
 			devh->info->ctrl_if.input_term_descs->request,
@@ -297,7 +777,7 @@ uvc_error_t uvc_set_exposure_abs(uvc_device_handle_t *devh, int time) {
 
 	INT_TO_DW(time, data);
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_CT_EXPOSURE_TIME_ABSOLUTE_CONTROL << 8,
 //			1 << 8, /* = fixed ID(00) and wrong VideoControl interface descriptor subtype(UVC_VC_HEADER) on original libuvc */
 			devh->info->ctrl_if.input_term_descs->request,
@@ -314,7 +794,7 @@ uvc_error_t uvc_get_exposure_rel(uvc_device_handle_t *devh, int *step,
 	uint8_t data[1];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_CT_EXPOSURE_TIME_RELATIVE_CONTROL << 8,
 //			1 << 8, /* = fixed ID(00) and wrong VideoControl interface descriptor subtype(UVC_VC_HEADER) on original libuvc */
 			devh->info->ctrl_if.input_term_descs->request,
@@ -334,7 +814,7 @@ uvc_error_t uvc_set_exposure_rel(uvc_device_handle_t *devh, int step) {
 
 	data[0] = step;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_CT_EXPOSURE_TIME_RELATIVE_CONTROL << 8,
 //			1 << 8, /* = fixed ID(00) and wrong VideoControl interface descriptor subtype(UVC_VC_HEADER) on original libuvc */
 			devh->info->ctrl_if.input_term_descs->request,
@@ -352,7 +832,7 @@ uvc_error_t uvc_get_scanning_mode(uvc_device_handle_t *devh, uint8_t *mode,
 	uint8_t data[1];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_CT_SCANNING_MODE_CONTROL << 8,
 //			1 << 8, /* = fixed ID(00) and wrong VideoControl interface descriptor subtype(UVC_VC_HEADER) on original libuvc */
 			devh->info->ctrl_if.input_term_descs->request,
@@ -372,7 +852,7 @@ uvc_error_t uvc_set_scanning_mode(uvc_device_handle_t *devh, uint8_t mode) {
 
 	data[0] = mode;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_CT_SCANNING_MODE_CONTROL << 8,
 //			1 << 8, /* = fixed ID(00) and wrong VideoControl interface descriptor subtype(UVC_VC_HEADER) on original libuvc */
 			devh->info->ctrl_if.input_term_descs->request,
@@ -390,7 +870,7 @@ uvc_error_t uvc_get_focus_auto(uvc_device_handle_t *devh, uint8_t *autofocus,
 	uint8_t data[1];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_CT_FOCUS_AUTO_CONTROL << 8,
 //			1 << 8, /* = fixed ID(00) and wrong VideoControl interface descriptor subtype(UVC_VC_HEADER) on original libuvc */
 			devh->info->ctrl_if.input_term_descs->request,
@@ -410,7 +890,7 @@ uvc_error_t uvc_set_focus_auto(uvc_device_handle_t *devh, uint8_t autofocus) {
 
 	data[0] = autofocus;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_CT_FOCUS_AUTO_CONTROL << 8,
 //			1 << 8, /* = fixed ID(00) and wrong VideoControl interface descriptor subtype(UVC_VC_HEADER) on original libuvc */
 			devh->info->ctrl_if.input_term_descs->request,
@@ -428,7 +908,7 @@ uvc_error_t uvc_get_focus_abs(uvc_device_handle_t *devh, short *focus,
 	uint8_t data[2];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_CT_FOCUS_ABSOLUTE_CONTROL << 8,
 //			1 << 8, /* = fixed ID(00) and wrong VideoControl interface descriptor subtype(UVC_VC_HEADER) on original libuvc */
 			devh->info->ctrl_if.input_term_descs->request,
@@ -448,7 +928,7 @@ uvc_error_t uvc_set_focus_abs(uvc_device_handle_t *devh, short focus) {
 
 	SHORT_TO_SW(focus, data);
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_CT_FOCUS_ABSOLUTE_CONTROL << 8,
 //			1 << 8, /* = fixed ID(00) and wrong VideoControl interface descriptor subtype(UVC_VC_HEADER) on original libuvc */
 			devh->info->ctrl_if.input_term_descs->request,
@@ -465,7 +945,7 @@ uvc_error_t uvc_get_focus_rel(uvc_device_handle_t *devh, int8_t *focus, uint8_t
 	uint8_t data[2];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_CT_FOCUS_RELATIVE_CONTROL << 8,
 //			1 << 8, /* = fixed ID(00) and wrong VideoControl interface descriptor subtype(UVC_VC_HEADER) on original libuvc */
 			devh->info->ctrl_if.input_term_descs->request,
@@ -487,7 +967,7 @@ uvc_error_t uvc_set_focus_rel(uvc_device_handle_t *devh, int8_t focus, uint8_t s
 	data[0] = focus;
 	data[1] = speed;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_CT_FOCUS_RELATIVE_CONTROL << 8,
 //			1 << 8, /* = fixed ID(00) and wrong VideoControl interface descriptor subtype(UVC_VC_HEADER) on original libuvc */
 			devh->info->ctrl_if.input_term_descs->request,
@@ -505,7 +985,7 @@ uvc_error_t uvc_get_iris_abs(uvc_device_handle_t *devh, uint16_t *iris,
 	uint8_t data[2];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_CT_FOCUS_ABSOLUTE_CONTROL << 8,
 //			1 << 8, /* = fixed ID(00) and wrong VideoControl interface descriptor subtype(UVC_VC_HEADER) on original libuvc */
 			devh->info->ctrl_if.input_term_descs->request,
@@ -525,7 +1005,7 @@ uvc_error_t uvc_set_iris_abs(uvc_device_handle_t *devh, uint16_t iris) {
 
 	SHORT_TO_SW(iris, data);
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_CT_FOCUS_ABSOLUTE_CONTROL << 8,
 //			1 << 8, /* = fixed ID(00) and wrong VideoControl interface descriptor subtype(UVC_VC_HEADER) on original libuvc */
 			devh->info->ctrl_if.input_term_descs->request,
@@ -542,7 +1022,7 @@ uvc_error_t uvc_get_iris_rel(uvc_device_handle_t *devh, uint8_t *iris,
 	uint8_t data[1];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_CT_FOCUS_RELATIVE_CONTROL << 8,
 //			1 << 8, /* = fixed ID(00) and wrong VideoControl interface descriptor subtype(UVC_VC_HEADER) on original libuvc */
 			devh->info->ctrl_if.input_term_descs->request,
@@ -562,7 +1042,7 @@ uvc_error_t uvc_set_iris_rel(uvc_device_handle_t *devh, uint8_t iris) {
 
 	data[0] = iris;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_CT_FOCUS_RELATIVE_CONTROL << 8,
 //			1 << 8, /* = fixed ID(00) and wrong VideoControl interface descriptor subtype(UVC_VC_HEADER) on original libuvc */
 			devh->info->ctrl_if.input_term_descs->request,
@@ -580,7 +1060,7 @@ uvc_error_t uvc_get_zoom_abs(uvc_device_handle_t *devh, uint16_t *zoom,
 	uint8_t data[2];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_CT_ZOOM_ABSOLUTE_CONTROL << 8,
 			devh->info->ctrl_if.input_term_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -599,7 +1079,7 @@ uvc_error_t uvc_set_zoom_abs(uvc_device_handle_t *devh, uint16_t zoom) {
 
 	SHORT_TO_SW(zoom, data);
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_CT_ZOOM_ABSOLUTE_CONTROL << 8,
 			devh->info->ctrl_if.input_term_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -615,7 +1095,7 @@ uvc_error_t uvc_get_zoom_rel(uvc_device_handle_t *devh, int8_t *zoom, uint8_t *i
 	uint8_t data[3];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_CT_ZOOM_RELATIVE_CONTROL << 8,
 			devh->info->ctrl_if.input_term_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -638,7 +1118,7 @@ uvc_error_t uvc_set_zoom_rel(uvc_device_handle_t *devh, int8_t zoom, uint8_t isd
 	data[1] = isdigital;
 	data[2] = speed;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_CT_ZOOM_RELATIVE_CONTROL << 8,
 			devh->info->ctrl_if.input_term_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -656,7 +1136,7 @@ uvc_error_t uvc_get_pantilt_abs(uvc_device_handle_t *devh, int32_t *pan, int32_t
 	uint8_t data[8];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_CT_PANTILT_ABSOLUTE_CONTROL << 8,
 			devh->info->ctrl_if.input_term_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -677,7 +1157,7 @@ uvc_error_t uvc_set_pantilt_abs(uvc_device_handle_t *devh, int32_t pan, int32_t
 	INT_TO_DW(pan, data);
 	INT_TO_DW(tilt, data + 4);
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_CT_PANTILT_ABSOLUTE_CONTROL << 8,
 			devh->info->ctrl_if.input_term_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -696,7 +1176,7 @@ uvc_error_t uvc_get_pantilt_rel(uvc_device_handle_t *devh,
 	uint8_t data[4];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_CT_PANTILT_RELATIVE_CONTROL << 8,
 			devh->info->ctrl_if.input_term_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -724,7 +1204,7 @@ uvc_error_t uvc_set_pantilt_rel(uvc_device_handle_t *devh,
 	data[2] = tilt_rel;
 	data[3] = tilt_speed;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_CT_PANTILT_RELATIVE_CONTROL << 8,
 			devh->info->ctrl_if.input_term_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -741,7 +1221,7 @@ uvc_error_t uvc_get_roll_abs(uvc_device_handle_t *devh, int16_t *roll,
 	uint8_t data[2];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_CT_ROLL_ABSOLUTE_CONTROL << 8,
 			devh->info->ctrl_if.input_term_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -761,7 +1241,7 @@ uvc_error_t uvc_set_roll_abs(uvc_device_handle_t *devh, int16_t roll) {
 
 	SHORT_TO_SW(roll, data + 0);
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_CT_ROLL_ABSOLUTE_CONTROL << 8,
 			devh->info->ctrl_if.input_term_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -785,7 +1265,7 @@ uvc_error_t uvc_get_roll_rel(uvc_device_handle_t *devh, int8_t *roll_rel, uint8_
 	uint8_t data[2];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_CT_ROLL_RELATIVE_CONTROL << 8,
 			devh->info->ctrl_if.input_term_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -814,7 +1294,7 @@ uvc_error_t uvc_set_roll_rel(uvc_device_handle_t *devh, int8_t roll_rel, uint8_t
 	data[0] = roll_rel;
 	data[1] = speed;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_CT_ROLL_RELATIVE_CONTROL << 8,
 			devh->info->ctrl_if.input_term_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -837,7 +1317,7 @@ uvc_error_t uvc_get_privacy(uvc_device_handle_t *devh, uint8_t *privacy,
 	uint8_t data[1];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_CT_PRIVACY_CONTROL << 8,
 			devh->info->ctrl_if.input_term_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -863,7 +1343,7 @@ uvc_error_t uvc_set_privacy(uvc_device_handle_t *devh, uint8_t privacy) {
 
 	data[0] = privacy;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_CT_PRIVACY_CONTROL << 8,
 			devh->info->ctrl_if.input_term_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -894,7 +1374,7 @@ uvc_error_t uvc_get_digital_window(uvc_device_handle_t *devh,
 	uint8_t data[12];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_CT_DIGITAL_WINDOW_CONTROL << 8,
 			devh->info->ctrl_if.input_term_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -938,7 +1418,7 @@ uvc_error_t uvc_set_digital_window(uvc_device_handle_t *devh,
 	SHORT_TO_SW(num_steps, data + 8);
 	SHORT_TO_SW(num_steps_units, data + 10);
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_CT_DIGITAL_WINDOW_CONTROL << 8,
 			devh->info->ctrl_if.input_term_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -967,7 +1447,7 @@ uvc_error_t uvc_get_digital_roi(uvc_device_handle_t *devh,
 	uint8_t data[10];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_CT_REGION_OF_INTEREST_CONTROL << 8,
 			devh->info->ctrl_if.input_term_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1007,7 +1487,7 @@ uvc_error_t uvc_set_digital_roi(uvc_device_handle_t *devh,
 	SHORT_TO_SW(roi_right, data + 6);
 	SHORT_TO_SW(auto_controls, data + 8);
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_CT_REGION_OF_INTEREST_CONTROL << 8,
 			devh->info->ctrl_if.input_term_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1028,7 +1508,7 @@ uvc_error_t uvc_get_backlight_compensation(uvc_device_handle_t *devh, short *com
 	uint8_t data[2];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_PU_BACKLIGHT_COMPENSATION_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1048,7 +1528,7 @@ uvc_error_t uvc_set_backlight_compensation(uvc_device_handle_t *devh, short comp
 
 	SHORT_TO_SW(comp, data);
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_PU_BACKLIGHT_COMPENSATION_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1064,7 +1544,7 @@ uvc_error_t uvc_get_brightness(uvc_device_handle_t *devh, short *brightness,
 	uint8_t data[2];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_PU_BRIGHTNESS_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1084,7 +1564,7 @@ uvc_error_t uvc_set_brightness(uvc_device_handle_t *devh, short brightness) {
 
 	SHORT_TO_SW(brightness, data);
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_PU_BRIGHTNESS_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1100,7 +1580,7 @@ uvc_error_t uvc_get_contrast(uvc_device_handle_t *devh, uint16_t *contrast,
 	uint8_t data[2];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_PU_CONTRAST_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1120,7 +1600,7 @@ uvc_error_t uvc_set_contrast(uvc_device_handle_t *devh, uint16_t contrast) {
 
 	SHORT_TO_SW(contrast, data);
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_PU_CONTRAST_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1136,7 +1616,7 @@ uvc_error_t uvc_get_contrast_auto(uvc_device_handle_t *devh, uint8_t *autoContra
 	uint8_t data[1];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_PU_CONTRAST_AUTO_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1156,7 +1636,7 @@ uvc_error_t uvc_set_contrast_auto(uvc_device_handle_t *devh, uint8_t autoContras
 
 	data[0] = autoContrast ? 1 : 0;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_PU_CONTRAST_AUTO_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1172,7 +1652,7 @@ uvc_error_t uvc_get_gain(uvc_device_handle_t *devh, uint16_t *gain,
 	uint8_t data[2];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_PU_GAIN_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1192,7 +1672,7 @@ uvc_error_t uvc_set_gain(uvc_device_handle_t *devh, uint16_t gain) {
 
 	SHORT_TO_SW(gain, data);
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_PU_GAIN_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1208,7 +1688,7 @@ uvc_error_t uvc_get_powerline_freqency(uvc_device_handle_t *devh, uint8_t *freq,
 	uint8_t data[1];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_PU_POWER_LINE_FREQUENCY_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1239,7 +1719,7 @@ uvc_error_t uvc_set_powerline_freqency(uvc_device_handle_t *devh, uint8_t freq)
 
 	data[0] = freq & 0x03;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_PU_POWER_LINE_FREQUENCY_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1255,7 +1735,7 @@ uvc_error_t uvc_get_hue(uvc_device_handle_t *devh, short *hue,
 	uint8_t data[2];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_PU_HUE_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1275,7 +1755,7 @@ uvc_error_t uvc_set_hue(uvc_device_handle_t *devh, short hue) {
 
 	SHORT_TO_SW(hue, data);
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_PU_HUE_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1291,7 +1771,7 @@ uvc_error_t uvc_get_hue_auto(uvc_device_handle_t *devh, uint8_t *autoHue,
 	uint8_t data[1];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_PU_HUE_AUTO_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1311,7 +1791,7 @@ uvc_error_t uvc_set_hue_auto(uvc_device_handle_t *devh, uint8_t autoHue) {
 
 	data[0] = autoHue ? 1 : 0;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_PU_HUE_AUTO_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1327,7 +1807,7 @@ uvc_error_t uvc_get_saturation(uvc_device_handle_t *devh, uint16_t *saturation,
 	uint8_t data[2];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_PU_SATURATION_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1347,7 +1827,7 @@ uvc_error_t uvc_set_saturation(uvc_device_handle_t *devh, uint16_t saturation) {
 
 	SHORT_TO_SW(saturation, data);
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_PU_SATURATION_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1363,7 +1843,7 @@ uvc_error_t uvc_get_sharpness(uvc_device_handle_t *devh, uint16_t *sharpness,
 	uint8_t data[2];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_PU_SHARPNESS_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1383,7 +1863,7 @@ uvc_error_t uvc_set_sharpness(uvc_device_handle_t *devh, uint16_t sharpness) {
 
 	SHORT_TO_SW(sharpness, data);
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_PU_SHARPNESS_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1399,7 +1879,7 @@ uvc_error_t uvc_get_gamma(uvc_device_handle_t *devh, uint16_t *gamma,
 	uint8_t data[2];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_PU_GAMMA_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1419,7 +1899,7 @@ uvc_error_t uvc_set_gamma(uvc_device_handle_t *devh, uint16_t gamma) {
 
 	SHORT_TO_SW(gamma, data);
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_PU_GAMMA_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1435,7 +1915,7 @@ uvc_error_t uvc_get_white_balance_temperature(uvc_device_handle_t *devh, uint16_
 	uint8_t data[2];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_PU_WHITE_BALANCE_TEMPERATURE_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1455,7 +1935,7 @@ uvc_error_t uvc_set_white_balance_temperature(uvc_device_handle_t *devh, uint16_
 
 	SHORT_TO_SW(wb_temperature, data);
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_PU_WHITE_BALANCE_TEMPERATURE_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1471,7 +1951,7 @@ uvc_error_t uvc_get_white_balance_temperature_auto(uvc_device_handle_t *devh, ui
 	uint8_t data[1];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_PU_WHITE_BALANCE_TEMPERATURE_AUTO_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1491,7 +1971,7 @@ uvc_error_t uvc_set_white_balance_temperature_auto(uvc_device_handle_t *devh, ui
 
 	data[0] = autoWbTemp ? 1 : 0;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_PU_WHITE_BALANCE_TEMPERATURE_AUTO_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1507,7 +1987,7 @@ uvc_error_t uvc_get_white_balance_component(uvc_device_handle_t *devh, uint32_t
 	uint8_t data[4];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_PU_WHITE_BALANCE_COMPONENT_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1527,7 +2007,7 @@ uvc_error_t uvc_set_white_balance_component(uvc_device_handle_t *devh, uint32_t
 
 	INT_TO_DW(wb_compo, data);
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_PU_WHITE_BALANCE_COMPONENT_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1543,7 +2023,7 @@ uvc_error_t uvc_get_white_balance_component_auto(uvc_device_handle_t *devh, uint
 	uint8_t data[1];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_PU_WHITE_BALANCE_COMPONENT_AUTO_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1563,7 +2043,7 @@ uvc_error_t uvc_set_white_balance_component_auto(uvc_device_handle_t *devh, uint
 
 	data[0] = autoWbCompo ? 1 : 0;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_PU_WHITE_BALANCE_COMPONENT_AUTO_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1579,7 +2059,7 @@ uvc_error_t uvc_get_digital_multiplier(uvc_device_handle_t *devh, uint16_t *mult
 	uint8_t data[2];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_PU_DIGITAL_MULTIPLIER_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1599,7 +2079,7 @@ uvc_error_t uvc_set_digital_multiplier(uvc_device_handle_t *devh, uint16_t multi
 
 	SHORT_TO_SW(multiplier, data);
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_PU_DIGITAL_MULTIPLIER_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1615,7 +2095,7 @@ uvc_error_t uvc_get_digital_multiplier_limit(uvc_device_handle_t *devh, uint16_t
 	uint8_t data[2];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_PU_DIGITAL_MULTIPLIER_LIMIT_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1635,7 +2115,7 @@ uvc_error_t uvc_set_digital_multiplier_limit(uvc_device_handle_t *devh, uint16_t
 
 	SHORT_TO_SW(limit, data);
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_PU_DIGITAL_MULTIPLIER_LIMIT_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1651,7 +2131,7 @@ uvc_error_t uvc_get_analog_video_standard(uvc_device_handle_t *devh, uint8_t *st
 	uint8_t data[1];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_PU_ANALOG_VIDEO_STANDARD_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1671,7 +2151,7 @@ uvc_error_t uvc_set_analog_video_standard(uvc_device_handle_t *devh, uint8_t sta
 
 	data[0] = standard;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_PU_ANALOG_VIDEO_STANDARD_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1687,7 +2167,7 @@ uvc_error_t uvc_get_analog_video_lockstate(uvc_device_handle_t *devh, uint8_t *l
 	uint8_t data[1];
 	uvc_error_t ret;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_GET, req_code,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_GET, req_code,
 			UVC_PU_ANALOG_LOCK_STATUS_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -1707,7 +2187,7 @@ uvc_error_t uvc_set_analog_video_lockstate(uvc_device_handle_t *devh, uint8_t lo
 
 	data[0] = lock_state;
 
-	ret = libusb_control_transfer(devh->usb_devh, REQ_TYPE_SET, UVC_SET_CUR,
+	ret = uvc_ctrl_transfer(devh, REQ_TYPE_SET, UVC_SET_CUR,
 			UVC_PU_ANALOG_LOCK_STATUS_CONTROL << 8,
 			devh->info->ctrl_if.processing_unit_descs->request,
 			data, sizeof(data), CTRL_TIMEOUT_MILLIS);
@@ -304,6 +304,9 @@ uvc_error_t uvc_open(uvc_device_t *dev, uvc_device_handle_t **devh) {
 	internal_devh->reset_on_release_if = 0;	// XXX
 	ret = uvc_get_device_info(dev, &(internal_devh->info));
 	pthread_mutex_init(&internal_devh->status_mutex, NULL);	// XXX saki
+	pthread_mutex_init(&internal_devh->ctrl_cache_mutex, NULL);
+	internal_devh->ctrl_cache_enabled = 1;
+	internal_devh->ctrl_cache_refresh_ms = UVC_CTRL_CACHE_REFRESH_MS;
 
 	if (UNLIKELY(ret != UVC_SUCCESS))
 		goto fail2;	// uvc_claim_if was not called yet and we don't need to call uvc_release_if
@@ -1547,6 +1550,7 @@ void uvc_free_devh(uvc_device_handle_t *devh) {
 	UVC_ENTER();
 
 	pthread_mutex_destroy(&devh->status_mutex);	// XXX saki
+	pthread_mutex_destroy(&devh->ctrl_cache_mutex);
 	if (devh->info)
 		uvc_free_device_info(devh->info);
 
@@ -1664,6 +1668,9 @@ void uvc_process_control_status(uvc_device_handle_t *devh, unsigned char *data,
 
 	/* printf("bSelector: %d\n", selector); */
 
+	// keep GET_CUR cache coherent, also for extension units
+	uvc_ctrl_cache_status(devh, originator, selector, data[4], data + 5, len - 5);
+
 	DL_FOREACH(devh->info->ctrl_if.input_term_descs, input_terminal) {
 		if (input_terminal->bTerminalID == originator) {
 			status_class = UVC_STATUS_CLASS_CONTROL_CAMERA;
@@ -189,6 +189,10 @@ uvc_error_t uvc_mjpeg2rgb(uvc_frame_t *in, uvc_frame_t *out) {
 	out->step = in->width * 3;
 	out->sequence = in->sequence;
 	out->capture_time = in->capture_time;
+	out->capture_mono_us = in->capture_mono_us;
+	out->pts = in->pts;
+	out->scr = in->scr;
+	out->bfh_err = in->bfh_err;
 	out->source = in->source;
 
 	dinfo.err = jpeg_std_error(&jerr.super);
@@ -259,6 +263,10 @@ uvc_error_t uvc_mjpeg2bgr(uvc_frame_t *in, uvc_frame_t *out) {
 	out->step = in->width * 3;
 	out->sequence = in->sequence;
 	out->capture_time = in->capture_time;
+	out->capture_mono_us = in->capture_mono_us;
+	out->pts = in->pts;
+	out->scr = in->scr;
+	out->bfh_err = in->bfh_err;
 	out->source = in->source;
 
 	dinfo.err = jpeg_std_error(&jerr.super);
@@ -333,6 +341,10 @@ uvc_error_t uvc_mjpeg2rgb565(uvc_frame_t *in, uvc_frame_t *out) {
 	out->step = in->width * 2;
 	out->sequence = in->sequence;
 	out->capture_time = in->capture_time;
+	out->capture_mono_us = in->capture_mono_us;
+	out->pts = in->pts;
+	out->scr = in->scr;
+	out->bfh_err = in->bfh_err;
 	out->source = in->source;
 
 	dinfo.err = jpeg_std_error(&jerr.super);
@@ -410,6 +422,10 @@ uvc_error_t uvc_mjpeg2rgbx(uvc_frame_t *in, uvc_frame_t *out) {
 	out->step = in->width * 4;
 	out->sequence = in->sequence;
 	out->capture_time = in->capture_time;
+	out->capture_mono_us = in->capture_mono_us;
+	out->pts = in->pts;
+	out->scr = in->scr;
+	out->bfh_err = in->bfh_err;
 	out->source = in->source;
 
 	dinfo.err = jpeg_std_error(&jerr.super);
@@ -484,6 +500,10 @@ uvc_error_t uvc_mjpeg2yuyv(uvc_frame_t *in, uvc_frame_t *out) {
 	out->step = in->width * 2;
 	out->sequence = in->sequence;
 	out->capture_time = in->capture_time;
+	out->capture_mono_us = in->capture_mono_us;
+	out->pts = in->pts;
+	out->scr = in->scr;
+	out->bfh_err = in->bfh_err;
 	out->source = in->source;
 
 	struct jpeg_decompress_struct dinfo;
@@ -550,3 +570,98 @@ fail:
 	return lines_read == out->height ? UVC_SUCCESS : UVC_ERROR_OTHER+1;
 }
 
+
+// XXX write JPEG marker segment of huffman table(DHT)
+#define PUT_HUFF_TABLE(p, tc_th, name) do { \
+	*(p++) = (tc_th); \
+	memcpy(p, name##_len + 1, 16); p += 16; \
+	memcpy(p, name##_val, sizeof(name##_val)); p += sizeof(name##_val); \
+	} while(0)
+
+#define DHT_SEGMENT_BYTES (2 + 2 + 4 * 17 \
+	+ sizeof(dc_lumi_val) + sizeof(dc_chromi_val) + sizeof(ac_lumi_val) + sizeof(ac_chromi_val))
+
+/** @brief Make a complete JPEG file from an MJPEG frame without decoding
+ * @ingroup frame
+ *
+ * Validates SOI/SOS/EOI markers and inserts the standard Huffman tables(DHT)
+ * before SOS when the frame omits them, as insert_huff_tables does for decoding.
+ *
+ * @param in MJPEG frame
+ * @param out JPEG frame, actual_bytes is the size of the JPEG file
+ * @return UVC_ERROR_INVALID_PARAM if the frame is broken or truncated
+ */
+uvc_error_t uvc_mjpeg2jpeg(uvc_frame_t *in, uvc_frame_t *out) {
+	const uint8_t *src = in->data;
+	size_t bytes = in->actual_bytes ? in->actual_bytes : in->data_bytes;
+	size_t pos, sos = 0;
+	int has_dht = 0;
+	uint8_t *dst;
+
+	if (UNLIKELY(in->frame_format != UVC_FRAME_FORMAT_MJPEG))
+		return UVC_ERROR_INVALID_PARAM;
+	if (UNLIKELY((bytes < 4) || (src[0] != 0xff) || (src[1] != 0xd8)))
+		return UVC_ERROR_INVALID_PARAM;
+	// some cameras pad the payload after EOI
+	for ( ; (bytes > 4) && !((src[bytes - 2] == 0xff) && (src[bytes - 1] == 0xd9)) ; bytes--) {
+		if (src[bytes - 1])
+			return UVC_ERROR_INVALID_PARAM;	// truncated frame
+	}
+	if (UNLIKELY((src[bytes - 2] != 0xff) || (src[bytes - 1] != 0xd9)))
+		return UVC_ERROR_INVALID_PARAM;
+	// walk marker segments until SOS
+	for (pos = 2; pos + 4 <= bytes; ) {
+		if (UNLIKELY(src[pos] != 0xff))
+			return UVC_ERROR_INVALID_PARAM;
+		const uint8_t marker = src[pos + 1];
+		if (marker == 0xff) {	// fill byte
+			pos++;
+			continue;
+		}
+		if (marker == 0xda) {	// SOS
+			sos = pos;
+			break;
+		}
+		if (marker == 0xc4)		// DHT
+			has_dht = 1;
+		pos += 2 + ((src[pos + 2] << 8) | src[pos + 3]);
+	}
+	if (UNLIKELY(!sos))
+		return UVC_ERROR_INVALID_PARAM;
+
+	const size_t out_bytes = bytes + (has_dht ? 0 : DHT_SEGMENT_BYTES);
+	if (UNLIKELY(uvc_ensure_frame_size(out, out_bytes) < 0))
+		return UVC_ERROR_NO_MEM;
+
+	dst = out->data;
+	if (has_dht) {
+		memcpy(dst, src, bytes);
+	} else {
+		memcpy(dst, src, sos);
+		dst += sos;
+		*(dst++) = 0xff;
+		*(dst++) = 0xc4;
+		*(dst++) = ((DHT_SEGMENT_BYTES - 2) >> 8) & 0xff;
+		*(dst++) = (DHT_SEGMENT_BYTES - 2) & 0xff;
+		PUT_HUFF_TABLE(dst, 0x00, dc_lumi);
+		PUT_HUFF_TABLE(dst, 0x01, dc_chromi);
+		PUT_HUFF_TABLE(dst, 0x10, ac_lumi);
+		PUT_HUFF_TABLE(dst, 0x11, ac_chromi);
+		memcpy(dst, src + sos, bytes - sos);
+	}
+
+	out->width = in->width;
+	out->height = in->height;
+	out->frame_format = UVC_FRAME_FORMAT_MJPEG;
+	out->step = 0;
+	out->sequence = in->sequence;
+	out->capture_time = in->capture_time;
+	out->capture_mono_us = in->capture_mono_us;
+	out->pts = in->pts;
+	out->scr = in->scr;
+	out->bfh_err = in->bfh_err;
+	out->source = in->source;
+	out->actual_bytes = out_bytes;
+
+	return UVC_SUCCESS;
+}
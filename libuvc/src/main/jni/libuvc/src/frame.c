@@ -135,8 +135,13 @@ uvc_error_t uvc_duplicate_frame(uvc_frame_t *in, uvc_frame_t *out) {
 		out->step = in->step;
 	out->sequence = in->sequence;
 	out->capture_time = in->capture_time;
+	out->capture_mono_us = in->capture_mono_us;
+	out->pts = in->pts;
+	out->scr = in->scr;
+	out->bfh_err = in->bfh_err;
 	out->source = in->source;
 	out->actual_bytes = in->actual_bytes;	// XXX
+	out->received_bytes = in->received_bytes;
 
 #if USE_STRIDE	 // XXX
 	if (in->step && out->step) {
@@ -241,6 +246,10 @@ uvc_error_t uvc_rgb2rgbx(uvc_frame_t *in, uvc_frame_t *out) {
 		out->step = in->width * PIXEL_RGBX;
 	out->sequence = in->sequence;
 	out->capture_time = in->capture_time;
+	out->capture_mono_us = in->capture_mono_us;
+	out->pts = in->pts;
+	out->scr = in->scr;
+	out->bfh_err = in->bfh_err;
 	out->source = in->source;
 
 	uint8_t *prgb = in->data;
@@ -323,6 +332,10 @@ uvc_error_t uvc_rgb2rgb565(uvc_frame_t *in, uvc_frame_t *out) {
 		out->step = in->width * PIXEL_RGB565;
 	out->sequence = in->sequence;
 	out->capture_time = in->capture_time;
+	out->capture_mono_us = in->capture_mono_us;
+	out->pts = in->pts;
+	out->scr = in->scr;
+	out->bfh_err = in->bfh_err;
 	out->source = in->source;
 
 	uint8_t *prgb = in->data;
@@ -426,6 +439,10 @@ uvc_error_t uvc_yuyv2rgb(uvc_frame_t *in, uvc_frame_t *out) {
 		out->step = in->width * PIXEL_RGB;
 	out->sequence = in->sequence;
 	out->capture_time = in->capture_time;
+	out->capture_mono_us = in->capture_mono_us;
+	out->pts = in->pts;
+	out->scr = in->scr;
+	out->bfh_err = in->bfh_err;
 	out->source = in->source;
 
 	uint8_t *pyuv = in->data;
@@ -490,6 +507,10 @@ uvc_error_t uvc_yuyv2rgb565(uvc_frame_t *in, uvc_frame_t *out) {
 		out->step = in->width * PIXEL_RGB565;
 	out->sequence = in->sequence;
 	out->capture_time = in->capture_time;
+	out->capture_mono_us = in->capture_mono_us;
+	out->pts = in->pts;
+	out->scr = in->scr;
+	out->bfh_err = in->bfh_err;
 	out->source = in->source;
 
 	uint8_t *pyuv = in->data;
@@ -586,6 +607,10 @@ uvc_error_t uvc_yuyv2rgbx(uvc_frame_t *in, uvc_frame_t *out) {
 		out->step = in->width * PIXEL_RGBX;
 	out->sequence = in->sequence;
 	out->capture_time = in->capture_time;
+	out->capture_mono_us = in->capture_mono_us;
+	out->pts = in->pts;
+	out->scr = in->scr;
+	out->bfh_err = in->bfh_err;
 	out->source = in->source;
 
 	uint8_t *pyuv = in->data;
@@ -676,6 +701,10 @@ uvc_error_t uvc_yuyv2bgr(uvc_frame_t *in, uvc_frame_t *out) {
 		out->step = in->width * PIXEL_BGR;
 	out->sequence = in->sequence;
 	out->capture_time = in->capture_time;
+	out->capture_mono_us = in->capture_mono_us;
+	out->pts = in->pts;
+	out->scr = in->scr;
+	out->bfh_err = in->bfh_err;
 	out->source = in->source;
 
 	uint8_t *pyuv = in->data;
@@ -765,6 +794,10 @@ uvc_error_t uvc_uyvy2rgb(uvc_frame_t *in, uvc_frame_t *out) {
 		out->step = in->width * PIXEL_RGB;
 	out->sequence = in->sequence;
 	out->capture_time = in->capture_time;
+	out->capture_mono_us = in->capture_mono_us;
+	out->pts = in->pts;
+	out->scr = in->scr;
+	out->bfh_err = in->bfh_err;
 	out->source = in->source;
 
 	uint8_t *pyuv = in->data;
@@ -829,6 +862,10 @@ uvc_error_t uvc_uyvy2rgb565(uvc_frame_t *in, uvc_frame_t *out) {
 		out->step = in->width * PIXEL_RGB565;
 	out->sequence = in->sequence;
 	out->capture_time = in->capture_time;
+	out->capture_mono_us = in->capture_mono_us;
+	out->pts = in->pts;
+	out->scr = in->scr;
+	out->bfh_err = in->bfh_err;
 	out->source = in->source;
 
 	uint8_t *pyuv = in->data;
@@ -925,6 +962,10 @@ uvc_error_t uvc_uyvy2rgbx(uvc_frame_t *in, uvc_frame_t *out) {
 		out->step = in->width * PIXEL_RGBX;
 	out->sequence = in->sequence;
 	out->capture_time = in->capture_time;
+	out->capture_mono_us = in->capture_mono_us;
+	out->pts = in->pts;
+	out->scr = in->scr;
+	out->bfh_err = in->bfh_err;
 	out->source = in->source;
 
 	uint8_t *pyuv = in->data;
@@ -1014,6 +1055,10 @@ uvc_error_t uvc_uyvy2bgr(uvc_frame_t *in, uvc_frame_t *out) {
 		out->step = in->width * PIXEL_BGR;
 	out->sequence = in->sequence;
 	out->capture_time = in->capture_time;
+	out->capture_mono_us = in->capture_mono_us;
+	out->pts = in->pts;
+	out->scr = in->scr;
+	out->bfh_err = in->bfh_err;
 	out->source = in->source;
 
 	uint8_t *pyuv = in->data;
@@ -1163,6 +1208,14 @@ uvc_error_t uvc_yuyv2yuv420SP(uvc_frame_t *in, uvc_frame_t *out) {
 	const int32_t src_height = in->height;
 	const int32_t dest_width = out->width = out->step = in->width;
 	const int32_t dest_height = out->height = in->height;
+	out->frame_format = UVC_FRAME_FORMAT_NV12;
+	out->sequence = in->sequence;
+	out->capture_time = in->capture_time;
+	out->capture_mono_us = in->capture_mono_us;
+	out->pts = in->pts;
+	out->scr = in->scr;
+	out->bfh_err = in->bfh_err;
+	out->source = in->source;
 
 	const uint32_t hh = src_height < dest_height ? src_height : dest_height;
 	uint8_t *uv = dest + dest_width * dest_height;
@@ -1208,6 +1261,14 @@ uvc_error_t uvc_yuyv2iyuv420SP(uvc_frame_t *in, uvc_frame_t *out) {
 	const int32_t src_height = in->height;
 	const int32_t dest_width = out->width = out->step = in->width;
 	const int32_t dest_height = out->height = in->height;
+	out->frame_format = UVC_FRAME_FORMAT_NV21;
+	out->sequence = in->sequence;
+	out->capture_time = in->capture_time;
+	out->capture_mono_us = in->capture_mono_us;
+	out->pts = in->pts;
+	out->scr = in->scr;
+	out->bfh_err = in->bfh_err;
+	out->source = in->source;
 
 	const uint32_t hh = src_height < dest_height ? src_height : dest_height;
 	uint8_t *uv = dest + dest_width * dest_height;
@@ -79,13 +79,67 @@ YUV stream from a UVC device such as a standard webcam.
  * @defgroup init Library initialization/deinitialization
  * @brief Setup routines used to construct UVC access contexts
  */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE	// for sched_setaffinity/CPU_SET
+#endif
 #include "libuvc/libuvc.h"
 #include "libuvc/libuvc_internal.h"
-#if defined(__ANDROID__)
+#include <sched.h>
 #include <unistd.h>
 #include <sys/time.h>
 #include <sys/resource.h>
-#endif	// defined(__ANDROID__)
+
+static const char *thread_names[UVC_THREAD_NUM] = {
+	"uvc_event", "uvc_callback", "uvc_preview", "uvc_capture",
+};
+
+/** @internal
+ * @brief Apply scheduling setup to the specific thread
+ * @param tid kernel thread id, used for nice value and affinity
+ * @param thread pthread handle, used for name and real-time policy
+ */
+static void _uvc_apply_thread_config(pid_t tid, pthread_t thread,
+		const uvc_thread_config_t *config, const char *name) {
+
+	int i;
+
+	if (name)
+		pthread_setname_np(thread, name);
+	if (config->cpu_mask) {
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+		for (i = 0; i < 32; i++) {
+			if (config->cpu_mask & (1U << i))
+				CPU_SET(i, &cpus);
+		}
+		if (UNLIKELY(sched_setaffinity(tid, sizeof(cpus), &cpus)))
+			LOGW("%s:could not set affinity:mask=0x%x", name, config->cpu_mask);
+	}
+	switch (config->policy) {
+	case SCHED_FIFO:
+	case SCHED_RR:
+	{
+		struct sched_param param = { .sched_priority = config->priority };
+		if (LIKELY(!pthread_setschedparam(thread, config->policy, &param)))
+			break;
+		// usually needs CAP_SYS_NICE, fall back to highest nice value
+		LOGW("%s:could not set real-time policy, use nice instead", name);
+		if (UNLIKELY(setpriority(PRIO_PROCESS, tid, -19)))
+			LOGW("%s:could not change thread priority", name);
+		break;
+	}
+	case SCHED_OTHER:
+	{
+		struct sched_param param = { .sched_priority = 0 };
+		pthread_setschedparam(thread, SCHED_OTHER, &param);
+		if (UNLIKELY(setpriority(PRIO_PROCESS, tid, config->priority)))
+			LOGW("%s:could not change thread priority", name);
+		break;
+	}
+	default:
+		break;
+	}
+}
 
 /** @internal
  * @brief Event handler thread
@@ -95,14 +149,9 @@ YUV stream from a UVC device such as a standard webcam.
 void *_uvc_handle_events(void *arg) {
 	uvc_context_t *ctx = (uvc_context_t *) arg;
 
-#if defined(__ANDROID__)
-	// try to increase thread priority
-	int prio = getpriority(PRIO_PROCESS, 0);
-	nice(-18);
-	if (UNLIKELY(getpriority(PRIO_PROCESS, 0) >= prio)) {
-		LOGW("could not change thread priority");
-	}
-#endif
+	ctx->handler_tid = gettid();
+	_uvc_apply_thread_config(ctx->handler_tid, pthread_self(),
+		&ctx->thread_config[UVC_THREAD_EVENT], thread_names[UVC_THREAD_EVENT]);
 	for (; !ctx->kill_handler_thread ;)
 		libusb_handle_events(ctx->usb_ctx);
 	return NULL;
@@ -141,8 +190,15 @@ uvc_error_t uvc_init2(uvc_context_t **pctx, struct libusb_context *usb_ctx, cons
 		ctx->usb_ctx = usb_ctx;
 	}
 
-	if (ctx != NULL)
+	if (ctx != NULL) {
+		int i;
+		// same as previous hard coded nice(-18) for event handler thread
+		ctx->thread_config[UVC_THREAD_EVENT].policy = SCHED_OTHER;
+		ctx->thread_config[UVC_THREAD_EVENT].priority = -18;
+		for (i = UVC_THREAD_CALLBACK; i < UVC_THREAD_NUM; i++)
+			ctx->thread_config[i].policy = -1;
 		*pctx = ctx;
+	}
 
 	return ret;
 }
@@ -212,3 +268,63 @@ void uvc_start_handler_thread(uvc_context_t *ctx) {
 	}
 }
 
+/**
+ * @internal
+ * @brief Re-apply scheduling setup to the running handler thread
+ * @ingroup init
+ *
+ * called when streaming starts so that changes after #uvc_open take effect.
+ */
+void uvc_apply_handler_thread_config(uvc_context_t *ctx) {
+	if (ctx->own_usb_ctx && ctx->handler_tid) {
+		_uvc_apply_thread_config(ctx->handler_tid, ctx->handler_thread,
+			&ctx->thread_config[UVC_THREAD_EVENT], thread_names[UVC_THREAD_EVENT]);
+	}
+}
+
+/**
+ * @brief Set scheduling setup of a thread type
+ * @ingroup init
+ *
+ * The event handler and callback threads pick this up when streaming starts,
+ * application threads should call #uvc_apply_thread_config when they start.
+ *
+ * @param ctx UVC context
+ * @param type thread type
+ * @param config policy(-1 keeps current), nice value or real-time priority and cpu mask
+ */
+uvc_error_t uvc_set_thread_config(uvc_context_t *ctx, enum uvc_thread_type type,
+		const uvc_thread_config_t *config) {
+
+	if (UNLIKELY(!ctx || !config || (type < 0) || (type >= UVC_THREAD_NUM)))
+		return UVC_ERROR_INVALID_PARAM;
+	ctx->thread_config[type] = *config;
+	return UVC_SUCCESS;
+}
+
+/**
+ * @brief Get scheduling setup of a thread type
+ * @ingroup init
+ */
+uvc_error_t uvc_get_thread_config(uvc_context_t *ctx, enum uvc_thread_type type,
+		uvc_thread_config_t *config) {
+
+	if (UNLIKELY(!ctx || !config || (type < 0) || (type >= UVC_THREAD_NUM)))
+		return UVC_ERROR_INVALID_PARAM;
+	*config = ctx->thread_config[type];
+	return UVC_SUCCESS;
+}
+
+/**
+ * @brief Apply scheduling setup of a thread type to the calling thread
+ * @ingroup init
+ */
+uvc_error_t uvc_apply_thread_config(uvc_context_t *ctx, enum uvc_thread_type type) {
+
+	if (UNLIKELY(!ctx || (type < 0) || (type >= UVC_THREAD_NUM)))
+		return UVC_ERROR_INVALID_PARAM;
+	_uvc_apply_thread_config(gettid(), pthread_self(),
+		&ctx->thread_config[type], thread_names[type]);
+	return UVC_SUCCESS;
+}
+
@@ -69,6 +69,8 @@ uvc_frame_desc_t *uvc_find_frame_desc(uvc_device_handle_t *devh,
 		uint16_t format_id, uint16_t frame_id);
 static void *_uvc_user_caller(void *arg);
 static void _uvc_populate_frame(uvc_stream_handle_t *strmh);
+static uvc_error_t _uvc_stream_cancel_transfers(uvc_stream_handle_t *strmh);
+static void _uvc_park_transfer(struct libusb_transfer *transfer);
 
 struct format_table_entry {
 	enum uvc_frame_format format;
@@ -645,6 +647,12 @@ static void _uvc_swap_buffers(uvc_stream_handle_t *strmh) {
 		strmh->hold_last_scr = strmh->last_scr;
 		strmh->hold_pts = strmh->pts;
 		strmh->hold_seq = strmh->seq;
+		gettimeofday(&strmh->hold_time, NULL);
+		{
+			struct timespec mono;
+			clock_gettime(CLOCK_MONOTONIC, &mono);
+			strmh->hold_mono_us = (int64_t)mono.tv_sec * 1000000LL + mono.tv_nsec / 1000;
+		}
 
 		pthread_cond_broadcast(&strmh->cb_cond);
 	}
@@ -982,6 +990,8 @@ static inline void _uvc_process_payload_iso(uvc_stream_handle_t *strmh, struct l
 }
 #endif
 
+static int _uvc_take_pause_cancelled(struct libusb_transfer *transfer);
+
 /** @internal
  * @brief Isochronous transfer callback
  * 
@@ -1031,8 +1041,16 @@ static void _uvc_stream_callback(struct libusb_transfer *transfer) {
 		break;
 	}
 
-	if (LIKELY(strmh->running && resubmit)) {
+	if (UNLIKELY(!resubmit && strmh->pause_cancel_mask && !strmh->paused)
+		&& (transfer->status == LIBUSB_TRANSFER_CANCELLED)) {
+		// cancelled by uvc_stream_pause but completed after resume
+		resubmit = _uvc_take_pause_cancelled(transfer);
+	}
+	if (LIKELY(strmh->running && !strmh->suspended && !strmh->paused && resubmit)) {
 		libusb_submit_transfer(transfer);
+	} else if (strmh->running && strmh->paused && !strmh->suspended) {
+		// keep transfer and its buffer for uvc_stream_resume
+		_uvc_park_transfer(transfer);
 	} else {
 		// XXX delete non-reusing transfer
 		// real implementation of deleting transfer moves to _uvc_delete_transfer
@@ -1400,17 +1418,11 @@ uvc_error_t uvc_stream_start(uvc_stream_handle_t *strmh,
 	return uvc_stream_start_bandwidth(strmh, cb, user_ptr, 0, flags);
 }
 
-/** Begin streaming video from the stream into the callback function.
- * @ingroup streaming
- *
- * @param strmh UVC stream
- * @param cb   User callback function. See {uvc_frame_callback_t} for restrictions.
- * @param bandwidth_factor [0.0f, 1.0f]
- * @param flags Stream setup flags, currently undefined. Set this to zero. The lower bit
- * is reserved for backward compatibility.
+/** @internal
+ * @brief Select the altsetting for current stream control and set up the transfers
+ * transfers are allocated but not submitted
  */
-uvc_error_t uvc_stream_start_bandwidth(uvc_stream_handle_t *strmh,
-		uvc_frame_callback_t *cb, void *user_ptr, float bandwidth_factor, uint8_t flags) {
+static uvc_error_t _uvc_stream_prepare_transfers(uvc_stream_handle_t *strmh, float bandwidth_factor) {
 	/* USB interface we'll be using */
 	const struct libusb_interface *interface;
 	int interface_id;
@@ -1418,7 +1430,7 @@ uvc_error_t uvc_stream_start_bandwidth(uvc_stream_handle_t *strmh,
 	uvc_frame_desc_t *frame_desc;
 	uvc_format_desc_t *format_desc;
 	uvc_stream_ctrl_t *ctrl;
-	uvc_error_t ret;
+	uvc_error_t ret = UVC_SUCCESS;
 	/* Total amount of data per transfer */
 	size_t total_transfer_size;
 	struct libusb_transfer *transfer;
@@ -1426,20 +1438,6 @@ uvc_error_t uvc_stream_start_bandwidth(uvc_stream_handle_t *strmh,
 
 	ctrl = &strmh->cur_ctrl;
 
-	UVC_ENTER();
-
-	if (UNLIKELY(strmh->running)) {
-		UVC_EXIT(UVC_ERROR_BUSY);
-		return UVC_ERROR_BUSY;
-	}
-
-	strmh->running = 1;
-	strmh->seq = 0;
-	strmh->fid = 0;
-	strmh->pts = 0;
-	strmh->last_scr = 0;
-	strmh->bfh_err = 0;	// XXX
-
 	frame_desc = uvc_find_frame_desc_stream(strmh, ctrl->bFormatIndex, ctrl->bFrameIndex);
 	if (UNLIKELY(!frame_desc)) {
 		ret = UVC_ERROR_INVALID_PARAM;
@@ -1607,16 +1605,18 @@ uvc_error_t uvc_stream_start_bandwidth(uvc_stream_handle_t *strmh,
 		}
 	}
 
-	strmh->user_cb = cb;
-	strmh->user_ptr = user_ptr;
+	return UVC_SUCCESS;
+fail:
+	return ret;
+}
+
+/** @internal
+ * @brief Submit all transfers set up by _uvc_stream_prepare_transfers
+ */
+static uvc_error_t _uvc_stream_submit_transfers(uvc_stream_handle_t *strmh) {
+	uvc_error_t ret = UVC_SUCCESS;
+	int transfer_id;
 
-	/* If the user wants it, set up a thread that calls the user's function
-	 * with the contents of each frame.
-	 */
-	MARK("create callback thread");
-	if LIKELY(cb) {
-		pthread_create(&strmh->cb_thread, NULL, _uvc_user_caller, (void*) strmh);
-	}
 	MARK("submit transfers");
 	for (transfer_id = 0; transfer_id < LIBUVC_NUM_TRANSFER_BUFS; transfer_id++) {
 		ret = libusb_submit_transfer(strmh->transfers[transfer_id]);
@@ -1625,7 +1625,52 @@ uvc_error_t uvc_stream_start_bandwidth(uvc_stream_handle_t *strmh,
 			break;
 		}
 	}
+	return ret;
+}
+
+/** Begin streaming video from the stream into the callback function.
+ * @ingroup streaming
+ *
+ * @param strmh UVC stream
+ * @param cb   User callback function. See {uvc_frame_callback_t} for restrictions.
+ * @param bandwidth_factor [0.0f, 1.0f]
+ * @param flags Stream setup flags, currently undefined. Set this to zero. The lower bit
+ * is reserved for backward compatibility.
+ */
+uvc_error_t uvc_stream_start_bandwidth(uvc_stream_handle_t *strmh,
+		uvc_frame_callback_t *cb, void *user_ptr, float bandwidth_factor, uint8_t flags) {
+	uvc_error_t ret;
+
+	UVC_ENTER();
+
+	if (UNLIKELY(strmh->running)) {
+		UVC_EXIT(UVC_ERROR_BUSY);
+		return UVC_ERROR_BUSY;
+	}
+
+	strmh->running = 1;
+	strmh->seq = 0;
+	strmh->fid = 0;
+	strmh->pts = 0;
+	strmh->last_scr = 0;
+	strmh->bfh_err = 0;	// XXX
 
+	ret = _uvc_stream_prepare_transfers(strmh, bandwidth_factor);
+	if (UNLIKELY(ret != UVC_SUCCESS))
+		goto fail;
+
+	strmh->user_cb = cb;
+	strmh->user_ptr = user_ptr;
+
+	/* If the user wants it, set up a thread that calls the user's function
+	 * with the contents of each frame.
+	 */
+	uvc_apply_handler_thread_config(strmh->devh->dev->ctx);
+	MARK("create callback thread");
+	if LIKELY(cb) {
+		pthread_create(&strmh->cb_thread, NULL, _uvc_user_caller, (void*) strmh);
+	}
+	ret = _uvc_stream_submit_transfers(strmh);
 	if (UNLIKELY(ret != UVC_SUCCESS)) {
 		/** @todo clean up transfers and memory */
 		goto fail;
@@ -1665,6 +1710,9 @@ static void *_uvc_user_caller(void *arg) {
 	uvc_stream_handle_t *strmh = (uvc_stream_handle_t *) arg;
 
 	uint32_t last_seq = 0;
+	int deliver;
+
+	uvc_apply_thread_config(strmh->devh->dev->ctx, UVC_THREAD_CALLBACK);
 
 	for (; 1 ;) {
 		pthread_mutex_lock(&strmh->cb_mutex);
@@ -1679,12 +1727,13 @@ static void *_uvc_user_caller(void *arg) {
 			}
 
 			last_seq = strmh->hold_seq;
-			if (LIKELY(!strmh->hold_bfh_err))	// XXX
+			deliver = LIKELY(!strmh->hold_bfh_err) || strmh->devh->error_frames;	// XXX
+			if (deliver)
 				_uvc_populate_frame(strmh);
 		}
 		pthread_mutex_unlock(&strmh->cb_mutex);
 
-		if (LIKELY(!strmh->hold_bfh_err))	// XXX
+		if (deliver)
 			strmh->user_cb(&strmh->frame, strmh->user_ptr);	// call user callback function
 	}
 
@@ -1714,6 +1763,13 @@ void _uvc_populate_frame(uvc_stream_handle_t *strmh) {
 	frame->height = frame_desc->wHeight;
 	// XXX set actual_bytes to zero when erro bits is on
 	frame->actual_bytes = LIKELY(!strmh->hold_bfh_err) ? strmh->hold_bytes : 0;
+	frame->received_bytes = strmh->hold_bytes;
+	frame->sequence = strmh->hold_seq;
+	frame->capture_time = strmh->hold_time;
+	frame->capture_mono_us = strmh->hold_mono_us;
+	frame->pts = strmh->hold_pts;
+	frame->scr = strmh->hold_last_scr;
+	frame->bfh_err = strmh->hold_bfh_err;
 
 	switch (frame->frame_format) {
 	case UVC_FRAME_FORMAT_YUYV:
@@ -1733,8 +1789,6 @@ void _uvc_populate_frame(uvc_stream_handle_t *strmh) {
 		frame->data_bytes = strmh->hold_bytes;
 	}
 	memcpy(frame->data, strmh->holdbuf, strmh->hold_bytes/*frame->data_bytes*/);	// XXX
-
-	/** @todo set the frame time */
 }
 
 /** Poll for a frame
@@ -1802,6 +1856,331 @@ uvc_error_t uvc_stream_get_frame(uvc_stream_handle_t *strmh,
 	return UVC_SUCCESS;
 }
 
+/** @internal
+ * @brief Mark the transfer as parked(not submitted) while pausing
+ */
+static void _uvc_park_transfer(struct libusb_transfer *transfer) {
+	uvc_stream_handle_t *strmh = transfer->user_data;
+	int i;
+
+	pthread_mutex_lock(&strmh->cb_mutex);
+	{
+		for (i = 0; i < LIBUVC_NUM_TRANSFER_BUFS; i++) {
+			if (strmh->transfers[i] == transfer) {
+				strmh->parked_mask |= (1U << i);
+				strmh->pause_cancel_mask &= ~(1U << i);
+				break;
+			}
+		}
+		pthread_cond_broadcast(&strmh->cb_cond);
+	}
+	pthread_mutex_unlock(&strmh->cb_mutex);
+}
+
+/** @internal
+ * @brief Transfer cancelled by #uvc_stream_pause completed after the stream was resumed
+ * @return 1 if the transfer should be resubmitted
+ */
+static int _uvc_take_pause_cancelled(struct libusb_transfer *transfer) {
+	uvc_stream_handle_t *strmh = transfer->user_data;
+	int i, result = 0;
+
+	pthread_mutex_lock(&strmh->cb_mutex);
+	{
+		for (i = 0; i < LIBUVC_NUM_TRANSFER_BUFS; i++) {
+			if (strmh->transfers[i] == transfer) {
+				result = (strmh->pause_cancel_mask & (1U << i)) != 0;
+				strmh->pause_cancel_mask &= ~(1U << i);
+				break;
+			}
+		}
+	}
+	pthread_mutex_unlock(&strmh->cb_mutex);
+
+	return result;
+}
+
+/** @internal
+ * @brief Cancel transfers that are not parked yet and wait until all transfers are parked
+ * must be called with stream cb lock held and paused flag set
+ * @return UVC_SUCCESS: all transfers are parked, UVC_ERROR_TIMEOUT: some are still in flight
+ */
+static uvc_error_t _uvc_stream_park_transfers(uvc_stream_handle_t *strmh, int cancel) {
+	uint32_t all_mask;
+	int i, retry;
+
+	/* transfers that were resubmitted just before setting paused flag
+	 * are cancelled on the next round */
+	for (retry = 0; retry < 10; retry++) {
+		all_mask = 0;
+		for (i = 0; i < LIBUVC_NUM_TRANSFER_BUFS; i++) {
+			if (strmh->transfers[i]) {
+				all_mask |= (1U << i);
+				if (cancel && !(strmh->parked_mask & (1U << i))
+					&& !libusb_cancel_transfer(strmh->transfers[i])) {
+					strmh->pause_cancel_mask |= (1U << i);
+				}
+			}
+		}
+		if ((strmh->parked_mask & all_mask) == all_mask)
+			return UVC_SUCCESS;
+		ts.tv_sec = 0;
+		ts.tv_nsec = 0;
+#if _POSIX_TIMERS > 0
+		clock_gettime(CLOCK_REALTIME, &ts);
+#else
+		gettimeofday(&tv, NULL);
+		ts.tv_sec = tv.tv_sec;
+		ts.tv_nsec = tv.tv_usec * 1000;
+#endif
+		ts.tv_nsec += 100000000;	// 100ms
+		if (ts.tv_nsec >= 1000000000) {
+			ts.tv_sec++;
+			ts.tv_nsec -= 1000000000;
+		}
+		pthread_cond_timedwait(&strmh->cb_cond, &strmh->cb_mutex, &ts);
+	}
+	return UVC_ERROR_TIMEOUT;
+}
+
+/** @brief Pause streaming but keep the stream ready to resume
+ * @ingroup streaming
+ *
+ * Stops submitting transfers, but keeps transfers and their buffers,
+ * the selected altsetting and the callback thread, so that #uvc_stream_resume
+ * only needs to resubmit the transfers.
+ * Transfers that do not complete within the wait are parked when they complete
+ * later, and #uvc_stream_resume waits for them again.
+ *
+ * @param strmh UVC stream
+ */
+uvc_error_t uvc_stream_pause(uvc_stream_handle_t *strmh) {
+	UVC_ENTER();
+
+	if (UNLIKELY(!strmh->running)) {
+		UVC_EXIT(UVC_ERROR_INVALID_PARAM);
+		return UVC_ERROR_INVALID_PARAM;
+	}
+	if (strmh->paused) {
+		UVC_EXIT(UVC_SUCCESS);
+		return UVC_SUCCESS;
+	}
+
+	pthread_mutex_lock(&strmh->cb_mutex);
+	{
+		strmh->parked_mask = 0;
+		strmh->pause_cancel_mask = 0;
+		strmh->paused = 1;
+		if (UNLIKELY(_uvc_stream_park_transfers(strmh, 1))) {
+			UVC_DEBUG("some transfers are not parked yet, park them on completion");
+		}
+		// discard partially received frame
+		strmh->got_bytes = 0;
+		strmh->bfh_err = 0;	// XXX
+	}
+	pthread_mutex_unlock(&strmh->cb_mutex);
+
+	UVC_EXIT(UVC_SUCCESS);
+	return UVC_SUCCESS;
+}
+
+/** @brief Resume streaming paused by #uvc_stream_pause
+ * @ingroup streaming
+ *
+ * @param strmh UVC stream
+ */
+uvc_error_t uvc_stream_resume(uvc_stream_handle_t *strmh) {
+	uvc_error_t ret = UVC_SUCCESS;
+	int i;
+
+	UVC_ENTER();
+
+	if (UNLIKELY(!strmh->running)) {
+		UVC_EXIT(UVC_ERROR_INVALID_PARAM);
+		return UVC_ERROR_INVALID_PARAM;
+	}
+	if (!strmh->paused) {
+		UVC_EXIT(UVC_SUCCESS);
+		return UVC_SUCCESS;
+	}
+
+	pthread_mutex_lock(&strmh->cb_mutex);
+	{
+		// wait for transfers that were still in flight when pausing,
+		// still paused here so that they are parked and resubmitted together
+		if (UNLIKELY(_uvc_stream_park_transfers(strmh, 0))) {
+			// resubmitted by _uvc_stream_callback when they complete
+			LOGW("some transfers are still in flight:parked=0x%x", strmh->parked_mask);
+		}
+		strmh->paused = 0;
+		strmh->fid = 0;
+		strmh->got_bytes = 0;
+		strmh->bfh_err = 0;	// XXX
+	}
+	pthread_mutex_unlock(&strmh->cb_mutex);
+
+	for (i = 0; i < LIBUVC_NUM_TRANSFER_BUFS; i++) {
+		if (strmh->transfers[i] && (strmh->parked_mask & (1U << i))) {
+			ret = libusb_submit_transfer(strmh->transfers[i]);
+			if (UNLIKELY(ret != UVC_SUCCESS)) {
+				UVC_DEBUG("libusb_submit_transfer failed");
+				break;
+			}
+		}
+	}
+	strmh->parked_mask = 0;
+
+	UVC_EXIT(ret);
+	return ret;
+}
+
+/** @brief Change format/size/fps of a running stream without stopping it
+ * @ingroup streaming
+ *
+ * Transfers are cancelled and set up again for the new stream control
+ * (altsetting is selected again), but the callback thread and
+ * frame buffers are kept. If the stream is not running, this just commits.
+ *
+ * @param strmh UVC stream
+ * @param ctrl Negotiated stream control, e.g. by uvc_get_stream_ctrl_format_size_fps
+ * @param bandwidth_factor [0.0f, 1.0f]
+ */
+uvc_error_t uvc_stream_reconfigure(uvc_stream_handle_t *strmh,
+		uvc_stream_ctrl_t *ctrl, float bandwidth_factor) {
+	const struct libusb_interface *interface;
+	uvc_error_t ret, r;
+
+	UVC_ENTER();
+
+	if (UNLIKELY(strmh->stream_if->bInterfaceNumber != ctrl->bInterfaceNumber)) {
+		UVC_EXIT(UVC_ERROR_INVALID_PARAM);
+		return UVC_ERROR_INVALID_PARAM;
+	}
+	if (!strmh->running) {
+		ret = uvc_stream_ctrl(strmh, ctrl);
+		UVC_EXIT(ret);
+		return ret;
+	}
+
+	pthread_mutex_lock(&strmh->cb_mutex);
+	{
+		strmh->suspended = 1;
+		ret = _uvc_stream_cancel_transfers(strmh);
+	}
+	pthread_mutex_unlock(&strmh->cb_mutex);
+	if (UNLIKELY(ret)) {
+		// preparing new transfers would overwrite the slots of ones still in flight,
+		// stop the stream instead, late callbacks free their transfers when not running
+		LOGE("transfers did not finish, stop stream");
+		strmh->suspended = 0;
+		uvc_stream_stop(strmh);
+		UVC_EXIT(ret);
+		return ret;
+	}
+
+	interface = &strmh->devh->info->config->interface[strmh->stream_if->bInterfaceNumber];
+	if (interface->num_altsetting > 1) {
+		// back to zero bandwidth altsetting while committing
+		libusb_set_interface_alt_setting(strmh->devh->usb_devh,
+			strmh->stream_if->bInterfaceNumber, 0);
+	}
+
+	ret = uvc_query_stream_ctrl(strmh->devh, ctrl, 0, UVC_SET_CUR);	// commit query
+	if (LIKELY(ret == UVC_SUCCESS)) {
+		pthread_mutex_lock(&strmh->cb_mutex);
+		{
+			strmh->cur_ctrl = *ctrl;
+			strmh->fid = 0;
+			strmh->pts = 0;
+			strmh->last_scr = 0;
+			strmh->got_bytes = 0;
+			strmh->bfh_err = 0;	// XXX
+		}
+		pthread_mutex_unlock(&strmh->cb_mutex);
+	} else {
+		LOGW("failed to commit new stream control, restart with previous one:err=%d", ret);
+		uvc_query_stream_ctrl(strmh->devh, &strmh->cur_ctrl, 0, UVC_SET_CUR);
+	}
+
+	r = _uvc_stream_prepare_transfers(strmh, bandwidth_factor);
+	strmh->suspended = 0;
+	strmh->paused = 0;	// paused stream also restarts here
+	strmh->parked_mask = 0;
+	strmh->pause_cancel_mask = 0;
+	if (LIKELY(r == UVC_SUCCESS))
+		r = _uvc_stream_submit_transfers(strmh);
+	if (UNLIKELY(r != UVC_SUCCESS)) {
+		LOGE("failed to restart transfers:err=%d", r);
+		ret = r;
+	}
+
+	UVC_EXIT(ret);
+	return ret;
+}
+
+/** @brief Pause all streams on the device
+ * @ingroup streaming
+ *
+ * @param devh UVC device
+ */
+uvc_error_t uvc_pause_streaming(uvc_device_handle_t *devh) {
+	uvc_stream_handle_t *strmh;
+	uvc_error_t ret = UVC_ERROR_INVALID_PARAM;
+
+	DL_FOREACH(devh->streams, strmh)
+	{
+		ret = uvc_stream_pause(strmh);
+	}
+	return ret;
+}
+
+/** @brief Resume all streams on the device paused by #uvc_pause_streaming
+ * @ingroup streaming
+ *
+ * @param devh UVC device
+ */
+uvc_error_t uvc_resume_streaming(uvc_device_handle_t *devh) {
+	uvc_stream_handle_t *strmh;
+	uvc_error_t ret = UVC_ERROR_INVALID_PARAM;
+
+	DL_FOREACH(devh->streams, strmh)
+	{
+		ret = uvc_stream_resume(strmh);
+	}
+	return ret;
+}
+
+/** @brief Also deliver frames whose payload headers had error bits to the callback
+ * @ingroup streaming
+ *
+ * Those frames have non-zero bfh_err and zero actual_bytes, the callback must check bfh_err.
+ * received_bytes keeps the number of bytes actually received for them.
+ * @param devh UVC device
+ * @param enable 0: drop them(default), 1: deliver them
+ */
+uvc_error_t uvc_set_error_frames(uvc_device_handle_t *devh, int enable) {
+	if (UNLIKELY(!devh))
+		return UVC_ERROR_INVALID_PARAM;
+	devh->error_frames = enable ? 1 : 0;
+	return UVC_SUCCESS;
+}
+
+/** @brief Change format/size/fps of the running stream on the device
+ * @ingroup streaming
+ *
+ * @param devh UVC device
+ * @param ctrl Negotiated stream control
+ * @param bandwidth_factor [0.0f, 1.0f]
+ */
+uvc_error_t uvc_reconfigure_streaming(uvc_device_handle_t *devh,
+		uvc_stream_ctrl_t *ctrl, float bandwidth_factor) {
+
+	uvc_stream_handle_t *strmh = _uvc_get_stream_by_interface(devh, ctrl->bInterfaceNumber);
+	if (UNLIKELY(!strmh))
+		return UVC_ERROR_INVALID_PARAM;
+	return uvc_stream_reconfigure(strmh, ctrl, bandwidth_factor);
+}
+
 /** @brief Stop streaming video
  * @ingroup streaming
  *
@@ -1820,6 +2199,68 @@ void uvc_stop_streaming(uvc_device_handle_t *devh) {
 	UVC_EXIT_VOID();
 }
 
+/** @internal
+ * @brief Cancel all transfers and wait until they are deleted by _uvc_stream_callback
+ * must be called with stream cb lock held!
+ * @return UVC_ERROR_TIMEOUT if some transfers are still in flight after waiting
+ */
+static uvc_error_t _uvc_stream_cancel_transfers(uvc_stream_handle_t *strmh) {
+	int i;
+
+	for (i = 0; i < LIBUVC_NUM_TRANSFER_BUFS; i++) {
+		if (strmh->transfers[i]) {
+			int res = libusb_cancel_transfer(strmh->transfers[i]);
+			if ((res < 0) && (res != LIBUSB_ERROR_NOT_FOUND)) {
+				UVC_DEBUG("libusb_cancel_transfer failed");
+				// XXX originally freed buffers and transfer here
+				// but this could lead to crash in _uvc_callback
+				// therefore we comment out these lines
+				// and free these objects in _uvc_iso_callback when strmh->running is false
+/*				free(strmh->transfers[i]->buffer);
+				libusb_free_transfer(strmh->transfers[i]);
+				strmh->transfers[i] = NULL; */
+			}
+			if (res == LIBUSB_ERROR_NOT_FOUND && strmh->transfers[i] != NULL) {
+				free(strmh->transfers[i]->buffer);
+				// libusb_free_transfer(strmh->transfers[i]);
+				strmh->transfers[i] = NULL;
+			}
+		}
+	}
+
+	/* Wait for transfers to complete/cancel */
+	for (; 1 ;) {
+		for (i = 0; i < LIBUVC_NUM_TRANSFER_BUFS; i++) {
+			if (strmh->transfers[i] != NULL)
+				break;
+		}
+		if (i == LIBUVC_NUM_TRANSFER_BUFS)
+			break;
+
+		ts.tv_sec = 0;
+		ts.tv_nsec = 0;
+
+#if _POSIX_TIMERS > 0
+		clock_gettime(CLOCK_REALTIME, &ts);
+#else
+		gettimeofday(&tv, NULL);
+		ts.tv_sec = tv.tv_sec;
+		ts.tv_nsec = tv.tv_usec * 1000;
+#endif
+		ts.tv_sec += 1;
+		ts.tv_nsec += 0;
+		if (pthread_cond_timedwait(&strmh->cb_cond, &strmh->cb_mutex, &ts) == ETIMEDOUT) {
+			break;
+		}
+	}
+	for (i = 0; i < LIBUVC_NUM_TRANSFER_BUFS; i++) {
+		if (strmh->transfers[i] != NULL)
+			return UVC_ERROR_TIMEOUT;
+	}
+	return UVC_SUCCESS;
+}
+
+
 /** @brief Stop stream.
  * @ingroup streaming
  *
@@ -1829,7 +2270,6 @@ void uvc_stop_streaming(uvc_device_handle_t *devh) {
  */
 uvc_error_t uvc_stream_stop(uvc_stream_handle_t *strmh) {
 
-	int i;
 	ENTER();
 
 	if (!strmh) RETURN(UVC_SUCCESS, uvc_error_t);
@@ -1843,52 +2283,7 @@ uvc_error_t uvc_stream_stop(uvc_stream_handle_t *strmh) {
 
 	pthread_mutex_lock(&strmh->cb_mutex);
 	{
-		for (i = 0; i < LIBUVC_NUM_TRANSFER_BUFS; i++) {
-			if (strmh->transfers[i]) {
-				int res = libusb_cancel_transfer(strmh->transfers[i]);
-				if ((res < 0) && (res != LIBUSB_ERROR_NOT_FOUND)) {
-					UVC_DEBUG("libusb_cancel_transfer failed");
-					// XXX originally freed buffers and transfer here
-					// but this could lead to crash in _uvc_callback
-					// therefore we comment out these lines
-					// and free these objects in _uvc_iso_callback when strmh->running is false
-/*					free(strmh->transfers[i]->buffer);
-					libusb_free_transfer(strmh->transfers[i]);
-					strmh->transfers[i] = NULL; */
-				}
-				if (res == LIBUSB_ERROR_NOT_FOUND && strmh->transfers[i] != NULL) {
-                    free(strmh->transfers[i]->buffer);
-                    // libusb_free_transfer(strmh->transfers[i]);
-                    strmh->transfers[i] = NULL;
-                }
-			}
-		}
-
-		/* Wait for transfers to complete/cancel */
-		for (; 1 ;) {
-			for (i = 0; i < LIBUVC_NUM_TRANSFER_BUFS; i++) {
-				if (strmh->transfers[i] != NULL)
-					break;
-			}
-			if (i == LIBUVC_NUM_TRANSFER_BUFS)
-				break;
-
-             ts.tv_sec = 0;
-             ts.tv_nsec = 0;
-
-#if _POSIX_TIMERS > 0
-             clock_gettime(CLOCK_REALTIME, &ts);
-#else
-             gettimeofday(&tv, NULL);
-             ts.tv_sec = tv.tv_sec;
-             ts.tv_nsec = tv.tv_usec * 1000;
-#endif
-             ts.tv_sec += 1;
-             ts.tv_nsec += 0;
-			if (pthread_cond_timedwait(&strmh->cb_cond, &strmh->cb_mutex, &ts) == ETIMEDOUT) {
-                break;
-			}
-		}
+		_uvc_stream_cancel_transfers(strmh);
 		// Kick the user thread awake
 		pthread_cond_broadcast(&strmh->cb_cond);
 	}